@@ -99,6 +99,7 @@ apple_cgl_init(void)
 
    apple_cgl.choose_pixel_format = sym(h, "CGLChoosePixelFormat");
    apple_cgl.destroy_pixel_format = sym(h, "CGLDestroyPixelFormat");
+   apple_cgl.describe_pixel_format = sym(h, "CGLDescribePixelFormat");
 
    apple_cgl.clear_drawable = sym(h, "CGLClearDrawable");
    apple_cgl.flush_drawable = sym(h, "CGLFlushDrawable");
@@ -45,6 +45,9 @@ struct apple_cgl_api
      CGLError(*choose_pixel_format) (const CGLPixelFormatAttribute * attribs,
                                      CGLPixelFormatObj * pix, GLint * npix);
      CGLError(*destroy_pixel_format) (CGLPixelFormatObj pix);
+     CGLError(*describe_pixel_format) (CGLPixelFormatObj pix, GLint pix_num,
+                                       CGLPixelFormatAttribute attrib,
+                                       GLint * value);
 
      CGLError(*clear_drawable) (CGLContextObj ctx);
      CGLError(*flush_drawable) (CGLContextObj ctx);
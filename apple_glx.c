@@ -137,6 +137,9 @@ apple_init_glx(Display * dpy)
       diagnostic = true;
    }
 
+   if (getenv("LIBGL_MAKE_CURRENT_STATS"))
+      atexit(apple_glx_dump_make_current_stats);
+
    apple_cgl_init();
    apple_xgl_init_direct();
    libgl_handle = dlopen(OPENGL_LIB_PATH, RTLD_LAZY);
@@ -161,14 +164,110 @@ apple_glx_swap_buffers(void *ptr)
    apple_cgl.flush_drawable(ac->context_obj);
 }
 
+/*
+ * This caches the results of apple_glx_get_proc_address.
+ *
+ * The table is open addressed, and each slot is written once with a
+ * compare and swap, so a cache hit doesn't need a lock.  The entries
+ * are never freed, because they may be in use by a reader at any time.
+ * When the table is full, new names are still resolved, but not cached.
+ */
+#define PROC_CACHE_SIZE 4096    /* This must be a power of 2. */
+#define PROC_CACHE_MAX ((PROC_CACHE_SIZE * 3) / 4)
+
+struct proc_cache_entry
+{
+   unsigned int hash;
+   void *proc;
+   char name[];
+};
+
+static struct proc_cache_entry *volatile proc_cache[PROC_CACHE_SIZE];
+static volatile int proc_cache_count = 0;
+
+static unsigned int
+proc_cache_hash(const char *name)
+{
+   unsigned int hash = 2166136261U;
+
+   /* FNV-1a */
+   for (; *name; ++name) {
+      hash ^= (unsigned char) *name;
+      hash *= 16777619U;
+   }
+
+   return hash;
+}
+
+static void *
+proc_cache_find(const char *name, unsigned int hash)
+{
+   struct proc_cache_entry *e;
+   unsigned int i;
+
+   for (i = hash & (PROC_CACHE_SIZE - 1); (e = proc_cache[i]);
+        i = (i + 1) & (PROC_CACHE_SIZE - 1)) {
+      if (e->hash == hash && !strcmp(e->name, name))
+         return e->proc;
+   }
+
+   return NULL;
+}
+
+static void
+proc_cache_insert(const char *name, unsigned int hash, void *proc)
+{
+   struct proc_cache_entry *e, *existing;
+   size_t len;
+   unsigned int i;
+
+   if (proc_cache_count >= PROC_CACHE_MAX)
+      return;
+
+   len = strlen(name);
+   e = malloc(sizeof(*e) + len + 1);
+
+   if (NULL == e)
+      return;
+
+   e->hash = hash;
+   e->proc = proc;
+   memcpy(e->name, name, len + 1);
+
+   for (i = hash & (PROC_CACHE_SIZE - 1);;
+        i = (i + 1) & (PROC_CACHE_SIZE - 1)) {
+      /* The compare and swap also publishes the entry's contents. */
+      if (__sync_bool_compare_and_swap(&proc_cache[i], NULL, e)) {
+         __sync_fetch_and_add(&proc_cache_count, 1);
+         return;
+      }
+
+      existing = proc_cache[i];
+
+      if (existing->hash == hash && !strcmp(existing->name, name)) {
+         /* Another thread cached this name first. */
+         free(e);
+         return;
+      }
+   }
+}
+
 void *
 apple_glx_get_proc_address(const GLubyte * procname)
 {
    size_t len;
    void *h, *s;
    char *pname = (char *) procname;
+   unsigned int hash;
 
    assert(NULL != procname);
+
+   hash = proc_cache_hash(pname);
+   s = proc_cache_find(pname, hash);
+
+   if (s)
+      return s;
+
    len = strlen(pname);
 
    if (len < 3) {
@@ -198,6 +297,13 @@ apple_glx_get_proc_address(const GLubyte * procname)
 
    dlclose(h);
 
+   /* 
+    * Failures aren't cached, because the symbol may become available
+    * later, from a library loaded with dlopen.
+    */
+   if (s)
+      proc_cache_insert(pname, hash, s);
+
    return s;
 }
 
@@ -0,0 +1,240 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <ApplicationServices/ApplicationServices.h>
+#include "apple_glx.h"
+#include "apple_cgl.h"
+#include "apple_glx_caps.h"
+
+#ifndef GL_MAX_RECTANGLE_TEXTURE_SIZE_EXT
+#define GL_MAX_RECTANGLE_TEXTURE_SIZE_EXT 0x84F8
+#endif
+
+/* This protects the apple_glx_screen_caps of every screen. */
+static pthread_mutex_t caps_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t caps_once_control = PTHREAD_ONCE_INIT;
+
+/* 
+ * This counts the display reconfigurations.  The notifications are
+ * delivered by the run loop of the thread that registered for them, so in
+ * a process that never runs one, the renderer is resolved only once.
+ */
+static unsigned long display_generation = 1;
+
+static void
+lock_caps(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&caps_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_caps(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&caps_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+/* 
+ * Query the limits with a temporary context of pfobj.  The context that
+ * was current in this thread is restored afterward.
+ * Return true if an error occurred.
+ */
+static bool
+probe_caps(CGLPixelFormatObj pfobj, struct apple_glx_renderer_caps *caps)
+{
+   CGLContextObj oldcontext, newcontext;
+   CGLError err;
+   bool error = true;
+
+   err = apple_cgl.create_context(pfobj, NULL, &newcontext);
+
+   if (kCGLNoError != err) {
+      apple_glx_diagnostic("create_context error in %s: %s\n", __func__,
+                           apple_cgl.error_string(err));
+      return true;
+   }
+
+   oldcontext = apple_cgl.get_current_context();
+
+   err = apple_cgl.set_current_context(newcontext);
+
+   if (kCGLNoError == err) {
+      glGetIntegerv(GL_MAX_VIEWPORT_DIMS, caps->max_viewport_dims);
+      glGetIntegerv(GL_MAX_TEXTURE_SIZE, &caps->max_texture_size);
+      glGetIntegerv(GL_MAX_RECTANGLE_TEXTURE_SIZE_EXT,
+                    &caps->max_rectangle_texture_size);
+
+      apple_cgl.set_current_context(oldcontext);
+      error = false;
+   }
+   else {
+      apple_glx_diagnostic("set_current_context error in %s: %s\n",
+                           __func__, apple_cgl.error_string(err));
+   }
+
+   apple_cgl.destroy_context(newcontext);
+
+   return error;
+}
+
+static void
+display_reconfigured(CGDirectDisplayID display,
+                     CGDisplayChangeSummaryFlags flags, void *data)
+{
+   /* There is a notification before the change, and one after it. */
+   if (flags & kCGDisplayBeginConfigurationFlag)
+      return;
+
+   (void) __atomic_add_fetch(&display_generation, 1, __ATOMIC_RELAXED);
+}
+
+static void
+init_caps(void)
+{
+   if (kCGErrorSuccess !=
+       CGDisplayRegisterReconfigurationCallback(display_reconfigured, NULL))
+      apple_glx_diagnostic("unable to register for display changes in %s\n",
+                           __func__);
+}
+
+/* 
+ * Return the ID of the renderer that a new context of a default pixel
+ * format uses, which is the renderer of its first virtual screen.
+ * Return true if an error occurred, with *known false if the pixel format
+ * doesn't describe its renderer.
+ */
+static bool
+resolve_renderer(CGLPixelFormatObj * pfobj, GLint * renderer_id,
+                 bool * known)
+{
+   CGLPixelFormatAttribute attr[3];
+   CGLError err;
+   GLint vsref = 0;
+
+   attr[0] = kCGLPFAColorSize;
+   attr[1] = 32;
+   attr[2] = 0;
+
+   err = apple_cgl.choose_pixel_format(attr, pfobj, &vsref);
+
+   if (kCGLNoError != err) {
+      apple_glx_diagnostic("choose_pixel_format error in %s: %s\n",
+                           __func__, apple_cgl.error_string(err));
+      return true;
+   }
+
+   *known = (kCGLNoError ==
+             apple_cgl.describe_pixel_format(*pfobj, 0, kCGLPFARendererID,
+                                             renderer_id));
+
+   return false;
+}
+
+bool
+apple_glx_get_renderer_caps(struct apple_glx_screen_caps *screen_caps,
+                            struct apple_glx_renderer_caps *caps)
+{
+   CGLPixelFormatObj pfobj;
+   GLint renderer_id = 0;
+   unsigned long generation;
+   bool known = false, error;
+
+   (void) pthread_once(&caps_once_control, init_caps);
+
+   generation = __atomic_load_n(&display_generation, __ATOMIC_RELAXED);
+
+   /* 
+    * The lock is held while the renderer is resolved and probed, so that
+    * concurrent callers wait for the one probe rather than making their
+    * own contexts.
+    */
+   lock_caps();
+
+   if (screen_caps->valid && generation == screen_caps->generation) {
+      *caps = screen_caps->caps;
+      unlock_caps();
+      return false;
+   }
+
+   if (resolve_renderer(&pfobj, &renderer_id, &known)) {
+      unlock_caps();
+      return true;
+   }
+
+   if (known && screen_caps->valid
+       && renderer_id == screen_caps->renderer_id) {
+      /* The display changed, but the renderer didn't. */
+      screen_caps->generation = generation;
+      *caps = screen_caps->caps;
+      error = false;
+   }
+   else {
+      error = probe_caps(pfobj, caps);
+
+      /* Without a renderer ID, the limits are probed but not cached. */
+      if (!error && known) {
+         screen_caps->valid = true;
+         screen_caps->generation = generation;
+         screen_caps->renderer_id = renderer_id;
+         screen_caps->caps = *caps;
+      }
+
+      if (!error)
+         apple_glx_diagnostic("renderer caps for renderer 0x%x: viewport "
+                              "%dx%d texture %d rectangle %d\n",
+                              renderer_id, caps->max_viewport_dims[0],
+                              caps->max_viewport_dims[1],
+                              caps->max_texture_size,
+                              caps->max_rectangle_texture_size);
+   }
+
+   unlock_caps();
+
+   apple_cgl.destroy_pixel_format(pfobj);
+
+   return error;
+}
@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#ifndef APPLE_GLX_CAPS_H
+#define APPLE_GLX_CAPS_H
+
+#include <stdbool.h>
+#include <OpenGL/gl.h>
+
+/* 
+ * The limits of a screen's renderer.  They are cached in the screen's
+ * __GLXscreenConfigs, and keyed by the renderer ID.  The renderer is
+ * resolved by the first query, and again only by the first query after a
+ * display reconfiguration notification, so a query doesn't touch CGL
+ * otherwise.  A new renderer is probed with a temporary context.
+ *
+ * The pbuffers use this for GLX_LARGEST_PBUFFER.  The pixmaps and
+ * fbconfigs don't query the renderer.
+ */
+struct apple_glx_renderer_caps
+{
+   GLint max_viewport_dims[2];
+   GLint max_texture_size;
+   GLint max_rectangle_texture_size;
+};
+
+struct apple_glx_screen_caps
+{
+   bool valid;
+   /* The display configuration that the renderer was resolved in. */
+   unsigned long generation;
+   GLint renderer_id;
+   struct apple_glx_renderer_caps caps;
+};
+
+/* Return true if an error occurred. */
+bool apple_glx_get_renderer_caps(struct apple_glx_screen_caps *screen_caps,
+                                 struct apple_glx_renderer_caps *caps);
+
+#endif
@@ -53,17 +53,21 @@
 #include "appledri.h"
 #include "apple_visual.h"
 #include "apple_cgl.h"
+#include "apple_xgl_api.h"
 #include "apple_glx_drawable.h"
 
-static pthread_mutex_t context_lock = PTHREAD_MUTEX_INITIALIZER;
+extern struct apple_xgl_api __gl_api;
 
 /*
- * This should be locked on creation and destruction of the 
- * apple_glx_contexts.
+ * This should be write locked on creation and destruction of the 
+ * apple_glx_contexts.  Readers such as is_context_valid only need a
+ * read lock, so they don't serialize against each other.
  *
- * It's also locked when the surface_notify_handler is searching
- * for a uid associated with a surface.
+ * The surface_notify_handler doesn't use this list.  It finds the
+ * contexts for a uid via the surface drawable (see attach_drawable).
  */
+static pthread_rwlock_t context_lock = PTHREAD_RWLOCK_INITIALIZER;
+
 static struct apple_glx_context *context_list = NULL;
 
 /* This guards the context_list above. */
@@ -72,10 +76,24 @@ lock_context_list(void)
 {
    int err;
 
-   err = pthread_mutex_lock(&context_lock);
+   err = pthread_rwlock_wrlock(&context_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_rwlock_wrlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+read_lock_context_list(void)
+{
+   int err;
+
+   err = pthread_rwlock_rdlock(&context_lock);
 
    if (err) {
-      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+      fprintf(stderr, "pthread_rwlock_rdlock failure in %s: %d\n",
               __func__, err);
       abort();
    }
@@ -86,10 +104,10 @@ unlock_context_list(void)
 {
    int err;
 
-   err = pthread_mutex_unlock(&context_lock);
+   err = pthread_rwlock_unlock(&context_lock);
 
    if (err) {
-      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+      fprintf(stderr, "pthread_rwlock_unlock failure in %s: %d\n",
               __func__, err);
       abort();
    }
@@ -100,7 +118,7 @@ is_context_valid(struct apple_glx_context *ac)
 {
    struct apple_glx_context *i;
 
-   lock_context_list();
+   read_lock_context_list();
 
    for (i = context_list; i; i = i->next) {
       if (ac == i) {
@@ -114,6 +132,165 @@ is_context_valid(struct apple_glx_context *ac)
    return false;
 }
 
+/* 
+ * The make current counters.  See apple_glx_get_make_current_stats.
+ * They're relaxed atomics, so counting doesn't add a lock to make current.
+ */
+static struct apple_glx_make_current_stats stats;
+
+static void
+add_stat(unsigned long *counter)
+{
+   (void) __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED);
+}
+
+/* The counters are read one at a time, so the result may be mid-update. */
+void
+apple_glx_get_make_current_stats(struct apple_glx_make_current_stats *result)
+{
+   result->calls = __atomic_load_n(&stats.calls, __ATOMIC_RELAXED);
+   result->set_current = __atomic_load_n(&stats.set_current,
+                                         __ATOMIC_RELAXED);
+   result->set_current_skipped =
+      __atomic_load_n(&stats.set_current_skipped, __ATOMIC_RELAXED);
+   result->attaches = __atomic_load_n(&stats.attaches, __ATOMIC_RELAXED);
+   result->attaches_skipped = __atomic_load_n(&stats.attaches_skipped,
+                                              __ATOMIC_RELAXED);
+}
+
+void
+apple_glx_dump_make_current_stats(void)
+{
+   struct apple_glx_make_current_stats s;
+
+   apple_glx_get_make_current_stats(&s);
+
+   fprintf(stderr, "make current: %lu calls, %lu CGL context switches "
+           "(%lu skipped), %lu drawable attaches (%lu skipped)\n",
+           s.calls, s.set_current, s.set_current_skipped, s.attaches,
+           s.attaches_skipped);
+}
+
+/* 
+ * The CGL current context is per thread, so this skips the switch when
+ * the calling thread already has ctx current.  Return the CGL error.
+ */
+CGLError
+apple_glx_context_set_current_cgl(CGLContextObj ctx)
+{
+   if (apple_cgl.get_current_context() == ctx) {
+      add_stat(&stats.set_current_skipped);
+      return kCGLNoError;
+   }
+
+   add_stat(&stats.set_current);
+
+   return apple_cgl.set_current_context(ctx);
+}
+
+/* This is the CGL context that renders to ac->drawable. */
+static CGLContextObj
+drawable_context_obj(struct apple_glx_context *ac)
+{
+   if (ac->drawable && APPLE_GLX_DRAWABLE_PIXMAP == ac->drawable->type)
+      return ac->drawable->types.pixmap.context_obj;
+
+   return ac->context_obj;
+}
+
+/*
+ * This sets ac->drawable, which must be referenced by the caller.
+ * A surface drawable also tracks the contexts attached to it, so that a
+ * surface change only needs to visit the contexts using that surface.
+ */
+static void
+attach_drawable(struct apple_glx_context *ac, struct apple_glx_drawable *d)
+{
+   struct apple_glx_surface *s;
+
+   ac->drawable = d;
+   ac->surface_previous = NULL;
+   ac->surface_next = NULL;
+
+   if (APPLE_GLX_DRAWABLE_SURFACE != d->type)
+      return;
+
+   s = &d->types.surface;
+
+   d->ops->lock(d);
+
+   ac->surface_next = s->contexts;
+
+   if (s->contexts)
+      s->contexts->surface_previous = ac;
+
+   s->contexts = ac;
+
+   /* Attaching the CGL context picks up every change up to now. */
+   ac->surface_generation = s->generation;
+
+   d->ops->unlock(d);
+}
+
+/* 
+ * This detaches ac->drawable from ac, and releases the reference the
+ * context had to it, which may destroy the drawable.
+ */
+static void
+detach_drawable(struct apple_glx_context *ac)
+{
+   struct apple_glx_drawable *d = ac->drawable;
+
+   if (NULL == d)
+      return;
+
+   if (APPLE_GLX_DRAWABLE_SURFACE == d->type) {
+      d->ops->lock(d);
+
+      if (ac->surface_previous)
+         ac->surface_previous->surface_next = ac->surface_next;
+      else
+         d->types.surface.contexts = ac->surface_next;
+
+      if (ac->surface_next)
+         ac->surface_next->surface_previous = ac->surface_previous;
+
+      d->ops->unlock(d);
+   }
+
+   ac->surface_previous = NULL;
+   ac->surface_next = NULL;
+   ac->drawable = NULL;
+   ac->bound_drawable = NULL;
+
+   /*
+    * This potentially causes surface_notify_handler to be called in
+    * apple_glx.c, so no locks should be held here.
+    */
+   d->ops->destroy(d);
+}
+
+/* 
+ * This releases the read drawable binding, which may destroy the
+ * drawable, so no locks should be held here.
+ */
+static void
+unbind_read(struct apple_glx_context *ac)
+{
+   struct apple_glx_drawable *d = ac->read_drawable;
+
+   if (NULL == d)
+      return;
+
+   if (ac->read_context_obj && ac->read_current == ac->read_context_obj)
+      (void) apple_cgl.clear_drawable(ac->read_context_obj);
+
+   ac->read_drawable = NULL;
+   ac->read_current = NULL;
+
+   d->ops->destroy(d);
+}
+
 /* This creates an apple_private_context struct.  
  *
  * It's typically called to save the struct in a GLXContext.
@@ -148,14 +325,22 @@ apple_glx_create_context(void **ptr, Display * dpy, int screen,
    ac->context_obj = NULL;
    ac->pixel_format_obj = NULL;
    ac->drawable = NULL;
+   ac->bound_drawable = NULL;
+   ac->surface_previous = NULL;
+   ac->surface_next = NULL;
    ac->thread_id = pthread_self();
    ac->screen = screen;
    ac->double_buffered = false;
    ac->uses_stereo = false;
-   ac->need_update = false;
+   ac->surface_generation = 0;
    ac->is_current = false;
    ac->made_current = false;
    ac->last_surface_window = None;
+   ac->read_drawable = NULL;
+   ac->read_context_obj = NULL;
+   ac->read_current = NULL;
+   ac->read_dirty = 0;
+   ac->read_error = GL_NO_ERROR;
 
    apple_visual_create_pfobj(&ac->pixel_format_obj, mode,
                              &ac->double_buffered, &ac->uses_stereo,
@@ -167,7 +352,7 @@ apple_glx_create_context(void **ptr, Display * dpy, int screen,
 
 
    if (error) {
-      (void) apple_cgl.destroy_pixel_format(ac->pixel_format_obj);
+      apple_visual_destroy_pfobj(ac->pixel_format_obj);
 
       free(ac);
 
@@ -255,14 +440,14 @@ apple_glx_destroy_context(void **ptr, Display * dpy)
     * an abort due to an attempted deadlock.  This is why we earlier
     * removed the ac pointer from the double-linked list.
     */
-   if (ac->drawable) {
-      ac->drawable->destroy(ac->drawable);
-   }
+   detach_drawable(ac);
 
-   if (apple_cgl.destroy_pixel_format(ac->pixel_format_obj)) {
-      fprintf(stderr, "error: destroying pixel format in %s\n", __func__);
-      abort();
-   }
+   unbind_read(ac);
+
+   if (ac->read_context_obj)
+      (void) apple_cgl.destroy_context(ac->read_context_obj);
+
+   apple_visual_destroy_pfobj(ac->pixel_format_obj);
 
    if (apple_cgl.destroy_context(ac->context_obj)) {
       fprintf(stderr, "error: destroying context_obj in %s\n", __func__);
@@ -288,6 +473,11 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
    CGLError cglerr;
    bool same_drawable = false;
 
+   add_stat(&stats.calls);
+
+   /* This sends the teardown of the pbuffers destroyed since the last. */
+   apple_glx_drawable_flush_pending(dpy);
+
 #if 0
    apple_glx_diagnostic("%s: oldac %p ac %p drawable 0x%lx\n",
                         __func__, (void *) oldac, (void *) ac, drawable);
@@ -306,21 +496,25 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
          return false;
    }
 
-   /* Reset the is_current state of the old context, if non-NULL. */
-   if (oldac && (ac != oldac))
+   /* 
+    * Reset the is_current state of the old context, if non-NULL.  A
+    * released context also drops its read binding, so that it doesn't
+    * keep the read drawable alive.
+    */
+   if (oldac && (ac != oldac)) {
       oldac->is_current = false;
 
+      unbind_read(oldac);
+   }
+
    if (NULL == ac) {
       /*Clear the current context for this thread. */
-      apple_cgl.set_current_context(NULL);
+      apple_glx_context_set_current_cgl(NULL);
 
       if (oldac) {
          oldac->is_current = false;
 
-         if (oldac->drawable) {
-            oldac->drawable->destroy(oldac->drawable);
-            oldac->drawable = NULL;
-         }
+         detach_drawable(oldac);
 
          /* Invalidate this to prevent surface recreation. */
          oldac->last_surface_window = None;
@@ -334,16 +528,13 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
 
       /* Clear the current drawable for this context_obj. */
 
-      if (apple_cgl.set_current_context(ac->context_obj))
+      if (apple_glx_context_set_current_cgl(ac->context_obj))
          error = true;
 
       if (apple_cgl.clear_drawable(ac->context_obj))
          error = true;
 
-      if (ac->drawable) {
-         ac->drawable->destroy(ac->drawable);
-         ac->drawable = NULL;
-      }
+      detach_drawable(ac);
 
       /* Invalidate this to prevent surface recreation. */
       ac->last_surface_window = None;
@@ -368,10 +559,8 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
     * Try to destroy the old drawable, so long as the new one
     * isn't the old. 
     */
-   if (ac->drawable && !same_drawable) {
-      ac->drawable->destroy(ac->drawable);
-      ac->drawable = NULL;
-   }
+   if (ac->drawable && !same_drawable)
+      detach_drawable(ac);
 
    if (NULL == newagd) {
       if (apple_glx_surface_create(dpy, ac->screen, drawable, &newagd))
@@ -398,10 +587,10 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
        * all be OpenGL.
        *
        */
-      newagd->reference(newagd);
+      newagd->ops->reference(newagd);
 
       /* Save the new drawable with the context structure. */
-      ac->drawable = newagd;
+      attach_drawable(ac, newagd);
    }
    else {
       /* We are reusing an existing drawable structure. */
@@ -411,7 +600,7 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
          /* The drawable_find above retained a reference for us. */
       }
       else {
-         ac->drawable = newagd;
+         attach_drawable(ac, newagd);
       }
    }
 
@@ -425,7 +614,10 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
       return false;
    }
 
-   cglerr = apple_cgl.set_current_context(ac->context_obj);
+   assert(NULL != ac->context_obj);
+   assert(NULL != ac->drawable);
+
+   cglerr = apple_glx_context_set_current_cgl(drawable_context_obj(ac));
 
    if (kCGLNoError != cglerr) {
       fprintf(stderr, "set current error: %s\n",
@@ -435,20 +627,30 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
 
    ac->is_current = true;
 
-   assert(NULL != ac->context_obj);
-   assert(NULL != ac->drawable);
-
    ac->thread_id = pthread_self();
 
    /* This will be set if the pending_destroy code indicates it should be: */
    ac->last_surface_window = None;
 
+   /* 
+    * A context that switches away and back to the same drawable is still
+    * attached to it, unless the surface is going away.
+    */
+   if (ac->bound_drawable == ac->drawable
+       && !(APPLE_GLX_DRAWABLE_SURFACE == ac->drawable->type
+            && ac->drawable->types.surface.pending_destroy)) {
+      add_stat(&stats.attaches_skipped);
+      return false;
+   }
+
+   ac->bound_drawable = NULL;
+
    switch (ac->drawable->type) {
    case APPLE_GLX_DRAWABLE_PBUFFER:
    case APPLE_GLX_DRAWABLE_SURFACE:
    case APPLE_GLX_DRAWABLE_PIXMAP:
-      if (ac->drawable->callbacks.make_current) {
-         if (ac->drawable->callbacks.make_current(ac, ac->drawable))
+      if (ac->drawable->callbacks->make_current) {
+         if (ac->drawable->callbacks->make_current(ac, ac->drawable))
             return true;
       }
       break;
@@ -459,6 +661,9 @@ apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
       abort();
    }
 
+   add_stat(&stats.attaches);
+   ac->bound_drawable = ac->drawable;
+
    return false;
 }
 
@@ -479,6 +684,221 @@ apple_glx_is_current_drawable(Display * dpy, void *ptr, GLXDrawable drawable)
    return false;
 }
 
+/* The client state that glReadPixels uses, besides GL_PIXEL_MODE_BIT. */
+static const GLenum read_pack_state_names[APPLE_GLX_READ_PACK_STATE] = {
+   GL_PACK_SWAP_BYTES,
+   GL_PACK_LSB_FIRST,
+   GL_PACK_ROW_LENGTH,
+   GL_PACK_IMAGE_HEIGHT,
+   GL_PACK_SKIP_ROWS,
+   GL_PACK_SKIP_PIXELS,
+   GL_PACK_SKIP_IMAGES,
+   GL_PACK_ALIGNMENT,
+   GL_PIXEL_PACK_BUFFER_BINDING
+};
+
+#define READ_PACK_ALIGNMENT 7
+#define READ_PACK_BUFFER 8
+
+/* Return true if an error occurred. */
+static bool
+bind_read(struct apple_glx_context *ac, struct apple_glx_drawable *d)
+{
+   struct apple_glx_context shadow;
+   CGLError err;
+   int i;
+
+   if (APPLE_GLX_DRAWABLE_PBUFFER == d->type && NULL == ac->read_context_obj) {
+      err = apple_cgl.create_context(ac->pixel_format_obj, ac->context_obj,
+                                     &ac->read_context_obj);
+
+      if (kCGLNoError != err) {
+         ac->read_context_obj = NULL;
+         return true;
+      }
+
+      /* These are the defaults of a new context. */
+      for (i = 0; i < APPLE_GLX_READ_PACK_STATE; ++i)
+         ac->read_pack_state[i] = 0;
+
+      ac->read_pack_state[READ_PACK_ALIGNMENT] = 4;
+   }
+
+   /* The primary may have changed anything while nothing was bound. */
+   ac->read_dirty = APPLE_GLX_READ_PACK_DIRTY | APPLE_GLX_READ_MODE_DIRTY;
+
+   /* 
+    * The drawable callbacks only use the context_obj and made_current of
+    * the context, so a copy directs them at the secondary context.
+    * A pixmap always renders through its own context.
+    */
+   shadow = *ac;
+   shadow.context_obj = ac->read_context_obj;
+   shadow.made_current = true;
+
+   if (d->callbacks->make_current(&shadow, d))
+      return true;
+
+   /*
+    * A pbuffer is only attached to the secondary context, which isn't
+    * made current by the callback.
+    */
+   if (APPLE_GLX_DRAWABLE_PIXMAP == d->type)
+      ac->read_current = d->types.pixmap.context_obj;
+   else
+      ac->read_current = ac->read_context_obj;
+
+   err = apple_glx_context_set_current_cgl(drawable_context_obj(ac));
+
+   if (kCGLNoError != err) {
+      fprintf(stderr, "set current error: %s\n", apple_cgl.error_string(err));
+      return true;
+   }
+
+   return false;
+}
+
+void
+apple_glx_context_bind_read(Display * dpy, void *ptr, GLXDrawable drawable,
+                            GLXDrawable readable)
+{
+   struct apple_glx_context *ac = ptr;
+   struct apple_glx_drawable *d;
+
+   if (ac->read_drawable && ac->read_drawable->drawable == readable
+       && readable != drawable)
+      return;
+
+   unbind_read(ac);
+
+   if (None == readable || readable == drawable)
+      return;
+
+   /* 
+    * Only pbuffers and pixmaps are bound.  A window surface must follow
+    * the surface changes, so reads from one still go through a full make
+    * current in apple_xgl_api_read.c.
+    */
+   d = apple_glx_drawable_find(readable, APPLE_GLX_DRAWABLE_REFERENCE);
+
+   if (NULL == d)
+      return;
+
+   if (APPLE_GLX_DRAWABLE_SURFACE == d->type) {
+      d->ops->destroy(d);
+      return;
+   }
+
+   ac->read_drawable = d;
+
+   if (bind_read(ac, d)) {
+      apple_glx_diagnostic("%s: unable to bind read drawable 0x%lx\n",
+                           __func__, readable);
+      ac->read_current = NULL;
+      unbind_read(ac);
+   }
+}
+
+bool
+apple_glx_context_begin_read(void *ptr)
+{
+   struct apple_glx_context *ac = ptr;
+   GLint state[APPLE_GLX_READ_PACK_STATE];
+   unsigned int dirty = ac->read_dirty;
+   int i;
+
+   if (NULL == ac->read_current)
+      return false;
+
+   if (ac->read_current != ac->read_context_obj)
+      return kCGLNoError == apple_cgl.set_current_context(ac->read_current);
+
+   /* 
+    * The secondary context has its own state, so the state that affects
+    * reads is copied from the primary, but only after the primary changed
+    * it.  Otherwise a read is just the switch of the current context.
+    */
+   if (dirty & APPLE_GLX_READ_PACK_DIRTY)
+      for (i = 0; i < APPLE_GLX_READ_PACK_STATE; ++i)
+         __gl_api.GetIntegerv(read_pack_state_names[i], &state[i]);
+
+   if ((dirty & APPLE_GLX_READ_MODE_DIRTY)
+       && kCGLNoError != apple_cgl.copy_context(ac->context_obj,
+                                                ac->read_context_obj,
+                                                GL_PIXEL_MODE_BIT))
+      return false;
+
+   if (kCGLNoError != apple_cgl.set_current_context(ac->read_current))
+      return false;
+
+   if (dirty & APPLE_GLX_READ_PACK_DIRTY) {
+      for (i = 0; i < APPLE_GLX_READ_PACK_STATE; ++i) {
+         if (state[i] == ac->read_pack_state[i])
+            continue;
+
+         if (READ_PACK_BUFFER == i)
+            __gl_api.BindBuffer(GL_PIXEL_PACK_BUFFER, state[i]);
+         else
+            __gl_api.PixelStorei(read_pack_state_names[i], state[i]);
+
+         ac->read_pack_state[i] = state[i];
+      }
+   }
+
+   ac->read_dirty = 0;
+
+   return true;
+}
+
+void
+apple_glx_context_end_read(void *ptr)
+{
+   struct apple_glx_context *ac = ptr;
+   CGLError err;
+   GLenum error;
+
+   /* 
+    * A read into a pixel pack buffer must be submitted before the primary
+    * context uses the buffer.
+    */
+   if (ac->read_current == ac->read_context_obj
+       && 0 != ac->read_pack_state[READ_PACK_BUFFER])
+      __gl_api.Flush();
+
+   /* 
+    * The errors of the read are set in the read context, where the
+    * application can't see them, so the first is kept for glGetError.
+    */
+   while (GL_NO_ERROR != (error = __gl_api.GetError())) {
+      if (GL_NO_ERROR == ac->read_error)
+         ac->read_error = error;
+   }
+
+   err = apple_glx_context_set_current_cgl(drawable_context_obj(ac));
+
+   if (kCGLNoError != err)
+      fprintf(stderr, "set current error: %s\n", apple_cgl.error_string(err));
+}
+
+void
+apple_glx_context_read_state_changed(void *ptr, unsigned int dirty)
+{
+   struct apple_glx_context *ac = ptr;
+
+   ac->read_dirty |= dirty;
+}
+
+GLenum
+apple_glx_context_read_error(void *ptr)
+{
+   struct apple_glx_context *ac = ptr;
+   GLenum error = ac->read_error;
+
+   ac->read_error = GL_NO_ERROR;
+
+   return error;
+}
+
 bool
 apple_glx_copy_context(void *currentptr, void *srcptr, void *destptr,
                        unsigned long mask, int *errorptr, bool * x11errorptr)
@@ -516,39 +936,53 @@ apple_glx_copy_context(void *currentptr, void *srcptr, void *destptr,
       return true;
    }
 
+   dest->read_dirty |= APPLE_GLX_READ_PACK_DIRTY | APPLE_GLX_READ_MODE_DIRTY;
+
    return false;
 }
 
 /* 
- * The value returned is the total number of contexts set to update. 
- * It's meant for debugging/introspection.
+ * A burst of changes, as from an interactive resize, only bumps the
+ * surface generation for the contexts in other threads.  Each of them is
+ * updated once, at its next glViewport, however many changes it missed.
+ *
+ * The value returned is the total number of contexts with an update
+ * pending.  It's meant for debugging/introspection.
  */
 int
 apple_glx_context_surface_changed(unsigned int uid, pthread_t caller)
 {
+   struct apple_glx_drawable *d;
    struct apple_glx_context *ac;
+   unsigned long generation;
    int updated = 0;
 
-   lock_context_list();
+   d = apple_glx_drawable_find_by_uid(uid, APPLE_GLX_DRAWABLE_REFERENCE
+                                      | APPLE_GLX_DRAWABLE_LOCK);
+
+   if (NULL == d)
+      return 0;
 
-   for (ac = context_list; ac; ac = ac->next) {
-      if (ac->drawable && APPLE_GLX_DRAWABLE_SURFACE == ac->drawable->type
-          && ac->drawable->types.surface.uid == uid) {
+   /* apple_glx_context_update reads this without the drawable lock. */
+   generation = __atomic_add_fetch(&d->types.surface.generation, 1,
+                                   __ATOMIC_RELEASE);
 
-         if (caller == ac->thread_id) {
-            apple_glx_diagnostic("caller is the same thread for uid %u\n",
-                                 uid);
+   /* The drawable lock protects the list of contexts using the surface. */
+   for (ac = d->types.surface.contexts; ac; ac = ac->surface_next) {
+      if (caller == ac->thread_id) {
+         apple_glx_diagnostic("caller is the same thread for uid %u\n",
+                              uid);
 
-            xp_update_gl_context(ac->context_obj);
-         }
-         else {
-            ac->need_update = true;
-            ++updated;
-         }
+         xp_update_gl_context(ac->context_obj);
+         ac->surface_generation = generation;
+      }
+      else {
+         ++updated;
       }
    }
 
-   unlock_context_list();
+   d->ops->unlock(d);
+   d->ops->release(d);
 
    return updated;
 }
@@ -569,11 +1003,22 @@ apple_glx_context_update(Display * dpy, void *ptr)
                            failed ? "YES" : "NO");
    }
 
-   if (ac->need_update) {
-      xp_update_gl_context(ac->context_obj);
-      ac->need_update = false;
+   if (ac->drawable && APPLE_GLX_DRAWABLE_SURFACE == ac->drawable->type) {
+      unsigned long generation;
+
+      /* 
+       * A change that lands during the update bumps the generation past
+       * the one stored here, so the next call updates again.
+       */
+      generation = __atomic_load_n(&ac->drawable->types.surface.generation,
+                                   __ATOMIC_ACQUIRE);
 
-      apple_glx_diagnostic("%s: updating context %p\n", __func__, ptr);
+      if (generation != ac->surface_generation) {
+         xp_update_gl_context(ac->context_obj);
+         ac->surface_generation = generation;
+
+         apple_glx_diagnostic("%s: updating context %p\n", __func__, ptr);
+      }
    }
 
    if (ac->drawable && APPLE_GLX_DRAWABLE_SURFACE == ac->drawable->type
@@ -593,8 +1038,6 @@ apple_glx_context_update(Display * dpy, void *ptr)
 
          ac->last_surface_window = d->drawable;
 
-         ac->drawable = NULL;
-
          /* 
           * This will destroy the surface drawable if there are 
           * no references to it.  
@@ -602,7 +1045,7 @@ apple_glx_context_update(Display * dpy, void *ptr)
           * If there are references to it, then it's probably made
           * current in another context.
           */
-         d->destroy(d);
+         detach_drawable(ac);
       }
    }
 }
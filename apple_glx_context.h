@@ -40,16 +40,26 @@
 
 #include "apple_glx_drawable.h"
 
+#define APPLE_GLX_READ_PACK_STATE 9
+
+/* These flag the state that a read through read_context_obj copies. */
+#define APPLE_GLX_READ_PACK_DIRTY (1U << 0)     /* pixel store, pack buffer */
+#define APPLE_GLX_READ_MODE_DIRTY (1U << 1)     /* GL_PIXEL_MODE_BIT */
+
 struct apple_glx_context
 {
    CGLContextObj context_obj;
    CGLPixelFormatObj pixel_format_obj;
    struct apple_glx_drawable *drawable;
+   /* 
+    * The drawable that the make_current callback last attached the CGL
+    * context to, while it's still ac->drawable.  Otherwise it's NULL.
+    */
+   struct apple_glx_drawable *bound_drawable;
    pthread_t thread_id;
    int screen;
    bool double_buffered;
    bool uses_stereo;
-   bool need_update;
    bool is_current;             /* True if the context is current in some thread. */
    bool made_current;           /* True if the context has ever been made current. */
 
@@ -60,6 +70,35 @@ struct apple_glx_context
     */
    Window last_surface_window;
    struct apple_glx_context *previous, *next;
+
+   /* The other contexts attached to the same surface drawable. */
+   struct apple_glx_context *surface_previous, *surface_next;
+   /* The generation of the surface that context_obj was last updated to. */
+   unsigned long surface_generation;
+
+   /*
+    * The separate read drawable from glXMakeContextCurrent, if it's bound.
+    * read_current is the CGL context that reads from it: either
+    * read_context_obj, which shares objects with context_obj, or the
+    * pixmap's own context.
+    */
+   struct apple_glx_drawable *read_drawable;
+   CGLContextObj read_context_obj;
+   CGLContextObj read_current;
+   /* The pixel pack state last set in read_context_obj. */
+   GLint read_pack_state[APPLE_GLX_READ_PACK_STATE];
+   /* The state changed in context_obj since the last read copied it. */
+   unsigned int read_dirty;
+   /* The first error of a read, for the next glGetError. */
+   GLenum read_error;
+};
+
+/* These count the work done by apple_glx_make_current_context. */
+struct apple_glx_make_current_stats
+{
+   unsigned long calls;
+   unsigned long set_current, set_current_skipped;
+   unsigned long attaches, attaches_skipped;
 };
 
 bool apple_glx_create_context(void **ptr, Display * dpy, int screen,
@@ -69,13 +108,49 @@ void apple_glx_destroy_context(void **ptr, Display * dpy);
 
 bool apple_glx_make_current_context(Display * dpy, void *oldptr, void *ptr,
                                     GLXDrawable drawable);
+/* Make ctx current in this thread, unless it already is. */
+CGLError apple_glx_context_set_current_cgl(CGLContextObj ctx);
+
+void apple_glx_get_make_current_stats(struct apple_glx_make_current_stats
+                                      *stats);
+
+/* This is called at exit when LIBGL_MAKE_CURRENT_STATS is set. */
+void apple_glx_dump_make_current_stats(void);
+
 bool apple_glx_is_current_drawable(Display * dpy, void *ptr,
                                    GLXDrawable drawable);
 
+/* 
+ * This is called after a successful glXMakeContextCurrent, so that reads
+ * from a separate read drawable don't need a make current for each call.
+ */
+void apple_glx_context_bind_read(Display * dpy, void *ptr,
+                                 GLXDrawable drawable, GLXDrawable readable);
+
+/* 
+ * Return true if the bound read drawable is now current for reading.
+ * apple_glx_context_end_read must then be called after the read.
+ */
+bool apple_glx_context_begin_read(void *ptr);
+void apple_glx_context_end_read(void *ptr);
+
+/* 
+ * The GL calls that change the state a read copies flag it here, so that
+ * a read only copies the state after a change.
+ */
+void apple_glx_context_read_state_changed(void *ptr, unsigned int dirty);
+
+/* Return and clear the error of the last failed read, or GL_NO_ERROR. */
+GLenum apple_glx_context_read_error(void *ptr);
+
 bool apple_glx_copy_context(void *currentptr, void *srcptr, void *destptr,
                             unsigned long mask, int *errorptr,
                             bool * x11errorptr);
 
+/* 
+ * This records a change to the surface with uid.  Contexts in the caller's
+ * thread are updated now, and the others by apple_glx_context_update.
+ */
 int apple_glx_context_surface_changed(unsigned int uid, pthread_t caller);
 
 void apple_glx_context_update(Display * dpy, void *ptr);
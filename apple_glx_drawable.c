@@ -28,17 +28,105 @@
 */
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <pthread.h>
+#include <X11/Xlibint.h>
 #include "apple_glx.h"
 #include "apple_glx_context.h"
 #include "apple_glx_drawable.h"
 #include "appledri.h"
+#include "glxhash.h"
+#include "glx_async.h"
 
+/*
+ * The drawables_list is the master list of every drawable.  It's walked
+ * incrementally by the garbage collector, and drawables_lock serializes all insertions
+ * and removals (and thus the destruction) of drawables.
+ *
+ * Lookups don't take drawables_lock.  They go through the sharded
+ * indexes below, which map an XID, or a surface uid to the drawable.
+ * Each shard has its own lock, so unrelated lookups don't contend.
+ *
+ * The lock order is: drawables_lock, then the XID shard lock, then the
+ * uid shard lock, and then a drawable's mutex.  The pools lock below is
+ * only held while a record is taken from or returned to its pool.
+ */
 static pthread_mutex_t drawables_lock = PTHREAD_MUTEX_INITIALIZER;
 static struct apple_glx_drawable *drawables_list = NULL;
+static unsigned int drawables_count = 0;
+
+/* Where the next garbage collection pass starts. */
+static struct apple_glx_drawable *gc_cursor = NULL;
+
+/*
+ * The records of each type of drawable come from that type's pool, and
+ * are only as large as the type needs.  A pool carves its records from
+ * slabs that are aligned to their size, so a record finds its slab by
+ * masking its address.  A slab is freed once none of its records are
+ * used, unless it's the last slab with free records in its pool.
+ */
+#define DRAWABLE_SLAB_SIZE 16384
+#define DRAWABLE_RECORD_ALIGN 16
+
+#define DRAWABLE_ROUND(size) \
+   (((size) + DRAWABLE_RECORD_ALIGN - 1) \
+    & ~(size_t) (DRAWABLE_RECORD_ALIGN - 1))
+
+struct drawable_pool;
+
+struct drawable_slab
+{
+   struct drawable_pool *pool;
+   /* These link the slabs with free records in the pool. */
+   struct drawable_slab *previous, *next;
+   void *free_records;
+   unsigned int used;
+};
+
+#define DRAWABLE_SLAB_HEADER DRAWABLE_ROUND(sizeof(struct drawable_slab))
+
+struct drawable_pool
+{
+   size_t record_size;
+   unsigned int slab_records;
+   struct drawable_slab *partial;
+   unsigned long slabs, used;
+};
+
+/* This is indexed by the APPLE_GLX_DRAWABLE_* type - 1. */
+static struct drawable_pool drawable_pools[APPLE_GLX_DRAWABLE_PIXMAP];
+static pthread_mutex_t drawable_pools_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* This must be a power of 2. */
+#define DRAWABLE_INDEX_SHARDS 64
+
+enum
+{
+   DRAWABLE_INDEX_XID,
+   DRAWABLE_INDEX_UID,
+   DRAWABLE_INDEX_COUNT
+};
+
+struct drawable_index_shard
+{
+   pthread_mutex_t lock;
+   /* 
+    * This maps a key to the newest drawable with that key.  Older
+    * drawables with the same key (such as 2 GLXPixmaps created for the
+    * same Pixmap) follow via the drawable's chain[] pointer.
+    */
+   __glxHashTable *table;
+};
+
+static struct drawable_index_shard
+   drawable_index[DRAWABLE_INDEX_COUNT][DRAWABLE_INDEX_SHARDS];
+
+static pthread_once_t drawable_index_once = PTHREAD_ONCE_INIT;
 
 static void
 lock_drawables_list(void)
@@ -68,21 +156,374 @@ unlock_drawables_list(void)
    }
 }
 
-struct apple_glx_drawable *
-apple_glx_find_drawable(Display * dpy, GLXDrawable drawable)
+static void
+lock_drawable_pools(void)
 {
-   struct apple_glx_drawable *i, *agd = NULL;
+   int err;
 
-   lock_drawables_list();
+   err = pthread_mutex_lock(&drawable_pools_lock);
 
-   for (i = drawables_list; i; i = i->next) {
-      if (i->drawable == drawable) {
-         agd = i;
-         break;
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_drawable_pools(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&drawable_pools_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static size_t
+drawable_record_size(int type)
+{
+   size_t size = offsetof(struct apple_glx_drawable, types);
+
+   switch (type) {
+   case APPLE_GLX_DRAWABLE_SURFACE:
+      size += sizeof(struct apple_glx_surface);
+      break;
+
+   case APPLE_GLX_DRAWABLE_PBUFFER:
+      size += sizeof(struct apple_glx_pbuffer);
+      break;
+
+   default:
+      size += sizeof(struct apple_glx_pixmap);
+      break;
+   }
+
+   return DRAWABLE_ROUND(size);
+}
+
+/* The pools must be locked prior to calling this. */
+static struct drawable_pool *
+drawable_pool(int type)
+{
+   struct drawable_pool *pool;
+
+   assert(type >= APPLE_GLX_DRAWABLE_SURFACE
+          && type <= APPLE_GLX_DRAWABLE_PIXMAP);
+
+   pool = &drawable_pools[type - 1];
+
+   if (0 == pool->record_size) {
+      pool->record_size = drawable_record_size(type);
+      pool->slab_records = (DRAWABLE_SLAB_SIZE - DRAWABLE_SLAB_HEADER)
+         / pool->record_size;
+   }
+
+   return pool;
+}
+
+/* The pools must be locked prior to calling this. */
+static void
+unlink_slab(struct drawable_pool *pool, struct drawable_slab *slab)
+{
+   if (slab->previous)
+      slab->previous->next = slab->next;
+   else
+      pool->partial = slab->next;
+
+   if (slab->next)
+      slab->next->previous = slab->previous;
+
+   slab->previous = NULL;
+   slab->next = NULL;
+}
+
+/* The pools must be locked prior to calling this. */
+static void
+link_slab(struct drawable_pool *pool, struct drawable_slab *slab)
+{
+   slab->previous = NULL;
+   slab->next = pool->partial;
+
+   if (pool->partial)
+      pool->partial->previous = slab;
+
+   pool->partial = slab;
+}
+
+/* The pools must be locked prior to calling this. */
+static struct drawable_slab *
+create_slab(struct drawable_pool *pool)
+{
+   struct drawable_slab *slab;
+   void *mem;
+   char *record;
+   unsigned int i;
+
+   if (posix_memalign(&mem, DRAWABLE_SLAB_SIZE, DRAWABLE_SLAB_SIZE))
+      return NULL;
+
+   slab = mem;
+   slab->pool = pool;
+   slab->free_records = NULL;
+   slab->used = 0;
+
+   /* The free list is built backwards, so that it starts at the front. */
+   for (i = pool->slab_records; i > 0; --i) {
+      record = (char *) slab + DRAWABLE_SLAB_HEADER
+         + (i - 1) * pool->record_size;
+      *(void **) record = slab->free_records;
+      slab->free_records = record;
+   }
+
+   link_slab(pool, slab);
+   ++pool->slabs;
+
+   return slab;
+}
+
+/* This returns a zeroed record for a drawable of type, or NULL. */
+static struct apple_glx_drawable *
+alloc_drawable(int type)
+{
+   struct drawable_pool *pool;
+   struct drawable_slab *slab;
+   void *record;
+   size_t size;
+
+   lock_drawable_pools();
+
+   pool = drawable_pool(type);
+   slab = pool->partial;
+
+   if (NULL == slab)
+      slab = create_slab(pool);
+
+   if (NULL == slab) {
+      unlock_drawable_pools();
+      return NULL;
+   }
+
+   record = slab->free_records;
+   slab->free_records = *(void **) record;
+   ++slab->used;
+   ++pool->used;
+
+   if (NULL == slab->free_records)
+      unlink_slab(pool, slab);
+
+   size = pool->record_size;
+
+   unlock_drawable_pools();
+
+   memset(record, 0, size);
+
+   return record;
+}
+
+static void
+free_drawable(struct apple_glx_drawable *d)
+{
+   struct drawable_pool *pool;
+   struct drawable_slab *slab;
+
+   slab = (struct drawable_slab *)
+      ((uintptr_t) d & ~(uintptr_t) (DRAWABLE_SLAB_SIZE - 1));
+
+   lock_drawable_pools();
+
+   pool = slab->pool;
+
+   /* A full slab has free records again. */
+   if (NULL == slab->free_records)
+      link_slab(pool, slab);
+
+   *(void **) d = slab->free_records;
+   slab->free_records = d;
+   --slab->used;
+   --pool->used;
+
+   if (0 == slab->used && (slab->previous || slab->next)) {
+      unlink_slab(pool, slab);
+      --pool->slabs;
+      free(slab);
+   }
+
+   unlock_drawable_pools();
+}
+
+void
+apple_glx_get_drawable_pool_stats(int type,
+                                  struct apple_glx_drawable_pool_stats *stats)
+{
+   struct drawable_pool *pool;
+
+   lock_drawable_pools();
+
+   pool = drawable_pool(type);
+
+   stats->record_size = pool->record_size;
+   stats->slabs = pool->slabs;
+   stats->used = pool->used;
+   stats->free = pool->slabs * pool->slab_records - pool->used;
+
+   unlock_drawable_pools();
+}
+
+static void
+init_drawable_index(void)
+{
+   int i, s, err;
+
+   for (i = 0; i < DRAWABLE_INDEX_COUNT; ++i) {
+      for (s = 0; s < DRAWABLE_INDEX_SHARDS; ++s) {
+         err = pthread_mutex_init(&drawable_index[i][s].lock, NULL);
+
+         if (err) {
+            fprintf(stderr, "pthread_mutex_init error: %d\n", err);
+            abort();
+         }
+
+         drawable_index[i][s].table = __glxHashCreate();
+
+         if (NULL == drawable_index[i][s].table) {
+            fprintf(stderr, "unable to allocate the drawable index!\n");
+            abort();
+         }
       }
    }
+}
 
-   unlock_drawables_list();
+static struct drawable_index_shard *
+lock_index_shard(int index, unsigned long key)
+{
+   struct drawable_index_shard *shard;
+   int err;
+
+   (void) pthread_once(&drawable_index_once, init_drawable_index);
+
+   shard = &drawable_index[index][key & (DRAWABLE_INDEX_SHARDS - 1)];
+
+   err = pthread_mutex_lock(&shard->lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+
+   return shard;
+}
+
+static void
+unlock_index_shard(struct drawable_index_shard *shard)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&shard->lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static unsigned long
+index_key(int index, struct apple_glx_drawable *d)
+{
+   if (DRAWABLE_INDEX_UID == index)
+      return d->types.surface.uid;
+
+   return d->drawable;
+}
+
+/* The shard must be locked prior to calling this. */
+static struct apple_glx_drawable *
+index_first(struct drawable_index_shard *shard, unsigned long key)
+{
+   void *value;
+
+   if (__glxHashLookup(shard->table, key, &value))
+      return NULL;
+
+   return value;
+}
+
+/* The shard must be locked prior to calling this. */
+static void
+index_insert(struct drawable_index_shard *shard, int index,
+             struct apple_glx_drawable *d)
+{
+   unsigned long key = index_key(index, d);
+
+   /* The newest drawable is found first, as with the old linear search. */
+   d->chain[index] = index_first(shard, key);
+
+   if (d->chain[index])
+      (void) __glxHashDelete(shard->table, key);
+
+   if (__glxHashInsert(shard->table, key, d)) {
+      fprintf(stderr, "unable to insert into the drawable index!\n");
+      abort();
+   }
+}
+
+/* The shard must be locked prior to calling this. */
+static void
+index_remove(struct drawable_index_shard *shard, int index,
+             struct apple_glx_drawable *d)
+{
+   unsigned long key = index_key(index, d);
+   struct apple_glx_drawable *i;
+
+   i = index_first(shard, key);
+
+   if (i == d) {
+      (void) __glxHashDelete(shard->table, key);
+
+      if (d->chain[index])
+         (void) __glxHashInsert(shard->table, key, d->chain[index]);
+   }
+   else {
+      for (; i; i = i->chain[index]) {
+         if (i->chain[index] == d) {
+            i->chain[index] = d->chain[index];
+            break;
+         }
+      }
+   }
+
+   d->chain[index] = NULL;
+}
+
+/* 
+ * This applies the APPLE_GLX_DRAWABLE_* find flags.  The shard must be
+ * locked prior to calling this, so that d can't be destroyed meanwhile.
+ */
+static void
+find_flags(struct apple_glx_drawable *d, int flags)
+{
+   if (flags & APPLE_GLX_DRAWABLE_REFERENCE)
+      d->ops->reference(d);
+
+   if (flags & APPLE_GLX_DRAWABLE_LOCK)
+      d->ops->lock(d);
+}
+
+struct apple_glx_drawable *
+apple_glx_find_drawable(Display * dpy, GLXDrawable drawable)
+{
+   struct drawable_index_shard *shard;
+   struct apple_glx_drawable *agd;
+
+   shard = lock_index_shard(DRAWABLE_INDEX_XID, drawable);
+   agd = index_first(shard, drawable);
+   unlock_index_shard(shard);
 
    return agd;
 }
@@ -117,33 +558,58 @@ drawable_unlock(struct apple_glx_drawable *d)
 static void
 reference_drawable(struct apple_glx_drawable *d)
 {
-   d->lock(d);
+   d->ops->lock(d);
    d->reference_count++;
-   d->unlock(d);
+   d->ops->unlock(d);
 }
 
 static void
 release_drawable(struct apple_glx_drawable *d)
 {
-   d->lock(d);
+   d->ops->lock(d);
    d->reference_count--;
-   d->unlock(d);
+   d->ops->unlock(d);
 }
 
 /* The drawables list must be locked prior to calling this. */
 /* Return true if the drawable was destroyed. */
 static bool
-destroy_drawable(struct apple_glx_drawable *d)
+destroy_drawable(struct apple_glx_drawable *d,
+                 struct apple_glx_drawable_batch *batch)
 {
+   struct drawable_index_shard *xid_shard, *uid_shard = NULL;
+
+   /* 
+    * The shards are held while checking the reference count, so that a
+    * concurrent find can't reference d after the check.
+    */
+   xid_shard = lock_index_shard(DRAWABLE_INDEX_XID, d->drawable);
 
-   d->lock(d);
+   if (d->uid_indexed)
+      uid_shard = lock_index_shard(DRAWABLE_INDEX_UID, d->types.surface.uid);
+
+   d->ops->lock(d);
 
    if (d->reference_count > 0) {
-      d->unlock(d);
+      d->ops->unlock(d);
+
+      if (uid_shard)
+         unlock_index_shard(uid_shard);
+
+      unlock_index_shard(xid_shard);
       return false;
    }
 
-   d->unlock(d);
+   d->ops->unlock(d);
+
+   if (uid_shard) {
+      index_remove(uid_shard, DRAWABLE_INDEX_UID, d);
+      d->uid_indexed = false;
+      unlock_index_shard(uid_shard);
+   }
+
+   index_remove(xid_shard, DRAWABLE_INDEX_XID, d);
+   unlock_index_shard(xid_shard);
 
    if (d->previous) {
       d->previous->next = d->next;
@@ -159,20 +625,25 @@ destroy_drawable(struct apple_glx_drawable *d)
    if (d->next)
       d->next->previous = d->previous;
 
+   if (gc_cursor == d)
+      gc_cursor = d->next;
+
+   --drawables_count;
+
    unlock_drawables_list();
 
-   if (d->callbacks.destroy) {
+   if (d->callbacks->destroy) {
       /*
        * Warning: this causes other routines to be called (potentially)
        * from surface_notify_handler.  It's probably best to not have
        * any locks at this point locked.
        */
-      d->callbacks.destroy(d->display, d);
+      d->callbacks->destroy(d->display, d, batch);
    }
 
    apple_glx_diagnostic("%s: freeing %p\n", __func__, (void *) d);
 
-   free(d);
+   free_drawable(d);
 
    /* So that the locks are balanced and the caller correctly unlocks. */
    lock_drawables_list();
@@ -180,6 +651,179 @@ destroy_drawable(struct apple_glx_drawable *d)
    return true;
 }
 
+/*
+ * The teardown of a pbuffer frees an X pixmap that only libGL knows of, so
+ * that request waits in the pending batch of the display.  The batch is
+ * sent by the next make current or collector pass on the display, or once
+ * it's full.  The requests for a GLXPixmap or a window surface are still
+ * sent right away.  Those drawables belong to the application, which may
+ * free or reuse them next, and a late request would then fail or act on
+ * the new drawable.
+ */
+struct pending_batch
+{
+   struct apple_glx_drawable_batch batch;
+   struct pending_batch *next;
+};
+
+static pthread_mutex_t pending_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pending_batch *pending_batches = NULL;
+/* The requests waiting in all of the pending batches. */
+static int pending_count = 0;
+
+static void
+lock_pending(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&pending_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_pending(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&pending_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+/* The pending_lock must be held. */
+static struct pending_batch *
+find_pending(Display * dpy)
+{
+   struct pending_batch *p;
+
+   for (p = pending_batches; p; p = p->next)
+      if (dpy == p->batch.dpy)
+         break;
+
+   return p;
+}
+
+/* 
+ * Move the requests of batch for pbuffers to the pending batch of its
+ * display, and send the others.
+ */
+static void
+defer_batch(struct apple_glx_drawable_batch *batch)
+{
+   struct apple_glx_drawable_batch now;
+   struct pending_batch *p;
+   XAppleDRIBatchRequest *r;
+   int i;
+
+   if (0 == batch->count)
+      return;
+
+   apple_glx_drawable_batch_init(&now, batch->dpy);
+
+   lock_pending();
+
+   p = find_pending(batch->dpy);
+
+   if (NULL == p) {
+      p = malloc(sizeof(*p));
+
+      if (p) {
+         apple_glx_drawable_batch_init(&p->batch, batch->dpy);
+         p->next = pending_batches;
+         pending_batches = p;
+      }
+   }
+
+   for (i = 0; i < batch->count; ++i) {
+      r = &batch->requests[i];
+
+      if (p && AppleDRIBatchFreePixmap == r->kind) {
+         /* A full batch is sent first. */
+         if (APPLE_GLX_DRAWABLE_BATCH_SIZE == p->batch.count)
+            __atomic_sub_fetch(&pending_count, p->batch.count,
+                               __ATOMIC_RELAXED);
+
+         apple_glx_drawable_batch_add(&p->batch, r->kind, r->screen, r->xid);
+         __atomic_add_fetch(&pending_count, 1, __ATOMIC_RELAXED);
+      }
+      else {
+         apple_glx_drawable_batch_add(&now, r->kind, r->screen, r->xid);
+      }
+   }
+
+   unlock_pending();
+
+   batch->count = 0;
+   apple_glx_drawable_batch_flush(&now);
+}
+
+/* Move the pending requests of the display of batch to it. */
+static void
+take_pending(struct apple_glx_drawable_batch *batch)
+{
+   struct pending_batch *p;
+   XAppleDRIBatchRequest *r;
+   int i;
+
+   if (0 == __atomic_load_n(&pending_count, __ATOMIC_RELAXED))
+      return;
+
+   lock_pending();
+
+   p = find_pending(batch->dpy);
+
+   if (p && p->batch.count > 0) {
+      for (i = 0; i < p->batch.count; ++i) {
+         r = &p->batch.requests[i];
+         apple_glx_drawable_batch_add(batch, r->kind, r->screen, r->xid);
+      }
+
+      __atomic_sub_fetch(&pending_count, p->batch.count, __ATOMIC_RELAXED);
+      p->batch.count = 0;
+   }
+
+   unlock_pending();
+}
+
+void
+apple_glx_drawable_flush_pending(Display * dpy)
+{
+   struct apple_glx_drawable_batch batch;
+
+   apple_glx_drawable_batch_init(&batch, dpy);
+   take_pending(&batch);
+   apple_glx_drawable_batch_flush(&batch);
+}
+
+void
+apple_glx_drawable_close_display(Display * dpy)
+{
+   struct pending_batch **prev, *p;
+
+   lock_pending();
+
+   for (prev = &pending_batches; (p = *prev); prev = &p->next) {
+      if (dpy == p->batch.dpy) {
+         *prev = p->next;
+         __atomic_sub_fetch(&pending_count, p->batch.count,
+                            __ATOMIC_RELAXED);
+         free(p);
+         break;
+      }
+   }
+
+   unlock_pending();
+}
+
 /*
  * This is typically called when a context is destroyed or the current
  * drawable is made None.
@@ -187,9 +831,10 @@ destroy_drawable(struct apple_glx_drawable *d)
 static bool
 destroy_drawable_callback(struct apple_glx_drawable *d)
 {
+   struct apple_glx_drawable_batch batch;
    bool result;
 
-   d->lock(d);
+   d->ops->lock(d);
 
    apple_glx_diagnostic("%s: %p ->reference_count before -- %d\n", __func__,
                         (void *) d, d->reference_count);
@@ -197,18 +842,22 @@ destroy_drawable_callback(struct apple_glx_drawable *d)
    d->reference_count--;
 
    if (d->reference_count > 0) {
-      d->unlock(d);
+      d->ops->unlock(d);
       return false;
    }
 
-   d->unlock(d);
+   d->ops->unlock(d);
+
+   apple_glx_drawable_batch_init(&batch, d->display);
 
    lock_drawables_list();
 
-   result = destroy_drawable(d);
+   result = destroy_drawable(d, &batch);
 
    unlock_drawables_list();
 
+   defer_batch(&batch);
+
    return result;
 }
 
@@ -224,6 +873,16 @@ is_pixmap(struct apple_glx_drawable *d)
    return APPLE_GLX_DRAWABLE_PIXMAP == d->type;
 }
 
+static const struct apple_glx_drawable_ops drawable_ops = {
+   .lock = drawable_lock,
+   .unlock = drawable_unlock,
+   .reference = reference_drawable,
+   .release = release_drawable,
+   .destroy = destroy_drawable_callback,
+   .is_pbuffer = is_pbuffer,
+   .is_pixmap = is_pixmap
+};
+
 static void
 common_init(Display * dpy, GLXDrawable drawable, struct apple_glx_drawable *d)
 {
@@ -263,32 +922,21 @@ common_init(Display * dpy, GLXDrawable drawable, struct apple_glx_drawable *d)
 
    (void) pthread_mutexattr_destroy(&attr);
 
-   d->lock = drawable_lock;
-   d->unlock = drawable_unlock;
-
-   d->reference = reference_drawable;
-   d->release = release_drawable;
-
-   d->destroy = destroy_drawable_callback;
-
-   d->is_pbuffer = is_pbuffer;
-   d->is_pixmap = is_pixmap;
-
-   d->width = -1;
-   d->height = -1;
-   d->row_bytes = 0;
-   d->path[0] = '\0';
-   d->fd = -1;
-   d->buffer = NULL;
-   d->buffer_length = 0;
+   d->ops = &drawable_ops;
 
    d->previous = NULL;
    d->next = NULL;
+
+   d->chain[DRAWABLE_INDEX_XID] = NULL;
+   d->chain[DRAWABLE_INDEX_UID] = NULL;
+   d->uid_indexed = false;
 }
 
 static void
 link_tail(struct apple_glx_drawable *agd)
 {
+   struct drawable_index_shard *shard;
+
    lock_drawables_list();
 
    /* Link the new drawable into the global list. */
@@ -298,6 +946,11 @@ link_tail(struct apple_glx_drawable *agd)
       drawables_list->previous = agd;
 
    drawables_list = agd;
+   ++drawables_count;
+
+   shard = lock_index_shard(DRAWABLE_INDEX_XID, agd->drawable);
+   index_insert(shard, DRAWABLE_INDEX_XID, agd);
+   unlock_index_shard(shard);
 
    unlock_drawables_list();
 }
@@ -308,11 +961,11 @@ apple_glx_drawable_create(Display * dpy,
                           int screen,
                           GLXDrawable drawable,
                           struct apple_glx_drawable **agdResult,
-                          struct apple_glx_drawable_callbacks *callbacks)
+                          const struct apple_glx_drawable_callbacks *callbacks)
 {
    struct apple_glx_drawable *d;
 
-   d = calloc(1, sizeof *d);
+   d = alloc_drawable(callbacks->type);
 
    if (NULL == d) {
       perror("malloc");
@@ -321,10 +974,10 @@ apple_glx_drawable_create(Display * dpy,
 
    common_init(dpy, drawable, d);
    d->type = callbacks->type;
-   d->callbacks = *callbacks;
+   d->callbacks = callbacks;
 
-   d->reference(d);
-   d->lock(d);
+   d->ops->reference(d);
+   d->ops->lock(d);
 
    link_tail(d);
 
@@ -335,93 +988,273 @@ apple_glx_drawable_create(Display * dpy,
    return false;
 }
 
-static int error_count = 0;
+/*
+ * The garbage collector works incrementally.  Each pass resumes at
+ * gc_cursor, visits at most GC_VISIT_LIMIT drawables, and probes at most
+ * GC_PROBE_LIMIT unreferenced ones, or prefetched windows.  The probes
+ * are sent as one batch of GetGeometry requests, and drawables_lock isn't
+ * held while waiting for the replies.
+ */
+#define GC_VISIT_LIMIT 256
+#define GC_PROBE_LIMIT 64
+
+static pthread_mutex_t gc_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct apple_glx_gc_stats gc_stats;
+
+struct gc_candidate
+{
+   struct apple_glx_drawable *d;
+   GLXDrawable drawable;
+   bool dead;
+};
+
+/* This consumes the replies and errors for the probe requests. */
+static Bool
+liveness_reply(Display * dpy, xReply * rep, char *buf, int len, int index,
+               XPointer data)
+{
+   struct gc_candidate *candidates = (struct gc_candidate *) data;
+
+   if (X_Error == rep->generic.type) {
+      xError *err = (xError *) rep;
+
+      if (BadDrawable == err->errorCode || BadWindow == err->errorCode)
+         candidates[index].dead = true;
+   }
+
+   /* A GetGeometry reply has no data past the fixed 32 bytes. */
+   return True;
+}
+
+/* 
+ * Mark the candidates whose drawable no longer exists.
+ * Mesa uses XGetWindowAttributes, but some of these things are 
+ * most definitely not Windows, and that's against the rules.
+ * GetGeometry on the other hand is legal with a Pixmap and Window.
+ */
+static void
+probe_liveness(Display * dpy, struct gc_candidate *candidates, int count)
+{
+   struct __GLXrequestBatch batch;
+   xResourceReq *req;
+   int i;
+
+   LockDisplay(dpy);
+
+   __glXBeginRequestBatch(dpy, &batch, liveness_reply,
+                          (XPointer) candidates);
+
+   for (i = 0; i < count; ++i)
+      GetResReq(GetGeometry, candidates[i].drawable, req);
+
+   __glXEndRequestBatch(dpy, &batch);
+   __glXFinishRequestBatch(dpy, &batch);
 
-static int
-error_handler(Display * dpy, XErrorEvent * err)
+   UnlockDisplay(dpy);
+   SyncHandle();
+}
+
+/* 
+ * Return true if d is still registered under the XID.
+ * The caller must hold drawables_lock.
+ */
+static bool
+is_registered(struct apple_glx_drawable *d, GLXDrawable drawable)
 {
-   if (err->error_code == BadWindow) {
-      ++error_count;
+   struct drawable_index_shard *shard;
+   struct apple_glx_drawable *agd;
+
+   shard = lock_index_shard(DRAWABLE_INDEX_XID, drawable);
+
+   for (agd = index_first(shard, drawable); agd;
+        agd = agd->chain[DRAWABLE_INDEX_XID]) {
+      if (agd == d)
+         break;
    }
 
-   return 0;
+   unlock_index_shard(shard);
+
+   return NULL != agd;
 }
 
 void
-apple_glx_garbage_collect_drawables(Display * dpy)
+apple_glx_drawable_batch_init(struct apple_glx_drawable_batch *batch,
+                              Display * dpy)
 {
-   struct apple_glx_drawable *d, *dnext;
-   Window root;
-   int x, y;
-   unsigned int width, height, bd, depth;
-   int (*old_handler) (Display *, XErrorEvent *);
+   batch->dpy = dpy;
+   batch->count = 0;
+}
 
+void
+apple_glx_drawable_batch_add(struct apple_glx_drawable_batch *batch,
+                             int kind, int screen, XID xid)
+{
+   XAppleDRIBatchRequest *r;
 
-   if (NULL == drawables_list)
-      return;
+   if (APPLE_GLX_DRAWABLE_BATCH_SIZE == batch->count)
+      apple_glx_drawable_batch_flush(batch);
 
-   old_handler = XSetErrorHandler(error_handler);
+   r = &batch->requests[batch->count++];
+   r->kind = kind;
+   r->screen = screen;
+   r->xid = xid;
+}
 
-   XSync(dpy, False);
+void
+apple_glx_drawable_batch_flush(struct apple_glx_drawable_batch *batch)
+{
+   if (batch->count > 0)
+      XAppleDRISendBatch(batch->dpy, batch->requests, batch->count);
+
+   batch->count = 0;
+}
+
+void
+apple_glx_garbage_collect_drawables(Display * dpy)
+{
+   struct gc_candidate candidates[GC_PROBE_LIMIT];
+   GLXDrawable windows[GC_PROBE_LIMIT];
+   struct apple_glx_drawable_batch batch;
+   struct apple_glx_drawable *d;
+   int visited = 0, count = 0, reclaimed = 0, nwindows, i;
+   int err;
 
    lock_drawables_list();
 
-   for (d = drawables_list; d;) {
-      dnext = d->next;
+   if (NULL == gc_cursor)
+      gc_cursor = drawables_list;
 
-      d->lock(d);
+   for (d = gc_cursor; d && visited < GC_VISIT_LIMIT && count < GC_PROBE_LIMIT;
+        d = d->next) {
+      ++visited;
 
-      if (d->reference_count > 0) {
-         /* 
-          * Skip this, because some context still retains a reference 
-          * to the drawable.
-          */
-         d->unlock(d);
-         d = dnext;
+      if (d->display != dpy)
          continue;
-      }
-
-      d->unlock(d);
 
-      error_count = 0;
+      d->ops->lock(d);
 
       /* 
-       * Mesa uses XGetWindowAttributes, but some of these things are 
-       * most definitely not Windows, and that's against the rules.
-       * XGetGeometry on the other hand is legal with a Pixmap and Window.
+       * Skip this, because some context still retains a reference 
+       * to the drawable.
        */
-      XGetGeometry(dpy, d->drawable, &root, &x, &y, &width, &height, &bd,
-                   &depth);
-
-      if (error_count > 0) {
-         /*
-          * Note: this may not actually destroy the drawable.
-          * If another context retains a reference to the drawable
-          * after the reference count test above. 
-          */
-         (void) destroy_drawable(d);
-         error_count = 0;
+      if (0 == d->reference_count) {
+         candidates[count].d = d;
+         candidates[count].drawable = d->drawable;
+         candidates[count].dead = false;
+         ++count;
       }
 
-      d = dnext;
+      d->ops->unlock(d);
+   }
+
+   /* The next pass starts where this one stopped, or wraps around. */
+   gc_cursor = d;
+
+   unlock_drawables_list();
+
+   /* 
+    * The spare probes go to the windows of surface prefetches, which
+    * have no drawable until they are made current.
+    */
+   nwindows = apple_glx_surface_prefetched(dpy, windows,
+                                           GC_PROBE_LIMIT - count);
+
+   for (i = 0; i < nwindows; ++i) {
+      candidates[count + i].d = NULL;
+      candidates[count + i].drawable = windows[i];
+      candidates[count + i].dead = false;
    }
 
-   XSetErrorHandler(old_handler);
+   if (count + nwindows > 0)
+      probe_liveness(dpy, candidates, count + nwindows);
+
+   for (i = count; i < count + nwindows; ++i)
+      if (candidates[i].dead)
+         apple_glx_surface_reap_prefetch(dpy, candidates[i].drawable);
+
+   apple_glx_drawable_batch_init(&batch, dpy);
+
+   lock_drawables_list();
+
+   for (i = 0; i < count; ++i) {
+      /* 
+       * The candidate may have been destroyed while the lock was
+       * released, so it's only used if it's still registered.
+       * Note: this may not actually destroy the drawable, if a context
+       * retained a reference to it after the probe.
+       */
+      if (candidates[i].dead
+          && is_registered(candidates[i].d, candidates[i].drawable)
+          && destroy_drawable(candidates[i].d, &batch))
+         ++reclaimed;
+   }
 
    unlock_drawables_list();
+
+   /* 
+    * The whole pass, with the requests pending for the display, costs one
+    * display lock for the X requests.
+    */
+   take_pending(&batch);
+   apple_glx_drawable_batch_flush(&batch);
+
+   err = pthread_mutex_lock(&gc_stats_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+
+   ++gc_stats.passes;
+   gc_stats.last_scanned = visited;
+   gc_stats.last_reclaimed = reclaimed;
+   gc_stats.scanned += visited;
+   gc_stats.reclaimed += reclaimed;
+
+   err = pthread_mutex_unlock(&gc_stats_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+
+   apple_glx_diagnostic("%s: scanned %d probed %d reclaimed %d\n",
+                        __func__, visited, count, reclaimed);
+}
+
+void
+apple_glx_get_gc_stats(struct apple_glx_gc_stats *stats)
+{
+   int err;
+
+   err = pthread_mutex_lock(&gc_stats_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+
+   *stats = gc_stats;
+
+   err = pthread_mutex_unlock(&gc_stats_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
 }
 
 unsigned int
 apple_glx_get_drawable_count(void)
 {
-   unsigned int result = 0;
-   struct apple_glx_drawable *d;
+   unsigned int result;
 
    lock_drawables_list();
-
-   for (d = drawables_list; d; d = d->next)
-      ++result;
-
+   result = drawables_count;
    unlock_drawables_list();
 
    return result;
@@ -430,53 +1263,40 @@ apple_glx_get_drawable_count(void)
 struct apple_glx_drawable *
 apple_glx_drawable_find_by_type(GLXDrawable drawable, int type, int flags)
 {
+   struct drawable_index_shard *shard;
    struct apple_glx_drawable *d;
 
-   lock_drawables_list();
-
-   for (d = drawables_list; d; d = d->next) {
-      if (d->type == type && d->drawable == drawable) {
-         if (flags & APPLE_GLX_DRAWABLE_REFERENCE)
-            d->reference(d);
-
-         if (flags & APPLE_GLX_DRAWABLE_LOCK)
-            d->lock(d);
+   shard = lock_index_shard(DRAWABLE_INDEX_XID, drawable);
 
-         unlock_drawables_list();
-
-         return d;
+   for (d = index_first(shard, drawable); d;
+        d = d->chain[DRAWABLE_INDEX_XID]) {
+      if (d->type == type) {
+         find_flags(d, flags);
+         break;
       }
    }
 
-   unlock_drawables_list();
+   unlock_index_shard(shard);
 
-   return NULL;
+   return d;
 }
 
 struct apple_glx_drawable *
 apple_glx_drawable_find(GLXDrawable drawable, int flags)
 {
+   struct drawable_index_shard *shard;
    struct apple_glx_drawable *d;
 
-   lock_drawables_list();
+   shard = lock_index_shard(DRAWABLE_INDEX_XID, drawable);
 
-   for (d = drawables_list; d; d = d->next) {
-      if (d->drawable == drawable) {
-         if (flags & APPLE_GLX_DRAWABLE_REFERENCE)
-            d->reference(d);
+   d = index_first(shard, drawable);
 
-         if (flags & APPLE_GLX_DRAWABLE_LOCK)
-            d->lock(d);
-
-         unlock_drawables_list();
-
-         return d;
-      }
-   }
+   if (d)
+      find_flags(d, flags);
 
-   unlock_drawables_list();
+   unlock_index_shard(shard);
 
-   return NULL;
+   return d;
 }
 
 /* Return true if the type is valid for the drawable. */
@@ -484,27 +1304,44 @@ bool
 apple_glx_drawable_destroy_by_type(Display * dpy,
                                    GLXDrawable drawable, int type)
 {
+   struct apple_glx_drawable_batch batch;
+   struct drawable_index_shard *shard;
    struct apple_glx_drawable *d;
 
+   apple_glx_drawable_batch_init(&batch, dpy);
+
+   /* 
+    * Nothing can be freed while the drawables list is locked, so d is
+    * still valid after the shard is unlocked.
+    */
    lock_drawables_list();
 
-   for (d = drawables_list; d; d = d->next) {
-      if (drawable == d->drawable && type == d->type) {
-         /*
-          * The user has requested that we destroy this resource.
-          * However, there may be references in the contexts to it, so
-          * release it, and call destroy_drawable which doesn't destroy
-          * if the reference_count is > 0.
-          */
-         d->release(d);
-
-         apple_glx_diagnostic("%s d->reference_count %d\n",
-                              __func__, d->reference_count);
-
-         destroy_drawable(d);
-         unlock_drawables_list();
-         return true;
-      }
+   shard = lock_index_shard(DRAWABLE_INDEX_XID, drawable);
+
+   for (d = index_first(shard, drawable); d;
+        d = d->chain[DRAWABLE_INDEX_XID]) {
+      if (type == d->type)
+         break;
+   }
+
+   unlock_index_shard(shard);
+
+   if (d) {
+      /*
+       * The user has requested that we destroy this resource.
+       * However, there may be references in the contexts to it, so
+       * release it, and call destroy_drawable which doesn't destroy
+       * if the reference_count is > 0.
+       */
+      d->ops->release(d);
+
+      apple_glx_diagnostic("%s d->reference_count %d\n",
+                           __func__, d->reference_count);
+
+      destroy_drawable(d, &batch);
+      unlock_drawables_list();
+      defer_batch(&batch);
+      return true;
    }
 
    unlock_drawables_list();
@@ -512,31 +1349,40 @@ apple_glx_drawable_destroy_by_type(Display * dpy,
    return false;
 }
 
-struct apple_glx_drawable *
-apple_glx_drawable_find_by_uid(unsigned int uid, int flags)
+void
+apple_glx_drawable_index_uid(struct apple_glx_drawable *d)
 {
-   struct apple_glx_drawable *d;
+   struct drawable_index_shard *shard;
+
+   /* Only surfaces have a uid. */
+   assert(APPLE_GLX_DRAWABLE_SURFACE == d->type);
 
    lock_drawables_list();
 
-   for (d = drawables_list; d; d = d->next) {
-      /* Only surfaces have a uid. */
-      if (APPLE_GLX_DRAWABLE_SURFACE == d->type) {
-         if (d->types.surface.uid == uid) {
-            if (flags & APPLE_GLX_DRAWABLE_REFERENCE)
-               d->reference(d);
+   if (!d->uid_indexed) {
+      shard = lock_index_shard(DRAWABLE_INDEX_UID, d->types.surface.uid);
+      index_insert(shard, DRAWABLE_INDEX_UID, d);
+      d->uid_indexed = true;
+      unlock_index_shard(shard);
+   }
 
-            if (flags & APPLE_GLX_DRAWABLE_LOCK)
-               d->lock(d);
+   unlock_drawables_list();
+}
 
-            unlock_drawables_list();
+struct apple_glx_drawable *
+apple_glx_drawable_find_by_uid(unsigned int uid, int flags)
+{
+   struct drawable_index_shard *shard;
+   struct apple_glx_drawable *d;
 
-            return d;
-         }
-      }
-   }
+   shard = lock_index_shard(DRAWABLE_INDEX_UID, uid);
 
-   unlock_drawables_list();
+   d = index_first(shard, uid);
+
+   if (d)
+      find_flags(d, flags);
+
+   unlock_index_shard(shard);
 
-   return NULL;
+   return d;
 }
@@ -36,6 +36,7 @@
 #define XP_NO_X_HEADERS
 #include <Xplugin.h>
 #undef XP_NO_X_HEADERS
+#include "appledri.h"
 #include "apple_glx_context.h"
 
 enum
@@ -55,16 +56,38 @@ enum
 struct apple_glx_context;
 struct apple_glx_drawable;
 
+/* 
+ * This collects the X requests of drawable teardown, so that they're sent
+ * under one display lock.  The destroy callbacks queue their requests in
+ * it, or send them right away when it's NULL.
+ */
+#define APPLE_GLX_DRAWABLE_BATCH_SIZE 64
+
+struct apple_glx_drawable_batch
+{
+   Display *dpy;
+   int count;
+   XAppleDRIBatchRequest requests[APPLE_GLX_DRAWABLE_BATCH_SIZE];
+};
+
 struct apple_glx_surface
 {
    xp_surface_id surface_id;
    unsigned int uid;
    bool pending_destroy;
+   /* 
+    * This counts the changes the server has notified for the surface.  A
+    * context is up to date while its surface_generation matches it.
+    */
+   unsigned long generation;
+   /* The contexts attached to this surface, protected by the drawable lock. */
+   struct apple_glx_context *contexts;
 };
 
 struct apple_glx_pbuffer
 {
    GLXPbuffer xid;              /* our pixmap */
+   int screen;
    int width, height;
    GLint fbconfigID;
    CGLPBufferObj buffer_obj;
@@ -77,7 +100,8 @@ struct apple_glx_pixmap
    void *buffer;
    int width, height, pitch, /*bytes per pixel */ bpp;
    size_t size;
-   char path[PATH_MAX];
+   /* The name of the shared memory, allocated to fit. */
+   char *path;
    int fd;
    CGLPixelFormatObj pixel_format_obj;
    CGLContextObj context_obj;
@@ -89,50 +113,61 @@ struct apple_glx_drawable_callbacks
    int type;
      bool(*make_current) (struct apple_glx_context * ac,
                           struct apple_glx_drawable * d);
-   void (*destroy) (Display * dpy, struct apple_glx_drawable * d);
+   void (*destroy) (Display * dpy, struct apple_glx_drawable * d,
+                    struct apple_glx_drawable_batch * batch);
+};
+
+/* These are shared by every drawable. */
+struct apple_glx_drawable_ops
+{
+   void (*lock) (struct apple_glx_drawable * agd);
+   void (*unlock) (struct apple_glx_drawable * agd);
+
+   void (*reference) (struct apple_glx_drawable * agd);
+   void (*release) (struct apple_glx_drawable * agd);
+
+     bool(*destroy) (struct apple_glx_drawable * agd);
+
+     bool(*is_pbuffer) (struct apple_glx_drawable * agd);
+
+     bool(*is_pixmap) (struct apple_glx_drawable * agd);
 };
 
 struct apple_glx_drawable
 {
    Display *display;
-   int reference_count;
    GLXDrawable drawable;
+   int reference_count;
    int type;                    /* APPLE_GLX_DRAWABLE_* */
+   bool uid_indexed;
 
-   union
-   {
-      struct apple_glx_pixmap pixmap;
-      struct apple_glx_pbuffer pbuffer;
-      struct apple_glx_surface surface;
-   } types;
-
-   struct apple_glx_drawable_callbacks callbacks;
+   const struct apple_glx_drawable_ops *ops;
+   const struct apple_glx_drawable_callbacks *callbacks;
 
    /* 
     * This mutex protects the reference count and any other drawable data.
     * It's used to prevent an early release of a drawable.
     */
    pthread_mutex_t mutex;
-   void (*lock) (struct apple_glx_drawable * agd);
-   void (*unlock) (struct apple_glx_drawable * agd);
 
-   void (*reference) (struct apple_glx_drawable * agd);
-   void (*release) (struct apple_glx_drawable * agd);
-
-     bool(*destroy) (struct apple_glx_drawable * agd);
-
-     bool(*is_pbuffer) (struct apple_glx_drawable * agd);
+   struct apple_glx_drawable *previous, *next;
 
-     bool(*is_pixmap) (struct apple_glx_drawable * agd);
+   /* 
+    * These link drawables that share an XID or uid in the registry index.
+    * They are protected by the index shard locks in apple_glx_drawable.c.
+    */
+   struct apple_glx_drawable *chain[2];
 
-/*BEGIN These are used for the mixed mode drawing... */
-   int width, height;
-   int row_bytes;
-   char path[PATH_MAX];
-   int fd;                      /* The file descriptor for this drawable's shared memory. */
-   void *buffer;                /* The memory for the drawable.  Typically shared memory. */
-   size_t buffer_length;
-     /*END*/ struct apple_glx_drawable *previous, *next;
+   /* 
+    * A drawable is allocated with room for only the member of its type,
+    * so this must be last.
+    */
+   union
+   {
+      struct apple_glx_pixmap pixmap;
+      struct apple_glx_pbuffer pbuffer;
+      struct apple_glx_surface surface;
+   } types;
 };
 
 struct apple_glx_context;
@@ -146,7 +181,7 @@ bool apple_glx_drawable_create(Display * dpy,
                                int screen,
                                GLXDrawable drawable,
                                struct apple_glx_drawable **agd,
-                               struct apple_glx_drawable_callbacks
+                               const struct apple_glx_drawable_callbacks
                                *callbacks);
 
 /* Returns true on error */
@@ -155,14 +190,59 @@ bool apple_glx_create_drawable(Display * dpy,
                                GLXDrawable drawable,
                                struct apple_glx_drawable **agd);
 
+/* 
+ * Each call checks a bounded number of the unreferenced drawables of dpy,
+ * and destroys those whose X drawable no longer exists.
+ */
 void apple_glx_garbage_collect_drawables(Display * dpy);
 
+void apple_glx_drawable_batch_init(struct apple_glx_drawable_batch *batch,
+                                   Display * dpy);
+/* This sends the batch first if it's full. */
+void apple_glx_drawable_batch_add(struct apple_glx_drawable_batch *batch,
+                                  int kind, int screen, XID xid);
+void apple_glx_drawable_batch_flush(struct apple_glx_drawable_batch *batch);
+
+/* 
+ * The explicit teardown of a pbuffer leaves its request pending for the
+ * display.  The next make current sends it, and the display's close drops
+ * it, since the server frees the pixmap with the connection.
+ */
+void apple_glx_drawable_flush_pending(Display * dpy);
+void apple_glx_drawable_close_display(Display * dpy);
+
+struct apple_glx_gc_stats
+{
+   unsigned long passes;
+   /* The drawables scanned and reclaimed by the last pass. */
+   unsigned int last_scanned, last_reclaimed;
+   /* The totals over every pass. */
+   unsigned long scanned, reclaimed;
+};
+
+/* This is intended for debugging and introspection. */
+void apple_glx_get_gc_stats(struct apple_glx_gc_stats *stats);
+
 /* 
  * This returns the total number of drawables. 
  * It's mostly intended for debugging and introspection.
  */
 unsigned int apple_glx_get_drawable_count(void);
 
+struct apple_glx_drawable_pool_stats
+{
+   /* The size of each record, and the slabs that hold the records. */
+   size_t record_size;
+   unsigned long slabs;
+   /* The records in use, and those free in the slabs. */
+   unsigned long used, free;
+};
+
+/* This is intended for debugging and introspection. */
+void apple_glx_get_drawable_pool_stats(int type,
+                                       struct apple_glx_drawable_pool_stats
+                                       *stats);
+
 struct apple_glx_drawable *apple_glx_drawable_find_by_type(GLXDrawable
                                                            drawable, int type,
                                                            int flags);
@@ -177,6 +257,12 @@ bool apple_glx_drawable_destroy_by_type(Display * dpy, GLXDrawable drawable,
 struct apple_glx_drawable *apple_glx_drawable_find_by_uid(unsigned int uid,
                                                           int flags);
 
+/* 
+ * This makes a surface drawable findable by apple_glx_drawable_find_by_uid.
+ * It should be called once the types.surface.uid is known.
+ */
+void apple_glx_drawable_index_uid(struct apple_glx_drawable *d);
+
 /* Surfaces */
 
 bool apple_glx_surface_create(Display * dpy, int screen, GLXDrawable drawable,
@@ -184,6 +270,26 @@ bool apple_glx_surface_create(Display * dpy, int screen, GLXDrawable drawable,
 
 void apple_glx_surface_destroy(unsigned int uid);
 
+/* 
+ * Send the request for the surface of a window before its first make
+ * current, which then collects the reply.
+ */
+void apple_glx_surface_prefetch(Display * dpy, int screen,
+                                GLXDrawable drawable);
+/* Drop the prefetched surface of a window, if it wasn't made current. */
+void apple_glx_surface_cancel_prefetch(Display * dpy, GLXDrawable drawable);
+
+/* 
+ * The garbage collector probes the windows of the prefetches, and reaps
+ * those of windows that were destroyed without glXDestroyWindow.
+ */
+int apple_glx_surface_prefetched(Display * dpy, GLXDrawable * drawables,
+                                 int max);
+void apple_glx_surface_reap_prefetch(Display * dpy, GLXDrawable drawable);
+
+/* Free the prefetches of a display that is closing. */
+void apple_glx_surface_close_display(Display * dpy);
+
 /* Pbuffers */
 
 /* Returns true if an error occurred. */
@@ -218,6 +324,15 @@ bool apple_glx_pixmap_destroy(Display * dpy, Pixmap pixmap);
 bool apple_glx_pixmap_query(GLXPixmap pixmap, int attribute,
                             unsigned int *value);
 
+/*
+ * Returns true with the pixmap's shared memory buffer, after the pixmap's
+ * rendering has finished.  The buffer is valid until the pixmap is
+ * destroyed.
+ */
+bool apple_glx_pixmap_query_buffer(GLXPixmap pixmap, const void **data,
+                                   int *width, int *height, int *pitch,
+                                   int *bpp);
+
 
 
 #endif
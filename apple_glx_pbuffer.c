@@ -30,18 +30,21 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <assert.h>
+#include "glxclient.h"
 #include "apple_glx.h"
 #include "glcontextmodes.h"
 #include "apple_glx_context.h"
 #include "apple_glx_drawable.h"
 #include "apple_cgl.h"
+#include "apple_glx_caps.h"
 
 static bool pbuffer_make_current(struct apple_glx_context *ac,
                                  struct apple_glx_drawable *d);
 
-static void pbuffer_destroy(Display * dpy, struct apple_glx_drawable *d);
+static void pbuffer_destroy(Display * dpy, struct apple_glx_drawable *d,
+                            struct apple_glx_drawable_batch *batch);
 
-static struct apple_glx_drawable_callbacks callbacks = {
+static const struct apple_glx_drawable_callbacks callbacks = {
    .type = APPLE_GLX_DRAWABLE_PBUFFER,
    .make_current = pbuffer_make_current,
    .destroy = pbuffer_destroy
@@ -77,7 +80,8 @@ pbuffer_make_current(struct apple_glx_context *ac,
 }
 
 void
-pbuffer_destroy(Display * dpy, struct apple_glx_drawable *d)
+pbuffer_destroy(Display * dpy, struct apple_glx_drawable *d,
+                struct apple_glx_drawable_batch *batch)
 {
    struct apple_glx_pbuffer *pbuf = &d->types.pbuffer;
 
@@ -87,7 +91,12 @@ pbuffer_destroy(Display * dpy, struct apple_glx_drawable *d)
                         d->drawable);
 
    apple_cgl.destroy_pbuffer(pbuf->buffer_obj);
-   XFreePixmap(dpy, pbuf->xid);
+
+   if (batch)
+      apple_glx_drawable_batch_add(batch, AppleDRIBatchFreePixmap, 0,
+                                   pbuf->xid);
+   else
+      XFreePixmap(dpy, pbuf->xid);
 }
 
 /* Return true if an error occurred. */
@@ -137,6 +146,7 @@ apple_glx_pbuffer_create(Display * dpy, GLXFBConfig config,
    pbuf = &d->types.pbuffer;
 
    pbuf->xid = xid;
+   pbuf->screen = screen;
    pbuf->width = width;
    pbuf->height = height;
 
@@ -145,8 +155,8 @@ apple_glx_pbuffer_create(Display * dpy, GLXFBConfig config,
                                   0, &pbuf->buffer_obj);
 
    if (kCGLNoError != err) {
-      d->unlock(d);
-      d->destroy(d);
+      d->ops->unlock(d);
+      d->ops->destroy(d);
       *errorcode = BadMatch;
       return true;
    }
@@ -157,7 +167,7 @@ apple_glx_pbuffer_create(Display * dpy, GLXFBConfig config,
 
    *result = pbuf->xid;
 
-   d->unlock(d);
+   d->ops->unlock(d);
 
    return false;
 }
@@ -166,76 +176,20 @@ apple_glx_pbuffer_create(Display * dpy, GLXFBConfig config,
 
 /* Return true if an error occurred. */
 static bool
-get_max_size(int *widthresult, int *heightresult)
+get_max_size(Display * dpy, int screen, int *widthresult, int *heightresult)
 {
-   CGLContextObj oldcontext;
-   GLint ar[2];
-
-   oldcontext = apple_cgl.get_current_context();
-
-   if (!oldcontext) {
-      /* 
-       * There is no current context, so we need to make one in order
-       * to call glGetInteger.
-       */
-      CGLPixelFormatObj pfobj;
-      CGLError err;
-      CGLPixelFormatAttribute attr[10];
-      int c = 0;
-      GLint vsref = 0;
-      CGLContextObj newcontext;
-
-      attr[c++] = kCGLPFAColorSize;
-      attr[c++] = 32;
-      attr[c++] = 0;
-
-      err = apple_cgl.choose_pixel_format(attr, &pfobj, &vsref);
-      if (kCGLNoError != err) {
-         if (getenv("LIBGL_DIAGNOSTIC")) {
-            printf("choose_pixel_format error in %s: %s\n", __func__,
-                   apple_cgl.error_string(err));
-         }
-
-         return true;
-      }
-
-
-      err = apple_cgl.create_context(pfobj, NULL, &newcontext);
-
-      if (kCGLNoError != err) {
-         if (getenv("LIBGL_DIAGNOSTIC")) {
-            printf("create_context error in %s: %s\n", __func__,
-                   apple_cgl.error_string(err));
-         }
-
-         apple_cgl.destroy_pixel_format(pfobj);
-
-         return true;
-      }
-
-      err = apple_cgl.set_current_context(newcontext);
-
-      if (kCGLNoError != err) {
-         printf("set_current_context error in %s: %s\n", __func__,
-                apple_cgl.error_string(err));
-         return true;
-      }
-
+   __GLXdisplayPrivate *priv = __glXInitialize(dpy);
+   struct apple_glx_renderer_caps caps;
 
-      glGetIntegerv(GL_MAX_VIEWPORT_DIMS, ar);
-
-      apple_cgl.set_current_context(oldcontext);
-      apple_cgl.destroy_context(newcontext);
-      apple_cgl.destroy_pixel_format(pfobj);
-   }
-   else {
-      /* We have a valid context. */
+   if (NULL == priv || NULL == priv->screenConfigs)
+      return true;
 
-      glGetIntegerv(GL_MAX_VIEWPORT_DIMS, ar);
-   }
+   if (apple_glx_get_renderer_caps(&priv->screenConfigs[screen].renderer_caps,
+                                   &caps))
+      return true;
 
-   *widthresult = ar[0];
-   *heightresult = ar[1];
+   *widthresult = caps.max_viewport_dims[0];
+   *heightresult = caps.max_viewport_dims[1];
 
    return false;
 }
@@ -271,7 +225,7 @@ apple_glx_pbuffer_query(GLXPbuffer p, int attr, unsigned int *value)
 
       case GLX_LARGEST_PBUFFER:{
             int width, height;
-            if (get_max_size(&width, &height)) {
+            if (get_max_size(d->display, pbuf->screen, &width, &height)) {
                fprintf(stderr, "internal error: "
                        "unable to find the largest pbuffer!\n");
             }
@@ -288,7 +242,7 @@ apple_glx_pbuffer_query(GLXPbuffer p, int attr, unsigned int *value)
          break;
       }
 
-      d->unlock(d);
+      d->ops->unlock(d);
    }
 
    return result;
@@ -306,7 +260,7 @@ apple_glx_pbuffer_set_event_mask(GLXDrawable drawable, unsigned long mask)
    if (d) {
       d->types.pbuffer.event_mask = mask;
       result = true;
-      d->unlock(d);
+      d->ops->unlock(d);
    }
 
    return result;
@@ -323,7 +277,7 @@ apple_glx_pbuffer_get_event_mask(GLXDrawable drawable, unsigned long *mask)
    if (d) {
       *mask = d->types.pbuffer.event_mask;
       result = true;
-      d->unlock(d);
+      d->ops->unlock(d);
    }
 
    return result;
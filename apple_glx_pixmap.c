@@ -29,6 +29,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <pthread.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -37,17 +39,20 @@
 #include <assert.h>
 #include "apple_glx.h"
 #include "apple_cgl.h"
+#include "apple_glx_context.h"
 #include "apple_visual.h"
 #include "apple_glx_drawable.h"
+#include "apple_glx_pixmap_pool.h"
 #include "appledri.h"
 #include "glcontextmodes.h"
 
 static bool pixmap_make_current(struct apple_glx_context *ac,
                                 struct apple_glx_drawable *d);
 
-static void pixmap_destroy(Display * dpy, struct apple_glx_drawable *d);
+static void pixmap_destroy(Display * dpy, struct apple_glx_drawable *d,
+                           struct apple_glx_drawable_batch *batch);
 
-static struct apple_glx_drawable_callbacks callbacks = {
+static const struct apple_glx_drawable_callbacks callbacks = {
    .type = APPLE_GLX_DRAWABLE_PIXMAP,
    .make_current = pixmap_make_current,
    .destroy = pixmap_destroy
@@ -62,7 +67,7 @@ pixmap_make_current(struct apple_glx_context *ac,
 
    assert(APPLE_GLX_DRAWABLE_PIXMAP == d->type);
 
-   cglerr = apple_cgl.set_current_context(p->context_obj);
+   cglerr = apple_glx_context_set_current_cgl(p->context_obj);
 
    if (kCGLNoError != cglerr) {
       fprintf(stderr, "set current context: %s\n",
@@ -89,17 +94,25 @@ pixmap_make_current(struct apple_glx_context *ac,
 }
 
 static void
-pixmap_destroy(Display * dpy, struct apple_glx_drawable *d)
+pixmap_destroy(Display * dpy, struct apple_glx_drawable *d,
+               struct apple_glx_drawable_batch *batch)
 {
    struct apple_glx_pixmap *p = &d->types.pixmap;
 
-   if (p->pixel_format_obj)
-      (void) apple_cgl.destroy_pixel_format(p->pixel_format_obj);
-
-   if (p->context_obj)
-      (void) apple_cgl.destroy_context(p->context_obj);
+   if (p->context_obj) {
+      /* The pool takes over the context and the pfobj reference. */
+      apple_glx_pixmap_pool_put(p->pixel_format_obj, p->width, p->height,
+                                p->pitch, p->size, p->context_obj);
+   }
+   else if (p->pixel_format_obj) {
+      apple_visual_destroy_pfobj(p->pixel_format_obj);
+   }
 
-   XAppleDRIDestroyPixmap(dpy, p->xpixmap);
+   if (batch)
+      apple_glx_drawable_batch_add(batch, AppleDRIBatchDestroyPixmap, 0,
+                                   p->xpixmap);
+   else
+      XAppleDRIDestroyPixmap(dpy, p->xpixmap);
 
    if (p->buffer) {
       if (munmap(p->buffer, p->size))
@@ -112,6 +125,8 @@ pixmap_destroy(Display * dpy, struct apple_glx_drawable *d)
          perror("shm_unlink");
    }
 
+   free(p->path);
+
    apple_glx_diagnostic("destroyed pixmap buffer for: 0x%lx\n", d->drawable);
 }
 
@@ -122,6 +137,7 @@ apple_glx_pixmap_create(Display * dpy, int screen, Pixmap pixmap,
 {
    struct apple_glx_drawable *d;
    struct apple_glx_pixmap *p;
+   char path[PATH_MAX];
    bool double_buffered;
    bool uses_stereo;
    CGLError error;
@@ -136,12 +152,25 @@ apple_glx_pixmap_create(Display * dpy, int screen, Pixmap pixmap,
 
    p->xpixmap = pixmap;
    p->buffer = NULL;
+   p->path = NULL;
+   p->pixel_format_obj = NULL;
+   p->context_obj = NULL;
 
    if (!XAppleDRICreatePixmap(dpy, screen, pixmap,
                               &p->width, &p->height, &p->pitch, &p->bpp,
-                              &p->size, p->path, PATH_MAX)) {
-      d->unlock(d);
-      d->destroy(d);
+                              &p->size, path, sizeof path)) {
+      d->ops->unlock(d);
+      d->ops->destroy(d);
+      return true;
+   }
+
+   /* Only the pixmap needs the name, and it's usually short. */
+   p->path = strdup(path);
+
+   if (NULL == p->path) {
+      perror("strdup");
+      d->ops->unlock(d);
+      d->ops->destroy(d);
       return true;
    }
 
@@ -149,8 +178,8 @@ apple_glx_pixmap_create(Display * dpy, int screen, Pixmap pixmap,
 
    if (p->fd < 0) {
       perror("shm_open");
-      d->unlock(d);
-      d->destroy(d);
+      d->ops->unlock(d);
+      d->ops->destroy(d);
       return true;
    }
 
@@ -159,26 +188,30 @@ apple_glx_pixmap_create(Display * dpy, int screen, Pixmap pixmap,
 
    if (MAP_FAILED == p->buffer) {
       perror("mmap");
-      d->unlock(d);
-      d->destroy(d);
+      d->ops->unlock(d);
+      d->ops->destroy(d);
       return true;
    }
 
    apple_visual_create_pfobj(&p->pixel_format_obj, mode, &double_buffered,
                              &uses_stereo, /*offscreen */ true);
 
-   error = apple_cgl.create_context(p->pixel_format_obj, NULL,
-                                    &p->context_obj);
+   if (!apple_glx_pixmap_pool_get(p->pixel_format_obj, p->width, p->height,
+                                  p->pitch, p->size, &p->context_obj)) {
+      error = apple_cgl.create_context(p->pixel_format_obj, NULL,
+                                       &p->context_obj);
 
-   if (kCGLNoError != error) {
-      d->unlock(d);
-      d->destroy(d);
-      return true;
+      if (kCGLNoError != error) {
+         p->context_obj = NULL;
+         d->ops->unlock(d);
+         d->ops->destroy(d);
+         return true;
+      }
    }
 
    p->fbconfigID = cmodes->fbconfigID;
 
-   d->unlock(d);
+   d->ops->unlock(d);
 
    apple_glx_diagnostic("created: pixmap buffer for 0x%lx\n", d->drawable);
 
@@ -215,12 +248,50 @@ apple_glx_pixmap_query(GLXPixmap pixmap, int attr, unsigned int *value)
          break;
       }
 
-      d->unlock(d);
+      d->ops->unlock(d);
    }
 
    return result;
 }
 
+bool
+apple_glx_pixmap_query_buffer(GLXPixmap pixmap, const void **data,
+                              int *width, int *height, int *pitch, int *bpp)
+{
+   struct apple_glx_drawable *d;
+   struct apple_glx_pixmap *p;
+   CGLContextObj previous;
+
+   d = apple_glx_drawable_find_by_type(pixmap, APPLE_GLX_DRAWABLE_PIXMAP,
+                                       APPLE_GLX_DRAWABLE_LOCK);
+
+   if (NULL == d)
+      return false;
+
+   p = &d->types.pixmap;
+
+   /* 
+    * Every GLX context renders to the pixmap with its CGL context, so
+    * finishing that flushes all of the pixmap's rendering.
+    */
+   previous = apple_cgl.get_current_context();
+
+   if (kCGLNoError == apple_glx_context_set_current_cgl(p->context_obj)) {
+      glFinish();
+      (void) apple_glx_context_set_current_cgl(previous);
+   }
+
+   *data = p->buffer;
+   *width = p->width;
+   *height = p->height;
+   *pitch = p->pitch;
+   *bpp = p->bpp;
+
+   d->ops->unlock(d);
+
+   return true;
+}
+
 /* Return true if the type is valid for pixmap. */
 bool
 apple_glx_pixmap_destroy(Display * dpy, GLXPixmap pixmap)
@@ -0,0 +1,380 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "apple_glx.h"
+#include "apple_cgl.h"
+#include "apple_visual.h"
+#include "apple_glx_pixmap_pool.h"
+
+/*
+ * The pool is a list ordered from the most to the least recently
+ * released context.  A hit requires the same pixel format and the same
+ * dimensions, because the renderer sizes the offscreen buffers of the
+ * context to match the last set_off_screen.
+ *
+ * A released context is reset from a pristine context of its pixel
+ * format, which is never made current and so keeps the default state.
+ * There is one for each pixel format that has been pooled, until the pool
+ * is flushed.
+ */
+struct pool_format
+{
+   CGLPixelFormatObj pfobj;     /* The pool's own reference. */
+   CGLContextObj pristine;
+   struct pool_format *next;
+};
+
+struct pool_entry
+{
+   CGLPixelFormatObj pfobj;
+   CGLContextObj context;
+   int width, height, pitch;
+   size_t size;
+   struct pool_entry *next;
+};
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t pool_once_control = PTHREAD_ONCE_INIT;
+static struct pool_entry *pool = NULL;
+static struct pool_format *formats = NULL;
+static struct apple_glx_pixmap_pool_stats pool_stats;
+
+static void
+lock_pool(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&pool_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_pool(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&pool_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+init_pool(void)
+{
+   const char *limit = getenv("LIBGL_PIXMAP_POOL_BYTES");
+
+   if (limit)
+      pool_stats.byte_limit = strtoul(limit, NULL, 0);
+}
+
+static void
+destroy_entries(struct pool_entry *e)
+{
+   struct pool_entry *next;
+
+   for (; e; e = next) {
+      next = e->next;
+
+      apple_glx_diagnostic("pixmap pool: destroying a %dx%d context\n",
+                           e->width, e->height);
+
+      (void) apple_cgl.destroy_context(e->context);
+      apple_visual_destroy_pfobj(e->pfobj);
+      free(e);
+   }
+}
+
+/* 
+ * Unlink the least recently used entries until the pool fits the limit.
+ * This returns the evicted entries, to be destroyed after the pool lock
+ * is released.
+ */
+static struct pool_entry *
+trim_pool(void)
+{
+   struct pool_entry *e, **prev, *evicted = NULL;
+
+   while (pool_stats.bytes_retained > pool_stats.byte_limit) {
+      for (prev = &pool; (*prev)->next; prev = &(*prev)->next) ;
+
+      e = *prev;
+      *prev = NULL;
+
+      pool_stats.bytes_retained -= e->size;
+      --pool_stats.entries;
+      ++pool_stats.evictions;
+
+      e->next = evicted;
+      evicted = e;
+   }
+
+   return evicted;
+}
+
+/* Return the pristine context for the pfobj, or NULL if there's none. */
+static CGLContextObj
+get_pristine(CGLPixelFormatObj pfobj)
+{
+   struct pool_format *f, *other;
+   CGLContextObj pristine;
+
+   lock_pool();
+
+   for (f = formats; f; f = f->next) {
+      if (f->pfobj == pfobj) {
+         pristine = f->pristine;
+         unlock_pool();
+         return pristine;
+      }
+   }
+
+   unlock_pool();
+
+   if (!apple_visual_reference_pfobj(pfobj))
+      return NULL;
+
+   f = malloc(sizeof(*f));
+
+   if (NULL == f) {
+      apple_visual_destroy_pfobj(pfobj);
+      return NULL;
+   }
+
+   if (kCGLNoError != apple_cgl.create_context(pfobj, NULL, &f->pristine)) {
+      apple_visual_destroy_pfobj(pfobj);
+      free(f);
+      return NULL;
+   }
+
+   f->pfobj = pfobj;
+
+   lock_pool();
+
+   /* Another thread may have added one while the pool was unlocked. */
+   for (other = formats; other; other = other->next)
+      if (other->pfobj == pfobj)
+         break;
+
+   if (other) {
+      pristine = other->pristine;
+   }
+   else {
+      f->next = formats;
+      formats = f;
+      ++pool_stats.formats;
+      pristine = f->pristine;
+      f = NULL;
+   }
+
+   unlock_pool();
+
+   if (f) {
+      (void) apple_cgl.destroy_context(f->pristine);
+      apple_visual_destroy_pfobj(f->pfobj);
+      free(f);
+   }
+
+   return pristine;
+}
+
+/* 
+ * Return true if the attribute state of the context couldn't be reset to
+ * the defaults.  The viewport and scissor box are set to the pixmap, as the
+ * renderer does when a new context is first attached.
+ */
+static bool
+reset_context(CGLContextObj context, CGLPixelFormatObj pfobj, int width,
+              int height)
+{
+   CGLContextObj pristine, previous;
+
+   pristine = get_pristine(pfobj);
+
+   if (NULL == pristine)
+      return true;
+
+   if (kCGLNoError != apple_cgl.copy_context(pristine, context,
+                                             GL_ALL_ATTRIB_BITS))
+      return true;
+
+   previous = apple_cgl.get_current_context();
+
+   if (kCGLNoError != apple_cgl.set_current_context(context))
+      return true;
+
+   glViewport(0, 0, width, height);
+   glScissor(0, 0, width, height);
+
+   (void) apple_cgl.set_current_context(previous);
+
+   return false;
+}
+
+bool
+apple_glx_pixmap_pool_get(CGLPixelFormatObj pfobj, int width, int height,
+                          int pitch, size_t size, CGLContextObj * context)
+{
+   struct pool_entry *e, **prev;
+
+   (void) pthread_once(&pool_once_control, init_pool);
+
+   if (0 == pool_stats.byte_limit)
+      return false;
+
+   lock_pool();
+
+   for (prev = &pool; (e = *prev); prev = &e->next) {
+      if (e->pfobj == pfobj && e->width == width && e->height == height
+          && e->pitch == pitch && e->size == size) {
+         *prev = e->next;
+
+         pool_stats.bytes_retained -= e->size;
+         --pool_stats.entries;
+         ++pool_stats.hits;
+
+         unlock_pool();
+
+         *context = e->context;
+
+         /* The caller has its own reference to the pfobj. */
+         apple_visual_destroy_pfobj(e->pfobj);
+         free(e);
+
+         return true;
+      }
+   }
+
+   ++pool_stats.misses;
+
+   unlock_pool();
+
+   return false;
+}
+
+void
+apple_glx_pixmap_pool_put(CGLPixelFormatObj pfobj, int width, int height,
+                          int pitch, size_t size, CGLContextObj context)
+{
+   struct pool_entry *e;
+
+   (void) pthread_once(&pool_once_control, init_pool);
+
+   if (size > pool_stats.byte_limit)
+      goto destroy;
+
+   /* Detach the context from the buffer that is about to be unmapped. */
+   if (kCGLNoError != apple_cgl.clear_drawable(context))
+      goto destroy;
+
+   if (reset_context(context, pfobj, width, height))
+      goto destroy;
+
+   e = malloc(sizeof(*e));
+
+   if (NULL == e)
+      goto destroy;
+
+   e->pfobj = pfobj;
+   e->context = context;
+   e->width = width;
+   e->height = height;
+   e->pitch = pitch;
+   e->size = size;
+
+   lock_pool();
+
+   e->next = pool;
+   pool = e;
+
+   pool_stats.bytes_retained += size;
+   ++pool_stats.entries;
+
+   e = trim_pool();
+
+   unlock_pool();
+
+   destroy_entries(e);
+
+   return;
+
+ destroy:
+   (void) apple_cgl.destroy_context(context);
+   apple_visual_destroy_pfobj(pfobj);
+}
+
+void
+apple_glx_pixmap_pool_flush(void)
+{
+   struct pool_entry *e;
+   struct pool_format *f, *next;
+
+   lock_pool();
+
+   e = pool;
+   pool = NULL;
+   f = formats;
+   formats = NULL;
+
+   pool_stats.bytes_retained = 0;
+   pool_stats.entries = 0;
+   pool_stats.formats = 0;
+
+   unlock_pool();
+
+   destroy_entries(e);
+
+   for (; f; f = next) {
+      next = f->next;
+      (void) apple_cgl.destroy_context(f->pristine);
+      apple_visual_destroy_pfobj(f->pfobj);
+      free(f);
+   }
+}
+
+void
+apple_glx_pixmap_pool_get_stats(struct apple_glx_pixmap_pool_stats *stats)
+{
+   (void) pthread_once(&pool_once_control, init_pool);
+
+   lock_pool();
+   *stats = pool_stats;
+   unlock_pool();
+}
@@ -0,0 +1,86 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#ifndef APPLE_GLX_PIXMAP_POOL_H
+#define APPLE_GLX_PIXMAP_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <OpenGL/CGLTypes.h>
+
+/*
+ * This keeps the offscreen CGL contexts of recently destroyed GLXPixmaps,
+ * so that a new pixmap with the same pixel format and dimensions can skip
+ * the context creation, and the allocation of the renderer's buffers.
+ * There are no size classes: a context is only reused for the exact
+ * dimensions and pitch, since its buffers were sized for them.  The shared
+ * memory itself can't be pooled, because the server creates it for each
+ * X pixmap.
+ *
+ * The pool is disabled unless LIBGL_PIXMAP_POOL_BYTES is set to the number
+ * of pixmap bytes that may be retained.  The attribute state of a released
+ * context, which includes the enables and the texture bindings, is reset to
+ * the defaults.  The client state and the objects of the previous pixmap
+ * are not, so the pool suits clients that create their objects for each
+ * pixmap, and leave no buffer object bound.
+ */
+
+struct apple_glx_pixmap_pool_stats
+{
+   unsigned long hits, misses, evictions;
+   size_t bytes_retained, byte_limit;
+   int entries;
+   /* The pixel formats with a pristine context to reset from. */
+   int formats;
+};
+
+/* 
+ * Return true if a pooled context was found.  The pool then gives up its
+ * reference to the pfobj, so the caller must hold its own.
+ */
+bool apple_glx_pixmap_pool_get(CGLPixelFormatObj pfobj, int width,
+                               int height, int pitch, size_t size,
+                               CGLContextObj * context);
+
+/* 
+ * This takes ownership of the context and the reference to the pfobj.
+ * They are destroyed immediately if they can't be retained.
+ */
+void apple_glx_pixmap_pool_put(CGLPixelFormatObj pfobj, int width,
+                               int height, int pitch, size_t size,
+                               CGLContextObj context);
+
+/* Destroy every pooled context, and the pristine contexts. */
+void apple_glx_pixmap_pool_flush(void);
+
+/* This is intended for debugging and introspection. */
+void apple_glx_pixmap_pool_get_stats(struct apple_glx_pixmap_pool_stats
+                                     *stats);
+
+#endif
@@ -26,24 +26,108 @@
  promote the sale, use or other dealings in this Software without
  prior written authorization.
 */
+#include <stdlib.h>
+#include <pthread.h>
 #include <assert.h>
 #include "glxclient.h"
 #include "apple_glx.h"
 #include "appledri.h"
 #include "apple_glx_drawable.h"
+#include "glxhash.h"
 
 static bool surface_make_current(struct apple_glx_context *ac,
                                  struct apple_glx_drawable *d);
 
-static void surface_destroy(Display * dpy, struct apple_glx_drawable *d);
+static void surface_destroy(Display * dpy, struct apple_glx_drawable *d,
+                            struct apple_glx_drawable_batch *batch);
 
 
-static struct apple_glx_drawable_callbacks callbacks = {
+static const struct apple_glx_drawable_callbacks callbacks = {
    .type = APPLE_GLX_DRAWABLE_SURFACE,
    .make_current = surface_make_current,
    .destroy = surface_destroy
 };
 
+/*
+ * glXCreateWindow sends the CreateSurface request for its window, and
+ * the first make current collects the reply.  The replies for a batch of
+ * windows then arrive together, or along with the replies to other
+ * requests, rather than in a round trip per window.  The table is keyed
+ * by drawable.
+ */
+struct surface_prefetch
+{
+   Display *dpy;
+   int screen;
+   XAppleDRISurfaceRequest *request;
+};
+
+static pthread_mutex_t prefetch_lock = PTHREAD_MUTEX_INITIALIZER;
+static __glxHashTable *prefetches = NULL;
+
+static void
+lock_prefetches(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&prefetch_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_prefetches(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&prefetch_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+/* This unlinks the prefetch for drawable on dpy, if there is one. */
+static struct surface_prefetch *
+remove_prefetch(Display * dpy, GLXDrawable drawable)
+{
+   struct surface_prefetch *p = NULL;
+   void *value;
+
+   lock_prefetches();
+
+   if (prefetches && 0 == __glxHashLookup(prefetches, drawable, &value)) {
+      p = value;
+
+      if (dpy == p->dpy)
+         __glxHashDelete(prefetches, drawable);
+      else
+         p = NULL;
+   }
+
+   unlock_prefetches();
+
+   return p;
+}
+
+/* Collect the reply, and destroy the surface that nothing will use. */
+static void
+discard_prefetch(struct surface_prefetch *p, GLXDrawable drawable)
+{
+   unsigned int key[2], uid;
+
+   if (XAppleDRICreateSurfaceReply(p->dpy, p->request, key, &uid))
+      XAppleDRIDestroySurface(p->dpy, p->screen, drawable);
+
+   free(p);
+}
+
 static void
 update_viewport_and_scissor(Display * dpy, GLXDrawable drawable)
 {
@@ -93,7 +177,8 @@ surface_make_current(struct apple_glx_context *ac,
 }
 
 static void
-surface_destroy(Display * dpy, struct apple_glx_drawable *d)
+surface_destroy(Display * dpy, struct apple_glx_drawable *d,
+                struct apple_glx_drawable_batch *batch)
 {
    struct apple_glx_surface *s = &d->types.surface;
 
@@ -116,8 +201,12 @@ surface_destroy(Display * dpy, struct apple_glx_drawable *d)
        * from surface_notify_handler.  It's probably best to not have
        * any locks at this point locked.
        */
-      XAppleDRIDestroySurface(d->display, DefaultScreen(d->display),
-                              d->drawable);
+      if (batch)
+         apple_glx_drawable_batch_add(batch, AppleDRIBatchDestroySurface,
+                                      DefaultScreen(d->display), d->drawable);
+      else
+         XAppleDRIDestroySurface(d->display, DefaultScreen(d->display),
+                                 d->drawable);
 
       apple_glx_diagnostic
          ("%s: destroyed a surface for drawable 0x%lx uid %u\n", __func__,
@@ -130,8 +219,11 @@ static bool
 create_surface(Display * dpy, int screen, struct apple_glx_drawable *d)
 {
    struct apple_glx_surface *s = &d->types.surface;
+   struct surface_prefetch *p;
    unsigned int key[2];
    xp_client_id id;
+   xp_error error;
+   bool prefetched = false;
 
    id = apple_glx_get_client_id();
    if (0 == id)
@@ -140,9 +232,24 @@ create_surface(Display * dpy, int screen, struct apple_glx_drawable *d)
    assert(None != d->drawable);
 
    s->pending_destroy = false;
+   s->generation = 0;
+   s->contexts = NULL;
 
-   if (XAppleDRICreateSurface(dpy, screen, d->drawable, id, key, &s->uid)) {
-      xp_error error;
+   p = remove_prefetch(dpy, d->drawable);
+
+   if (p) {
+      /* 
+       * The import fails if the window was destroyed, and its XID reused,
+       * after the prefetch.  Then a new surface is requested.
+       */
+      prefetched = XAppleDRICreateSurfaceReply(dpy, p->request, key, &s->uid)
+         && XP_Success == xp_import_surface(key, &s->surface_id);
+      free(p);
+   }
+
+   if (!prefetched) {
+      if (!XAppleDRICreateSurface(dpy, screen, d->drawable, id, key, &s->uid))
+         return true;           /* unable to create a surface. */
 
       error = xp_import_surface(key, &s->surface_id);
 
@@ -150,13 +257,15 @@ create_surface(Display * dpy, int screen, struct apple_glx_drawable *d)
          fprintf(stderr, "error: xp_import_surface returned: %d\n", error);
          return true;
       }
-
-      apple_glx_diagnostic("%s: created a surface for drawable 0x%lx"
-                           " with uid %u\n", __func__, d->drawable, s->uid);
-      return false;             /*success */
    }
 
-   return true;                 /* unable to create a surface. */
+   apple_glx_drawable_index_uid(d);
+
+   apple_glx_diagnostic("%s: created a %s surface for drawable 0x%lx"
+                        " with uid %u\n", __func__,
+                        prefetched ? "prefetched" : "new", d->drawable, s->uid);
+
+   return false;                /*success */
 }
 
 /* Return true if an error occured. */
@@ -174,18 +283,189 @@ apple_glx_surface_create(Display * dpy, int screen,
    /* apple_glx_drawable_create creates a locked and referenced object. */
 
    if (create_surface(dpy, screen, d)) {
-      d->unlock(d);
-      d->destroy(d);
+      d->ops->unlock(d);
+      d->ops->destroy(d);
       return true;
    }
 
    *resultptr = d;
 
-   d->unlock(d);
+   d->ops->unlock(d);
 
    return false;
 }
 
+void
+apple_glx_surface_prefetch(Display * dpy, int screen, GLXDrawable drawable)
+{
+   struct surface_prefetch *p;
+   xp_client_id id;
+   void *value;
+
+   id = apple_glx_get_client_id();
+   if (0 == id)
+      return;
+
+   p = malloc(sizeof(*p));
+
+   if (NULL == p)
+      return;
+
+   p->dpy = dpy;
+   p->screen = screen;
+   p->request = NULL;
+
+   lock_prefetches();
+
+   if (NULL == prefetches)
+      prefetches = __glxHashCreate();
+
+   /* A surface is requested once for each drawable. */
+   if (NULL == prefetches || 0 == __glxHashLookup(prefetches, drawable,
+                                                  &value)) {
+      unlock_prefetches();
+      free(p);
+      return;
+   }
+
+   p->request = XAppleDRICreateSurfaceAsync(dpy, screen, drawable, id);
+
+   if (NULL == p->request) {
+      unlock_prefetches();
+      free(p);
+      return;
+   }
+
+   if (__glxHashInsert(prefetches, drawable, p)) {
+      unlock_prefetches();
+      discard_prefetch(p, drawable);
+      return;
+   }
+
+   unlock_prefetches();
+}
+
+void
+apple_glx_surface_cancel_prefetch(Display * dpy, GLXDrawable drawable)
+{
+   struct surface_prefetch *p;
+
+   p = remove_prefetch(dpy, drawable);
+
+   if (p)
+      discard_prefetch(p, drawable);
+}
+
+/* 
+ * Return the windows of up to max prefetches on dpy, for the garbage
+ * collector to probe.  Each call resumes after the last window returned,
+ * so every prefetch is probed in turn.
+ */
+int
+apple_glx_surface_prefetched(Display * dpy, GLXDrawable * drawables, int max)
+{
+   static int resume = 0;
+   struct surface_prefetch *p;
+   unsigned long key;
+   void *value;
+   int total = 0, count = 0, i, pass;
+
+   lock_prefetches();
+
+   if (prefetches && __glxHashFirst(prefetches, &key, &value) == 1) {
+      do {
+         p = value;
+
+         if (dpy == p->dpy)
+            ++total;
+      } while (__glxHashNext(prefetches, &key, &value) == 1);
+   }
+
+   if (0 == total) {
+      unlock_prefetches();
+      return 0;
+   }
+
+   if (resume >= total)
+      resume = 0;
+
+   /* The first pass takes the windows from resume, the second wraps. */
+   for (pass = 0; pass < 2 && count < max; ++pass) {
+      if (__glxHashFirst(prefetches, &key, &value) != 1)
+         break;
+
+      i = 0;
+
+      do {
+         p = value;
+
+         if (dpy != p->dpy)
+            continue;
+
+         if ((0 == pass) == (i >= resume) && count < max)
+            drawables[count++] = key;
+
+         ++i;
+      } while (__glxHashNext(prefetches, &key, &value) == 1);
+   }
+
+   resume = (resume + count) % total;
+
+   unlock_prefetches();
+
+   return count;
+}
+
+/* The window is gone, and the server destroyed its surface with it. */
+void
+apple_glx_surface_reap_prefetch(Display * dpy, GLXDrawable drawable)
+{
+   struct surface_prefetch *p;
+
+   p = remove_prefetch(dpy, drawable);
+
+   if (p) {
+      XAppleDRICancelSurfaceRequest(dpy, p->request);
+      free(p);
+   }
+}
+
+/* 
+ * This is called as dpy closes.  The connection takes the surfaces with
+ * it, so the requests are only freed, and none is sent.
+ */
+void
+apple_glx_surface_close_display(Display * dpy)
+{
+   struct surface_prefetch *p;
+   unsigned long key;
+   void *value;
+
+   for (;;) {
+      p = NULL;
+
+      lock_prefetches();
+
+      if (prefetches && __glxHashFirst(prefetches, &key, &value) == 1) {
+         do {
+            if (dpy == ((struct surface_prefetch *) value)->dpy) {
+               p = value;
+               __glxHashDelete(prefetches, key);
+               break;
+            }
+         } while (__glxHashNext(prefetches, &key, &value) == 1);
+      }
+
+      unlock_prefetches();
+
+      if (NULL == p)
+         return;
+
+      XAppleDRICancelSurfaceRequest(dpy, p->request);
+      free(p);
+   }
+}
+
 /*
  * All surfaces are reference counted, and surfaces are only created
  * when the window is made current.  When all contexts no longer reference
@@ -206,19 +486,19 @@ apple_glx_surface_destroy(unsigned int uid)
 
    if (d) {
       d->types.surface.pending_destroy = true;
-      d->release(d);
+      d->ops->release(d);
       /* 
        * We release 2 references to the surface.  One was acquired by
        * the find, and the other was leftover from a context, or 
        * the surface being displayed, so the destroy() will decrease it
        * once more.
        *
-       * If the surface is in a context, it will take one d->destroy(d);
+       * If the surface is in a context, it will take one d->ops->destroy(d);
        * to actually destroy it when the pending_destroy is processed
        * by a glViewport callback (see apple_glx_context_update()).
        */
-      d->destroy(d);
+      d->ops->destroy(d);
 
-      d->unlock(d);
+      d->ops->unlock(d);
    }
 }
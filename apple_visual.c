@@ -30,7 +30,9 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <pthread.h>
 #include <GL/gl.h>
 #include <OpenGL/OpenGL.h>
 #include <OpenGL/CGLContext.h>
@@ -45,6 +47,113 @@ enum
    MAX_ATTR = 60
 };
 
+/*
+ * Identical attribute lists always result in an identical pixel format,
+ * so the pixel formats are shared.  The attribute list is the key, and
+ * it already reflects the offscreen flag and the LIBGL_ALWAYS_SOFTWARE
+ * and LIBGL_ALLOW_SOFTWARE environment state.
+ */
+struct pfobj_cache_entry
+{
+   CGLPixelFormatAttribute attr[MAX_ATTR];
+   int numattr;
+   CGLPixelFormatObj pfobj;
+   int reference_count;
+   struct pfobj_cache_entry *next;
+};
+
+static pthread_mutex_t pfobj_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pfobj_cache_entry *pfobj_cache = NULL;
+static unsigned long pfobj_cache_hits = 0;
+static unsigned long pfobj_cache_misses = 0;
+
+static void
+lock_pfobj_cache(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&pfobj_cache_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_pfobj_cache(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&pfobj_cache_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+/* Return the referenced pixel format for the attr list. */
+static CGLPixelFormatObj
+choose_cached_pixel_format(const CGLPixelFormatAttribute * attr,
+                           int numattr)
+{
+   struct pfobj_cache_entry *e;
+   CGLPixelFormatObj pfobj;
+   CGLError error;
+   GLint vsref = 0;
+
+   lock_pfobj_cache();
+
+   for (e = pfobj_cache; e; e = e->next) {
+      if (e->numattr == numattr
+          && !memcmp(e->attr, attr, sizeof(*attr) * numattr)) {
+         ++e->reference_count;
+         ++pfobj_cache_hits;
+         pfobj = e->pfobj;
+         unlock_pfobj_cache();
+         return pfobj;
+      }
+   }
+
+   ++pfobj_cache_misses;
+
+   /* 
+    * The cache stays locked, so that only one thread chooses the
+    * pixel format for an attribute list.
+    */
+   error = apple_cgl.choose_pixel_format(attr, &pfobj, &vsref);
+
+   if (error) {
+      fprintf(stderr, "error: %s\n", apple_cgl.error_string(error));
+      abort();
+   }
+
+   e = malloc(sizeof(*e));
+
+   if (NULL == e) {
+      /* The pixel format just isn't shared. */
+      unlock_pfobj_cache();
+      return pfobj;
+   }
+
+   memcpy(e->attr, attr, sizeof(*attr) * numattr);
+   e->numattr = numattr;
+   e->pfobj = pfobj;
+   e->reference_count = 1;
+   e->next = pfobj_cache;
+   pfobj_cache = e;
+
+   unlock_pfobj_cache();
+
+   apple_glx_diagnostic("%s: new pixel format %p\n", __func__,
+                        (void *) pfobj);
+
+   return pfobj;
+}
+
 /*mode is a __GlcontextModes*/
 void
 apple_visual_create_pfobj(CGLPixelFormatObj * pfobj, const void *mode,
@@ -54,8 +163,6 @@ apple_visual_create_pfobj(CGLPixelFormatObj * pfobj, const void *mode,
    CGLPixelFormatAttribute attr[MAX_ATTR];
    const __GLcontextModes *c = mode;
    int numattr = 0;
-   GLint vsref = 0;
-   CGLError error = 0;
 
    if (offscreen) {
       apple_glx_diagnostic
@@ -135,10 +242,63 @@ apple_visual_create_pfobj(CGLPixelFormatObj * pfobj, const void *mode,
 
    assert(numattr < MAX_ATTR);
 
-   error = apple_cgl.choose_pixel_format(attr, pfobj, &vsref);
+   *pfobj = choose_cached_pixel_format(attr, numattr);
+}
 
-   if (error) {
-      fprintf(stderr, "error: %s\n", apple_cgl.error_string(error));
+void
+apple_visual_destroy_pfobj(CGLPixelFormatObj pfobj)
+{
+   struct pfobj_cache_entry *e, **prev;
+
+   lock_pfobj_cache();
+
+   for (prev = &pfobj_cache; (e = *prev); prev = &e->next) {
+      if (e->pfobj == pfobj) {
+         if (--e->reference_count > 0) {
+            unlock_pfobj_cache();
+            return;
+         }
+
+         *prev = e->next;
+         free(e);
+         break;
+      }
+   }
+
+   unlock_pfobj_cache();
+
+   /* This is the last user, or the pixel format wasn't cached. */
+   if (apple_cgl.destroy_pixel_format(pfobj)) {
+      fprintf(stderr, "error: destroying pixel format in %s\n", __func__);
       abort();
    }
 }
+
+bool
+apple_visual_reference_pfobj(CGLPixelFormatObj pfobj)
+{
+   struct pfobj_cache_entry *e;
+
+   lock_pfobj_cache();
+
+   for (e = pfobj_cache; e; e = e->next) {
+      if (e->pfobj == pfobj) {
+         ++e->reference_count;
+         unlock_pfobj_cache();
+         return true;
+      }
+   }
+
+   unlock_pfobj_cache();
+
+   return false;
+}
+
+void
+apple_visual_get_pfobj_stats(unsigned long *hits, unsigned long *misses)
+{
+   lock_pfobj_cache();
+   *hits = pfobj_cache_hits;
+   *misses = pfobj_cache_misses;
+   unlock_pfobj_cache();
+}
@@ -38,4 +38,19 @@ void apple_visual_create_pfobj(CGLPixelFormatObj * pfobj, const void *mode,
                                bool * double_buffered, bool * uses_stereo,
                                bool offscreen);
 
+/* 
+ * The pixel formats from apple_visual_create_pfobj are shared and
+ * reference counted, so they must be released with this.
+ */
+void apple_visual_destroy_pfobj(CGLPixelFormatObj pfobj);
+
+/* 
+ * Return true with another reference to a shared pixel format, or false
+ * if the pixel format isn't shared.
+ */
+bool apple_visual_reference_pfobj(CGLPixelFormatObj pfobj);
+
+/* This is intended for debugging and introspection. */
+void apple_visual_get_pfobj_stats(unsigned long *hits, unsigned long *misses);
+
 #endif
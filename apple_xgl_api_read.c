@@ -32,6 +32,15 @@
  *
  * The way it works is by swapping the currentDrawable for the currentReadable
  * drawable if they are different.
+ *
+ * glReadPixels first tries the read binding that glXMakeContextCurrent set
+ * up in apple_glx_context.c, which only switches the current CGL context.
+ * glCopyPixels and glCopyColorTable use the state and objects of the
+ * context itself, so they always swap the drawable.
+ *
+ * The binding reads in a secondary context, so the calls below that change
+ * the pack or pixel mode state flag it for the next read to copy, and
+ * glGetError reports the errors of the reads.
  */
 #include <stdbool.h>
 #include "apple_xgl_api_read.h"
@@ -44,6 +53,7 @@ extern struct apple_xgl_api __gl_api;
 struct apple_xgl_saved_state
 {
    bool swapped;
+   bool bound;
 };
 
 static void
@@ -56,6 +66,7 @@ SetRead(struct apple_xgl_saved_state *saved)
     * functions correctly.
     */
    saved->swapped = false;
+   saved->bound = false;
 
    /* 
     * If the readable drawable isn't the same as the drawable then 
@@ -78,10 +89,35 @@ SetRead(struct apple_xgl_saved_state *saved)
    }
 }
 
+/* This uses the read binding when one exists, and falls back to SetRead. */
+static void
+SetBoundRead(struct apple_xgl_saved_state *saved)
+{
+   GLXContext gc = __glXGetCurrentContext();
+
+   saved->swapped = false;
+   saved->bound = false;
+
+   if (None != gc->currentReadable
+       && gc->currentReadable != gc->currentDrawable) {
+      if (apple_glx_context_begin_read(gc->apple)) {
+         saved->bound = true;
+         return;
+      }
+
+      SetRead(saved);
+   }
+}
+
 static void
 UnsetRead(struct apple_xgl_saved_state *saved)
 {
-   if (saved->swapped) {
+   if (saved->bound) {
+      GLXContext gc = __glXGetCurrentContext();
+
+      apple_glx_context_end_read(gc->apple);
+   }
+   else if (saved->swapped) {
       GLXContext gc = __glXGetCurrentContext();
       Display *dpy = glXGetCurrentDisplay();
 
@@ -101,7 +137,7 @@ glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height,
 {
    struct apple_xgl_saved_state saved;
 
-   SetRead(&saved);
+   SetBoundRead(&saved);
 
    __gl_api.ReadPixels(x, y, width, height, format, type, pixels);
 
@@ -132,3 +168,250 @@ glCopyColorTable(GLenum target, GLenum internalformat, GLint x, GLint y,
 
    UnsetRead(&saved);
 }
+
+/* Flag the state that the next bound read must copy from this context. */
+static void
+ReadStateChanged(unsigned int dirty)
+{
+   GLXContext gc = __glXGetCurrentContext();
+
+   if (gc->apple)
+      apple_glx_context_read_state_changed(gc->apple, dirty);
+}
+
+static bool
+IsPackName(GLenum pname)
+{
+   switch (pname) {
+   case GL_PACK_SWAP_BYTES:
+   case GL_PACK_LSB_FIRST:
+   case GL_PACK_ROW_LENGTH:
+   case GL_PACK_IMAGE_HEIGHT:
+   case GL_PACK_SKIP_ROWS:
+   case GL_PACK_SKIP_PIXELS:
+   case GL_PACK_SKIP_IMAGES:
+   case GL_PACK_ALIGNMENT:
+      return true;
+   }
+
+   return false;
+}
+
+/* These are the enables of GL_PIXEL_MODE_BIT. */
+static bool
+IsPixelModeCap(GLenum cap)
+{
+   switch (cap) {
+   case GL_COLOR_TABLE:
+   case GL_POST_CONVOLUTION_COLOR_TABLE:
+   case GL_POST_COLOR_MATRIX_COLOR_TABLE:
+   case GL_CONVOLUTION_1D:
+   case GL_CONVOLUTION_2D:
+   case GL_SEPARABLE_2D:
+   case GL_HISTOGRAM:
+   case GL_MINMAX:
+      return true;
+   }
+
+   return false;
+}
+
+GLenum
+glGetError(void)
+{
+   GLXContext gc = __glXGetCurrentContext();
+   GLenum error;
+
+   if (gc->apple) {
+      error = apple_glx_context_read_error(gc->apple);
+
+      if (GL_NO_ERROR != error)
+         return error;
+   }
+
+   return __gl_api.GetError();
+}
+
+void
+glPixelStorei(GLenum pname, GLint param)
+{
+   if (IsPackName(pname))
+      ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.PixelStorei(pname, param);
+}
+
+void
+glPixelStoref(GLenum pname, GLfloat param)
+{
+   if (IsPackName(pname))
+      ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.PixelStoref(pname, param);
+}
+
+void
+glBindBuffer(GLenum target, GLuint buffer)
+{
+   if (GL_PIXEL_PACK_BUFFER == target)
+      ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.BindBuffer(target, buffer);
+}
+
+void
+glBindBufferARB(GLenum target, GLuint buffer)
+{
+   if (GL_PIXEL_PACK_BUFFER == target)
+      ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.BindBufferARB(target, buffer);
+}
+
+/* Deleting the bound pack buffer unbinds it. */
+void
+glDeleteBuffers(GLsizei n, const GLuint * buffers)
+{
+   ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.DeleteBuffers(n, buffers);
+}
+
+void
+glDeleteBuffersARB(GLsizei n, const GLuint * buffers)
+{
+   ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.DeleteBuffersARB(n, buffers);
+}
+
+void
+glPopClientAttrib(void)
+{
+   ReadStateChanged(APPLE_GLX_READ_PACK_DIRTY);
+
+   __gl_api.PopClientAttrib();
+}
+
+void
+glPopAttrib(void)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.PopAttrib();
+}
+
+void
+glEnable(GLenum cap)
+{
+   if (IsPixelModeCap(cap))
+      ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.Enable(cap);
+}
+
+void
+glDisable(GLenum cap)
+{
+   if (IsPixelModeCap(cap))
+      ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.Disable(cap);
+}
+
+void
+glReadBuffer(GLenum mode)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ReadBuffer(mode);
+}
+
+void
+glPixelTransferi(GLenum pname, GLint param)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.PixelTransferi(pname, param);
+}
+
+void
+glPixelTransferf(GLenum pname, GLfloat param)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.PixelTransferf(pname, param);
+}
+
+void
+glPixelZoom(GLfloat xfactor, GLfloat yfactor)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.PixelZoom(xfactor, yfactor);
+}
+
+void
+glColorTableParameterfv(GLenum target, GLenum pname, const GLfloat * params)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ColorTableParameterfv(target, pname, params);
+}
+
+void
+glColorTableParameteriv(GLenum target, GLenum pname, const GLint * params)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ColorTableParameteriv(target, pname, params);
+}
+
+void
+glConvolutionParameterf(GLenum target, GLenum pname, GLfloat params)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ConvolutionParameterf(target, pname, params);
+}
+
+void
+glConvolutionParameterfv(GLenum target, GLenum pname, const GLfloat * params)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ConvolutionParameterfv(target, pname, params);
+}
+
+void
+glConvolutionParameteri(GLenum target, GLenum pname, GLint params)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ConvolutionParameteri(target, pname, params);
+}
+
+void
+glConvolutionParameteriv(GLenum target, GLenum pname, const GLint * params)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.ConvolutionParameteriv(target, pname, params);
+}
+
+/* A display list may set any of the pixel mode state. */
+void
+glCallList(GLuint list)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.CallList(list);
+}
+
+void
+glCallLists(GLsizei n, GLenum type, const GLvoid * lists)
+{
+   ReadStateChanged(APPLE_GLX_READ_MODE_DIRTY);
+
+   __gl_api.CallLists(n, type, lists);
+}
@@ -44,4 +44,35 @@ extern void glCopyPixels(GLint x, GLint y, GLsizei width, GLsizei height,
 extern void glCopyColorTable(GLenum target, GLenum internalformat, GLint x,
                              GLint y, GLsizei width);
 
+/* These track the state that apple_glx_context_begin_read copies. */
+extern GLenum glGetError(void);
+extern void glPixelStorei(GLenum pname, GLint param);
+extern void glPixelStoref(GLenum pname, GLfloat param);
+extern void glBindBuffer(GLenum target, GLuint buffer);
+extern void glBindBufferARB(GLenum target, GLuint buffer);
+extern void glDeleteBuffers(GLsizei n, const GLuint * buffers);
+extern void glDeleteBuffersARB(GLsizei n, const GLuint * buffers);
+extern void glPopClientAttrib(void);
+extern void glPopAttrib(void);
+extern void glEnable(GLenum cap);
+extern void glDisable(GLenum cap);
+extern void glReadBuffer(GLenum mode);
+extern void glPixelTransferi(GLenum pname, GLint param);
+extern void glPixelTransferf(GLenum pname, GLfloat param);
+extern void glPixelZoom(GLfloat xfactor, GLfloat yfactor);
+extern void glColorTableParameterfv(GLenum target, GLenum pname,
+                                    const GLfloat * params);
+extern void glColorTableParameteriv(GLenum target, GLenum pname,
+                                    const GLint * params);
+extern void glConvolutionParameterf(GLenum target, GLenum pname,
+                                    GLfloat params);
+extern void glConvolutionParameterfv(GLenum target, GLenum pname,
+                                     const GLfloat * params);
+extern void glConvolutionParameteri(GLenum target, GLenum pname,
+                                    GLint params);
+extern void glConvolutionParameteriv(GLenum target, GLenum pname,
+                                     const GLint * params);
+extern void glCallList(GLuint list);
+extern void glCallLists(GLsizei n, GLenum type, const GLvoid * lists);
+
 #endif
@@ -40,9 +40,9 @@ extern struct apple_xgl_api __gl_api;
 void
 glDrawBuffer(GLenum mode)
 {
-   GLXContext gc = glXGetCurrentContext();
+   GLXContext gc = __glXGetCurrentContext();
 
-   if (gc && apple_glx_context_uses_stereo(gc->apple)) {
+   if (gc->uses_stereo) {
       GLenum buf[2];
       GLsizei n = 0;
 
@@ -75,9 +75,9 @@ glDrawBuffer(GLenum mode)
 void
 glDrawBuffers(GLsizei n, const GLenum * bufs)
 {
-   GLXContext gc = glXGetCurrentContext();
+   GLXContext gc = __glXGetCurrentContext();
 
-   if (gc && apple_glx_context_uses_stereo(gc->apple)) {
+   if (gc->uses_stereo) {
       GLenum newbuf[n + 2];
       GLsizei i, outi = 0;
       bool have_back = false;
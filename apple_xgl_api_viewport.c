@@ -36,10 +36,9 @@ void
 glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
    GLXContext gc = __glXGetCurrentContext();
-   Display *dpy = glXGetCurrentDisplay();
 
-   if (gc && gc->apple)
-      apple_glx_context_update(dpy, gc->apple);
+   if (gc->apple)
+      apple_glx_context_update(gc->currentDpy, gc->apple);
 
    __gl_api.Viewport(x, y, width, height);
 }
@@ -45,6 +45,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <X11/extensions/Xext.h>
 #include <X11/extensions/extutil.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 static XExtensionInfo _appledri_info_data;
 static XExtensionInfo *appledri_info = &_appledri_info_data;
@@ -282,6 +283,137 @@ XAppleDRICreateSurface(dpy, screen, drawable, client_id, key, uid)
    return True;
 }
 
+/*
+ * A CreateSurface request whose reply is collected later.  Xlib passes
+ * the reply to the async handler when it reads past it, as it does for
+ * the reply to any later request.
+ */
+struct _XAppleDRISurfaceRequest
+{
+   _XAsyncHandler async;
+   unsigned long sequence;
+   Bool done;
+   Bool success;
+   unsigned int key[2];
+   unsigned int uid;
+};
+
+static Bool
+create_surface_handler(Display * dpy, xReply * rep, char *buf, int len,
+                       XPointer data)
+{
+   XAppleDRISurfaceRequest *r = (XAppleDRISurfaceRequest *) data;
+   xAppleDRICreateSurfaceReply replbuf, *repl;
+
+   if (dpy->last_request_read != r->sequence)
+      return False;
+
+   /* 
+    * The handler would otherwise see every later reply until the request
+    * is collected, which for a window never made current is never.
+    */
+   r->done = True;
+   DeqAsyncHandler(dpy, &r->async);
+
+   /* Xlib reports the error, as it does for XAppleDRICreateSurface. */
+   if (X_Error == rep->generic.type)
+      return False;
+
+   repl = (xAppleDRICreateSurfaceReply *)
+      _XGetAsyncReply(dpy, (char *) &replbuf, rep, buf, len,
+                      (SIZEOF(xAppleDRICreateSurfaceReply) -
+                       SIZEOF(xReply)) >> 2, True);
+
+   if (repl->key_0) {
+      r->key[0] = repl->key_0;
+      r->key[1] = repl->key_1;
+      r->uid = repl->uid;
+      r->success = True;
+   }
+
+   return True;
+}
+
+XAppleDRISurfaceRequest *
+XAppleDRICreateSurfaceAsync(Display * dpy, int screen, Drawable drawable,
+                            unsigned int client_id)
+{
+   XExtDisplayInfo *info = find_display(dpy);
+   xAppleDRICreateSurfaceReq *req;
+   XAppleDRISurfaceRequest *r;
+
+   TRACE("CreateSurfaceAsync...");
+   AppleDRICheckExtension(dpy, info, NULL);
+
+   r = calloc(1, sizeof(*r));
+
+   if (NULL == r)
+      return NULL;
+
+   LockDisplay(dpy);
+   GetReq(AppleDRICreateSurface, req);
+   req->reqType = info->codes->major_opcode;
+   req->driReqType = X_AppleDRICreateSurface;
+   req->screen = screen;
+   req->drawable = drawable;
+   req->client_id = client_id;
+   r->sequence = dpy->request;
+   r->async.next = dpy->async_handlers;
+   r->async.handler = create_surface_handler;
+   r->async.data = (XPointer) r;
+   dpy->async_handlers = &r->async;
+   UnlockDisplay(dpy);
+   SyncHandle();
+   TRACE("CreateSurfaceAsync... return");
+   return r;
+}
+
+Bool
+XAppleDRICreateSurfaceReply(Display * dpy, XAppleDRISurfaceRequest * r,
+                            unsigned int key[2], unsigned int *uid)
+{
+   Bool done, result;
+
+   TRACE("CreateSurfaceReply...");
+
+   LockDisplay(dpy);
+   done = r->done;
+   UnlockDisplay(dpy);
+
+   /* This reads every reply up to the one for the XSync. */
+   if (!done)
+      XSync(dpy, False);
+
+   LockDisplay(dpy);
+   DeqAsyncHandler(dpy, &r->async);
+   result = r->success;
+
+   if (result) {
+      key[0] = r->key[0];
+      key[1] = r->key[1];
+      *uid = r->uid;
+   }
+
+   UnlockDisplay(dpy);
+
+   free(r);
+   TRACE("CreateSurfaceReply... return");
+   return result;
+}
+
+void
+XAppleDRICancelSurfaceRequest(Display * dpy, XAppleDRISurfaceRequest * r)
+{
+   TRACE("CancelSurfaceRequest...");
+
+   LockDisplay(dpy);
+   DeqAsyncHandler(dpy, &r->async);
+   UnlockDisplay(dpy);
+
+   free(r);
+   TRACE("CancelSurfaceRequest... return");
+}
+
 Bool
 XAppleDRIDestroySurface(dpy, screen, drawable)
      Display *dpy;
@@ -450,3 +582,47 @@ XAppleDRIDestroyPixmap(Display * dpy, Pixmap drawable)
 
    return True;
 }
+
+Bool
+XAppleDRISendBatch(Display * dpy, const XAppleDRIBatchRequest * requests,
+                   int count)
+{
+   XExtDisplayInfo *info = find_display(dpy);
+   xAppleDRIDestroySurfaceReq *surface_req;
+   xAppleDRIDestroyPixmapReq *pixmap_req;
+   xResourceReq *req;
+   int i;
+
+   TRACE("SendBatch...");
+   AppleDRICheckExtension(dpy, info, False);
+
+   LockDisplay(dpy);
+
+   for (i = 0; i < count; ++i) {
+      switch (requests[i].kind) {
+      case AppleDRIBatchDestroySurface:
+         GetReq(AppleDRIDestroySurface, surface_req);
+         surface_req->reqType = info->codes->major_opcode;
+         surface_req->driReqType = X_AppleDRIDestroySurface;
+         surface_req->screen = requests[i].screen;
+         surface_req->drawable = requests[i].xid;
+         break;
+
+      case AppleDRIBatchDestroyPixmap:
+         GetReq(AppleDRIDestroyPixmap, pixmap_req);
+         pixmap_req->reqType = info->codes->major_opcode;
+         pixmap_req->driReqType = X_AppleDRIDestroyPixmap;
+         pixmap_req->drawable = requests[i].xid;
+         break;
+
+      case AppleDRIBatchFreePixmap:
+         GetResReq(FreePixmap, requests[i].xid, req);
+         break;
+      }
+   }
+
+   UnlockDisplay(dpy);
+   SyncHandle();
+   TRACE("SendBatch... return True");
+   return True;
+}
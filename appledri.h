@@ -70,6 +70,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define AppleDRISurfaceNotifyChanged	0
 #define AppleDRISurfaceNotifyDestroyed	1
 
+/* Kinds of batched requests: */
+#define AppleDRIBatchDestroySurface	0
+#define AppleDRIBatchDestroyPixmap	1
+#define AppleDRIBatchFreePixmap		2
+
 #ifndef _APPLEDRI_SERVER_
 
 typedef struct
@@ -103,6 +108,26 @@ Bool XAppleDRICreateSurface(Display * dpy, int screen, Drawable drawable,
                             unsigned int client_id, unsigned int key[2],
                             unsigned int *uid);
 
+/* 
+ * XAppleDRICreateSurfaceAsync sends the CreateSurface request without
+ * waiting for the reply.  XAppleDRICreateSurfaceReply returns the result,
+ * waiting for it if it hasn't arrived yet, and frees the request.  Each
+ * request must be collected or canceled once.  XAppleDRICancelSurfaceRequest
+ * frees it without waiting, when the surface can't be used: its window is
+ * gone, or the display is closing.
+ */
+typedef struct _XAppleDRISurfaceRequest XAppleDRISurfaceRequest;
+
+XAppleDRISurfaceRequest *XAppleDRICreateSurfaceAsync(Display * dpy,
+                                                     int screen,
+                                                     Drawable drawable,
+                                                     unsigned int client_id);
+
+Bool XAppleDRICreateSurfaceReply(Display * dpy, XAppleDRISurfaceRequest * r,
+                                 unsigned int key[2], unsigned int *uid);
+
+void XAppleDRICancelSurfaceRequest(Display * dpy, XAppleDRISurfaceRequest * r);
+
 Bool XAppleDRIDestroySurface(Display * dpy, int screen, Drawable drawable);
 
 Bool XAppleDRISynchronizeSurfaces(Display * dpy);
@@ -119,6 +144,21 @@ Bool XAppleDRICreatePixmap(Display * dpy, int screen, Drawable drawable,
 
 Bool XAppleDRIDestroyPixmap(Display * dpy, Pixmap pixmap);
 
+/* 
+ * XAppleDRISendBatch sends a batch of the requests without replies under
+ * one display lock.  A FreePixmap is included, so that the teardown of a
+ * pbuffer can join the batch.
+ */
+typedef struct
+{
+   int kind;                    /* AppleDRIBatchDestroySurface, ... */
+   int screen;
+   XID xid;
+} XAppleDRIBatchRequest;
+
+Bool XAppleDRISendBatch(Display * dpy, const XAppleDRIBatchRequest * requests,
+                        int count);
+
 _XFUNCPROTOEND
 #endif /* _APPLEDRI_SERVER_ */
 #endif /* _APPLEDRI_H_ */
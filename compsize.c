@@ -33,6 +33,15 @@
 #include "indirect_size.h"
 #endif
 #include "glxclient.h"
+#include "compsize_table.h"
+
+/*
+** The format and type tables are generated from specs/enum.spec by
+** gen_compsize.tcl.  An enum outside the tables has no components and
+** no bytes.  This is a macro so that -Os still inlines it.
+*/
+#define __GL_PIXEL_ENUM_BITS(e) \
+   (((e) > 0xffff) ? 0 : compsize_pages[(e) >> 8][(e) & 0xff])
 
 /*
 ** Return the number of elements per group of a specified format
@@ -44,59 +53,10 @@ __glElementsPerGroup(GLenum format, GLenum type)
     ** To make row length computation valid for image extraction,
     ** packed pixel types assume elements per group equals one.
     */
-   switch (type) {
-   case GL_UNSIGNED_BYTE_3_3_2:
-   case GL_UNSIGNED_BYTE_2_3_3_REV:
-   case GL_UNSIGNED_SHORT_5_6_5:
-   case GL_UNSIGNED_SHORT_5_6_5_REV:
-   case GL_UNSIGNED_SHORT_4_4_4_4:
-   case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-   case GL_UNSIGNED_SHORT_5_5_5_1:
-   case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-   case GL_UNSIGNED_SHORT_8_8_APPLE:
-   case GL_UNSIGNED_SHORT_8_8_REV_APPLE:
-   case GL_UNSIGNED_SHORT_15_1_MESA:
-   case GL_UNSIGNED_SHORT_1_15_REV_MESA:
-   case GL_UNSIGNED_INT_8_8_8_8:
-   case GL_UNSIGNED_INT_8_8_8_8_REV:
-   case GL_UNSIGNED_INT_10_10_10_2:
-   case GL_UNSIGNED_INT_2_10_10_10_REV:
-   case GL_UNSIGNED_INT_24_8_NV:
-   case GL_UNSIGNED_INT_24_8_MESA:
-   case GL_UNSIGNED_INT_8_24_REV_MESA:
+   if (__GL_PIXEL_ENUM_BITS(type) & COMPSIZE_PACKED)
       return 1;
-   default:
-      break;
-   }
 
-   switch (format) {
-   case GL_RGB:
-   case GL_BGR:
-      return 3;
-   case GL_422_EXT:
-   case GL_422_REV_EXT:
-   case GL_422_AVERAGE_EXT:
-   case GL_422_REV_AVERAGE_EXT:
-   case GL_YCBCR_422_APPLE:
-   case GL_LUMINANCE_ALPHA:
-      return 2;
-   case GL_RGBA:
-   case GL_BGRA:
-   case GL_ABGR_EXT:
-      return 4;
-   case GL_COLOR_INDEX:
-   case GL_STENCIL_INDEX:
-   case GL_DEPTH_COMPONENT:
-   case GL_RED:
-   case GL_GREEN:
-   case GL_BLUE:
-   case GL_ALPHA:
-   case GL_LUMINANCE:
-   case GL_INTENSITY:
-      return 1;
-   default:
-      return 0;
-   }
+   return COMPSIZE_COMPONENTS(__GL_PIXEL_ENUM_BITS(format));
 }
 
 /*
@@ -106,39 +66,7 @@ __glElementsPerGroup(GLenum format, GLenum type)
 GLint
 __glBytesPerElement(GLenum type)
 {
-   switch (type) {
-   case GL_UNSIGNED_SHORT:
-   case GL_SHORT:
-   case GL_UNSIGNED_SHORT_5_6_5:
-   case GL_UNSIGNED_SHORT_5_6_5_REV:
-   case GL_UNSIGNED_SHORT_4_4_4_4:
-   case GL_UNSIGNED_SHORT_4_4_4_4_REV:
-   case GL_UNSIGNED_SHORT_5_5_5_1:
-   case GL_UNSIGNED_SHORT_1_5_5_5_REV:
-   case GL_UNSIGNED_SHORT_8_8_APPLE:
-   case GL_UNSIGNED_SHORT_8_8_REV_APPLE:
-   case GL_UNSIGNED_SHORT_15_1_MESA:
-   case GL_UNSIGNED_SHORT_1_15_REV_MESA:
-      return 2;
-   case GL_UNSIGNED_BYTE:
-   case GL_BYTE:
-   case GL_UNSIGNED_BYTE_3_3_2:
-   case GL_UNSIGNED_BYTE_2_3_3_REV:
-      return 1;
-   case GL_INT:
-   case GL_UNSIGNED_INT:
-   case GL_FLOAT:
-   case GL_UNSIGNED_INT_8_8_8_8:
-   case GL_UNSIGNED_INT_8_8_8_8_REV:
-   case GL_UNSIGNED_INT_10_10_10_2:
-   case GL_UNSIGNED_INT_2_10_10_10_REV:
-   case GL_UNSIGNED_INT_24_8_NV:
-   case GL_UNSIGNED_INT_24_8_MESA:
-   case GL_UNSIGNED_INT_8_24_REV_MESA:
-      return 4;
-   default:
-      return 0;
-   }
+   return COMPSIZE_BYTES(__GL_PIXEL_ENUM_BITS(type));
 }
 
 /*
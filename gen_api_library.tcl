@@ -94,11 +94,39 @@ set dlopen_code {
     }
 }
 
+#This is used in place of the glsym() loop, when the binding is lazy.
+#Each __gl_api slot starts as a trampoline that binds the real symbol
+#on the first call, and then patches the slot.
+set lazy_code {
+static void *lazy_handle = NULL;
+
+static void lazybind(void **slot, void *trampoline, const char *name) {
+    void *sym = glsym(lazy_handle, name);
+
+    /* 
+     * Another thread may have bound this first, in which case the 
+     * result is the same. 
+     */
+    (void)__sync_bool_compare_and_swap(slot, trampoline, sym);
+}
+}
+
 set this_script [info script]
 
 proc main {argc argv} {
-    if {2 != $argc} {
-	puts stderr "syntax is: [set ::this_script] serialized-array-file output.c"
+    if {2 != $argc && 3 != $argc} {
+	puts stderr "syntax is: [set ::this_script] serialized-array-file output.c ?eager|lazy?"
+	return 1
+    }
+
+    set binding eager
+
+    if {3 == $argc} {
+	set binding [lindex $argv 2]
+    }
+
+    if {$binding ni {eager lazy}} {
+	puts stderr "invalid binding: $binding"
 	return 1
     }
 
@@ -121,7 +149,12 @@ proc main {argc argv} {
 #include "apple_glx_context.h"
     }
 
-    puts $fd "struct apple_xgl_api __gl_api;"
+    if {"lazy" eq $binding} {
+	#The table is defined below, after the trampolines.
+	puts $fd "extern struct apple_xgl_api __gl_api;"
+    } else {
+	puts $fd "struct apple_xgl_api __gl_api;"
+    }
     
     set sorted [lsort -dictionary [array names api]]
     
@@ -130,6 +163,16 @@ proc main {argc argv} {
     #These are special to glXMakeContextCurrent.
     #See also: apple_xgl_api_read.c.    
     lappend exclude ReadPixels CopyPixels CopyColorTable 
+
+    #These flag the state that a read binding copies, and glGetError
+    #reports the errors of its reads.  See also: apple_xgl_api_read.c.
+    lappend exclude GetError PixelStorei PixelStoref BindBuffer BindBufferARB
+    lappend exclude DeleteBuffers DeleteBuffersARB PopClientAttrib PopAttrib
+    lappend exclude Enable Disable ReadBuffer PixelTransferi PixelTransferf
+    lappend exclude PixelZoom ColorTableParameterfv ColorTableParameteriv
+    lappend exclude ConvolutionParameterf ConvolutionParameterfv
+    lappend exclude ConvolutionParameteri ConvolutionParameteriv
+    lappend exclude CallList CallLists
     
     #This is excluded to work with surface updates.
     lappend exclude Viewport
@@ -183,6 +226,12 @@ proc main {argc argv} {
     }
 
     puts $fd $::init_code
+
+    if {"lazy" eq $binding} {
+	write_lazy_binding $fd [array get api]
+	close $fd
+	return 0
+    }
     
     puts $fd "void apple_xgl_init_direct(void) \{"
     puts $fd "\tvoid *handle;"
@@ -209,4 +258,63 @@ proc main {argc argv} {
 
     return 0
 }
+
+proc write_lazy_binding {fd apilist} {
+    array set api $apilist
+    set sorted [lsort -dictionary [array names api]]
+    set bound [list]
+
+    puts $fd $::lazy_code
+
+    foreach f $sorted {
+	set attr $api($f)
+
+	if {[dict exists $attr alias_for] || [dict exists $attr noop]} {
+	    continue
+	}
+
+	lappend bound $f
+
+	set pstr ""
+	set callvars ""
+
+	foreach p [dict get $attr parameters] {
+	    append pstr "[lindex $p 0] [lindex $p 1], "
+	    append callvars "[lindex $p end], "
+	}
+
+	set pstr [string trimright $pstr ", "]
+	set callvars [string trimright $callvars ", "]
+
+	if {![string length $pstr]} {
+	    set pstr void
+	}
+
+	set return ""
+	if {"void" ne [dict get $attr return]} {
+	    set return "return "
+	}
+
+	puts $fd "static [dict get $attr return] APIENTRY lazy_[set f]([set pstr]) \{"
+	puts $fd "\tlazybind((void **)&__gl_api.$f, (void *)lazy_$f, \"gl$f\");"
+	puts $fd "\t[set return]__gl_api.[set f]([set callvars]);"
+	puts $fd "\}"
+    }
+
+    puts $fd "\nstruct apple_xgl_api __gl_api = \{"
+
+    foreach f $bound {
+	puts $fd "\t.$f = lazy_$f,"
+    }
+
+    puts $fd "\};\n"
+
+    puts $fd "void apple_xgl_init_direct(void) \{"
+    puts $fd "\tvoid *handle;"
+
+    puts $fd $::dlopen_code
+
+    puts $fd "\tlazy_handle = handle;"
+    puts $fd "\}\n"
+}
 exit [main $::argc $::argv]
@@ -29,9 +29,16 @@ if 0 {
 
 package require Tcl 8.5
 
-proc main {} {
+proc main {argv} {
     set tclsh [info nameofexecutable]
 
+    #The __gl_api binding is eager or lazy.  See gen_api_library.tcl.
+    set binding eager
+
+    if {[llength $argv]} {
+	set binding [lindex $argv 0]
+    }
+
     puts TYPES
     exec $tclsh ./gen_types.tcl stage.1
     puts DEFS
@@ -41,10 +48,12 @@ proc main {} {
     puts HEADER
     exec $tclsh ./gen_api_header.tcl stage.4 apple_xgl_api.h
     puts "C API"
-    exec $tclsh ./gen_api_library.tcl stage.4 apple_xgl_api.c
+    exec $tclsh ./gen_api_library.tcl stage.4 apple_xgl_api.c $binding
     puts "EXPORTS"
     exec $tclsh ./gen_exports.tcl stage.4 exports.list
+    puts "COMPSIZE"
+    exec $tclsh ./gen_compsize.tcl specs/enum.spec compsize_table.h
 
     return 0
 }
-exit [main]
+exit [main $::argv]
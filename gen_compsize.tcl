@@ -0,0 +1,181 @@
+if 0 { 
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+}
+
+#This generates the format and type tables of compsize.c from an
+#enum.spec type of file.  Each enum value indexes a byte with the number
+#of components of a format, or the bytes per element of a type.
+#The bytes are kept in 256 entry pages, selected by the high byte of the
+#enum, so a lookup is two loads.
+
+package require Tcl 8.5
+
+#The components of each pixel format.
+set formats {
+    RGB 3 BGR 3
+    422_EXT 2 422_REV_EXT 2 422_AVERAGE_EXT 2 422_REV_AVERAGE_EXT 2
+    YCBCR_422_APPLE 2 LUMINANCE_ALPHA 2
+    RGBA 4 BGRA 4 ABGR_EXT 4
+    COLOR_INDEX 1 STENCIL_INDEX 1 DEPTH_COMPONENT 1 RED 1 GREEN 1 BLUE 1
+    ALPHA 1 LUMINANCE 1 INTENSITY 1
+}
+
+#The bytes per element of each pixel type.
+set types {
+    UNSIGNED_BYTE 1 BYTE 1
+    UNSIGNED_SHORT 2 SHORT 2
+    UNSIGNED_INT 4 INT 4 FLOAT 4
+}
+
+#The packed pixel types, which have one element per group.
+set packed_types {
+    UNSIGNED_BYTE_3_3_2 1 UNSIGNED_BYTE_2_3_3_REV 1
+    UNSIGNED_SHORT_5_6_5 2 UNSIGNED_SHORT_5_6_5_REV 2
+    UNSIGNED_SHORT_4_4_4_4 2 UNSIGNED_SHORT_4_4_4_4_REV 2
+    UNSIGNED_SHORT_5_5_5_1 2 UNSIGNED_SHORT_1_5_5_5_REV 2
+    UNSIGNED_SHORT_8_8_APPLE 2 UNSIGNED_SHORT_8_8_REV_APPLE 2
+    UNSIGNED_SHORT_15_1_MESA 2 UNSIGNED_SHORT_1_15_REV_MESA 2
+    UNSIGNED_INT_8_8_8_8 4 UNSIGNED_INT_8_8_8_8_REV 4
+    UNSIGNED_INT_10_10_10_2 4 UNSIGNED_INT_2_10_10_10_REV 4
+    UNSIGNED_INT_24_8_NV 4 UNSIGNED_INT_24_8_MESA 4
+    UNSIGNED_INT_8_24_REV_MESA 4
+}
+
+set COMPONENTS_SHIFT 0
+set BYTES_SHIFT 3
+set PACKED 0x40
+
+proc read_enums {path} {
+    set fd [open $path r]
+    set data [read $fd]
+    close $fd
+
+    set enums [dict create]
+
+    foreach line [split $data \n] {
+	if {[regexp {^\t(\w+)\s*=\s*(0x[0-9A-Fa-f]+|\d+)} $line _ def value]} {
+	    if {![dict exists $enums $def]} {
+		dict set enums $def [expr {$value}]
+	    }
+	}
+    }
+
+    return $enums
+}
+
+proc add {enums name bits} {
+    upvar pages pages
+
+    if {![dict exists $enums $name]} {
+	puts stderr "GL_$name is not in the enum spec"
+	exit 1
+    }
+
+    set value [dict get $enums $name]
+
+    if {$value > 0xffff} {
+	puts stderr "GL_$name is too large for the pages"
+	exit 1
+    }
+
+    set page [expr {$value >> 8}]
+    set index [expr {$value & 0xff}]
+
+    if {[dict exists $pages $page $index]} {
+	puts stderr "GL_$name has the value of another format or type"
+	exit 1
+    }
+
+    dict set pages $page $index [list $bits $name]
+}
+
+proc main {argc argv} {
+    global formats types packed_types COMPONENTS_SHIFT BYTES_SHIFT PACKED
+
+    if {2 != $argc} {
+	puts stderr "syntax is: [info script] enum.spec output.h"
+	exit 1
+    }
+
+    set enums [read_enums [lindex $argv 0]]
+    set pages [dict create]
+
+    foreach {name n} $formats {
+	add $enums $name [expr {$n << $COMPONENTS_SHIFT}]
+    }
+
+    foreach {name n} $types {
+	add $enums $name [expr {$n << $BYTES_SHIFT}]
+    }
+
+    foreach {name n} $packed_types {
+	add $enums $name [expr {($n << $BYTES_SHIFT) | $PACKED}]
+    }
+
+    set fd [open [lindex $argv 1] w]
+
+    puts $fd "/* This file was generated by gen_compsize.tcl.  Do not edit. */"
+    puts $fd ""
+    puts $fd "#define COMPSIZE_COMPONENTS(bits) (((bits) >> $COMPONENTS_SHIFT) & 0x7)"
+    puts $fd "#define COMPSIZE_BYTES(bits) (((bits) >> $BYTES_SHIFT) & 0x7)"
+    puts $fd "#define COMPSIZE_PACKED [format 0x%02x $PACKED]"
+
+    foreach page [lsort -integer [dict keys $pages]] {
+	puts $fd ""
+	puts $fd "static const GLubyte compsize_page_[format %02x $page]\[256\] = \{"
+
+	set entries [dict get $pages $page]
+
+	foreach index [lsort -integer [dict keys $entries]] {
+	    lassign [dict get $entries $index] bits name
+	    puts $fd [format "   \[0x%02x\] = 0x%02x, /* GL_%s */" \
+			  $index $bits $name]
+	}
+
+	puts $fd "\};"
+    }
+
+    #The other pages point at an empty page, so there's no NULL check.
+    puts $fd ""
+    puts $fd "static const GLubyte compsize_page_none\[256\];"
+    puts $fd ""
+    puts $fd "static const GLubyte *const compsize_pages\[256\] = \{"
+
+    for {set page 0} {$page < 256} {incr page} {
+	if {[dict exists $pages $page]} {
+	    puts $fd [format "   compsize_page_%02x," $page]
+	} else {
+	    puts $fd "   compsize_page_none,"
+	}
+    }
+
+    puts $fd "\};"
+
+    close $fd
+}
+main $::argc $::argv
@@ -70,7 +70,7 @@ proc main {argc argv} {
     lappend glxlist glXGetProcAddress
 
     #Extensions
-    lappend glxlist glXGetProcAddressARB
+    lappend glxlist glXGetProcAddressARB glXQueryPixmapBufferAPPLE
 
     #Old extensions we don't support and never really have, but need for
     #symbol compatibility.  See also: glx_empty.c
@@ -420,7 +420,10 @@ proc translate-parameters {func parameters} {
 	} elseif {("MultiDrawArrays" eq $func) && ("count" eq $var)} {
 	    set final_type "const $type *"
 	} elseif {"array" eq [lindex $p 3]} {
-	    if {"in" eq [lindex $p 2]} {
+	    #Types such as ConstUInt32 are already const.
+	    if {[string match "const *" $type]} {
+		set final_type "$type *"
+	    } elseif {"in" eq [lindex $p 2]} {
 		set final_type "const $type *"
 	    } else {
 		set final_type "$type *"
@@ -553,14 +556,25 @@ proc main {argc argv} {
     #Iterate the nm output and set each symbol in an associative array.
     array set validapi {}
 
-    foreach line [split [exec nm -j -g /System/Library/Frameworks/OpenGL.framework/Libraries/libGL.dylib] \n] {
+    #OPENGL_LIBGL_PATH selects another library, such as the mock backend.
+    set libgl /System/Library/Frameworks/OpenGL.framework/Libraries/libGL.dylib
+
+    if {[info exists ::env(OPENGL_LIBGL_PATH)]} {
+	set libgl $::env(OPENGL_LIBGL_PATH)
+    }
+
+    foreach line [split [exec nm -j -g $libgl] \n] {
 	set fn [string trim $line]
 
-	#Only match the _gl functions.
+	#Only match the _gl functions.  ELF symbols lack the underscore.
 	if {[string match _gl* $fn]} {
 	    set finalfn [string range $fn 3 end]
 	    puts FINALFN:$finalfn
 	    set validapi($finalfn) $finalfn
+	} elseif {[string match gl* $fn]} {
+	    set finalfn [string range $fn 2 end]
+	    puts FINALFN:$finalfn
+	    set validapi($finalfn) $finalfn
 	}
     }
 
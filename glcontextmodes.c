@@ -64,6 +64,8 @@
 # endif /* XFree86Server */
 #endif /* !defined(IN_MINI_GLX) */
 
+#include <stdlib.h>
+#include <stdint.h>
 #include "glcontextmodes.h"
 
 #if !defined(IN_MINI_GLX)
@@ -362,6 +364,42 @@ _gl_get_context_mode_data(const __GLcontextModes * mode, int attribute,
 #endif /* !defined(IN_MINI_GLX) */
 
 
+/*
+ * The modes of a list are one array that follows this header, in a single
+ * allocation.  The next links are kept for the code that walks the list,
+ * and a mode's position is its offset in the array.
+ *
+ * The ID tables are built by _gl_context_modes_index, and never change
+ * after that, so they can be searched without a lock.
+ */
+struct modes_id
+{
+   GLint id;
+   unsigned index;
+};
+
+struct modes_arena
+{
+   unsigned count;
+   size_t size;
+   struct modes_id *visual_ids;
+   unsigned num_visual_ids;
+   struct modes_id *fbconfig_ids;
+   unsigned num_fbconfig_ids;
+   __GLcontextModes **fbconfigs;
+   unsigned num_fbconfigs;
+};
+
+/* This keeps the modes aligned like the result of a malloc. */
+#define MODES_ARENA_SIZE ((sizeof(struct modes_arena) + 15) & ~(size_t) 15)
+
+#define MODES_ARENA(modes) \
+   ((struct modes_arena *) ((char *) (modes) - MODES_ARENA_SIZE))
+
+#define MODES_AT(arena, i) \
+   ((__GLcontextModes *) ((char *) (arena) + MODES_ARENA_SIZE + \
+                          (size_t) (i) * (arena)->size))
+
 /**
  * Allocate a linked list of \c __GLcontextModes structures.  The fields of
  * each structure will be initialized to "reasonable" default values.  In
@@ -378,6 +416,8 @@ _gl_get_context_mode_data(const __GLcontextModes * mode, int attribute,
  *                      DRI-based driver.
  * \returns A pointer to the first element in a linked list of \c count
  *          stuctures on success, or \c NULL on failure.
+ *
+ * The structures are one array in a single allocation, linked in order.
  * 
  * \warning Use of \c minimum_size does \b not guarantee binary compatibility.
  *          The fundamental assumption is that if the \c minimum_size
@@ -393,42 +433,65 @@ _gl_context_modes_create(unsigned count, size_t minimum_size)
 {
    const size_t size = (minimum_size > sizeof(__GLcontextModes))
       ? minimum_size : sizeof(__GLcontextModes);
-   __GLcontextModes *base = NULL;
-   __GLcontextModes **next;
+   struct modes_arena *arena;
+   __GLcontextModes *m;
    unsigned i;
 
-   next = &base;
-   for (i = 0; i < count; i++) {
-      *next = (__GLcontextModes *) _mesa_malloc(size);
-      if (*next == NULL) {
-         _gl_context_modes_destroy(base);
-         base = NULL;
-         break;
-      }
+   if (count == 0 || count > (~(size_t) 0 - MODES_ARENA_SIZE) / size)
+      return NULL;
 
-      (void) _mesa_memset(*next, 0, size);
-      (*next)->visualID = GLX_DONT_CARE;
-      (*next)->visualType = GLX_DONT_CARE;
-      (*next)->visualRating = GLX_NONE;
-      (*next)->transparentPixel = GLX_NONE;
-      (*next)->transparentRed = GLX_DONT_CARE;
-      (*next)->transparentGreen = GLX_DONT_CARE;
-      (*next)->transparentBlue = GLX_DONT_CARE;
-      (*next)->transparentAlpha = GLX_DONT_CARE;
-      (*next)->transparentIndex = GLX_DONT_CARE;
-      (*next)->xRenderable = GLX_DONT_CARE;
-      (*next)->fbconfigID = GLX_DONT_CARE;
-      (*next)->swapMethod = GLX_SWAP_UNDEFINED_OML;
-      (*next)->bindToTextureRgb = GLX_DONT_CARE;
-      (*next)->bindToTextureRgba = GLX_DONT_CARE;
-      (*next)->bindToMipmapTexture = GLX_DONT_CARE;
-      (*next)->bindToTextureTargets = GLX_DONT_CARE;
-      (*next)->yInverted = GLX_DONT_CARE;
-
-      next = &((*next)->next);
+   arena = (struct modes_arena *) _mesa_malloc(MODES_ARENA_SIZE +
+                                                count * size);
+   if (arena == NULL)
+      return NULL;
+
+   (void) _mesa_memset(arena, 0, MODES_ARENA_SIZE + count * size);
+   arena->count = count;
+   arena->size = size;
+
+   for (i = 0; i < count; i++) {
+      m = MODES_AT(arena, i);
+
+      m->next = (i + 1 < count) ? MODES_AT(arena, i + 1) : NULL;
+      m->visualID = GLX_DONT_CARE;
+      m->visualType = GLX_DONT_CARE;
+      m->visualRating = GLX_NONE;
+      m->transparentPixel = GLX_NONE;
+      m->transparentRed = GLX_DONT_CARE;
+      m->transparentGreen = GLX_DONT_CARE;
+      m->transparentBlue = GLX_DONT_CARE;
+      m->transparentAlpha = GLX_DONT_CARE;
+      m->transparentIndex = GLX_DONT_CARE;
+      m->xRenderable = GLX_DONT_CARE;
+      m->fbconfigID = GLX_DONT_CARE;
+      m->swapMethod = GLX_SWAP_UNDEFINED_OML;
+      m->bindToTextureRgb = GLX_DONT_CARE;
+      m->bindToTextureRgba = GLX_DONT_CARE;
+      m->bindToMipmapTexture = GLX_DONT_CARE;
+      m->bindToTextureTargets = GLX_DONT_CARE;
+      m->yInverted = GLX_DONT_CARE;
    }
 
-   return base;
+   return MODES_AT(arena, 0);
+}
+
+
+static void
+free_index(struct modes_arena *arena)
+{
+   if (arena->visual_ids)
+      _mesa_free(arena->visual_ids);
+   if (arena->fbconfig_ids)
+      _mesa_free(arena->fbconfig_ids);
+   if (arena->fbconfigs)
+      _mesa_free(arena->fbconfigs);
+
+   arena->visual_ids = NULL;
+   arena->fbconfig_ids = NULL;
+   arena->fbconfigs = NULL;
+   arena->num_visual_ids = 0;
+   arena->num_fbconfig_ids = 0;
+   arena->num_fbconfigs = 0;
 }
 
 
@@ -442,12 +505,125 @@ _gl_context_modes_create(unsigned count, size_t minimum_size)
 void
 _gl_context_modes_destroy(__GLcontextModes * modes)
 {
-   while (modes != NULL) {
-      __GLcontextModes *const next = modes->next;
+   struct modes_arena *arena;
+
+   if (modes == NULL)
+      return;
+
+   arena = MODES_ARENA(modes);
+   free_index(arena);
+   _mesa_free(arena);
+}
+
+
+/* This orders equal IDs by position, so the first match comes first. */
+static int
+compare_modes_id(const void *a, const void *b)
+{
+   const struct modes_id *ia = a;
+   const struct modes_id *ib = b;
+
+   if (ia->id != ib->id)
+      return (ia->id < ib->id) ? -1 : 1;
+
+   return (ia->index < ib->index) ? -1 : (ia->index > ib->index);
+}
+
 
-      _mesa_free(modes);
-      modes = next;
+static struct modes_id *
+build_id_table(struct modes_arena *arena, GLboolean fbconfig,
+               unsigned *count)
+{
+   struct modes_id *table;
+   const __GLcontextModes *m;
+   unsigned i, n;
+   GLint id;
+
+   table = _mesa_malloc(sizeof(*table) * arena->count);
+   if (table == NULL)
+      return NULL;
+
+   for (i = 0, n = 0; i < arena->count; i++) {
+      m = MODES_AT(arena, i);
+      id = fbconfig ? m->fbconfigID : m->visualID;
+
+      if (id != GLX_DONT_CARE) {
+         table[n].id = id;
+         table[n].index = i;
+         n++;
+      }
    }
+
+   qsort(table, n, sizeof(*table), compare_modes_id);
+   *count = n;
+
+   return table;
+}
+
+
+/**
+ * Build the lookup tables of a list created by \c _gl_context_modes_create,
+ * after its modes are filled in.  The list must not change after this.
+ *
+ * \param modes  List of context-mode structures to be indexed.
+ * \returns \c GL_TRUE on success, or \c GL_FALSE if the tables couldn't be
+ *          allocated.  The lookups still work then, by walking the list.
+ */
+GLboolean
+_gl_context_modes_index(__GLcontextModes * modes)
+{
+   struct modes_arena *arena;
+   unsigned i, n;
+
+   if (modes == NULL)
+      return GL_TRUE;
+
+   arena = MODES_ARENA(modes);
+   free_index(arena);
+
+   arena->visual_ids = build_id_table(arena, GL_FALSE,
+                                      &arena->num_visual_ids);
+   arena->fbconfig_ids = build_id_table(arena, GL_TRUE,
+                                        &arena->num_fbconfig_ids);
+   arena->fbconfigs = _mesa_malloc(sizeof(*arena->fbconfigs) * arena->count);
+
+   if (arena->visual_ids == NULL || arena->fbconfig_ids == NULL
+       || arena->fbconfigs == NULL) {
+      free_index(arena);
+      return GL_FALSE;
+   }
+
+   for (i = 0, n = 0; i < arena->count; i++) {
+      if (MODES_AT(arena, i)->fbconfigID != GLX_DONT_CARE)
+         arena->fbconfigs[n++] = MODES_AT(arena, i);
+   }
+
+   arena->num_fbconfigs = n;
+
+   return GL_TRUE;
+}
+
+
+static __GLcontextModes *
+find_id(struct modes_arena *arena, const struct modes_id *table,
+        unsigned count, GLint id)
+{
+   unsigned low = 0, high = count, middle;
+
+   /* Find the first entry that isn't less than id. */
+   while (low < high) {
+      middle = low + (high - low) / 2;
+
+      if (table[middle].id < id)
+         low = middle + 1;
+      else
+         high = middle;
+   }
+
+   if (low < count && table[low].id == id)
+      return MODES_AT(arena, table[low].index);
+
+   return NULL;
 }
 
 
@@ -463,8 +639,17 @@ _gl_context_modes_destroy(__GLcontextModes * modes)
 __GLcontextModes *
 _gl_context_modes_find_visual(__GLcontextModes * modes, int vid)
 {
+   struct modes_arena *arena;
    __GLcontextModes *m;
 
+   if (modes == NULL)
+      return NULL;
+
+   arena = MODES_ARENA(modes);
+
+   if (arena->visual_ids)
+      return find_id(arena, arena->visual_ids, arena->num_visual_ids, vid);
+
    for (m = modes; m != NULL; m = m->next)
       if (m->visualID == vid)
          return m;
@@ -475,8 +660,18 @@ _gl_context_modes_find_visual(__GLcontextModes * modes, int vid)
 __GLcontextModes *
 _gl_context_modes_find_fbconfig(__GLcontextModes * modes, int fbid)
 {
+   struct modes_arena *arena;
    __GLcontextModes *m;
 
+   if (modes == NULL)
+      return NULL;
+
+   arena = MODES_ARENA(modes);
+
+   if (arena->fbconfig_ids)
+      return find_id(arena, arena->fbconfig_ids, arena->num_fbconfig_ids,
+                     fbid);
+
    for (m = modes; m != NULL; m = m->next)
       if (m->fbconfigID == fbid)
          return m;
@@ -484,6 +679,57 @@ _gl_context_modes_find_fbconfig(__GLcontextModes * modes, int fbid)
    return NULL;
 }
 
+
+/**
+ * Get the modes of a list that have an fbconfig ID, in list order.  The
+ * array belongs to the list, and is only available once it's indexed.
+ *
+ * \param modes  List of context-mode structures.
+ * \param count  Receives the number of modes in the array.
+ * \returns The array, or \c NULL if the list isn't indexed.
+ */
+__GLcontextModes *const *
+_gl_context_modes_get_fbconfigs(const __GLcontextModes * modes,
+                                unsigned *count)
+{
+   struct modes_arena *arena;
+
+   *count = 0;
+
+   if (modes == NULL)
+      return NULL;
+
+   arena = MODES_ARENA(modes);
+   *count = arena->num_fbconfigs;
+
+   return arena->fbconfigs;
+}
+
+
+/**
+ * Determine if a pointer is one of the modes of a list, without walking it.
+ *
+ * \param modes  List created by \c _gl_context_modes_create.
+ * \param m      Pointer to be checked.  It doesn't need to be valid.
+ * \returns \c GL_TRUE if \c m is a mode in the list.
+ */
+GLboolean
+_gl_context_modes_contains(const __GLcontextModes * modes,
+                           const void *m)
+{
+   const struct modes_arena *arena;
+   uintptr_t offset;
+
+   if (modes == NULL)
+      return GL_FALSE;
+
+   arena = MODES_ARENA(modes);
+   offset = (uintptr_t) m - (uintptr_t) modes;
+
+   return (uintptr_t) m >= (uintptr_t) modes
+      && offset / arena->size < arena->count && offset % arena->size == 0;
+}
+
 /**
  * Determine if two context-modes are the same.  This is intended to be used
  * by libGL implementations to compare to sets of driver generated FBconfigs.
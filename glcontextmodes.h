@@ -48,6 +48,14 @@ extern __GLcontextModes *_gl_context_modes_find_visual(__GLcontextModes *
                                                        modes, int vid);
 extern __GLcontextModes *_gl_context_modes_find_fbconfig(__GLcontextModes *
                                                          modes, int fbid);
+extern GLboolean _gl_context_modes_index(__GLcontextModes * modes);
+extern __GLcontextModes *const *_gl_context_modes_get_fbconfigs(const
+                                                                __GLcontextModes
+                                                                * modes,
+                                                                unsigned
+                                                                *count);
+extern GLboolean _gl_context_modes_contains(const __GLcontextModes * modes,
+                                            const void *m);
 extern GLboolean _gl_context_modes_are_same(const __GLcontextModes * a,
                                             const __GLcontextModes * b);
 
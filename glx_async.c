@@ -0,0 +1,98 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <X11/Xlibint.h>
+#include "glx_async.h"
+
+/* 
+ * An async handler sees the 16-bit sequence number from the wire, so the
+ * index is computed modulo 2^16 from the first request of the batch,
+ * which is exact while fewer than 65536 requests are outstanding.
+ */
+static Bool
+batch_handler(Display * dpy, xReply * rep, char *buf, int len,
+              XPointer data)
+{
+   struct __GLXrequestBatch *batch = (struct __GLXrequestBatch *) data;
+   unsigned int index;
+
+   index = (rep->generic.sequenceNumber - batch->first) & 0xffff;
+
+   if (index >= (unsigned int) batch->count)
+      return False;
+
+   /* The server answers requests in order. */
+   if (index == (unsigned int) batch->count - 1)
+      batch->done = True;
+
+   return batch->reply(dpy, rep, buf, len, (int) index, batch->data);
+}
+
+void
+__glXBeginRequestBatch(Display * dpy, struct __GLXrequestBatch *batch,
+                       __GLXbatchReplyProc reply, XPointer data)
+{
+   batch->first = NextRequest(dpy);
+   batch->count = 0;
+   batch->done = False;
+   batch->reply = reply;
+   batch->data = data;
+}
+
+void
+__glXEndRequestBatch(Display * dpy, struct __GLXrequestBatch *batch)
+{
+   batch->count = (int) (NextRequest(dpy) - batch->first);
+
+   batch->async.next = dpy->async_handlers;
+   batch->async.handler = batch_handler;
+   batch->async.data = (XPointer) batch;
+   dpy->async_handlers = &batch->async;
+}
+
+void
+__glXFinishRequestBatch(Display * dpy, struct __GLXrequestBatch *batch)
+{
+   xGetInputFocusReply rep;
+   xReq *req;
+
+   /* 
+    * _XReply hands every reply and error before the GetInputFocus reply
+    * to the async handlers, so when it returns the batch is answered.
+    * GetEmptyReq needs somewhere to put the request, which has no fields
+    * to fill in.
+    */
+   if (!batch->done && batch->count > 0) {
+      GetEmptyReq(GetInputFocus, req);
+      (void) req;
+      (void) _XReply(dpy, (xReply *) & rep, 0, xTrue);
+   }
+
+   DeqAsyncHandler(dpy, &batch->async);
+}
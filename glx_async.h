@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+#ifndef GLX_ASYNC_H
+#define GLX_ASYNC_H
+
+#include <X11/Xlibint.h>
+
+/*
+ * A batch is a range of requests whose replies and errors go to an async
+ * handler, instead of being read with an _XReply for each request.  The
+ * requests are sent between __glXBeginRequestBatch and
+ * __glXEndRequestBatch, and __glXFinishRequestBatch waits for whatever
+ * is still outstanding with one round trip.  The display must be locked
+ * for each of the three calls.
+ *
+ * The reply callback gets the index of the request in the batch.  It
+ * returns True if it consumed the reply or error, as an _XAsyncHandler
+ * does, and False to let Xlib report an error.
+ */
+typedef Bool(*__GLXbatchReplyProc) (Display * dpy, xReply * rep, char *buf,
+                                     int len, int index, XPointer data);
+
+struct __GLXrequestBatch
+{
+   _XAsyncHandler async;
+   unsigned long first;
+   int count;
+   Bool done;                   /* The last request has been answered. */
+   __GLXbatchReplyProc reply;
+   XPointer data;
+};
+
+void __glXBeginRequestBatch(Display * dpy, struct __GLXrequestBatch *batch,
+                            __GLXbatchReplyProc reply, XPointer data);
+
+void __glXEndRequestBatch(Display * dpy, struct __GLXrequestBatch *batch);
+
+void __glXFinishRequestBatch(Display * dpy, struct __GLXrequestBatch *batch);
+
+#endif
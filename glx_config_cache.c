@@ -0,0 +1,352 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "glx_config_cache.h"
+
+/*
+ * An entry is a file with a header, count __GLcontextModes records in the
+ * layout of this build, and the count * nprops properties they were
+ * decoded from.  The pointers in the records are meaningless.  A new entry
+ * is written to a temporary file and renamed over the old one, so a reader
+ * never reads a partial entry.
+ *
+ * The properties are compared with memcmp rather than hashed, since a hash
+ * of a large fbconfig table costs about as much as decoding it.
+ */
+#define CONFIG_CACHE_MAGIC "GLXCFGC"
+#define CONFIG_CACHE_VERSION 2
+
+/*
+ * A hit costs an open and a read, which is more than decoding a small
+ * table.  With 40 attribute pairs for each fbconfig, a hit took 3 us and
+ * a decode 2.3 us for 20 configs, and 4.6 us against 6.1 us for 50.
+ */
+#define CONFIG_CACHE_MIN_PROPS 2048
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+struct cache_header
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t record_size;
+   uint64_t layout;
+   int32_t screen;
+   int32_t tagged_only;
+   int32_t count;
+   int32_t nprops;
+};
+
+/*
+ * Every member of __GLcontextModes, in order.  The build fails if a type
+ * here doesn't match the struct, and a new member must be added here, so
+ * that the layout fingerprint of an entry covers it.
+ */
+#ifdef __APPLE__
+#define CONFIG_CACHE_APPLE_FIELDS(VALUE, POINTER) POINTER(void *, apple)
+#else
+#define CONFIG_CACHE_APPLE_FIELDS(VALUE, POINTER)
+#endif
+
+#define CONFIG_CACHE_FIELDS(VALUE, POINTER) \
+   POINTER(struct __GLcontextModesRec *, next) \
+   VALUE(GLboolean, rgbMode) VALUE(GLboolean, floatMode) \
+   VALUE(GLboolean, colorIndexMode) \
+   VALUE(GLuint, doubleBufferMode) VALUE(GLuint, stereoMode) \
+   VALUE(GLboolean, haveAccumBuffer) VALUE(GLboolean, haveDepthBuffer) \
+   VALUE(GLboolean, haveStencilBuffer) \
+   VALUE(GLint, redBits) VALUE(GLint, greenBits) VALUE(GLint, blueBits) \
+   VALUE(GLint, alphaBits) \
+   VALUE(GLuint, redMask) VALUE(GLuint, greenMask) VALUE(GLuint, blueMask) \
+   VALUE(GLuint, alphaMask) \
+   VALUE(GLint, rgbBits) VALUE(GLint, indexBits) \
+   VALUE(GLint, accumRedBits) VALUE(GLint, accumGreenBits) \
+   VALUE(GLint, accumBlueBits) VALUE(GLint, accumAlphaBits) \
+   VALUE(GLint, depthBits) VALUE(GLint, stencilBits) \
+   VALUE(GLint, numAuxBuffers) VALUE(GLint, level) VALUE(GLint, pixmapMode) \
+   VALUE(GLint, visualID) VALUE(GLint, visualType) \
+   VALUE(GLint, visualRating) \
+   VALUE(GLint, transparentPixel) VALUE(GLint, transparentRed) \
+   VALUE(GLint, transparentGreen) VALUE(GLint, transparentBlue) \
+   VALUE(GLint, transparentAlpha) VALUE(GLint, transparentIndex) \
+   VALUE(GLint, sampleBuffers) VALUE(GLint, samples) \
+   VALUE(GLint, drawableType) VALUE(GLint, renderType) \
+   VALUE(GLint, xRenderable) VALUE(GLint, fbconfigID) \
+   VALUE(GLint, maxPbufferWidth) VALUE(GLint, maxPbufferHeight) \
+   VALUE(GLint, maxPbufferPixels) VALUE(GLint, optimalPbufferWidth) \
+   VALUE(GLint, optimalPbufferHeight) \
+   VALUE(GLint, visualSelectGroup) VALUE(GLint, swapMethod) \
+   VALUE(GLint, screen) \
+   VALUE(GLint, bindToTextureRgb) VALUE(GLint, bindToTextureRgba) \
+   VALUE(GLint, bindToMipmapTexture) VALUE(GLint, bindToTextureTargets) \
+   VALUE(GLint, yInverted) \
+   CONFIG_CACHE_APPLE_FIELDS(VALUE, POINTER)
+
+#define CHECK_FIELD_TYPE(type, field) \
+   (void) sizeof(char[__builtin_types_compatible_p \
+                      (__typeof__(((__GLcontextModes *) 0)->field), type) \
+                      ? 1 : -1])
+
+/* A value member is described by its offset, size, signedness and kind. */
+#define VALUE_FIELD(type, field) \
+   CHECK_FIELD_TYPE(type, field); \
+   words[0] = offsetof(__GLcontextModes, field); \
+   words[1] = sizeof(type); \
+   words[2] = (type) -1 < (type) 0; \
+   words[3] = (type) 0.5 != (type) 0; \
+   h = digest_words(h, words, 4);
+
+#define POINTER_FIELD(type, field) \
+   CHECK_FIELD_TYPE(type, field); \
+   words[0] = offsetof(__GLcontextModes, field); \
+   words[1] = sizeof(type); \
+   h = digest_words(h, words, 2);
+
+static uint64_t
+digest_string(uint64_t h, const char *s)
+{
+   /* The terminator is included, so that "ab" "c" differs from "a" "bc". */
+   do {
+      h ^= (unsigned char) *s;
+      h *= FNV_PRIME;
+   } while (*s++);
+
+   return h;
+}
+
+static uint64_t
+digest_words(uint64_t h, const INT32 * words, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i < count; i++) {
+      h ^= (uint32_t) words[i];
+      h *= FNV_PRIME;
+   }
+
+   return h;
+}
+
+/* 
+ * This changes whenever a member of __GLcontextModes moves or changes its
+ * size or type, even if the size of the whole struct doesn't change.
+ */
+static uint64_t
+layout_fingerprint(void)
+{
+   uint64_t h = FNV_OFFSET_BASIS;
+   INT32 words[4];
+
+   CONFIG_CACHE_FIELDS(VALUE_FIELD, POINTER_FIELD);
+
+   words[0] = sizeof(__GLcontextModes);
+
+   return digest_words(h, words, 1);
+}
+
+GLboolean
+__glXConfigCacheKey(struct __GLXconfigCacheKey *key,
+                    const char *vendor, int release,
+                    const char *glx_version, int screen,
+                    GLboolean tagged_only, const INT32 * props,
+                    int count, int nprops)
+{
+   const char *dir = getenv("LIBGL_CONFIG_CACHE_DIR");
+   uint64_t server;
+   INT32 words[1];
+   int length;
+
+   if (NULL == dir || '\0' == *dir
+       || (size_t) count * nprops < CONFIG_CACHE_MIN_PROPS)
+      return GL_FALSE;
+
+   server = digest_string(FNV_OFFSET_BASIS, vendor ? vendor : "");
+   words[0] = release;
+   server = digest_words(server, words, 1);
+   server = digest_string(server, glx_version ? glx_version : "");
+
+   length = snprintf(key->path, sizeof(key->path),
+                     "%s/glx-configs-%016llx-%d-%s", dir,
+                     (unsigned long long) server, screen,
+                     tagged_only ? "fbconfigs" : "visuals");
+
+   if (length < 0 || length >= (int) sizeof(key->path))
+      return GL_FALSE;
+
+   key->props = props;
+   key->screen = screen;
+   key->tagged_only = tagged_only ? 1 : 0;
+   key->count = count;
+   key->nprops = nprops;
+
+   return GL_TRUE;
+}
+
+static GLboolean
+valid_header(const struct cache_header *header,
+             const struct __GLXconfigCacheKey *key)
+{
+   return 0 == memcmp(header->magic, CONFIG_CACHE_MAGIC,
+                      sizeof(header->magic))
+      && CONFIG_CACHE_VERSION == header->version
+      && sizeof(__GLcontextModes) == header->record_size
+      && layout_fingerprint() == header->layout
+      && key->screen == header->screen
+      && key->tagged_only == header->tagged_only
+      && key->count == header->count && key->nprops == header->nprops;
+}
+
+static void
+clear_pointers(__GLcontextModes * record)
+{
+   record->next = NULL;
+#ifdef __APPLE__
+   record->apple = NULL;
+#endif
+}
+
+__GLcontextModes *
+__glXConfigCacheLoad(const struct __GLXconfigCacheKey *key)
+{
+   const struct cache_header *header;
+   const __GLcontextModes *record;
+   __GLcontextModes *modes = NULL, *m, *next;
+   size_t size, props_size;
+   struct stat st;
+   void *entry;
+   int fd;
+
+   props_size = (size_t) key->count * key->nprops * sizeof(INT32);
+   size = sizeof(*header) + (size_t) key->count * sizeof(*record)
+      + props_size;
+
+   fd = open(key->path, O_RDONLY);
+
+   if (fd < 0)
+      return NULL;
+
+   /* A read is cheaper than a mapping, which faults in each page. */
+   entry = NULL;
+
+   if (0 == fstat(fd, &st) && (size_t) st.st_size == size) {
+      entry = malloc(size);
+
+      if (entry && read(fd, entry, size) != (ssize_t) size) {
+         free(entry);
+         entry = NULL;
+      }
+   }
+
+   close(fd);
+
+   if (NULL == entry)
+      return NULL;
+
+   header = entry;
+   record = (const __GLcontextModes *) (header + 1);
+
+   if (valid_header(header, key)
+       && 0 == memcmp(record + key->count, key->props, props_size)) {
+      modes = _gl_context_modes_create(key->count, sizeof(*modes));
+
+      for (m = modes; m; m = next, ++record) {
+         next = m->next;
+         memcpy(m, record, sizeof(*m));
+         clear_pointers(m);
+         m->next = next;
+      }
+   }
+
+   free(entry);
+
+   return modes;
+}
+
+void
+__glXConfigCacheSave(const struct __GLXconfigCacheKey *key,
+                     const __GLcontextModes * modes)
+{
+   char path[PATH_MAX];
+   struct cache_header header;
+   __GLcontextModes record;
+   const __GLcontextModes *m;
+   FILE *fp;
+   int fd, count;
+
+   if (snprintf(path, sizeof(path), "%s.XXXXXX", key->path) >=
+       (int) sizeof(path))
+      return;
+
+   fd = mkstemp(path);
+
+   if (fd < 0)
+      return;
+
+   fp = fdopen(fd, "wb");
+
+   if (NULL == fp) {
+      close(fd);
+      unlink(path);
+      return;
+   }
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, CONFIG_CACHE_MAGIC, sizeof(header.magic));
+   header.version = CONFIG_CACHE_VERSION;
+   header.record_size = sizeof(record);
+   header.layout = layout_fingerprint();
+   header.screen = key->screen;
+   header.tagged_only = key->tagged_only;
+   header.count = key->count;
+   header.nprops = key->nprops;
+
+   fwrite(&header, sizeof(header), 1, fp);
+
+   for (m = modes, count = 0; m; m = m->next, ++count) {
+      record = *m;
+      clear_pointers(&record);
+      fwrite(&record, sizeof(record), 1, fp);
+   }
+
+   if (count == key->count)
+      fwrite(key->props, sizeof(INT32), (size_t) key->count * key->nprops,
+             fp);
+
+   if (fclose(fp) || count != key->count || rename(path, key->path))
+      unlink(path);
+}
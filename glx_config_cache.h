@@ -0,0 +1,80 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+#ifndef GLX_CONFIG_CACHE_H
+#define GLX_CONFIG_CACHE_H
+
+#include <limits.h>
+#include <stdint.h>
+#include <X11/X.h>
+#include <X11/Xmd.h>
+#include <GL/glx.h>
+#include "GL/glxint.h"
+#include "glcontextmodes.h"
+
+/*
+ * This keeps the decoded visual and fbconfig tables of a screen in a file,
+ * so that a later process can read them instead of decoding the properties
+ * from the server again.
+ *
+ * The cache is disabled unless LIBGL_CONFIG_CACHE_DIR names a directory.
+ * An entry is keyed by the X server vendor and release, the GLX version,
+ * the screen and the kind of table, and it is only used when the
+ * properties in the reply match the ones that were stored with it, and
+ * the layout of __GLcontextModes matches the one it was written with.
+ */
+
+struct __GLXconfigCacheKey
+{
+   char path[PATH_MAX];
+   const INT32 *props;          /* The reply's, which must outlive the key. */
+   int screen;
+   int tagged_only;
+   int count;
+   int nprops;
+};
+
+/* 
+ * Return true if the cache is enabled and the table is large enough to be
+ * worth caching, and then fill in the key.
+ */
+GLboolean __glXConfigCacheKey(struct __GLXconfigCacheKey *key,
+                              const char *vendor, int release,
+                              const char *glx_version, int screen,
+                              GLboolean tagged_only, const INT32 * props,
+                              int count, int nprops);
+
+/* Return a new list of count configs, or NULL if there's no valid entry. */
+__GLcontextModes *__glXConfigCacheLoad(const struct __GLXconfigCacheKey
+                                       *key);
+
+/* Replace the entry for the key with the list. */
+void __glXConfigCacheSave(const struct __GLXconfigCacheKey *key,
+                          const __GLcontextModes * modes);
+
+#endif
@@ -0,0 +1,277 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "glxclient.h"
+#include "glcontextmodes.h"
+
+/* 
+ * We don't want to enable this GLX_OML_swap_method in glxext.h, 
+ * because we can't support it.  The X server writes it out though,
+ * so we should handle it somehow, to avoid false warnings.
+ */
+enum {
+    IGNORE_GLX_SWAP_METHOD_OML = 0x8060
+};
+
+/*
+ * The tags are decoded through a table indexed by a hash of the tag.  The
+ * hash has no collisions among the tags below, and each entry holds its
+ * tag, so that any other tag is unknown.  A collision fails to compile,
+ * in check_prop_slots.
+ */
+#define PROP_SLOTS 128
+
+/* This is a constant expression, so it can index the initializers. */
+#define PROP_SLOT(tag) \
+   (((unsigned long) (tag) ^ ((unsigned long) (tag) >> 6) ^ \
+     ((unsigned long) (tag) >> 9)) & (PROP_SLOTS - 1))
+
+enum prop_kind
+{
+   PROP_UNKNOWN = 0,
+   /* Store the value in a GLint or GLuint field. */
+   PROP_INT,
+   /* Store the value, or 1 if the tags aren't fbconfig style. */
+   PROP_FETCH_OR_SET_UINT,
+   PROP_FETCH_OR_SET_BOOLEAN,
+   PROP_DRAWABLE_TYPE,
+   PROP_IGNORE,
+   PROP_END
+};
+
+struct prop
+{
+   INT32 tag;
+   unsigned char kind;
+   unsigned short offset;
+};
+
+#define FIELD(field) offsetof(__GLcontextModes, field)
+
+#ifdef GLX_USE_APPLEGL
+/* We ignore this tag.  See the comment above the enum. */
+#define PROPS_PLATFORM(X) \
+   X(IGNORE_GLX_SWAP_METHOD_OML, PROP_IGNORE, 0)
+#else
+#define PROPS_PLATFORM(X) \
+   X(GLX_OPTIMAL_PBUFFER_WIDTH_SGIX, PROP_INT, FIELD(optimalPbufferWidth)) \
+   X(GLX_OPTIMAL_PBUFFER_HEIGHT_SGIX, PROP_INT, FIELD(optimalPbufferHeight)) \
+   X(GLX_VISUAL_SELECT_GROUP_SGIX, PROP_INT, FIELD(visualSelectGroup)) \
+   X(GLX_SWAP_METHOD_OML, PROP_INT, FIELD(swapMethod)) \
+   X(GLX_BIND_TO_TEXTURE_RGB_EXT, PROP_INT, FIELD(bindToTextureRgb)) \
+   X(GLX_BIND_TO_TEXTURE_RGBA_EXT, PROP_INT, FIELD(bindToTextureRgba)) \
+   X(GLX_BIND_TO_MIPMAP_TEXTURE_EXT, PROP_INT, FIELD(bindToMipmapTexture)) \
+   X(GLX_BIND_TO_TEXTURE_TARGETS_EXT, PROP_INT, \
+     FIELD(bindToTextureTargets)) \
+   X(GLX_Y_INVERTED_EXT, PROP_INT, FIELD(yInverted))
+#endif
+
+/* 
+ * These are the cases of the switch in the original decoder, as
+ * X(tag, kind, offset).
+ */
+#define PROPS(X) \
+   X(GLX_RGBA, PROP_FETCH_OR_SET_BOOLEAN, FIELD(rgbMode)) \
+   X(GLX_BUFFER_SIZE, PROP_INT, FIELD(rgbBits)) \
+   X(GLX_LEVEL, PROP_INT, FIELD(level)) \
+   X(GLX_DOUBLEBUFFER, PROP_FETCH_OR_SET_UINT, FIELD(doubleBufferMode)) \
+   X(GLX_STEREO, PROP_FETCH_OR_SET_UINT, FIELD(stereoMode)) \
+   X(GLX_AUX_BUFFERS, PROP_INT, FIELD(numAuxBuffers)) \
+   X(GLX_RED_SIZE, PROP_INT, FIELD(redBits)) \
+   X(GLX_GREEN_SIZE, PROP_INT, FIELD(greenBits)) \
+   X(GLX_BLUE_SIZE, PROP_INT, FIELD(blueBits)) \
+   X(GLX_ALPHA_SIZE, PROP_INT, FIELD(alphaBits)) \
+   X(GLX_DEPTH_SIZE, PROP_INT, FIELD(depthBits)) \
+   X(GLX_STENCIL_SIZE, PROP_INT, FIELD(stencilBits)) \
+   X(GLX_ACCUM_RED_SIZE, PROP_INT, FIELD(accumRedBits)) \
+   X(GLX_ACCUM_GREEN_SIZE, PROP_INT, FIELD(accumGreenBits)) \
+   X(GLX_ACCUM_BLUE_SIZE, PROP_INT, FIELD(accumBlueBits)) \
+   X(GLX_ACCUM_ALPHA_SIZE, PROP_INT, FIELD(accumAlphaBits)) \
+   X(GLX_VISUAL_CAVEAT_EXT, PROP_INT, FIELD(visualRating)) \
+   X(GLX_X_VISUAL_TYPE, PROP_INT, FIELD(visualType)) \
+   X(GLX_TRANSPARENT_TYPE, PROP_INT, FIELD(transparentPixel)) \
+   X(GLX_TRANSPARENT_INDEX_VALUE, PROP_INT, FIELD(transparentIndex)) \
+   X(GLX_TRANSPARENT_RED_VALUE, PROP_INT, FIELD(transparentRed)) \
+   X(GLX_TRANSPARENT_GREEN_VALUE, PROP_INT, FIELD(transparentGreen)) \
+   X(GLX_TRANSPARENT_BLUE_VALUE, PROP_INT, FIELD(transparentBlue)) \
+   X(GLX_TRANSPARENT_ALPHA_VALUE, PROP_INT, FIELD(transparentAlpha)) \
+   X(GLX_VISUAL_ID, PROP_INT, FIELD(visualID)) \
+   X(GLX_DRAWABLE_TYPE, PROP_DRAWABLE_TYPE, FIELD(drawableType)) \
+   X(GLX_RENDER_TYPE, PROP_INT, FIELD(renderType)) \
+   X(GLX_X_RENDERABLE, PROP_INT, FIELD(xRenderable)) \
+   X(GLX_FBCONFIG_ID, PROP_INT, FIELD(fbconfigID)) \
+   X(GLX_MAX_PBUFFER_WIDTH, PROP_INT, FIELD(maxPbufferWidth)) \
+   X(GLX_MAX_PBUFFER_HEIGHT, PROP_INT, FIELD(maxPbufferHeight)) \
+   X(GLX_MAX_PBUFFER_PIXELS, PROP_INT, FIELD(maxPbufferPixels)) \
+   X(GLX_SAMPLE_BUFFERS_SGIS, PROP_INT, FIELD(sampleBuffers)) \
+   X(GLX_SAMPLES_SGIS, PROP_INT, FIELD(samples)) \
+   PROPS_PLATFORM(X) \
+   X(None, PROP_END, 0)
+
+#define PROP_ENTRY(tag, kind, offset) [PROP_SLOT(tag)] = { tag, kind, offset },
+
+static const struct prop props[PROP_SLOTS] = {
+   PROPS(PROP_ENTRY)
+};
+
+#define PROP_CASE(tag, kind, offset) case PROP_SLOT(tag):
+
+/* 
+ * This is never called.  Two tags in one slot are a duplicate case here,
+ * where the initializers of props would silently override one another.
+ */
+static inline void
+check_prop_slots(unsigned long slot)
+{
+   switch (slot) {
+      PROPS(PROP_CASE)
+      break;
+   }
+}
+
+#define PROP_FIELD(config, p) ((char *) (config) + (p)->offset)
+
+/*
+ * The visual configs use the !tagged_only path.
+ * The FBConfigs use the tagged_only path.
+ *
+ * An unknown tag is followed by a value only in fbconfig style lists, but
+ * the value is skipped only when LIBGL_DIAGNOSTIC is set, as it always
+ * was.  The results must match the original switch bit for bit, which
+ * tests/config_tags checks.
+ */
+_X_HIDDEN void
+__glXInitializeVisualConfigFromTags(__GLcontextModes * config, int count,
+                                    const INT32 * bp, Bool tagged_only,
+                                    Bool fbconfig_style_tags)
+{
+   const struct prop *p;
+   int diagnostic = -1;
+   long int tag;
+   int i, kind;
+
+   if (!tagged_only) {
+      /* Copy in the first set of properties */
+      config->visualID = *bp++;
+
+      config->visualType = _gl_convert_from_x_visual_type(*bp++);
+
+      config->rgbMode = *bp++;
+
+      config->redBits = *bp++;
+      config->greenBits = *bp++;
+      config->blueBits = *bp++;
+      config->alphaBits = *bp++;
+      config->accumRedBits = *bp++;
+      config->accumGreenBits = *bp++;
+      config->accumBlueBits = *bp++;
+      config->accumAlphaBits = *bp++;
+
+      config->doubleBufferMode = *bp++;
+      config->stereoMode = *bp++;
+
+      config->rgbBits = *bp++;
+      config->depthBits = *bp++;
+      config->stencilBits = *bp++;
+      config->numAuxBuffers = *bp++;
+      config->level = *bp++;
+
+#ifdef GLX_USE_APPLEGL
+       /* AppleSGLX supports pixmap and pbuffers with all config. */
+       config->drawableType = GLX_WINDOW_BIT | GLX_PIXMAP_BIT | GLX_PBUFFER_BIT;
+       /* Unfortunately this can create an ABI compatibility problem. */
+       count -= 18;
+#else
+      count -= __GLX_MIN_CONFIG_PROPS;
+#endif
+   }
+
+   /*
+    ** Additional properties may be in a list at the end
+    ** of the reply.  They are in pairs of property type
+    ** and property value.
+    */
+   for (i = 0; i < count; i += 2) {
+      tag = *bp++;
+      p = &props[PROP_SLOT(tag)];
+      kind = (p->tag == tag) ? p->kind : PROP_UNKNOWN;
+
+      if (kind == PROP_INT) {
+         *(GLint *) PROP_FIELD(config, p) = *bp++;
+         continue;
+      }
+
+      switch (kind) {
+      case PROP_FETCH_OR_SET_UINT:
+         *(GLuint *) PROP_FIELD(config, p) =
+            (fbconfig_style_tags) ? *bp++ : 1;
+         break;
+      case PROP_FETCH_OR_SET_BOOLEAN:
+         *(GLboolean *) PROP_FIELD(config, p) =
+            (fbconfig_style_tags) ? *bp++ : 1;
+         break;
+      case PROP_DRAWABLE_TYPE:
+         config->drawableType = *bp++;
+#ifdef GLX_USE_APPLEGL
+         /* AppleSGLX supports pixmap and pbuffers with all config. */
+         config->drawableType |= GLX_WINDOW_BIT | GLX_PIXMAP_BIT | GLX_PBUFFER_BIT;
+#endif
+         break;
+      case PROP_IGNORE:
+         ++bp;
+         break;
+      case PROP_END:
+         i = count;
+         break;
+      default:
+         if (diagnostic < 0)
+            diagnostic = (getenv("LIBGL_DIAGNOSTIC") != NULL);
+
+         if (diagnostic) {
+            long int tagvalue = *bp++;
+            fprintf(stderr, "WARNING: unknown GLX tag from server: "
+                    "tag 0x%lx value 0x%lx\n", tag, tagvalue);
+         }
+         break;
+      }
+   }
+
+   config->renderType =
+      (config->rgbMode) ? GLX_RGBA_BIT : GLX_COLOR_INDEX_BIT;
+
+   config->haveAccumBuffer = ((config->accumRedBits +
+                               config->accumGreenBits +
+                               config->accumBlueBits +
+                               config->accumAlphaBits) > 0);
+   config->haveDepthBuffer = (config->depthBits > 0);
+   config->haveStencilBuffer = (config->stencilBits > 0);
+}
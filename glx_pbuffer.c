@@ -833,16 +833,27 @@ glXCreateWindow(Display * dpy, GLXFBConfig config, Window win,
 
    (void) attrib_list;          /*unused according to GLX 1.4 */
 
+   /* 
+    * The surface request goes first, so that its reply arrives with the
+    * one for XGetWindowAttributes.
+    */
+   if (config)
+      apple_glx_surface_prefetch(dpy, ((__GLcontextModes *) config)->screen,
+                                 win);
+
    XGetWindowAttributes(dpy, win, &xwattr);
 
    visinfo = glXGetVisualFromFBConfig(dpy, config);
 
    if (NULL == visinfo) {
+      apple_glx_surface_cancel_prefetch(dpy, win);
       __glXSendError(dpy, GLXBadFBConfig, 0, X_GLXCreateWindow, false);
       return None;
    }
 
    if (visinfo->visualid != XVisualIDFromVisual(xwattr.visual)) {
+      XFree(visinfo);
+      apple_glx_surface_cancel_prefetch(dpy, win);
       __glXSendError(dpy, BadMatch, 0, X_GLXCreateWindow, true);
       return None;
    }
@@ -874,7 +885,9 @@ PUBLIC void
 glXDestroyWindow(Display * dpy, GLXWindow win)
 {
    WARN_ONCE_GLX_1_3(dpy, __func__);
-#ifndef GLX_USE_APPLEGL
+#ifdef GLX_USE_APPLEGL
+   apple_glx_surface_cancel_prefetch(dpy, win);
+#else
    DestroyDrawable(dpy, (GLXDrawable) win, X_GLXDestroyWindow);
 #endif
 }
@@ -63,6 +63,10 @@
 
 #include "glxextensions.h"
 
+#ifdef GLX_USE_APPLEGL
+#include "apple_glx_caps.h"
+#endif
+
 
 /* If we build the library with gcc's -fvisibility=hidden flag, we'll
  * use the PUBLIC macro to mark functions that are to be exported.
@@ -89,6 +93,7 @@ typedef struct __GLXscreenConfigsRec __GLXscreenConfigs;
 typedef struct __GLXcontextRec __GLXcontext;
 typedef struct __GLXdrawableRec __GLXdrawable;
 typedef struct __GLXdisplayPrivateRec __GLXdisplayPrivate;
+typedef struct __GLXchooserIndexRec __GLXchooserIndex;
 typedef struct _glapi_table __GLapi;
 
 /************************************************************************/
@@ -447,6 +452,8 @@ struct __GLXcontextRec
 #ifdef GLX_USE_APPLEGL
    void *apple;
    Bool do_destroy;
+   /* This caches apple_glx_context_uses_stereo for the GL wrappers. */
+   Bool uses_stereo;
 #endif
 };
 
@@ -555,6 +562,12 @@ struct __GLXscreenConfigsRec
      */
    __GLcontextModes *visuals, *configs;
 
+    /**
+     * Sorted and bucketed indexes of \c visuals and \c configs, used by
+     * glXChooseVisual and glXChooseFBConfig.
+     */
+   __GLXchooserIndex *visual_index, *config_index;
+
     /**
      * Per-screen dynamic GLX extension tracking.  The \c direct_support
      * field only contains enough bits for 64 extensions.  Should libGL
@@ -567,6 +580,12 @@ struct __GLXscreenConfigsRec
    GLboolean ext_list_first_time;
    /*@} */
 
+#ifdef GLX_USE_APPLEGL
+    /**
+     * The cached limits of the screen's renderer.
+     */
+   struct apple_glx_screen_caps renderer_caps;
+#endif
 };
 
 /**
@@ -775,6 +794,14 @@ extern void __glXInitializeVisualConfigFromTags(__GLcontextModes * config,
                                                 Bool tagged_only,
                                                 Bool fbconfig_style_tags);
 
+/*
+** Build or free the chooser index for a list of visuals or fbconfigs.
+** When fbconfigs_only is set, modes without an fbconfigID are left out.
+*/
+extern __GLXchooserIndex *__glXCreateChooserIndex(__GLcontextModes * modes,
+                                                  GLboolean fbconfigs_only);
+extern void __glXDestroyChooserIndex(__GLXchooserIndex * index);
+
 extern char *__glXQueryServerString(Display * dpy, int opcode,
                                     CARD32 screen, CARD32 name);
 extern char *__glXGetString(Display * dpy, int opcode,
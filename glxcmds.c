@@ -235,11 +235,9 @@ ValidateGLXFBConfig(Display * dpy, GLXFBConfig config)
 
    if (priv != NULL) {
       for (i = 0; i < num_screens; i++) {
-         for (modes = priv->screenConfigs[i].configs; modes != NULL;
-              modes = modes->next) {
-            if (modes == (__GLcontextModes *) config) {
-               return (__GLcontextModes *) config;
-            }
+         modes = priv->screenConfigs[i].configs;
+         if (_gl_context_modes_contains(modes, config)) {
+            return (__GLcontextModes *) config;
          }
       }
    }
@@ -538,6 +536,7 @@ CreateContext(Display * dpy, XVisualInfo * vis,
    gc->currentContextTag = -1;
    gc->mode = mode;
    gc->isDirect = allowDirect;
+   gc->uses_stereo = apple_glx_context_uses_stereo(gc->apple);
 #else
    gc->renderType = renderType;
 #endif
@@ -1094,6 +1093,49 @@ glXDestroyGLXPixmap(Display * dpy, GLXPixmap glxpixmap)
 #endif /* GLX_USE_APPLEGL */
 }
 
+#ifdef GLX_USE_APPLEGL
+/*
+** GLX_APPLE_pixmap_buffer
+**
+** Return a read-only view of the shared memory that a GLXPixmap is
+** rendered to, after a glFinish of its rendering.  The first row is the
+** top of the pixmap, which is the reverse of glReadPixels.  The view is
+** valid until the GLXPixmap is destroyed.
+*/
+PUBLIC Bool
+glXQueryPixmapBufferAPPLE(Display * dpy, GLXPixmap pixmap,
+                          const void **data, int *width, int *height,
+                          int *pitch, GLenum * format, GLenum * type)
+{
+   int bpp;
+
+   (void) dpy;
+
+   if (!apple_glx_pixmap_query_buffer(pixmap, data, width, height, pitch,
+                                      &bpp))
+      return False;
+
+   switch (bpp) {
+   case 32:
+      *format = GL_BGRA;
+      *type = GL_UNSIGNED_INT_8_8_8_8_REV;
+      break;
+
+   case 16:
+      *format = GL_BGRA;
+      *type = GL_UNSIGNED_SHORT_1_5_5_5_REV;
+      break;
+
+   default:
+      *format = GL_NONE;
+      *type = GL_NONE;
+      break;
+   }
+
+   return True;
+}
+#endif
+
 PUBLIC void
 glXSwapBuffers(Display * dpy, GLXDrawable drawable)
 {
@@ -1451,17 +1493,257 @@ fbconfig_compare(const __GLcontextModes * const *const a,
 }
 
 
+/*
+ * The chooser index of a screen's visuals or fbconfigs.  The modes are
+ * sorted once with fbconfig_compare, because the sort order doesn't depend
+ * on the attributes requested.  Each mode is also filed in a bucket by the
+ * properties that rule out the most modes, and a query only walks the
+ * buckets that can contain a match.
+ */
+#define CHOOSER_BUCKET_DOUBLE      0x01
+#define CHOOSER_BUCKET_DEPTH       0x02
+#define CHOOSER_BUCKET_MULTISAMPLE 0x04
+#define CHOOSER_BUCKET_RGBA        0x08
+#define CHOOSER_BUCKET_WINDOW      0x10
+#define CHOOSER_BUCKETS            0x20
+
+#define CHOOSER_MEMO_SIZE 8
+
+struct chooser_memo
+{
+   GLboolean valid;
+   __GLcontextModes test_config;
+   int count;
+   __GLcontextModes **result;
+};
+
+struct __GLXchooserIndexRec
+{
+   int count;
+   /* Every mode, best first, and each mode's position in that order. */
+   __GLcontextModes **sorted;
+   /* The positions in sorted of the modes in each bucket, ascending. */
+   int *bucket[CHOOSER_BUCKETS];
+   int bucket_size[CHOOSER_BUCKETS];
+
+   /* Recent queries, most recent first.  This is protected by __glXLock. */
+   struct chooser_memo memo[CHOOSER_MEMO_SIZE];
+};
+
+static unsigned
+chooser_bucket(const __GLcontextModes * mode)
+{
+   unsigned bucket = 0;
+
+   if (mode->doubleBufferMode)
+      bucket |= CHOOSER_BUCKET_DOUBLE;
+   if (mode->depthBits > 0)
+      bucket |= CHOOSER_BUCKET_DEPTH;
+   if (mode->samples > 0)
+      bucket |= CHOOSER_BUCKET_MULTISAMPLE;
+   if (mode->renderType & GLX_RGBA_BIT)
+      bucket |= CHOOSER_BUCKET_RGBA;
+   if (mode->drawableType & GLX_WINDOW_BIT)
+      bucket |= CHOOSER_BUCKET_WINDOW;
+
+   return bucket;
+}
+
+/* Return true if no mode in the bucket can satisfy the template. */
+static Bool
+chooser_bucket_excluded(const __GLcontextModes * a, unsigned bucket)
+{
+   if (a->doubleBufferMode != GLX_DONT_CARE
+       && !a->doubleBufferMode != !(bucket & CHOOSER_BUCKET_DOUBLE))
+      return True;
+
+   if (a->depthBits != GLX_DONT_CARE && a->depthBits > 0
+       && !(bucket & CHOOSER_BUCKET_DEPTH))
+      return True;
+
+   if (a->samples != GLX_DONT_CARE && a->samples > 0
+       && !(bucket & CHOOSER_BUCKET_MULTISAMPLE))
+      return True;
+
+   if ((a->renderType & ~GLX_RGBA_BIT) == 0
+       && !(bucket & CHOOSER_BUCKET_RGBA))
+      return True;
+
+   if ((a->drawableType & ~GLX_WINDOW_BIT) == 0
+       && !(bucket & CHOOSER_BUCKET_WINDOW))
+      return True;
+
+   return False;
+}
+
+static __GLcontextModes *const *chooser_sort_base;
+
+/* This orders equal modes by their position in the list, like a stable sort. */
+static int
+chooser_compare(const void *a, const void *b)
+{
+   const int ia = *(const int *) a;
+   const int ib = *(const int *) b;
+   int result;
+
+   result = fbconfig_compare((const __GLcontextModes * const *const)
+                             &chooser_sort_base[ia],
+                             (const __GLcontextModes * const *const)
+                             &chooser_sort_base[ib]);
+
+   return (result != 0) ? result : ia - ib;
+}
+
+_X_HIDDEN __GLXchooserIndex *
+__glXCreateChooserIndex(__GLcontextModes * modes, GLboolean fbconfigs_only)
+{
+   __GLXchooserIndex *index;
+   __GLcontextModes *m, **list;
+   int *order;
+   int count, i, b;
+
+   count = 0;
+   for (m = modes; m != NULL; m = m->next) {
+      if (!fbconfigs_only || m->fbconfigID != GLX_DONT_CARE)
+         count++;
+   }
+
+   index = Xcalloc(1, sizeof(*index));
+   list = Xmalloc(sizeof(*list) * (count + 1));
+   order = Xmalloc(sizeof(*order) * (count + 1));
+   if (index == NULL || list == NULL || order == NULL)
+      goto error;
+
+   i = 0;
+   for (m = modes; m != NULL; m = m->next) {
+      if (!fbconfigs_only || m->fbconfigID != GLX_DONT_CARE) {
+         list[i] = m;
+         order[i] = i;
+         i++;
+      }
+   }
+
+   /* The index is built while __glXInitialize holds __glXLock. */
+   chooser_sort_base = list;
+   qsort(order, count, sizeof(*order), chooser_compare);
+   chooser_sort_base = NULL;
+
+   index->count = count;
+   index->sorted = Xmalloc(sizeof(*index->sorted) * (count + 1));
+   if (index->sorted == NULL)
+      goto error;
+
+   for (i = 0; i < count; i++) {
+      index->sorted[i] = list[order[i]];
+      index->bucket_size[chooser_bucket(index->sorted[i])]++;
+   }
+
+   for (b = 0; b < CHOOSER_BUCKETS; b++) {
+      if (index->bucket_size[b] == 0)
+         continue;
+
+      index->bucket[b] = Xmalloc(sizeof(int) * index->bucket_size[b]);
+      if (index->bucket[b] == NULL)
+         goto error;
+
+      index->bucket_size[b] = 0;
+   }
+
+   for (i = 0; i < count; i++) {
+      b = chooser_bucket(index->sorted[i]);
+      index->bucket[b][index->bucket_size[b]++] = i;
+   }
+
+   Xfree(list);
+   Xfree(order);
+   return index;
+
+ error:
+   Xfree(list);
+   Xfree(order);
+   __glXDestroyChooserIndex(index);
+   return NULL;
+}
+
+_X_HIDDEN void
+__glXDestroyChooserIndex(__GLXchooserIndex * index)
+{
+   int i;
+
+   if (index == NULL)
+      return;
+
+   for (i = 0; i < CHOOSER_BUCKETS; i++)
+      Xfree(index->bucket[i]);
+
+   for (i = 0; i < CHOOSER_MEMO_SIZE; i++)
+      Xfree(index->memo[i].result);
+
+   Xfree(index->sorted);
+   Xfree(index);
+}
+
 /**
- * Selects and sorts a subset of the supplied configs based on the attributes.
+ * Selects and sorts the configs of an index that match a template.
  * This function forms to basis of \c glXChooseVisual, \c glXChooseFBConfig,
  * and \c glXChooseFBConfigSGIX.
  *
- * \param configs   Array of pointers to possible configs.  The elements of
- *                  this array that do not meet the criteria will be set to
- *                  NULL.  The remaining elements will be sorted according to
- *                  the various visual / FBConfig selection rules.
- * \param num_configs  Number of elements in the \c configs array.
- * \param attribList   Attributes used select from \c configs.  This array is
+ * The eligible buckets are merged by their position in the sorted order,
+ * so the result comes out sorted according to the various visual /
+ * FBConfig selection rules.
+ *
+ * \param index    The chooser index of the screen.
+ * \param test_config  The template built from the attribute list.
+ * \param result   Receives the matching configs, best first.  It must have
+ *                 room for every config in the index.
+ * \returns The number of elements stored in \c result.
+ */
+static int
+choose_from_index(const __GLXchooserIndex * index,
+                  const __GLcontextModes * test_config,
+                  __GLcontextModes ** result)
+{
+   int pos[CHOOSER_BUCKETS];
+   unsigned eligible = 0;
+   int count = 0;
+   int b, best, r;
+
+   for (b = 0; b < CHOOSER_BUCKETS; b++) {
+      pos[b] = 0;
+
+      if (index->bucket_size[b] > 0
+          && !chooser_bucket_excluded(test_config, b))
+         eligible |= 1U << b;
+   }
+
+   for (;;) {
+      best = -1;
+
+      for (b = 0; b < CHOOSER_BUCKETS; b++) {
+         if ((eligible & (1U << b)) && pos[b] < index->bucket_size[b]
+             && (best < 0
+                 || index->bucket[b][pos[b]] <
+                 index->bucket[best][pos[best]]))
+            best = b;
+      }
+
+      if (best < 0)
+         break;
+
+      r = index->bucket[best][pos[best]++];
+
+      if (fbconfigs_compatible(test_config, index->sorted[r]))
+         result[count++] = index->sorted[r];
+   }
+
+   return count;
+}
+
+/**
+ * Look up the configs that match an attribute list, using the memo of
+ * recent queries when possible.
+ *
+ * \param attribList   Attributes used select from \c index.  This array is
  *                     terminated by a \c None tag.  The array can either take
  *                     the form expected by \c glXChooseVisual (where boolean
  *                     tags do not have a value) or by \c glXChooseFBConfig
@@ -1469,53 +1751,93 @@ fbconfig_compare(const __GLcontextModes * const *const a,
  * \param fbconfig_style_tags  Selects whether \c attribList is in
  *                             \c glXChooseVisual style or
  *                             \c glXChooseFBConfig style.
- * \returns The number of valid elements left in \c configs.
+ * \returns An array of the matching configs, best first, allocated with
+ *          \c Xmalloc, or \c NULL if there is no match.
  *
  * \sa glXChooseVisual, glXChooseFBConfig, glXChooseFBConfigSGIX
  */
-static int
-choose_visual(__GLcontextModes ** configs, int num_configs,
-              const int *attribList, GLboolean fbconfig_style_tags)
+static __GLcontextModes **
+choose_configs(__GLXchooserIndex * index, const int *attribList,
+               GLboolean fbconfig_style_tags, int *nitems)
 {
    __GLcontextModes test_config;
-   int base;
-   int i;
+   __GLcontextModes **result = NULL;
+   struct chooser_memo memo;
+   int i, count;
 
-   /* This is a fairly direct implementation of the selection method
-    * described by GLX_SGIX_fbconfig.  Start by culling out all the
-    * configs that are not compatible with the selected parameter
-    * list.
-    */
+   *nitems = 0;
 
+   /* The template is zero filled first, so it can be compared with memcmp. */
    init_fbconfig_for_chooser(&test_config, fbconfig_style_tags);
    __glXInitializeVisualConfigFromTags(&test_config, 512,
                                        (const INT32 *) attribList,
                                        GL_TRUE, fbconfig_style_tags);
 
-   base = 0;
-   for (i = 0; i < num_configs; i++) {
-      if (fbconfigs_compatible(&test_config, configs[i])) {
-         configs[base] = configs[i];
-         base++;
-      }
+   __glXLock();
+
+   for (i = 0; i < CHOOSER_MEMO_SIZE && index->memo[i].valid; i++) {
+      if (memcmp(&index->memo[i].test_config, &test_config,
+                 sizeof(test_config)) == 0)
+         break;
    }
 
-   if (base == 0) {
-      return 0;
+   if (i < CHOOSER_MEMO_SIZE && index->memo[i].valid) {
+      memo = index->memo[i];
+
+      if (memo.count > 0) {
+         result = Xmalloc(sizeof(*result) * memo.count);
+         if (result != NULL) {
+            memcpy(result, memo.result, sizeof(*result) * memo.count);
+            *nitems = memo.count;
+         }
+      }
+
+      /* Move the hit to the front. */
+      memmove(&index->memo[1], &index->memo[0], sizeof(memo) * i);
+      index->memo[0] = memo;
+
+      __glXUnlock();
+      return result;
    }
 
-   if (base < num_configs) {
-      (void) memset(&configs[base], 0, sizeof(void *) * (num_configs - base));
+   __glXUnlock();
+
+   result = Xmalloc(sizeof(*result) * (index->count + 1));
+   if (result == NULL)
+      return NULL;
+
+   count = choose_from_index(index, &test_config, result);
+
+   memo.valid = GL_TRUE;
+   memo.test_config = test_config;
+   memo.count = count;
+   memo.result = NULL;
+
+   if (count > 0) {
+      memo.result = Xmalloc(sizeof(*result) * count);
+      if (memo.result == NULL)
+         memo.valid = GL_FALSE;
+      else
+         memcpy(memo.result, result, sizeof(*result) * count);
+   }
+   else {
+      Xfree(result);
+      result = NULL;
    }
 
-   /* After the incompatible configs are removed, the resulting
-    * list is sorted according to the rules set out in the various
-    * specifications.
-    */
+   if (memo.valid) {
+      __glXLock();
+
+      Xfree(index->memo[CHOOSER_MEMO_SIZE - 1].result);
+      memmove(&index->memo[1], &index->memo[0],
+              sizeof(memo) * (CHOOSER_MEMO_SIZE - 1));
+      index->memo[0] = memo;
 
-   qsort(configs, base, sizeof(__GLcontextModes *),
-         (int (*)(const void *, const void *)) fbconfig_compare);
-   return base;
+      __glXUnlock();
+   }
+
+   *nitems = count;
+   return result;
 }
 
 
@@ -1531,9 +1853,8 @@ glXChooseVisual(Display * dpy, int screen, int *attribList)
    XVisualInfo *visualList = NULL;
    __GLXdisplayPrivate *priv;
    __GLXscreenConfigs *psc;
-   __GLcontextModes test_config;
-   __GLcontextModes *modes;
-   const __GLcontextModes *best_config = NULL;
+   __GLcontextModes **candidates;
+   int count, i;
 
    /*
     ** Get a list of all visuals, return if list is empty
@@ -1542,48 +1863,30 @@ glXChooseVisual(Display * dpy, int screen, int *attribList)
       return None;
    }
 
+   if (psc->visual_index == NULL)
+      return None;
 
    /*
-    ** Build a template from the defaults and the attribute list
-    ** Free visual list and return if an unexpected token is encountered
+    ** Build a template from the defaults and the attribute list, and
+    ** find the visuals that meet the minimum requirements, best first.
+    ** Only then fetch the XVisualInfo, for the first visual that the X
+    ** server still knows about.
     */
-   init_fbconfig_for_chooser(&test_config, GL_FALSE);
-   __glXInitializeVisualConfigFromTags(&test_config, 512,
-                                       (const INT32 *) attribList,
-                                       GL_TRUE, GL_FALSE);
+   candidates = choose_configs(psc->visual_index, attribList, GL_FALSE,
+                               &count);
 
-   /*
-    ** Eliminate visuals that don't meet minimum requirements
-    ** Compute a score for those that do
-    ** Remember which visual, if any, got the highest score
-    ** If no visual is acceptable, return None
-    ** Otherwise, create an XVisualInfo list with just the selected X visual
-    ** and return this.
-    */
-   for (modes = psc->visuals; modes != NULL; modes = modes->next) {
-      if (fbconfigs_compatible(&test_config, modes)
-          && ((best_config == NULL)
-              ||
-              (fbconfig_compare
-               ((const __GLcontextModes * const *const) &modes,
-                &best_config) < 0))) {
-         XVisualInfo visualTemplate;
-         XVisualInfo *newList;
-         int i;
-
-         visualTemplate.screen = screen;
-         visualTemplate.visualid = modes->visualID;
-         newList = XGetVisualInfo(dpy, VisualScreenMask | VisualIDMask,
-                                  &visualTemplate, &i);
-
-         if (newList) {
-            Xfree(visualList);
-            visualList = newList;
-            best_config = modes;
-         }
-      }
+   for (i = 0; i < count && visualList == NULL; i++) {
+      XVisualInfo visualTemplate;
+      int n;
+
+      visualTemplate.screen = screen;
+      visualTemplate.visualid = candidates[i]->visualID;
+      visualList = XGetVisualInfo(dpy, VisualScreenMask | VisualIDMask,
+                                  &visualTemplate, &n);
    }
 
+   Xfree(candidates);
+
 #ifdef GLX_USE_APPLEGL
    if(visualList && getenv("LIBGL_DUMP_VISUALID")) {
       printf("visualid 0x%lx\n", visualList[0].visualid);
@@ -1927,23 +2230,22 @@ PUBLIC GLXFBConfig *
 glXChooseFBConfig(Display * dpy, int screen,
                   const int *attribList, int *nitems)
 {
-   __GLcontextModes **config_list;
-   int list_size;
+   __GLXdisplayPrivate *priv;
+   __GLXscreenConfigs *psc;
 
+   if (attribList == NULL)
+      return glXGetFBConfigs(dpy, screen, nitems);
 
-   config_list = (__GLcontextModes **)
-      glXGetFBConfigs(dpy, screen, &list_size);
+   *nitems = 0;
 
-   if ((config_list != NULL) && (list_size > 0) && (attribList != NULL)) {
-      list_size = choose_visual(config_list, list_size, attribList, GL_TRUE);
-      if (list_size == 0) {
-         XFree(config_list);
-         config_list = NULL;
-      }
-   }
+   /* This has the same requirements as glXGetFBConfigs. */
+   if (GetGLXPrivScreenConfig(dpy, screen, &priv, &psc) != Success
+       || psc->configs == NULL || psc->configs->fbconfigID == GLX_DONT_CARE
+       || psc->config_index == NULL)
+      return NULL;
 
-   *nitems = list_size;
-   return (GLXFBConfig *) config_list;
+   return (GLXFBConfig *) choose_configs(psc->config_index, attribList,
+                                         GL_TRUE, nitems);
 }
 
 
@@ -1978,7 +2280,22 @@ glXGetFBConfigs(Display * dpy, int screen, int *nelements)
        && (priv->screenConfigs[screen].configs->fbconfigID != GLX_DONT_CARE)) {
       unsigned num_configs = 0;
       __GLcontextModes *modes;
-
+      __GLcontextModes *const *fbconfigs;
+
+      /* The array is built when the screen's configs are fetched. */
+      fbconfigs =
+         _gl_context_modes_get_fbconfigs(priv->screenConfigs[screen].configs,
+                                         &num_configs);
+      if (fbconfigs != NULL) {
+         config = (__GLcontextModes **) Xmalloc(sizeof(__GLcontextModes *)
+                                                * num_configs);
+         if (config != NULL) {
+            memcpy(config, fbconfigs,
+                   sizeof(__GLcontextModes *) * num_configs);
+            *nelements = num_configs;
+         }
+         return (GLXFBConfig *) config;
+      }
 
       for (modes = priv->screenConfigs[screen].configs; modes != NULL;
            modes = modes->next) {
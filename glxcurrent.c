@@ -120,6 +120,15 @@ static pthread_once_t once_control = PTHREAD_ONCE_INIT;
  */
 static pthread_key_t ContextTSD;
 
+/**
+ * Set after \c ContextTSD is created.
+ *
+ * A thread only sets a context after \c init_thread_data has run, so a
+ * reader that sees this clear has no context, and the get path needs no
+ * \c pthread_once.
+ */
+static int ContextTSDReady = 0;
+
 /**
  * Initialize the per-thread data key.
  *
@@ -134,12 +143,16 @@ init_thread_data(void)
       perror("pthread_key_create");
       exit(-1);
    }
+
+   __atomic_store_n(&ContextTSDReady, 1, __ATOMIC_RELEASE);
 }
 
 _X_HIDDEN void
 __glXSetCurrentContext(__GLXcontext * c)
 {
-   pthread_once(&once_control, init_thread_data);
+   if (!__atomic_load_n(&ContextTSDReady, __ATOMIC_ACQUIRE))
+      pthread_once(&once_control, init_thread_data);
+
    pthread_setspecific(ContextTSD, c);
 }
 
@@ -148,7 +161,8 @@ __glXGetCurrentContext(void)
 {
    void *v;
 
-   pthread_once(&once_control, init_thread_data);
+   if (!__atomic_load_n(&ContextTSDReady, __ATOMIC_ACQUIRE))
+      return &dummyContext;
 
    v = pthread_getspecific(ContextTSD);
    return (v == NULL) ? &dummyContext : (__GLXcontext *) v;
@@ -351,6 +365,9 @@ MakeContextCurrent(Display * dpy, GLXDrawable draw,
    apple_glx_diagnostic("%s: error %s\n", __func__, error ? "YES" : "NO");
    if(error)
       return GL_FALSE;
+
+   if (gc)
+      apple_glx_context_bind_read(dpy, gc->apple, draw, read);
 #else
    xGLXMakeCurrentReply reply;
    const CARD8 opcode = __glXSetupForCommand(dpy);
@@ -43,12 +43,15 @@
 #include <X11/extensions/extutil.h>
 #ifdef GLX_USE_APPLEGL
 #include "apple_glx.h"
+#include "apple_glx_drawable.h"
 #include "apple_visual.h"
 #else
 #include "glapi.h"
 #endif
 #include "glxextensions.h"
 #include "glcontextmodes.h"
+#include "glx_config_cache.h"
+#include "glx_async.h"
 
 #ifdef USE_XCB
 #include <X11/Xlib-xcb.h>
@@ -104,6 +107,11 @@ __glXCloseDisplay(Display * dpy, XExtCodes * codes)
       __glXFreeContext(gc);
    }
 
+#ifdef GLX_USE_APPLEGL
+   apple_glx_surface_close_display(dpy);
+   apple_glx_drawable_close_display(dpy);
+#endif
+
    return XextRemoveDisplay(__glXExtensionInfo, dpy);
 }
 
@@ -153,6 +161,14 @@ FreeScreenConfigs(__GLXdisplayPrivate * priv)
    psc = priv->screenConfigs;
    screens = ScreenCount(priv->dpy);
    for (i = 0; i < screens; i++, psc++) {
+      if (psc->visual_index) {
+         __glXDestroyChooserIndex(psc->visual_index);
+         psc->visual_index = NULL;
+      }
+      if (psc->config_index) {
+         __glXDestroyChooserIndex(psc->config_index);
+         psc->config_index = NULL;
+      }
       if (psc->configs) {
          _gl_context_modes_destroy(psc->configs);
          if (psc->effectiveGLXexts)
@@ -227,298 +243,15 @@ __glXFreeDisplayPrivate(XExtData * extension)
 /************************************************************************/
 
 /*
-** Query the version of the GLX extension.  This procedure works even if
-** the client extension is not completely set up.
-*/
-static Bool
-QueryVersion(Display * dpy, int opcode, int *major, int *minor)
-{
-#ifdef USE_XCB
-   xcb_connection_t *c = XGetXCBConnection(dpy);
-   xcb_glx_query_version_reply_t *reply = xcb_glx_query_version_reply(c,
-                                                                      xcb_glx_query_version
-                                                                      (c,
-                                                                       GLX_MAJOR_VERSION,
-                                                                       GLX_MINOR_VERSION),
-                                                                      NULL);
-
-   if (reply->major_version != GLX_MAJOR_VERSION) {
-      free(reply);
-      return GL_FALSE;
-   }
-   *major = reply->major_version;
-   *minor = min(reply->minor_version, GLX_MINOR_VERSION);
-   free(reply);
-   return GL_TRUE;
-#else
-   xGLXQueryVersionReq *req;
-   xGLXQueryVersionReply reply;
-
-   /* Send the glXQueryVersion request */
-   LockDisplay(dpy);
-   GetReq(GLXQueryVersion, req);
-   req->reqType = opcode;
-   req->glxCode = X_GLXQueryVersion;
-   req->majorVersion = GLX_MAJOR_VERSION;
-   req->minorVersion = GLX_MINOR_VERSION;
-   _XReply(dpy, (xReply *) & reply, 0, False);
-   UnlockDisplay(dpy);
-   SyncHandle();
-
-   if (reply.majorVersion != GLX_MAJOR_VERSION) {
-      /*
-       ** The server does not support the same major release as this
-       ** client.
-       */
-      return GL_FALSE;
-   }
-   *major = reply.majorVersion;
-   *minor = min(reply.minorVersion, GLX_MINOR_VERSION);
-   return GL_TRUE;
-#endif /* USE_XCB */
-}
-
-/* 
- * We don't want to enable this GLX_OML_swap_method in glxext.h, 
- * because we can't support it.  The X server writes it out though,
- * so we should handle it somehow, to avoid false warnings.
+ * The properties are read from the connection, unless they're in data.
+ * They are read with one _XRead, rather than one for each config.
  */
-enum {
-    IGNORE_GLX_SWAP_METHOD_OML = 0x8060
-};
-
-
-/*
- * getVisualConfigs uses the !tagged_only path.
- * getFBConfigs uses the tagged_only path.
- */
-_X_HIDDEN void
-__glXInitializeVisualConfigFromTags(__GLcontextModes * config, int count,
-                                    const INT32 * bp, Bool tagged_only,
-                                    Bool fbconfig_style_tags)
-{
-   int i;
-
-   if (!tagged_only) {
-      /* Copy in the first set of properties */
-      config->visualID = *bp++;
-
-      config->visualType = _gl_convert_from_x_visual_type(*bp++);
-
-      config->rgbMode = *bp++;
-
-      config->redBits = *bp++;
-      config->greenBits = *bp++;
-      config->blueBits = *bp++;
-      config->alphaBits = *bp++;
-      config->accumRedBits = *bp++;
-      config->accumGreenBits = *bp++;
-      config->accumBlueBits = *bp++;
-      config->accumAlphaBits = *bp++;
-
-      config->doubleBufferMode = *bp++;
-      config->stereoMode = *bp++;
-
-      config->rgbBits = *bp++;
-      config->depthBits = *bp++;
-      config->stencilBits = *bp++;
-      config->numAuxBuffers = *bp++;
-      config->level = *bp++;
-
-#ifdef GLX_USE_APPLEGL
-       /* AppleSGLX supports pixmap and pbuffers with all config. */
-       config->drawableType = GLX_WINDOW_BIT | GLX_PIXMAP_BIT | GLX_PBUFFER_BIT;
-       /* Unfortunately this can create an ABI compatibility problem. */
-       count -= 18;
-#else
-      count -= __GLX_MIN_CONFIG_PROPS;
-#endif
-   }
-
-   /*
-    ** Additional properties may be in a list at the end
-    ** of the reply.  They are in pairs of property type
-    ** and property value.
-    */
-
-#define FETCH_OR_SET(tag) \
-    config-> tag = ( fbconfig_style_tags ) ? *bp++ : 1
-
-   for (i = 0; i < count; i += 2) {
-      long int tag = *bp++;
-      
-      switch (tag) {
-      case GLX_RGBA:
-         FETCH_OR_SET(rgbMode);
-         break;
-      case GLX_BUFFER_SIZE:
-         config->rgbBits = *bp++;
-         break;
-      case GLX_LEVEL:
-         config->level = *bp++;
-         break;
-      case GLX_DOUBLEBUFFER:
-         FETCH_OR_SET(doubleBufferMode);
-         break;
-      case GLX_STEREO:
-         FETCH_OR_SET(stereoMode);
-         break;
-      case GLX_AUX_BUFFERS:
-         config->numAuxBuffers = *bp++;
-         break;
-      case GLX_RED_SIZE:
-         config->redBits = *bp++;
-         break;
-      case GLX_GREEN_SIZE:
-         config->greenBits = *bp++;
-         break;
-      case GLX_BLUE_SIZE:
-         config->blueBits = *bp++;
-         break;
-      case GLX_ALPHA_SIZE:
-         config->alphaBits = *bp++;
-         break;
-      case GLX_DEPTH_SIZE:
-         config->depthBits = *bp++;
-         break;
-      case GLX_STENCIL_SIZE:
-         config->stencilBits = *bp++;
-         break;
-      case GLX_ACCUM_RED_SIZE:
-         config->accumRedBits = *bp++;
-         break;
-      case GLX_ACCUM_GREEN_SIZE:
-         config->accumGreenBits = *bp++;
-         break;
-      case GLX_ACCUM_BLUE_SIZE:
-         config->accumBlueBits = *bp++;
-         break;
-      case GLX_ACCUM_ALPHA_SIZE:
-         config->accumAlphaBits = *bp++;
-         break;
-      case GLX_VISUAL_CAVEAT_EXT:
-         config->visualRating = *bp++;
-         break;
-      case GLX_X_VISUAL_TYPE:
-         config->visualType = *bp++;
-         break;
-      case GLX_TRANSPARENT_TYPE:
-         config->transparentPixel = *bp++;
-         break;
-      case GLX_TRANSPARENT_INDEX_VALUE:
-         config->transparentIndex = *bp++;
-         break;
-      case GLX_TRANSPARENT_RED_VALUE:
-         config->transparentRed = *bp++;
-         break;
-      case GLX_TRANSPARENT_GREEN_VALUE:
-         config->transparentGreen = *bp++;
-         break;
-      case GLX_TRANSPARENT_BLUE_VALUE:
-         config->transparentBlue = *bp++;
-         break;
-      case GLX_TRANSPARENT_ALPHA_VALUE:
-         config->transparentAlpha = *bp++;
-         break;
-      case GLX_VISUAL_ID:
-         config->visualID = *bp++;
-         break;
-      case GLX_DRAWABLE_TYPE:
-         config->drawableType = *bp++;
-#ifdef GLX_USE_APPLEGL
-         /* AppleSGLX supports pixmap and pbuffers with all config. */
-         config->drawableType |= GLX_WINDOW_BIT | GLX_PIXMAP_BIT | GLX_PBUFFER_BIT;              
-#endif
-         break;
-      case GLX_RENDER_TYPE:
-         config->renderType = *bp++;
-         break;
-      case GLX_X_RENDERABLE:
-         config->xRenderable = *bp++;
-         break;
-      case GLX_FBCONFIG_ID:
-         config->fbconfigID = *bp++;
-         break;
-      case GLX_MAX_PBUFFER_WIDTH:
-         config->maxPbufferWidth = *bp++;
-         break;
-      case GLX_MAX_PBUFFER_HEIGHT:
-         config->maxPbufferHeight = *bp++;
-         break;
-      case GLX_MAX_PBUFFER_PIXELS:
-         config->maxPbufferPixels = *bp++;
-         break;
-#ifndef GLX_USE_APPLEGL
-      case GLX_OPTIMAL_PBUFFER_WIDTH_SGIX:
-         config->optimalPbufferWidth = *bp++;
-         break;
-      case GLX_OPTIMAL_PBUFFER_HEIGHT_SGIX:
-         config->optimalPbufferHeight = *bp++;
-         break;
-      case GLX_VISUAL_SELECT_GROUP_SGIX:
-         config->visualSelectGroup = *bp++;
-         break;
-      case GLX_SWAP_METHOD_OML:
-         config->swapMethod = *bp++;
-         break;
-#endif
-      case GLX_SAMPLE_BUFFERS_SGIS:
-         config->sampleBuffers = *bp++;
-         break;
-      case GLX_SAMPLES_SGIS:
-         config->samples = *bp++;
-         break;
-#ifdef GLX_USE_APPLEGL
-      case IGNORE_GLX_SWAP_METHOD_OML:
-         /* We ignore this tag.  See the comment above this function. */
-         ++bp;
-         break;
-#else
-      case GLX_BIND_TO_TEXTURE_RGB_EXT:
-         config->bindToTextureRgb = *bp++;
-         break;
-      case GLX_BIND_TO_TEXTURE_RGBA_EXT:
-         config->bindToTextureRgba = *bp++;
-         break;
-      case GLX_BIND_TO_MIPMAP_TEXTURE_EXT:
-         config->bindToMipmapTexture = *bp++;
-         break;
-      case GLX_BIND_TO_TEXTURE_TARGETS_EXT:
-         config->bindToTextureTargets = *bp++;
-         break;
-      case GLX_Y_INVERTED_EXT:
-         config->yInverted = *bp++;
-         break;
-#endif
-      case None:
-         i = count;
-         break;
-      default:
-         if(getenv("LIBGL_DIAGNOSTIC")) {
-             long int tagvalue = *bp++;
-             fprintf(stderr, "WARNING: unknown GLX tag from server: "
-                     "tag 0x%lx value 0x%lx\n", tag, tagvalue);
-         }
-              break;
-      }
-   }
-
-   config->renderType =
-      (config->rgbMode) ? GLX_RGBA_BIT : GLX_COLOR_INDEX_BIT;
-
-   config->haveAccumBuffer = ((config->accumRedBits +
-                               config->accumGreenBits +
-                               config->accumBlueBits +
-                               config->accumAlphaBits) > 0);
-   config->haveDepthBuffer = (config->depthBits > 0);
-   config->haveStencilBuffer = (config->stencilBits > 0);
-}
-
 static __GLcontextModes *
 createConfigsFromProperties(Display * dpy, int nvisuals, int nprops,
-                            int screen, GLboolean tagged_only)
+                            int screen, GLboolean tagged_only,
+                            const INT32 * data)
 {
-   INT32 buf[__GLX_TOTAL_CONFIG], *props;
+   INT32 *props = NULL;
    unsigned prop_size;
    __GLcontextModes *modes, *m;
    int i;
@@ -532,21 +265,29 @@ createConfigsFromProperties(Display * dpy, int nvisuals, int nprops,
    if (nprops < __GLX_MIN_CONFIG_PROPS || nprops > __GLX_MAX_CONFIG_PROPS)
       return NULL;
 
+   prop_size = nprops * __GLX_SIZE_INT32;
+
+   if (data == NULL) {
+      props = Xmalloc((size_t) nvisuals * prop_size);
+      if (!props) {
+         _XEatData(dpy, (unsigned long) nvisuals * prop_size);
+         return NULL;
+      }
+
+      _XRead(dpy, (char *) props, (long) nvisuals * prop_size);
+      data = props;
+   }
+
    /* Allocate memory for our config structure */
    modes = _gl_context_modes_create(nvisuals, sizeof(__GLcontextModes));
-   if (!modes)
+   if (!modes) {
+      Xfree(props);
       return NULL;
+   }
 
-   prop_size = nprops * __GLX_SIZE_INT32;
-   if (prop_size <= sizeof(buf))
-      props = buf;
-   else
-      props = Xmalloc(prop_size);
-
-   /* Read each config structure and convert it into our format */
+   /* Convert each config structure into our format */
    m = modes;
    for (i = 0; i < nvisuals; i++) {
-      _XRead(dpy, (char *) props, prop_size);
 #ifdef GLX_USE_APPLEGL
        /* Older X servers don't send this so we default it here. */
       m->drawableType = GLX_WINDOW_BIT;
@@ -558,81 +299,287 @@ createConfigsFromProperties(Display * dpy, int nvisuals, int nprops,
        */
       m->drawableType = GLX_WINDOW_BIT | GLX_PIXMAP_BIT | GLX_PBUFFER_BIT;
 #endif
-       __glXInitializeVisualConfigFromTags(m, nprops, props,
+       __glXInitializeVisualConfigFromTags(m, nprops, data + i * nprops,
                                           tagged_only, GL_TRUE);
       m->screen = screen;
       m = m->next;
    }
 
-   if (props != buf)
-      Xfree(props);
+   Xfree(props);
 
    return modes;
 }
 
-static GLboolean
-getVisualConfigs(Display * dpy, __GLXdisplayPrivate * priv, int screen)
+/*
+ * __glXInitialize sends all of its requests as one batch before it reads
+ * any reply, so that a display with a long round trip pays for one round
+ * trip rather than one for each request.  The batch handler copies each
+ * reply.
+ */
+enum
 {
-   xGLXGetVisualConfigsReq *req;
-   __GLXscreenConfigs *psc;
-   xGLXGetVisualConfigsReply reply;
+   INIT_VERSION,
+   INIT_VERSION_STRING,
+   INIT_SCREEN_REQUESTS
+};
 
-   LockDisplay(dpy);
+/* The requests for each screen, which follow INIT_SCREEN_REQUESTS. */
+enum
+{
+   INIT_EXTENSIONS_STRING,
+   INIT_VISUAL_CONFIGS,
+   INIT_FBCONFIGS,
+   INIT_REQUESTS_PER_SCREEN
+};
 
-   psc = priv->screenConfigs + screen;
-   psc->visuals = NULL;
-   GetReq(GLXGetVisualConfigs, req);
-   req->reqType = priv->majorOpcode;
-   req->glxCode = X_GLXGetVisualConfigs;
+struct init_reply
+{
+   xReply reply;
+   char *data;                  /* The reply->generic.length words after it. */
+   Bool done;
+   Bool failed;
+   /* The GetFBConfigs is sent before the server's GLX version is known. */
+   Bool ignore_error;
+};
+
+struct init_requests
+{
+   int count;
+   struct init_reply *replies;
+   struct __GLXrequestBatch batch;
+};
+
+#define INIT_SCREEN_REPLY(init, screen, which) \
+   (&(init)->replies[INIT_SCREEN_REQUESTS + \
+                     (screen) * INIT_REQUESTS_PER_SCREEN + (which)])
+
+static Bool
+InitReplyHandler(Display * dpy, xReply * rep, char *buf, int len,
+                 int index, XPointer data)
+{
+   struct init_requests *init = (struct init_requests *) data;
+   struct init_reply *r;
+   int length;
+
+   r = &init->replies[index];
+   r->done = True;
+
+   if (rep->generic.type == X_Error) {
+      r->failed = True;
+      /* Otherwise Xlib reports the error, as it did for the _XReply. */
+      return r->ignore_error;
+   }
+
+   memcpy(&r->reply, rep, SIZEOF(xReply));
+   length = rep->generic.length << 2;
+
+   if (length > 0) {
+      r->data = Xmalloc(length);
+      r->failed = (r->data == NULL);
+      _XGetAsyncData(dpy, r->data, buf, len, SIZEOF(xReply),
+                     r->data ? length : 0, length);
+   }
+
+   return True;
+}
+
+static void
+SendServerString(Display * dpy, int opcode, CARD32 screen, CARD32 name)
+{
+   xGLXQueryServerStringReq *req;
+
+   GetReq(GLXQueryServerString, req);
+   req->reqType = opcode;
+   req->glxCode = X_GLXQueryServerString;
    req->screen = screen;
+   req->name = name;
+}
 
-   if (!_XReply(dpy, (xReply *) & reply, 0, False))
-      goto out;
+static Bool
+SendInitRequests(Display * dpy, int opcode, struct init_requests *init)
+{
+   xGLXQueryVersionReq *version_req;
+   xGLXGetVisualConfigsReq *visual_req;
+   xGLXGetFBConfigsReq *fb_req;
+   GLint i, screens;
 
-   psc->visuals = createConfigsFromProperties(dpy,
-                                              reply.numVisuals,
-                                              reply.numProps,
-                                              screen, GL_FALSE);
+   screens = ScreenCount(dpy);
+   init->count = INIT_SCREEN_REQUESTS + screens * INIT_REQUESTS_PER_SCREEN;
+   init->replies = Xcalloc(init->count, sizeof(struct init_reply));
+   if (!init->replies)
+      return False;
+
+   LockDisplay(dpy);
+
+   __glXBeginRequestBatch(dpy, &init->batch, InitReplyHandler,
+                          (XPointer) init);
+
+   GetReq(GLXQueryVersion, version_req);
+   version_req->reqType = opcode;
+   version_req->glxCode = X_GLXQueryVersion;
+   version_req->majorVersion = GLX_MAJOR_VERSION;
+   version_req->minorVersion = GLX_MINOR_VERSION;
+
+   SendServerString(dpy, opcode, 0, GLX_VERSION);
+
+   for (i = 0; i < screens; i++) {
+      SendServerString(dpy, opcode, i, GLX_EXTENSIONS);
+
+      GetReq(GLXGetVisualConfigs, visual_req);
+      visual_req->reqType = opcode;
+      visual_req->glxCode = X_GLXGetVisualConfigs;
+      visual_req->screen = i;
+
+      GetReq(GLXGetFBConfigs, fb_req);
+      fb_req->reqType = opcode;
+      fb_req->glxCode = X_GLXGetFBConfigs;
+      fb_req->screen = i;
+      INIT_SCREEN_REPLY(init, i, INIT_FBCONFIGS)->ignore_error = True;
+   }
+
+   __glXEndRequestBatch(dpy, &init->batch);
 
- out:
    UnlockDisplay(dpy);
-   return psc->visuals != NULL;
+
+   /* Let the server start on the requests while the client goes on. */
+   XFlush(dpy);
+
+   return True;
 }
 
+static void
+CollectInitReplies(Display * dpy, struct init_requests *init)
+{
+   LockDisplay(dpy);
+   __glXFinishRequestBatch(dpy, &init->batch);
+   UnlockDisplay(dpy);
+   SyncHandle();
+}
+
+static void
+FreeInitReplies(struct init_requests *init)
+{
+   int i;
+
+   for (i = 0; i < init->count; i++) {
+      if (init->replies[i].data)
+         Xfree(init->replies[i].data);
+   }
+
+   Xfree(init->replies);
+}
+
+static Bool
+VersionFromReply(struct init_reply *r, int *major, int *minor)
+{
+   xGLXQueryVersionReply *reply = (xGLXQueryVersionReply *) & r->reply;
+
+   if (!r->done || r->failed)
+      return GL_FALSE;
+
+   if (reply->majorVersion != GLX_MAJOR_VERSION) {
+      /*
+       ** The server does not support the same major release as this
+       ** client.
+       */
+      return GL_FALSE;
+   }
+   *major = reply->majorVersion;
+   *minor = min(reply->minorVersion, GLX_MINOR_VERSION);
+   return GL_TRUE;
+}
+
+static char *
+StringFromReply(struct init_reply *r)
+{
+   xGLXQueryServerStringReply *reply =
+      (xGLXQueryServerStringReply *) & r->reply;
+   char *buf;
+
+   if (!r->done || r->failed || reply->n > (reply->length << 2))
+      return NULL;
+
+   buf = Xmalloc(reply->n);
+   if (buf != NULL && reply->n > 0)
+      memcpy(buf, r->data, reply->n);
+
+   return buf;
+}
+
+/*
+ * With LIBGL_CONFIG_CACHE_DIR set, the decoded configs come from the cache
+ * when the properties in the reply match the ones they were decoded from.
+ */
+static __GLcontextModes *
+ConfigsFromReply(Display * dpy, __GLXdisplayPrivate * priv,
+                 struct init_reply *r, int screen, GLboolean tagged_only)
+{
+   xGLXGetVisualConfigsReply *visuals;
+   xGLXGetFBConfigsReply *fbconfigs;
+   struct __GLXconfigCacheKey key;
+   __GLcontextModes *modes;
+   GLboolean cached;
+   unsigned long count, nprops;
+
+   if (!r->done || r->failed)
+      return NULL;
+
+   if (tagged_only) {
+      fbconfigs = (xGLXGetFBConfigsReply *) & r->reply;
+      count = fbconfigs->numFBConfigs;
+      nprops = (unsigned long) fbconfigs->numAttribs * 2;
+   }
+   else {
+      visuals = (xGLXGetVisualConfigsReply *) & r->reply;
+      count = visuals->numVisuals;
+      nprops = visuals->numProps;
+   }
+
+   if (count == 0 || nprops == 0 || nprops > __GLX_MAX_CONFIG_PROPS ||
+       count > r->reply.generic.length / nprops)
+      return NULL;
+
+   cached = __glXConfigCacheKey(&key, ServerVendor(dpy), VendorRelease(dpy),
+                                priv->serverGLXversion, screen, tagged_only,
+                                (const INT32 *) r->data, count, nprops);
+
+   if (cached) {
+      modes = __glXConfigCacheLoad(&key);
+      if (modes)
+         return modes;
+   }
+
+   modes = createConfigsFromProperties(dpy, count, nprops, screen,
+                                       tagged_only, (const INT32 *) r->data);
+
+   if (cached && modes)
+      __glXConfigCacheSave(&key, modes);
+
+   return modes;
+}
+
+/* Servers before GLX 1.3 may have the SGIX_fbconfig version. */
 static GLboolean
-getFBConfigs(Display * dpy, __GLXdisplayPrivate * priv, int screen)
+getFBConfigsSGIX(Display * dpy, __GLXdisplayPrivate * priv, int screen)
 {
-   xGLXGetFBConfigsReq *fb_req;
    xGLXGetFBConfigsSGIXReq *sgi_req;
    xGLXVendorPrivateWithReplyReq *vpreq;
    xGLXGetFBConfigsReply reply;
    __GLXscreenConfigs *psc;
 
    psc = priv->screenConfigs + screen;
-   psc->serverGLXexts =
-      __glXQueryServerString(dpy, priv->majorOpcode, screen, GLX_EXTENSIONS);
 
    LockDisplay(dpy);
 
    psc->configs = NULL;
-   if (atof(priv->serverGLXversion) >= 1.3) {
-      GetReq(GLXGetFBConfigs, fb_req);
-      fb_req->reqType = priv->majorOpcode;
-      fb_req->glxCode = X_GLXGetFBConfigs;
-      fb_req->screen = screen;
-   }
-   else if (strstr(psc->serverGLXexts, "GLX_SGIX_fbconfig") != NULL) {
-      GetReqExtra(GLXVendorPrivateWithReply,
-                  sz_xGLXGetFBConfigsSGIXReq +
-                  sz_xGLXVendorPrivateWithReplyReq, vpreq);
-      sgi_req = (xGLXGetFBConfigsSGIXReq *) vpreq;
-      sgi_req->reqType = priv->majorOpcode;
-      sgi_req->glxCode = X_GLXVendorPrivateWithReply;
-      sgi_req->vendorCode = X_GLXvop_GetFBConfigsSGIX;
-      sgi_req->screen = screen;
-   }
-   else
-      goto out;
+   GetReqExtra(GLXVendorPrivateWithReply,
+               sz_xGLXGetFBConfigsSGIXReq +
+               sz_xGLXVendorPrivateWithReplyReq, vpreq);
+   sgi_req = (xGLXGetFBConfigsSGIXReq *) vpreq;
+   sgi_req->reqType = priv->majorOpcode;
+   sgi_req->glxCode = X_GLXVendorPrivateWithReply;
+   sgi_req->vendorCode = X_GLXvop_GetFBConfigsSGIX;
+   sgi_req->screen = screen;
 
    if (!_XReply(dpy, (xReply *) & reply, 0, False))
       goto out;
@@ -640,7 +587,7 @@ getFBConfigs(Display * dpy, __GLXdisplayPrivate * priv, int screen)
    psc->configs = createConfigsFromProperties(dpy,
                                               reply.numFBConfigs,
                                               reply.numAttribs * 2,
-                                              screen, GL_TRUE);
+                                              screen, GL_TRUE, NULL);
 
  out:
    UnlockDisplay(dpy);
@@ -652,7 +599,8 @@ getFBConfigs(Display * dpy, __GLXdisplayPrivate * priv, int screen)
 ** If that works then fetch the per screen configs data.
 */
 static Bool
-AllocAndFetchScreenConfigs(Display * dpy, __GLXdisplayPrivate * priv)
+AllocAndFetchScreenConfigs(Display * dpy, __GLXdisplayPrivate * priv,
+                           struct init_requests *init)
 {
    __GLXscreenConfigs *psc;
    GLint i, screens;
@@ -669,15 +617,37 @@ AllocAndFetchScreenConfigs(Display * dpy, __GLXdisplayPrivate * priv)
    priv->screenConfigs = psc;
 
    priv->serverGLXversion =
-      __glXQueryServerString(dpy, priv->majorOpcode, 0, GLX_VERSION);
+      StringFromReply(&init->replies[INIT_VERSION_STRING]);
    if (priv->serverGLXversion == NULL) {
       FreeScreenConfigs(priv);
       return GL_FALSE;
    }
 
    for (i = 0; i < screens; i++, psc++) {
-      getVisualConfigs(dpy, priv, i);
-      getFBConfigs(dpy, priv, i);
+      psc->serverGLXexts =
+         StringFromReply(INIT_SCREEN_REPLY(init, i, INIT_EXTENSIONS_STRING));
+      psc->visuals =
+         ConfigsFromReply(dpy, priv,
+                          INIT_SCREEN_REPLY(init, i, INIT_VISUAL_CONFIGS),
+                          i, GL_FALSE);
+
+      if (atof(priv->serverGLXversion) >= 1.3)
+         psc->configs =
+            ConfigsFromReply(dpy, priv,
+                             INIT_SCREEN_REPLY(init, i, INIT_FBCONFIGS),
+                             i, GL_TRUE);
+      else if (psc->serverGLXexts != NULL &&
+               strstr(psc->serverGLXexts, "GLX_SGIX_fbconfig") != NULL)
+         getFBConfigsSGIX(dpy, priv, i);
+
+      /* The lists don't change after this, so the lookups need no lock. */
+      (void) _gl_context_modes_index(psc->visuals);
+      (void) _gl_context_modes_index(psc->configs);
+
+      if (psc->visuals)
+         psc->visual_index = __glXCreateChooserIndex(psc->visuals, GL_FALSE);
+      if (psc->configs)
+         psc->config_index = __glXCreateChooserIndex(psc->configs, GL_TRUE);
 
 #ifdef GLX_DIRECT_RENDERING
       psc->scr = i;
@@ -715,7 +685,11 @@ __glXInitialize(Display * dpy)
    XExtData **privList, *private, *found;
    __GLXdisplayPrivate *dpyPriv;
    XEDataObject dataObj;
+   struct init_requests init;
    int major, minor;
+#ifdef GLX_USE_APPLEGL
+   bool apple_failed;
+#endif
 #ifdef GLX_DIRECT_RENDERING
    Bool glx_direct, glx_accel;
 #endif
@@ -739,9 +713,22 @@ __glXInitialize(Display * dpy)
       return (__GLXdisplayPrivate *) found->private_data;
    }
 
+   if (!SendInitRequests(dpy, info->codes->major_opcode, &init)) {
+      __glXUnlock();
+      return 0;
+   }
+
+#ifdef GLX_USE_APPLEGL
+   /* The AppleDRI round trips also bring in the replies to the requests. */
+   apple_failed = apple_init_glx(dpy);
+#endif
+
+   CollectInitReplies(dpy, &init);
+
    /* See if the versions are compatible */
-   if (!QueryVersion(dpy, info->codes->major_opcode, &major, &minor)) {
+   if (!VersionFromReply(&init.replies[INIT_VERSION], &major, &minor)) {
       /* The client and server do not agree on versions.  Punt. */
+      FreeInitReplies(&init);
       __glXUnlock();
       return 0;
    }
@@ -751,11 +738,13 @@ __glXInitialize(Display * dpy)
     */
    private = (XExtData *) Xmalloc(sizeof(XExtData));
    if (!private) {
+      FreeInitReplies(&init);
       __glXUnlock();
       return 0;
    }
    dpyPriv = (__GLXdisplayPrivate *) Xcalloc(1, sizeof(__GLXdisplayPrivate));
    if (!dpyPriv) {
+      FreeInitReplies(&init);
       __glXUnlock();
       Xfree((char *) private);
       return 0;
@@ -790,16 +779,19 @@ __glXInitialize(Display * dpy)
       dpyPriv->driswDisplay = driswCreateDisplay(dpy);
 #endif
 #ifdef GLX_USE_APPLEGL
-   if (apple_init_glx(dpy) || !AllocAndFetchScreenConfigs(dpy, dpyPriv)) {
+   if (apple_failed || !AllocAndFetchScreenConfigs(dpy, dpyPriv, &init)) {
 #else
-   if (!AllocAndFetchScreenConfigs(dpy, dpyPriv)) {
+   if (!AllocAndFetchScreenConfigs(dpy, dpyPriv, &init)) {
 #endif
+      FreeInitReplies(&init);
       __glXUnlock();
       Xfree((char *) dpyPriv);
       Xfree((char *) private);
       return 0;
    }
 
+   FreeInitReplies(&init);
+
    /*
     ** Fill in the private structure.  This is the actual structure that
     ** hangs off of the Display structure.  Our private structure is
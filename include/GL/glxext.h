@@ -925,6 +925,14 @@ extern void glXCopyImageSubDataNV (Display *, GLXContext, GLuint, GLenum, GLint,
 typedef void ( * PFNGLXCOPYIMAGESUBDATANVPROC) (Display *dpy, GLXContext srcCtx, GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLXContext dstCtx, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei width, GLsizei height, GLsizei depth);
 #endif
 
+#ifndef GLX_APPLE_pixmap_buffer
+#define GLX_APPLE_pixmap_buffer 1
+#ifdef GLX_GLXEXT_PROTOTYPES
+extern Bool glXQueryPixmapBufferAPPLE (Display *, GLXPixmap, const void **, int *, int *, int *, GLenum *, GLenum *);
+#endif /* GLX_GLXEXT_PROTOTYPES */
+typedef Bool ( * PFNGLXQUERYPIXMAPBUFFERAPPLEPROC) (Display *dpy, GLXPixmap pixmap, const void **data, int *width, int *height, int *pitch, GLenum *format, GLenum *type);
+#endif
+
 
 #ifdef __cplusplus
 }
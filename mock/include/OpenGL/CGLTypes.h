@@ -0,0 +1,103 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * The subset of the CGL types that libGL uses, for building against the
+ * mock backend in mock/mock_cgl.c.  The values match the OpenGL framework.
+ */
+#ifndef MOCK_CGLTYPES_H
+#define MOCK_CGLTYPES_H
+
+typedef struct _CGLContextObject *CGLContextObj;
+typedef struct _CGLPixelFormatObject *CGLPixelFormatObj;
+typedef struct _CGLPBufferObject *CGLPBufferObj;
+
+typedef enum _CGLPixelFormatAttribute
+{
+   kCGLPFAAllRenderers = 1,
+   kCGLPFADoubleBuffer = 5,
+   kCGLPFAStereo = 6,
+   kCGLPFAAuxBuffers = 7,
+   kCGLPFAColorSize = 8,
+   kCGLPFAAlphaSize = 11,
+   kCGLPFADepthSize = 12,
+   kCGLPFAStencilSize = 13,
+   kCGLPFAAccumSize = 14,
+   kCGLPFAMinimumPolicy = 51,
+   kCGLPFAMaximumPolicy = 52,
+   kCGLPFAOffScreen = 53,
+   kCGLPFAFullScreen = 54,
+   kCGLPFASampleBuffers = 55,
+   kCGLPFASamples = 56,
+   kCGLPFAAuxDepthStencil = 57,
+   kCGLPFAColorFloat = 58,
+   kCGLPFAMultisample = 59,
+   kCGLPFASupersample = 60,
+   kCGLPFASampleAlpha = 61,
+   kCGLPFARendererID = 70,
+   kCGLPFASingleRenderer = 71,
+   kCGLPFANoRecovery = 72,
+   kCGLPFAAccelerated = 73,
+   kCGLPFAClosestPolicy = 74,
+   kCGLPFARobust = 75,
+   kCGLPFABackingStore = 76,
+   kCGLPFAMPSafe = 78,
+   kCGLPFAWindow = 80,
+   kCGLPFAMultiScreen = 81,
+   kCGLPFACompliant = 83,
+   kCGLPFADisplayMask = 84,
+   kCGLPFAPBuffer = 90,
+   kCGLPFARemotePBuffer = 91,
+   kCGLPFAVirtualScreenCount = 128
+} CGLPixelFormatAttribute;
+
+typedef enum _CGLError
+{
+   kCGLNoError = 0,
+   kCGLBadAttribute = 10000,
+   kCGLBadProperty = 10001,
+   kCGLBadPixelFormat = 10002,
+   kCGLBadRendererInfo = 10003,
+   kCGLBadContext = 10004,
+   kCGLBadDrawable = 10005,
+   kCGLBadDisplay = 10006,
+   kCGLBadState = 10007,
+   kCGLBadValue = 10008,
+   kCGLBadMatch = 10009,
+   kCGLBadEnumeration = 10010,
+   kCGLBadOffScreen = 10011,
+   kCGLBadFullScreen = 10012,
+   kCGLBadWindow = 10013,
+   kCGLBadAddress = 10014,
+   kCGLBadCodeModule = 10015,
+   kCGLBadAlloc = 10016,
+   kCGLBadConnection = 10017
+} CGLError;
+
+#endif /* MOCK_CGLTYPES_H */
@@ -0,0 +1,67 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#ifndef MOCK_OPENGL_H
+#define MOCK_OPENGL_H
+
+#include <OpenGL/CGLCurrent.h>
+#include <OpenGL/CGLTypes.h>
+#include <OpenGL/gl.h>
+
+extern void CGLGetVersion(GLint * majorvers, GLint * minorvers);
+
+extern CGLError CGLChoosePixelFormat(const CGLPixelFormatAttribute * attribs,
+                                     CGLPixelFormatObj * pix, GLint * npix);
+extern CGLError CGLDestroyPixelFormat(CGLPixelFormatObj pix);
+extern CGLError CGLDescribePixelFormat(CGLPixelFormatObj pix, GLint pix_num,
+                                       CGLPixelFormatAttribute attrib,
+                                       GLint * value);
+
+extern CGLError CGLCreateContext(CGLPixelFormatObj pix, CGLContextObj share,
+                                 CGLContextObj * ctx);
+extern CGLError CGLDestroyContext(CGLContextObj ctx);
+extern CGLError CGLCopyContext(CGLContextObj src, CGLContextObj dst,
+                               GLbitfield mask);
+
+extern CGLError CGLClearDrawable(CGLContextObj ctx);
+extern CGLError CGLFlushDrawable(CGLContextObj ctx);
+extern CGLError CGLSetOffScreen(CGLContextObj ctx, GLsizei width,
+                                GLsizei height, GLint rowbytes,
+                                void *baseaddr);
+
+extern CGLError CGLCreatePBuffer(GLsizei width, GLsizei height,
+                                 GLenum target, GLenum internalFormat,
+                                 GLint max_level, CGLPBufferObj * pbuffer);
+extern CGLError CGLDestroyPBuffer(CGLPBufferObj pbuffer);
+extern CGLError CGLSetPBuffer(CGLContextObj ctx, CGLPBufferObj pbuffer,
+                              GLenum face, GLint level, GLint screen);
+
+extern const char *CGLErrorString(CGLError error);
+
+#endif /* MOCK_OPENGL_H */
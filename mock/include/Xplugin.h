@@ -0,0 +1,64 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * The subset of the Xplugin interface that libGL uses.  The mock build
+ * implements it in mock/mock_xplugin.c.
+ */
+#ifndef MOCK_XPLUGIN_H
+#define MOCK_XPLUGIN_H
+
+#include <stdint.h>
+
+typedef uint32_t xp_resource_id;
+typedef xp_resource_id xp_surface_id;
+typedef uint32_t xp_client_id;
+
+typedef enum xp_error_enum
+{
+   XP_Success = 0,
+   XP_ErrorBadValue = 3,
+   XP_ErrorBadMatch = 8,
+   XP_ErrorBadAlloc = 11,
+   XP_ErrorBadSurface = 32
+} xp_error;
+
+#define XP_IN_BACKGROUND (1 << 0)
+
+extern xp_error xp_init(unsigned int options);
+extern xp_error xp_get_client_id(xp_client_id * ret_client);
+
+extern xp_error xp_import_surface(const uint32_t key[2],
+                                  xp_surface_id * ret_sid);
+extern xp_error xp_destroy_surface(xp_surface_id sid);
+
+extern xp_error xp_attach_gl_context(void *cgl_ctx, xp_surface_id sid);
+extern xp_error xp_update_gl_context(void *cgl_ctx);
+
+#endif /* MOCK_XPLUGIN_H */
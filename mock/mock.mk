@@ -0,0 +1,102 @@
+#The mock build is libGL for Linux, with the in-memory CGL and Xplugin in
+#mock/ standing in for the OpenGL framework and the XQuartz server.
+#make mock builds it in $(MOCK_BUILD_DIR), and make mock-bench runs the
+#benchmarks under Xvfb.  make mock-launch-bench runs startup_time against
+#Xvfb directly and through xdelay, which makes the display look remote.
+#make mock-test runs the mock tests against mock_xserver, which is enough
+#for the tests that need no more than XIDs from the display.
+
+MOCK_BUILD_DIR=mockbuilds
+MOCK_TCLSH=tclsh
+MOCK_API_BINDING=$(API_BINDING)
+MOCK_SYSTEM_GL_H=/usr/include/GL/gl.h
+MOCK_XVFB_RUN=xvfb-run -a -s "-screen 0 1280x1024x24 +extension GLX"
+MOCK_BENCH_ITERATIONS=10000
+MOCK_LAUNCH_DELAY_MS=10
+MOCK_LAUNCH_XVFB_DISPLAY=91
+MOCK_LAUNCH_DELAYED_DISPLAY=92
+MOCK_TEST_DISPLAY=93
+
+MOCK_CGL=$(MOCK_BUILD_DIR)/libmockcgl.so
+MOCK_LIBGL=$(MOCK_BUILD_DIR)/libGL.so.1
+
+#The mock CGL is the OpenGL framework, and the libGL that __gl_api binds.
+MOCK_CFLAGS=-Wall -ggdb3 -O2 -fPIC -DPTHREADS -D_REENTRANT -DGLX_USE_APPLEGL -DGLX_ALIAS_UNSUPPORTED $(GLX_TLS_CFLAGS) \
+  -DOPENGL_FRAMEWORK_PATH=\"$(CURDIR)/$(MOCK_CGL)\" \
+  -DOPENGL_LIB_PATH=\"$(CURDIR)/$(MOCK_CGL)\" \
+  -DLIBGLNAME=\"$(CURDIR)/$(MOCK_CGL)\" $(CFLAGS)
+
+MOCK_INCLUDE=-I$(MOCK_BUILD_DIR)/gen -I$(MOCK_BUILD_DIR)/include -Imock -Imock/include -I. -Iinclude -Iinclude/internal
+MOCK_COMPILE=$(CC) $(MOCK_INCLUDE) $(MOCK_CFLAGS) -c
+
+MOCK_OBJECTS=$(addprefix $(MOCK_BUILD_DIR)/obj/,$(filter-out appledri.o,$(OBJECTS)) \
+  mock_appledri.o mock_xplugin.o mock_display.o mock_latency.o)
+
+MOCK_GENERATED=$(MOCK_BUILD_DIR)/include/GL/gl.h $(MOCK_BUILD_DIR)/gen/apple_xgl_api.h
+
+MOCK_TESTS=$(MOCK_BUILD_DIR)/read_pbuffer
+
+.PHONY : mock mock-bench mock-launch-bench mock-test
+
+mock: $(MOCK_LIBGL) $(MOCK_CGL) $(MOCK_BUILD_DIR)/mock_bench \
+  $(MOCK_BUILD_DIR)/startup_time $(MOCK_BUILD_DIR)/xdelay \
+  $(MOCK_BUILD_DIR)/mock_xserver $(MOCK_TESTS)
+
+mock-bench: mock
+	$(MOCK_XVFB_RUN) $(MOCK_BUILD_DIR)/mock_bench $(MOCK_BENCH_ITERATIONS)
+
+mock-test: mock
+	for t in $(MOCK_TESTS); do \
+	    $(MOCK_BUILD_DIR)/mock_xserver $(MOCK_TEST_DISPLAY) $$t || exit 1; \
+	done
+
+mock-launch-bench: mock
+	tests/startup_time/launch_bench.sh $(MOCK_BUILD_DIR)/startup_time $(MOCK_BUILD_DIR)/xdelay \
+	    $(MOCK_LAUNCH_DELAY_MS) $(MOCK_LAUNCH_XVFB_DISPLAY) $(MOCK_LAUNCH_DELAYED_DISPLAY)
+
+$(MOCK_BUILD_DIR)/include/GL/gl.h: include/GL/gl.h.template
+	$(MKDIR) -p $(@D)
+	sed -e 's:/System/Library/Frameworks/OpenGL.framework/Headers/gl.h:$(MOCK_SYSTEM_GL_H):' \
+	    -e '/^@CGL_MESA_.*@$$/d' include/GL/gl.h.template > $@
+
+#The generator keeps the functions that the mock CGL exports.
+$(MOCK_BUILD_DIR)/gen/apple_xgl_api.h: $(MOCK_CGL) gen_api_header.tcl gen_api_library.tcl gen_code.tcl gen_defs.tcl gen_exports.tcl gen_funcs.tcl gen_types.tcl gen_compsize.tcl
+	$(RM) -rf $(MOCK_BUILD_DIR)/gen
+	$(MKDIR) -p $(MOCK_BUILD_DIR)/gen
+	cp -R gen_*.tcl GL_aliases GL_extensions GL_noop GL_promoted specs $(MOCK_BUILD_DIR)/gen
+	cd $(MOCK_BUILD_DIR)/gen && OPENGL_LIBGL_PATH=$(CURDIR)/$(MOCK_CGL) $(MOCK_TCLSH) gen_code.tcl $(MOCK_API_BINDING)
+
+$(MOCK_BUILD_DIR)/gen/apple_xgl_api.c: $(MOCK_BUILD_DIR)/gen/apple_xgl_api.h
+
+$(MOCK_CGL): mock/mock_cgl.c mock/mock_cgl.h mock/mock_latency.c mock/mock_latency.h $(MOCK_BUILD_DIR)/include/GL/gl.h
+	$(CC) -I$(MOCK_BUILD_DIR)/include -Imock -Imock/include -Iinclude $(MOCK_CFLAGS) -shared -Wl,-Bsymbolic -Wl,-soname,libmockcgl.so \
+	    -o $@ mock/mock_cgl.c mock/mock_latency.c -lpthread
+
+$(MOCK_LIBGL): $(MOCK_OBJECTS)
+	$(CC) -shared -Wl,-soname,libGL.so.1 -o $@ $(MOCK_OBJECTS) -lX11 -lXext -lpthread -ldl -lrt
+
+$(MOCK_BUILD_DIR)/obj/apple_xgl_api.o: $(MOCK_BUILD_DIR)/gen/apple_xgl_api.c $(MOCK_GENERATED)
+	$(MKDIR) -p $(@D)
+	$(MOCK_COMPILE) -o $@ $(MOCK_BUILD_DIR)/gen/apple_xgl_api.c
+
+$(MOCK_BUILD_DIR)/obj/%.o: mock/%.c $(MOCK_GENERATED)
+	$(MKDIR) -p $(@D)
+	$(MOCK_COMPILE) -o $@ $<
+
+$(MOCK_BUILD_DIR)/obj/%.o: %.c $(MOCK_GENERATED)
+	$(MKDIR) -p $(@D)
+	$(MOCK_COMPILE) -o $@ $<
+
+include tests/mock_bench/mock_bench.mk
+include tests/read_binding/read_pbuffer.mk
+
+$(MOCK_BUILD_DIR)/startup_time: tests/startup_time/startup_time.c $(MOCK_LIBGL) $(MOCK_CGL)
+	$(CC) tests/startup_time/startup_time.c $(MOCK_INCLUDE) $(MOCK_CFLAGS) -o $@ $(MOCK_LIBGL) $(MOCK_CGL) -Wl,-rpath,$(CURDIR)/$(MOCK_BUILD_DIR) -lX11
+
+$(MOCK_BUILD_DIR)/xdelay: tests/startup_time/xdelay.c
+	$(MKDIR) -p $(@D)
+	$(CC) $(MOCK_CFLAGS) -o $@ tests/startup_time/xdelay.c
+
+$(MOCK_BUILD_DIR)/mock_xserver: mock/mock_xserver.c
+	$(MKDIR) -p $(@D)
+	$(CC) $(MOCK_CFLAGS) -o $@ mock/mock_xserver.c
@@ -0,0 +1,452 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This replaces appledri.c in the mock build.  The Apple-DRI extension
+ * exists only in the XQuartz server, so the requests are answered here:
+ * surfaces are records keyed by drawable, and pixmap buffers are real
+ * shared memory segments, sized from the X pixmap.  Each request that
+ * has a reply in the real protocol costs an XSync round trip, plus
+ * MOCK_DRI_LATENCY_US.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <X11/Xproto.h>
+#include "appledri.h"
+#include "appledristr.h"
+#include "glxhash.h"
+#include "mock_appledri.h"
+#include "mock_latency.h"
+
+struct mock_surface
+{
+   Drawable drawable;
+   unsigned int uid;
+   int width, height;
+};
+
+/* 
+ * The reply to an async CreateSurface costs nothing if a round trip has
+ * been made since the request was sent.
+ */
+struct _XAppleDRISurfaceRequest
+{
+   Drawable drawable;
+   unsigned long round_trips;
+};
+
+static pthread_mutex_t surfaces_lock = PTHREAD_MUTEX_INITIALIZER;
+static __glxHashTable *surfaces = NULL;
+static unsigned int next_uid = 1;
+static unsigned long next_pixmap_buffer = 1;
+static unsigned long round_trips = 0;
+
+static void (*surface_notify_handler) ();
+
+static struct mock_latency latency = MOCK_LATENCY_INIT("MOCK_DRI_LATENCY_US");
+
+static void
+lock_surfaces(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&surfaces_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+
+   if (NULL == surfaces) {
+      surfaces = __glxHashCreate();
+
+      if (NULL == surfaces) {
+         fprintf(stderr, "unable to create the mock surface table\n");
+         abort();
+      }
+   }
+}
+
+static void
+unlock_surfaces(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&surfaces_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+/* A request with a reply. */
+static void
+round_trip(Display * dpy)
+{
+   XSync(dpy, False);
+   mock_latency_wait(&latency);
+   __atomic_add_fetch(&round_trips, 1, __ATOMIC_RELAXED);
+}
+
+Bool
+XAppleDRIQueryExtension(Display * dpy, int *event_basep, int *error_basep)
+{
+   /* Nothing checks these, and there are no events from the server. */
+   *event_basep = 0;
+   *error_basep = 0;
+
+   return True;
+}
+
+Bool
+XAppleDRIQueryVersion(Display * dpy, int *majorVersion, int *minorVersion,
+                      int *patchVersion)
+{
+   round_trip(dpy);
+
+   *majorVersion = APPLE_DRI_MAJOR_VERSION;
+   *minorVersion = APPLE_DRI_MINOR_VERSION;
+   *patchVersion = APPLE_DRI_PATCH_VERSION;
+
+   return True;
+}
+
+Bool
+XAppleDRIQueryDirectRenderingCapable(Display * dpy, int screen,
+                                     Bool * isCapable)
+{
+   round_trip(dpy);
+   *isCapable = True;
+
+   return True;
+}
+
+void *
+XAppleDRISetSurfaceNotifyHandler(void (*fun) ())
+{
+   void *old = surface_notify_handler;
+   surface_notify_handler = fun;
+   return old;
+}
+
+void
+mock_appledri_notify(Display * dpy, unsigned int uid, int kind)
+{
+   if (surface_notify_handler)
+      (*surface_notify_handler) (dpy, uid, kind);
+}
+
+Bool
+XAppleDRIAuthConnection(Display * dpy, int screen, unsigned int magic)
+{
+   round_trip(dpy);
+
+   return True;
+}
+
+static Bool
+create_surface(Display * dpy, Drawable drawable, unsigned int key[2],
+               unsigned int *uid)
+{
+   struct mock_surface *s;
+   Window root;
+   int x, y;
+   unsigned int width, height, border, depth;
+   void *value;
+
+   /* This fails for a bad drawable. */
+   if (!XGetGeometry(dpy, drawable, &root, &x, &y, &width, &height, &border,
+                     &depth))
+      return False;
+
+   lock_surfaces();
+
+   if (0 == __glxHashLookup(surfaces, drawable, &value)) {
+      /* The server has one surface per drawable. */
+      s = value;
+   }
+   else {
+      s = malloc(sizeof(*s));
+
+      if (NULL == s) {
+         unlock_surfaces();
+         return False;
+      }
+
+      s->drawable = drawable;
+      s->uid = next_uid++;
+
+      if (__glxHashInsert(surfaces, drawable, s)) {
+         free(s);
+         unlock_surfaces();
+         return False;
+      }
+   }
+
+   s->width = width;
+   s->height = height;
+
+   key[0] = s->uid;
+   key[1] = drawable;
+   *uid = s->uid;
+
+   unlock_surfaces();
+
+   return True;
+}
+
+Bool
+XAppleDRICreateSurface(Display * dpy, int screen, Drawable drawable,
+                       unsigned int client_id, unsigned int key[2],
+                       unsigned int *uid)
+{
+   mock_latency_wait(&latency);
+   __atomic_add_fetch(&round_trips, 1, __ATOMIC_RELAXED);
+
+   /* The XGetGeometry in create_surface is the round trip. */
+   return create_surface(dpy, drawable, key, uid);
+}
+
+XAppleDRISurfaceRequest *
+XAppleDRICreateSurfaceAsync(Display * dpy, int screen, Drawable drawable,
+                            unsigned int client_id)
+{
+   XAppleDRISurfaceRequest *r;
+
+   r = malloc(sizeof(*r));
+
+   if (NULL == r)
+      return NULL;
+
+   r->drawable = drawable;
+   r->round_trips = __atomic_load_n(&round_trips, __ATOMIC_RELAXED);
+
+   return r;
+}
+
+Bool
+XAppleDRICreateSurfaceReply(Display * dpy, XAppleDRISurfaceRequest * r,
+                            unsigned int key[2], unsigned int *uid)
+{
+   Bool result;
+
+   if (r->round_trips == __atomic_load_n(&round_trips, __ATOMIC_RELAXED))
+      round_trip(dpy);
+
+   result = create_surface(dpy, r->drawable, key, uid);
+   free(r);
+
+   return result;
+}
+
+void
+XAppleDRICancelSurfaceRequest(Display * dpy, XAppleDRISurfaceRequest * r)
+{
+   free(r);
+}
+
+static void
+destroy_surface(Drawable drawable)
+{
+   void *value;
+
+   lock_surfaces();
+
+   if (0 == __glxHashLookup(surfaces, drawable, &value)) {
+      __glxHashDelete(surfaces, drawable);
+      free(value);
+   }
+
+   unlock_surfaces();
+}
+
+Bool
+XAppleDRIDestroySurface(Display * dpy, int screen, Drawable drawable)
+{
+   /* The real request has no reply. */
+   mock_latency_wait(&latency);
+   destroy_surface(drawable);
+
+   return True;
+}
+
+bool
+mock_appledri_find_surface(const unsigned int key[2], int *width,
+                           int *height)
+{
+   struct mock_surface *s;
+   void *value;
+   bool result = false;
+
+   lock_surfaces();
+
+   if (0 == __glxHashLookup(surfaces, key[1], &value)) {
+      s = value;
+
+      if (s->uid == key[0]) {
+         *width = s->width;
+         *height = s->height;
+         result = true;
+      }
+   }
+
+   unlock_surfaces();
+
+   return result;
+}
+
+unsigned int
+mock_appledri_surface_uid(Drawable drawable)
+{
+   void *value;
+   unsigned int uid = 0;
+
+   lock_surfaces();
+
+   if (0 == __glxHashLookup(surfaces, drawable, &value))
+      uid = ((struct mock_surface *) value)->uid;
+
+   unlock_surfaces();
+
+   return uid;
+}
+
+Bool
+XAppleDRISynchronizeSurfaces(Display * dpy)
+{
+   round_trip(dpy);
+
+   return True;
+}
+
+Bool
+XAppleDRICreateSharedBuffer(Display * dpy, int screen, Drawable drawable,
+                            Bool doubleSwap, char *path, size_t pathlen,
+                            int *width, int *height)
+{
+   /* libGL doesn't use shared buffers for windows. */
+   return False;
+}
+
+Bool
+XAppleDRISwapBuffers(Display * dpy, int screen, Drawable drawable)
+{
+   mock_latency_wait(&latency);
+
+   return True;
+}
+
+Bool
+XAppleDRICreatePixmap(Display * dpy, int screen, Drawable drawable,
+                      int *width, int *height, int *pitch, int *bpp,
+                      size_t * size, char *bufname, size_t bufnamesize)
+{
+   Window root;
+   int x, y, fd;
+   unsigned int w, h, border, depth;
+   unsigned long n;
+
+   mock_latency_wait(&latency);
+
+   if (!XGetGeometry(dpy, drawable, &root, &x, &y, &w, &h, &border, &depth))
+      return False;
+
+   lock_surfaces();
+   n = next_pixmap_buffer++;
+   unlock_surfaces();
+
+   /* The server creates the segment, and the client unlinks it. */
+   snprintf(bufname, bufnamesize, "/mock-appledri-%d-%lu", (int) getpid(),
+            n);
+
+   fd = shm_open(bufname, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+
+   if (fd < 0) {
+      perror("shm_open");
+      return False;
+   }
+
+   *width = w;
+   *height = h;
+   *bpp = 32;
+   *pitch = w * 4;
+   *size = (size_t) * pitch * h;
+
+   if (ftruncate(fd, *size)) {
+      perror("ftruncate");
+      close(fd);
+      shm_unlink(bufname);
+      return False;
+   }
+
+   close(fd);
+
+   return True;
+}
+
+Bool
+XAppleDRIDestroyPixmap(Display * dpy, Pixmap pixmap)
+{
+   mock_latency_wait(&latency);
+
+   return True;
+}
+
+/* The batch pays the latency once, as it takes the display lock once. */
+Bool
+XAppleDRISendBatch(Display * dpy, const XAppleDRIBatchRequest * requests,
+                   int count)
+{
+   int i;
+
+   mock_latency_wait(&latency);
+
+   for (i = 0; i < count; ++i) {
+      switch (requests[i].kind) {
+      case AppleDRIBatchDestroySurface:
+         destroy_surface(requests[i].xid);
+         break;
+
+      case AppleDRIBatchFreePixmap:
+         XFreePixmap(dpy, requests[i].xid);
+         break;
+      }
+   }
+
+   return True;
+}
@@ -0,0 +1,51 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+#ifndef MOCK_APPLEDRI_H
+#define MOCK_APPLEDRI_H
+
+#include <stdbool.h>
+#include <X11/Xlib.h>
+
+/*
+ * The surface keys from the mock XAppleDRICreateSurface are the uid and
+ * the drawable.  Return true if the key names a live surface.
+ */
+bool mock_appledri_find_surface(const unsigned int key[2], int *width,
+                                int *height);
+
+/* Return the uid of the surface for drawable, or 0 if it has none. */
+unsigned int mock_appledri_surface_uid(Drawable drawable);
+
+/* 
+ * Deliver a surface notification as if it came from the server.  kind is
+ * AppleDRISurfaceNotifyChanged or AppleDRISurfaceNotifyDestroyed.
+ */
+void mock_appledri_notify(Display * dpy, unsigned int uid, int kind);
+
+#endif /* MOCK_APPLEDRI_H */
@@ -0,0 +1,1170 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * An in-memory stand-in for the OpenGL framework, so that the GLX layer
+ * can be built and measured on Linux.  It is loaded through
+ * OPENGL_FRAMEWORK_PATH like the real framework, and it exports the CGL
+ * calls in struct apple_cgl_api, plus the few GL calls that libGL itself
+ * makes.  Rendering is limited to glClear, with the scissor test, and
+ * glReadPixels of 32-bit pixels, which is enough to move real bytes through pixmaps, pbuffers
+ * and surfaces.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <OpenGL/CGLRenderers.h>
+#include "mock_cgl.h"
+#include "mock_latency.h"
+
+#define MOCK_MAX_SIZE 8192
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+enum mock_target
+{
+   MOCK_TARGET_NONE,
+   MOCK_TARGET_OFFSCREEN,
+   MOCK_TARGET_PBUFFER,
+   MOCK_TARGET_SURFACE
+};
+
+struct mock_pixel_format
+{
+   bool double_buffered;
+   bool stereo;
+   bool offscreen;
+   GLint color_size, alpha_size, depth_size, stencil_size, samples;
+};
+
+struct _CGLPixelFormatObject
+{
+   struct mock_pixel_format format;
+};
+
+struct _CGLPBufferObject
+{
+   GLsizei width, height;
+   GLenum target, internal_format;
+   GLint max_level;
+   GLuint *pixels;
+};
+
+/* The pack state, in the order of pack_names. */
+#define MOCK_PACK_STATE 8
+
+static const GLenum pack_names[MOCK_PACK_STATE] = {
+   GL_PACK_SWAP_BYTES, GL_PACK_LSB_FIRST, GL_PACK_ROW_LENGTH,
+   GL_PACK_SKIP_ROWS, GL_PACK_SKIP_PIXELS, GL_PACK_ALIGNMENT,
+   GL_PACK_IMAGE_HEIGHT, GL_PACK_SKIP_IMAGES
+};
+
+struct _CGLContextObject
+{
+   struct mock_pixel_format format;
+
+   GLint viewport[4];
+   GLint scissor[4];
+   GLboolean scissor_test;
+   GLenum draw_buffer, read_buffer;
+   GLfloat clear_color[4];
+   GLint pack[MOCK_PACK_STATE];
+   GLint unpack_alignment;
+   GLint pixel_pack_buffer;
+   GLint list_base;
+   GLenum error;
+
+   enum mock_target target;
+   GLsizei width, height;
+   GLint rowbytes;
+   void *base;
+   CGLPBufferObj pbuffer;
+   mock_cgl_detach_proc detached;
+};
+
+static __thread CGLContextObj current_context;
+
+static struct mock_latency latency = MOCK_LATENCY_INIT("MOCK_CGL_LATENCY_US");
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct mock_cgl_stats stats;
+
+static void
+count(unsigned long *counter, long delta)
+{
+   int err;
+
+   err = pthread_mutex_lock(&stats_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+
+   *counter += delta;
+
+   err = pthread_mutex_unlock(&stats_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+void
+MockCGLGetStats(struct mock_cgl_stats *result)
+{
+   pthread_mutex_lock(&stats_lock);
+   *result = stats;
+   pthread_mutex_unlock(&stats_lock);
+}
+
+static GLint renderer_id = kCGLRendererGenericFloatID;
+
+void
+MockCGLSetRendererID(GLint id)
+{
+   __atomic_store_n(&renderer_id, id, __ATOMIC_RELAXED);
+}
+
+void
+MockCGLResetStats(void)
+{
+   unsigned long contexts, pbuffers;
+
+   pthread_mutex_lock(&stats_lock);
+   contexts = stats.contexts;
+   pbuffers = stats.pbuffers;
+   memset(&stats, 0, sizeof(stats));
+   stats.contexts = contexts;
+   stats.pbuffers = pbuffers;
+   pthread_mutex_unlock(&stats_lock);
+}
+
+void
+CGLGetVersion(GLint * majorvers, GLint * minorvers)
+{
+   *majorvers = 1;
+   *minorvers = 2;
+}
+
+CGLError
+CGLChoosePixelFormat(const CGLPixelFormatAttribute * attribs,
+                     CGLPixelFormatObj * pix, GLint * npix)
+{
+   struct mock_pixel_format format;
+   int i;
+
+   mock_latency_wait(&latency);
+   count(&stats.choose_pixel_format, 1);
+
+   memset(&format, 0, sizeof(format));
+
+   for (i = 0; attribs[i]; ++i) {
+      switch (attribs[i]) {
+      case kCGLPFADoubleBuffer:
+         format.double_buffered = true;
+         break;
+
+      case kCGLPFAStereo:
+         format.stereo = true;
+         break;
+
+      case kCGLPFAOffScreen:
+         format.offscreen = true;
+         break;
+
+      case kCGLPFAColorSize:
+         format.color_size = attribs[++i];
+         break;
+
+      case kCGLPFAAlphaSize:
+         format.alpha_size = attribs[++i];
+         break;
+
+      case kCGLPFADepthSize:
+         format.depth_size = attribs[++i];
+         break;
+
+      case kCGLPFAStencilSize:
+         format.stencil_size = attribs[++i];
+         break;
+
+      case kCGLPFASamples:
+         format.samples = attribs[++i];
+         break;
+
+         /* These take a value that the mock ignores. */
+      case kCGLPFAAuxBuffers:
+      case kCGLPFAAccumSize:
+      case kCGLPFASampleBuffers:
+      case kCGLPFARendererID:
+      case kCGLPFADisplayMask:
+         ++i;
+         break;
+
+      default:
+         break;
+      }
+   }
+
+   *pix = malloc(sizeof(**pix));
+
+   if (NULL == *pix) {
+      *npix = 0;
+      return kCGLBadAlloc;
+   }
+
+   (*pix)->format = format;
+   *npix = 1;
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLDestroyPixelFormat(CGLPixelFormatObj pix)
+{
+   mock_latency_wait(&latency);
+
+   free(pix);
+
+   return kCGLNoError;
+}
+
+/* The mock has one virtual screen. */
+CGLError
+CGLDescribePixelFormat(CGLPixelFormatObj pix, GLint pix_num,
+                       CGLPixelFormatAttribute attrib, GLint * value)
+{
+   if (NULL == pix)
+      return kCGLBadPixelFormat;
+
+   if (0 != pix_num)
+      return kCGLBadValue;
+
+   switch (attrib) {
+   case kCGLPFARendererID:
+      *value = __atomic_load_n(&renderer_id, __ATOMIC_RELAXED);
+      break;
+
+   case kCGLPFADoubleBuffer:
+      *value = pix->format.double_buffered;
+      break;
+
+   case kCGLPFAStereo:
+      *value = pix->format.stereo;
+      break;
+
+   case kCGLPFAOffScreen:
+      *value = pix->format.offscreen;
+      break;
+
+   case kCGLPFAColorSize:
+      *value = pix->format.color_size;
+      break;
+
+   case kCGLPFAAlphaSize:
+      *value = pix->format.alpha_size;
+      break;
+
+   case kCGLPFADepthSize:
+      *value = pix->format.depth_size;
+      break;
+
+   case kCGLPFAStencilSize:
+      *value = pix->format.stencil_size;
+      break;
+
+   case kCGLPFASamples:
+      *value = pix->format.samples;
+      break;
+
+   default:
+      *value = 0;
+      break;
+   }
+
+   return kCGLNoError;
+}
+
+static void
+set_target(CGLContextObj ctx, enum mock_target target, GLsizei width,
+           GLsizei height, GLint rowbytes, void *base, CGLPBufferObj pbuffer)
+{
+   if (MOCK_TARGET_SURFACE == ctx->target && ctx->detached) {
+      ctx->detached(ctx);
+      ctx->detached = NULL;
+   }
+
+   ctx->target = target;
+   ctx->width = width;
+   ctx->height = height;
+   ctx->rowbytes = rowbytes;
+   ctx->base = base;
+   ctx->pbuffer = pbuffer;
+}
+
+static void
+init_context_state(CGLContextObj ctx)
+{
+   int i;
+
+   memset(ctx->viewport, 0, sizeof(ctx->viewport));
+   memset(ctx->scissor, 0, sizeof(ctx->scissor));
+   ctx->scissor_test = GL_FALSE;
+   ctx->draw_buffer = ctx->format.double_buffered ? GL_BACK : GL_FRONT;
+   ctx->read_buffer = ctx->draw_buffer;
+   memset(ctx->clear_color, 0, sizeof(ctx->clear_color));
+
+   for (i = 0; i < MOCK_PACK_STATE; ++i)
+      ctx->pack[i] = (GL_PACK_ALIGNMENT == pack_names[i]) ? 4 : 0;
+
+   ctx->unpack_alignment = 4;
+   ctx->pixel_pack_buffer = 0;
+   ctx->list_base = 0;
+   ctx->error = GL_NO_ERROR;
+}
+
+CGLError
+CGLCreateContext(CGLPixelFormatObj pix, CGLContextObj share,
+                 CGLContextObj * ctx)
+{
+   CGLContextObj c;
+
+   mock_latency_wait(&latency);
+
+   if (NULL == pix)
+      return kCGLBadPixelFormat;
+
+   /* The mock has no shared objects, so only the format must match. */
+   if (share && share->format.offscreen != pix->format.offscreen)
+      return kCGLBadMatch;
+
+   c = calloc(1, sizeof(*c));
+
+   if (NULL == c)
+      return kCGLBadAlloc;
+
+   c->format = pix->format;
+   c->target = MOCK_TARGET_NONE;
+   init_context_state(c);
+
+   count(&stats.create_context, 1);
+   count(&stats.contexts, 1);
+
+   *ctx = c;
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLDestroyContext(CGLContextObj ctx)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == ctx)
+      return kCGLBadContext;
+
+   if (current_context == ctx)
+      current_context = NULL;
+
+   set_target(ctx, MOCK_TARGET_NONE, 0, 0, 0, NULL, NULL);
+   free(ctx);
+
+   count(&stats.destroy_context, 1);
+   count(&stats.contexts, -1);
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLSetCurrentContext(CGLContextObj ctx)
+{
+   mock_latency_wait(&latency);
+   count(&stats.set_current_context, 1);
+
+   current_context = ctx;
+
+   return kCGLNoError;
+}
+
+CGLContextObj
+CGLGetCurrentContext(void)
+{
+   return current_context;
+}
+
+CGLError
+CGLCopyContext(CGLContextObj src, CGLContextObj dst, GLbitfield mask)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == src || NULL == dst)
+      return kCGLBadContext;
+
+   count(&stats.copy_context, 1);
+
+   if (mask & GL_VIEWPORT_BIT)
+      memcpy(dst->viewport, src->viewport, sizeof(dst->viewport));
+
+   if (mask & GL_SCISSOR_BIT) {
+      memcpy(dst->scissor, src->scissor, sizeof(dst->scissor));
+      dst->scissor_test = src->scissor_test;
+   }
+
+   if (mask & GL_COLOR_BUFFER_BIT) {
+      dst->draw_buffer = src->draw_buffer;
+      memcpy(dst->clear_color, src->clear_color, sizeof(dst->clear_color));
+   }
+
+   if (mask & GL_PIXEL_MODE_BIT)
+      dst->read_buffer = src->read_buffer;
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLClearDrawable(CGLContextObj ctx)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == ctx)
+      return kCGLBadContext;
+
+   count(&stats.clear_drawable, 1);
+   set_target(ctx, MOCK_TARGET_NONE, 0, 0, 0, NULL, NULL);
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLFlushDrawable(CGLContextObj ctx)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == ctx)
+      return kCGLBadContext;
+
+   count(&stats.flush_drawable, 1);
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLSetOffScreen(CGLContextObj ctx, GLsizei width, GLsizei height,
+                GLint rowbytes, void *baseaddr)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == ctx)
+      return kCGLBadContext;
+
+   if (!ctx->format.offscreen)
+      return kCGLBadOffScreen;
+
+   if (width < 0 || height < 0 || rowbytes < width * 4)
+      return kCGLBadValue;
+
+   count(&stats.set_off_screen, 1);
+   set_target(ctx, MOCK_TARGET_OFFSCREEN, width, height, rowbytes, baseaddr,
+              NULL);
+
+   return kCGLNoError;
+}
+
+/* The caller has already forgotten any earlier surface. */
+CGLError
+MockCGLSetSurface(CGLContextObj ctx, GLsizei width, GLsizei height,
+                  GLint rowbytes, void *base, mock_cgl_detach_proc detached)
+{
+   if (NULL == ctx)
+      return kCGLBadContext;
+
+   count(&stats.set_surface, 1);
+
+   ctx->detached = NULL;
+
+   if (base) {
+      set_target(ctx, MOCK_TARGET_SURFACE, width, height, rowbytes, base,
+                 NULL);
+      ctx->detached = detached;
+   }
+   else if (MOCK_TARGET_SURFACE == ctx->target) {
+      set_target(ctx, MOCK_TARGET_NONE, 0, 0, 0, NULL, NULL);
+   }
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLCreatePBuffer(GLsizei width, GLsizei height, GLenum target,
+                 GLenum internalFormat, GLint max_level,
+                 CGLPBufferObj * pbuffer)
+{
+   CGLPBufferObj pb;
+
+   mock_latency_wait(&latency);
+
+   if (width <= 0 || height <= 0 || width > MOCK_MAX_SIZE
+       || height > MOCK_MAX_SIZE)
+      return kCGLBadValue;
+
+   if (GL_TEXTURE_2D != target && GL_TEXTURE_RECTANGLE_EXT != target)
+      return kCGLBadEnumeration;
+
+   if (GL_RGB != internalFormat && GL_RGBA != internalFormat)
+      return kCGLBadEnumeration;
+
+   pb = malloc(sizeof(*pb));
+
+   if (NULL == pb)
+      return kCGLBadAlloc;
+
+   pb->pixels = calloc((size_t) width * height, sizeof(*pb->pixels));
+
+   if (NULL == pb->pixels) {
+      free(pb);
+      return kCGLBadAlloc;
+   }
+
+   pb->width = width;
+   pb->height = height;
+   pb->target = target;
+   pb->internal_format = internalFormat;
+   pb->max_level = max_level;
+
+   count(&stats.create_pbuffer, 1);
+   count(&stats.pbuffers, 1);
+
+   *pbuffer = pb;
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLDestroyPBuffer(CGLPBufferObj pbuffer)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == pbuffer)
+      return kCGLBadAddress;
+
+   free(pbuffer->pixels);
+   free(pbuffer);
+
+   count(&stats.destroy_pbuffer, 1);
+   count(&stats.pbuffers, -1);
+
+   return kCGLNoError;
+}
+
+CGLError
+CGLSetPBuffer(CGLContextObj ctx, CGLPBufferObj pbuffer, GLenum face,
+              GLint level, GLint screen)
+{
+   mock_latency_wait(&latency);
+
+   if (NULL == ctx)
+      return kCGLBadContext;
+
+   if (NULL == pbuffer)
+      return kCGLBadAddress;
+
+   if (level > pbuffer->max_level)
+      return kCGLBadValue;
+
+   count(&stats.set_pbuffer, 1);
+   set_target(ctx, MOCK_TARGET_PBUFFER, pbuffer->width, pbuffer->height,
+              pbuffer->width * sizeof(*pbuffer->pixels), pbuffer->pixels,
+              pbuffer);
+
+   return kCGLNoError;
+}
+
+const char *
+CGLErrorString(CGLError error)
+{
+   switch (error) {
+   case kCGLNoError:
+      return "no error";
+   case kCGLBadAttribute:
+      return "invalid pixel format attribute";
+   case kCGLBadPixelFormat:
+      return "invalid pixel format";
+   case kCGLBadContext:
+      return "invalid context";
+   case kCGLBadValue:
+      return "invalid numerical value";
+   case kCGLBadMatch:
+      return "invalid share context";
+   case kCGLBadEnumeration:
+      return "invalid enumerant";
+   case kCGLBadOffScreen:
+      return "invalid offscreen drawable";
+   case kCGLBadAddress:
+      return "invalid pointer";
+   case kCGLBadAlloc:
+      return "invalid memory allocation";
+   default:
+      return "unknown error";
+   }
+}
+
+/* 
+ * The GL calls below act on the current context of the calling thread,
+ * and quietly do nothing without one.
+ */
+
+static void
+set_error(CGLContextObj ctx, GLenum error)
+{
+   if (GL_NO_ERROR == ctx->error)
+      ctx->error = error;
+}
+
+GLenum
+glGetError(void)
+{
+   CGLContextObj ctx = current_context;
+   GLenum error;
+
+   if (NULL == ctx)
+      return GL_NO_ERROR;
+
+   error = ctx->error;
+   ctx->error = GL_NO_ERROR;
+
+   return error;
+}
+
+const GLubyte *
+glGetString(GLenum name)
+{
+   switch (name) {
+   case GL_VENDOR:
+      return (const GLubyte *) "AppleSGLX mock";
+   case GL_RENDERER:
+      return (const GLubyte *) "Mock CGL";
+   case GL_VERSION:
+      return (const GLubyte *) "2.1 Mock";
+   case GL_EXTENSIONS:
+      return (const GLubyte *) "GL_ARB_texture_rectangle "
+         "GL_EXT_texture_rectangle GL_ARB_pixel_buffer_object";
+   default:
+      return NULL;
+   }
+}
+
+void
+glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+   CGLContextObj ctx = current_context;
+
+   if (NULL == ctx)
+      return;
+
+   ctx->viewport[0] = x;
+   ctx->viewport[1] = y;
+   ctx->viewport[2] = width;
+   ctx->viewport[3] = height;
+}
+
+void
+glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+   CGLContextObj ctx = current_context;
+
+   if (NULL == ctx)
+      return;
+
+   ctx->scissor[0] = x;
+   ctx->scissor[1] = y;
+   ctx->scissor[2] = width;
+   ctx->scissor[3] = height;
+}
+
+/* The scissor test is the only capability of the mock. */
+void
+glEnable(GLenum cap)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx && GL_SCISSOR_TEST == cap)
+      ctx->scissor_test = GL_TRUE;
+}
+
+void
+glDisable(GLenum cap)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx && GL_SCISSOR_TEST == cap)
+      ctx->scissor_test = GL_FALSE;
+}
+
+GLboolean
+glIsEnabled(GLenum cap)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx && GL_SCISSOR_TEST == cap)
+      return ctx->scissor_test;
+
+   return GL_FALSE;
+}
+
+void
+glDrawBuffer(GLenum mode)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx)
+      ctx->draw_buffer = mode;
+}
+
+void
+glDrawBuffers(GLsizei n, const GLenum * bufs)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx && n > 0)
+      ctx->draw_buffer = bufs[0];
+}
+
+void
+glReadBuffer(GLenum mode)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx)
+      ctx->read_buffer = mode;
+}
+
+void
+glBindBuffer(GLenum target, GLuint buffer)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx && GL_PIXEL_PACK_BUFFER == target)
+      ctx->pixel_pack_buffer = buffer;
+}
+
+void
+glPixelStorei(GLenum pname, GLint param)
+{
+   CGLContextObj ctx = current_context;
+   int i;
+
+   if (NULL == ctx)
+      return;
+
+   if (GL_UNPACK_ALIGNMENT == pname) {
+      ctx->unpack_alignment = param;
+      return;
+   }
+
+   for (i = 0; i < MOCK_PACK_STATE; ++i) {
+      if (pack_names[i] == pname) {
+         ctx->pack[i] = param;
+         return;
+      }
+   }
+}
+
+void
+glPixelStoref(GLenum pname, GLfloat param)
+{
+   glPixelStorei(pname, (GLint) param);
+}
+
+void
+glBindBufferARB(GLenum target, GLuint buffer)
+{
+   glBindBuffer(target, buffer);
+}
+
+/* There are no buffer objects, but deleting the bound one unbinds it. */
+void
+glDeleteBuffers(GLsizei n, const GLuint * buffers)
+{
+   CGLContextObj ctx = current_context;
+   GLsizei i;
+
+   if (NULL == ctx)
+      return;
+
+   for (i = 0; i < n; ++i)
+      if (buffers[i] == ctx->pixel_pack_buffer)
+         ctx->pixel_pack_buffer = 0;
+}
+
+void
+glDeleteBuffersARB(GLsizei n, const GLuint * buffers)
+{
+   glDeleteBuffers(n, buffers);
+}
+
+/* The mock has no attribute stacks, pixel transfer or imaging subset. */
+void
+glPopAttrib(void)
+{
+}
+
+void
+glPopClientAttrib(void)
+{
+}
+
+void
+glPixelTransferi(GLenum pname, GLint param)
+{
+}
+
+void
+glPixelTransferf(GLenum pname, GLfloat param)
+{
+}
+
+void
+glPixelZoom(GLfloat xfactor, GLfloat yfactor)
+{
+}
+
+void
+glColorTableParameterfv(GLenum target, GLenum pname, const GLfloat * params)
+{
+}
+
+void
+glColorTableParameteriv(GLenum target, GLenum pname, const GLint * params)
+{
+}
+
+void
+glConvolutionParameterf(GLenum target, GLenum pname, GLfloat params)
+{
+}
+
+void
+glConvolutionParameterfv(GLenum target, GLenum pname, const GLfloat * params)
+{
+}
+
+void
+glConvolutionParameteri(GLenum target, GLenum pname, GLint params)
+{
+}
+
+void
+glConvolutionParameteriv(GLenum target, GLenum pname, const GLint * params)
+{
+}
+
+static GLint
+get_pack(CGLContextObj ctx, GLenum pname)
+{
+   int i;
+
+   for (i = 0; i < MOCK_PACK_STATE; ++i)
+      if (pack_names[i] == pname)
+         return ctx->pack[i];
+
+   return 0;
+}
+
+void
+glGetIntegerv(GLenum pname, GLint * params)
+{
+   CGLContextObj ctx = current_context;
+   int i;
+
+   if (NULL == ctx)
+      return;
+
+   switch (pname) {
+   case GL_VIEWPORT:
+      memcpy(params, ctx->viewport, sizeof(ctx->viewport));
+      return;
+
+   case GL_SCISSOR_BOX:
+      memcpy(params, ctx->scissor, sizeof(ctx->scissor));
+      return;
+
+   case GL_MAX_VIEWPORT_DIMS:
+      params[0] = MOCK_MAX_SIZE;
+      params[1] = MOCK_MAX_SIZE;
+      return;
+
+   case GL_MAX_TEXTURE_SIZE:
+   case GL_MAX_RECTANGLE_TEXTURE_SIZE_ARB:
+      params[0] = MOCK_MAX_SIZE;
+      return;
+
+   case GL_DRAW_BUFFER:
+      params[0] = ctx->draw_buffer;
+      return;
+
+   case GL_READ_BUFFER:
+      params[0] = ctx->read_buffer;
+      return;
+
+   case GL_DOUBLEBUFFER:
+      params[0] = ctx->format.double_buffered;
+      return;
+
+   case GL_STEREO:
+      params[0] = ctx->format.stereo;
+      return;
+
+   case GL_UNPACK_ALIGNMENT:
+      params[0] = ctx->unpack_alignment;
+      return;
+
+   case GL_PIXEL_PACK_BUFFER_BINDING:
+      params[0] = ctx->pixel_pack_buffer;
+      return;
+   }
+
+   for (i = 0; i < MOCK_PACK_STATE; ++i) {
+      if (pack_names[i] == pname) {
+         params[0] = ctx->pack[i];
+         return;
+      }
+   }
+
+   set_error(ctx, GL_INVALID_ENUM);
+}
+
+void
+glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+   CGLContextObj ctx = current_context;
+
+   if (NULL == ctx)
+      return;
+
+   ctx->clear_color[0] = red;
+   ctx->clear_color[1] = green;
+   ctx->clear_color[2] = blue;
+   ctx->clear_color[3] = alpha;
+}
+
+static GLubyte
+to_ubyte(GLfloat f)
+{
+   if (f <= 0.0f)
+      return 0;
+
+   if (f >= 1.0f)
+      return 255;
+
+   return (GLubyte) (f * 255.0f + 0.5f);
+}
+
+/* The mock stores BGRA, the native order of the pixmap buffers. */
+void
+glClear(GLbitfield mask)
+{
+   CGLContextObj ctx = current_context;
+   GLuint pixel;
+   GLubyte *row;
+   GLsizei x, y, x0 = 0, y0 = 0, x1, y1;
+
+   if (NULL == ctx || !(mask & GL_COLOR_BUFFER_BIT) || NULL == ctx->base)
+      return;
+
+   x1 = ctx->width;
+   y1 = ctx->height;
+
+   if (ctx->scissor_test) {
+      x0 = MAX(ctx->scissor[0], 0);
+      y0 = MAX(ctx->scissor[1], 0);
+      x1 = MIN(ctx->scissor[0] + ctx->scissor[2], x1);
+      y1 = MIN(ctx->scissor[1] + ctx->scissor[3], y1);
+   }
+
+   pixel = (GLuint) to_ubyte(ctx->clear_color[2])
+      | ((GLuint) to_ubyte(ctx->clear_color[1]) << 8)
+      | ((GLuint) to_ubyte(ctx->clear_color[0]) << 16)
+      | ((GLuint) to_ubyte(ctx->clear_color[3]) << 24);
+
+   /* Rows are bottom-up in GL, and top-down in the buffer. */
+   for (y = y0; y < y1; ++y) {
+      row = (GLubyte *) ctx->base + (size_t) (ctx->height - 1 - y)
+         * ctx->rowbytes;
+
+      for (x = x0; x < x1; ++x)
+         ((GLuint *) row)[x] = pixel;
+   }
+}
+
+void
+glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height,
+             GLenum format, GLenum type, GLvoid * pixels)
+{
+   CGLContextObj ctx = current_context;
+   GLint row_length, alignment, skip_rows, skip_pixels, stride;
+   const GLubyte *src;
+   GLubyte *dst;
+   GLuint pixel;
+   GLsizei i, j;
+
+   if (NULL == ctx)
+      return;
+
+   count(&stats.read_pixels, 1);
+
+   if ((GL_BGRA != format && GL_RGBA != format)
+       || (GL_UNSIGNED_BYTE != type && GL_UNSIGNED_INT_8_8_8_8_REV != type)) {
+      set_error(ctx, GL_INVALID_ENUM);
+      return;
+   }
+
+   if (ctx->pixel_pack_buffer) {
+      /* There are no buffer objects in the mock. */
+      set_error(ctx, GL_INVALID_OPERATION);
+      return;
+   }
+
+   if (width < 0 || height < 0) {
+      set_error(ctx, GL_INVALID_VALUE);
+      return;
+   }
+
+   row_length = get_pack(ctx, GL_PACK_ROW_LENGTH);
+   alignment = get_pack(ctx, GL_PACK_ALIGNMENT);
+   skip_rows = get_pack(ctx, GL_PACK_SKIP_ROWS);
+   skip_pixels = get_pack(ctx, GL_PACK_SKIP_PIXELS);
+
+   stride = ((row_length > 0) ? row_length : width) * 4;
+
+   if (alignment > 4)
+      stride = (stride + alignment - 1) / alignment * alignment;
+
+   for (j = 0; j < height; ++j) {
+      dst = (GLubyte *) pixels + (size_t) (skip_rows + j) * stride
+         + (size_t) skip_pixels * 4;
+
+      for (i = 0; i < width; ++i, dst += 4) {
+         pixel = 0;
+
+         /* Rows are bottom-up in GL, and top-down in the buffer. */
+         if (ctx->base && x + i >= 0 && x + i < ctx->width
+             && y + j >= 0 && y + j < ctx->height) {
+            src = (const GLubyte *) ctx->base
+               + (size_t) (ctx->height - 1 - (y + j)) * ctx->rowbytes;
+            pixel = ((const GLuint *) src)[x + i];
+         }
+
+         if (GL_RGBA == format)
+            pixel = (pixel & 0xff00ff00)
+               | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+
+         memcpy(dst, &pixel, 4);
+      }
+   }
+}
+
+void
+glCopyPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum type)
+{
+}
+
+void
+glCopyColorTable(GLenum target, GLenum internalformat, GLint x, GLint y,
+                 GLsizei width)
+{
+}
+
+void
+glBitmap(GLsizei width, GLsizei height, GLfloat xorig, GLfloat yorig,
+         GLfloat xmove, GLfloat ymove, const GLubyte * bitmap)
+{
+}
+
+GLuint
+glGenLists(GLsizei range)
+{
+   static GLuint next_list = 1;
+   GLuint first;
+
+   pthread_mutex_lock(&stats_lock);
+   first = next_list;
+   next_list += range;
+   pthread_mutex_unlock(&stats_lock);
+
+   return first;
+}
+
+void
+glNewList(GLuint list, GLenum mode)
+{
+}
+
+void
+glEndList(void)
+{
+}
+
+void
+glCallList(GLuint list)
+{
+}
+
+void
+glCallLists(GLsizei n, GLenum type, const GLvoid * lists)
+{
+}
+
+void
+glListBase(GLuint base)
+{
+   CGLContextObj ctx = current_context;
+
+   if (ctx)
+      ctx->list_base = base;
+}
+
+void
+glFlush(void)
+{
+   mock_latency_wait(&latency);
+}
+
+void
+glFinish(void)
+{
+   mock_latency_wait(&latency);
+}
@@ -0,0 +1,65 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+#ifndef MOCK_CGL_H
+#define MOCK_CGL_H
+
+#include <OpenGL/OpenGL.h>
+
+/* Call counts and live object counts, for the benchmarks. */
+struct mock_cgl_stats
+{
+   unsigned long choose_pixel_format;
+   unsigned long create_context, destroy_context;
+   unsigned long set_current_context;
+   unsigned long copy_context;
+   unsigned long set_off_screen, set_pbuffer, set_surface;
+   unsigned long clear_drawable, flush_drawable;
+   unsigned long create_pbuffer, destroy_pbuffer;
+   unsigned long read_pixels;
+   unsigned long contexts, pbuffers;
+};
+
+void MockCGLGetStats(struct mock_cgl_stats *stats);
+void MockCGLResetStats(void);
+
+/* This sets the renderer that the pixel formats describe. */
+void MockCGLSetRendererID(GLint renderer_id);
+
+/* 
+ * This is how mock_xplugin.c attaches a surface's memory to a context.
+ * A NULL base detaches it.  detached is called when a CGL call, such as
+ * CGLClearDrawable or CGLDestroyContext, drops the surface instead.
+ */
+typedef void (*mock_cgl_detach_proc) (CGLContextObj ctx);
+
+CGLError MockCGLSetSurface(CGLContextObj ctx, GLsizei width, GLsizei height,
+                           GLint rowbytes, void *base,
+                           mock_cgl_detach_proc detached);
+
+#endif /* MOCK_CGL_H */
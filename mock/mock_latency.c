@@ -0,0 +1,63 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <stdlib.h>
+#include <time.h>
+#include "mock_latency.h"
+
+/*
+ * This spins rather than sleeps, so that the cost looks like a call into
+ * the framework rather than a reschedule.
+ */
+void
+mock_latency_wait(struct mock_latency *l)
+{
+   struct timespec start, now;
+   const char *value;
+   long elapsed;
+
+   if (l->usec < 0) {
+      value = getenv(l->variable);
+      l->usec = value ? strtol(value, NULL, 10) : 0;
+
+      if (l->usec < 0)
+         l->usec = 0;
+   }
+
+   if (0 == l->usec)
+      return;
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+
+   do {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      elapsed = (now.tv_sec - start.tv_sec) * 1000000L
+         + (now.tv_nsec - start.tv_nsec) / 1000L;
+   } while (elapsed < l->usec);
+}
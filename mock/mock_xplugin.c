@@ -0,0 +1,331 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * The Xplugin calls that libGL makes, for the mock build.  An imported
+ * surface owns the memory that its attached contexts draw into, and
+ * hands it to the mock CGL through MockCGLSetSurface.  Each call costs
+ * MOCK_XP_LATENCY_US.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dlfcn.h>
+#include <Xplugin.h>
+#include "apple_cgl.h"
+#include "glxhash.h"
+#include "mock_appledri.h"
+#include "mock_cgl.h"
+#include "mock_latency.h"
+
+struct mock_xp_attachment
+{
+   CGLContextObj context;
+   struct mock_xp_attachment *next;
+};
+
+struct mock_xp_surface
+{
+   xp_surface_id id;
+   int width, height;
+   void *pixels;
+   struct mock_xp_attachment *attachments;
+};
+
+static pthread_mutex_t xp_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Surfaces by id, and the surface that each context is attached to. */
+static __glxHashTable *surfaces = NULL;
+static __glxHashTable *attached = NULL;
+static xp_surface_id next_surface_id = 1;
+
+static CGLError(*set_surface) (CGLContextObj ctx, GLsizei width,
+                               GLsizei height, GLint rowbytes, void *base,
+                               mock_cgl_detach_proc detached);
+
+static void detached(CGLContextObj context);
+
+static struct mock_latency latency = MOCK_LATENCY_INIT("MOCK_XP_LATENCY_US");
+
+static void
+lock_xp(void)
+{
+   int err;
+
+   err = pthread_mutex_lock(&xp_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_lock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+static void
+unlock_xp(void)
+{
+   int err;
+
+   err = pthread_mutex_unlock(&xp_lock);
+
+   if (err) {
+      fprintf(stderr, "pthread_mutex_unlock failure in %s: %d\n",
+              __func__, err);
+      abort();
+   }
+}
+
+xp_error
+xp_init(unsigned int options)
+{
+   mock_latency_wait(&latency);
+
+   lock_xp();
+
+   if (NULL == surfaces) {
+      surfaces = __glxHashCreate();
+      attached = __glxHashCreate();
+   }
+
+   unlock_xp();
+
+   if (NULL == surfaces || NULL == attached)
+      return XP_ErrorBadAlloc;
+
+   return XP_Success;
+}
+
+xp_error
+xp_get_client_id(xp_client_id * ret_client)
+{
+   mock_latency_wait(&latency);
+
+   *ret_client = (xp_client_id) getpid();
+
+   return XP_Success;
+}
+
+/* The mock CGL is loaded by apple_cgl_init, before any surface exists. */
+static void
+init_set_surface(void)
+{
+   if (NULL == set_surface) {
+      set_surface = dlsym(apple_cgl_get_dl_handle(), "MockCGLSetSurface");
+
+      if (NULL == set_surface) {
+         fprintf(stderr, "error: the OpenGL framework isn't the mock: %s\n",
+                 dlerror());
+         abort();
+      }
+   }
+}
+
+xp_error
+xp_import_surface(const uint32_t key[2], xp_surface_id * ret_sid)
+{
+   struct mock_xp_surface *s;
+   int width, height;
+
+   mock_latency_wait(&latency);
+
+   if (!mock_appledri_find_surface(key, &width, &height))
+      return XP_ErrorBadValue;
+
+   s = malloc(sizeof(*s));
+
+   if (NULL == s)
+      return XP_ErrorBadAlloc;
+
+   s->width = width;
+   s->height = height;
+   s->attachments = NULL;
+   s->pixels = calloc((size_t) width * height, 4);
+
+   if (NULL == s->pixels) {
+      free(s);
+      return XP_ErrorBadAlloc;
+   }
+
+   lock_xp();
+
+   s->id = next_surface_id++;
+
+   if (__glxHashInsert(surfaces, s->id, s)) {
+      unlock_xp();
+      free(s->pixels);
+      free(s);
+      return XP_ErrorBadAlloc;
+   }
+
+   unlock_xp();
+
+   *ret_sid = s->id;
+
+   return XP_Success;
+}
+
+/* This must be called with the xp_lock held. */
+static void
+detach(CGLContextObj context)
+{
+   struct mock_xp_surface *s;
+   struct mock_xp_attachment **a, *dead;
+   void *value;
+
+   if (__glxHashLookup(attached, (unsigned long) context, &value))
+      return;
+
+   s = value;
+   __glxHashDelete(attached, (unsigned long) context);
+
+   for (a = &s->attachments; *a; a = &(*a)->next) {
+      if (context == (*a)->context) {
+         dead = *a;
+         *a = dead->next;
+         free(dead);
+         break;
+      }
+   }
+}
+
+/* The mock CGL calls this when the context drops the surface by itself. */
+static void
+detached(CGLContextObj context)
+{
+   lock_xp();
+   detach(context);
+   unlock_xp();
+}
+
+xp_error
+xp_destroy_surface(xp_surface_id sid)
+{
+   struct mock_xp_surface *s;
+   struct mock_xp_attachment *a, *next;
+   void *value;
+
+   mock_latency_wait(&latency);
+
+   lock_xp();
+
+   if (__glxHashLookup(surfaces, sid, &value)) {
+      unlock_xp();
+      return XP_ErrorBadSurface;
+   }
+
+   s = value;
+   __glxHashDelete(surfaces, sid);
+
+   /* The contexts lose their drawable with the surface. */
+   for (a = s->attachments; a; a = next) {
+      next = a->next;
+      __glxHashDelete(attached, (unsigned long) a->context);
+      set_surface(a->context, 0, 0, 0, NULL, NULL);
+      free(a);
+   }
+
+   unlock_xp();
+
+   free(s->pixels);
+   free(s);
+
+   return XP_Success;
+}
+
+xp_error
+xp_attach_gl_context(void *cgl_ctx, xp_surface_id sid)
+{
+   CGLContextObj context = cgl_ctx;
+   struct mock_xp_surface *s;
+   struct mock_xp_attachment *a;
+   void *value;
+
+   mock_latency_wait(&latency);
+   init_set_surface();
+
+   lock_xp();
+
+   detach(context);
+
+   if (0 == sid) {
+      set_surface(context, 0, 0, 0, NULL, NULL);
+      unlock_xp();
+      return XP_Success;
+   }
+
+   if (__glxHashLookup(surfaces, sid, &value)) {
+      unlock_xp();
+      return XP_ErrorBadSurface;
+   }
+
+   s = value;
+
+   a = malloc(sizeof(*a));
+
+   if (NULL == a || __glxHashInsert(attached, (unsigned long) context, s)) {
+      free(a);
+      unlock_xp();
+      return XP_ErrorBadAlloc;
+   }
+
+   a->context = context;
+   a->next = s->attachments;
+   s->attachments = a;
+
+   set_surface(context, s->width, s->height, s->width * 4, s->pixels,
+               detached);
+
+   unlock_xp();
+
+   return XP_Success;
+}
+
+xp_error
+xp_update_gl_context(void *cgl_ctx)
+{
+   CGLContextObj context = cgl_ctx;
+   struct mock_xp_surface *s;
+   void *value;
+
+   mock_latency_wait(&latency);
+
+   lock_xp();
+
+   if (0 == __glxHashLookup(attached, (unsigned long) context, &value)) {
+      s = value;
+      set_surface(context, s->width, s->height, s->width * 4, s->pixels,
+               detached);
+   }
+
+   unlock_xp();
+
+   return XP_Success;
+}
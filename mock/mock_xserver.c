@@ -0,0 +1,506 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This is an X server that only has the connection setup, and answers
+ * the core requests with empty replies.  It's enough for the mock tests
+ * that need XIDs and round trips, but no rendering or extensions, so they
+ * don't need Xvfb.  It runs the command with DISPLAY set to the display,
+ * serves it until it exits, and exits with its status.
+ *
+ * usage: mock_xserver display command [argument ...]
+ *
+ * The display is a number, and uses the local socket directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define SOCKET_DIRECTORY "/tmp/.X11-unix"
+#define SOCKET_FORMAT SOCKET_DIRECTORY "/X%d"
+#define MAX_CLIENTS 16
+
+#define VENDOR "mock_xserver"
+#define RESOURCE_BASE 0x00200000
+#define RESOURCE_MASK 0x001fffff
+#define ROOT_WINDOW 0x00000100
+#define ROOT_COLORMAP 0x00000101
+#define ROOT_VISUAL 0x00000102
+#define ROOT_WIDTH 1280
+#define ROOT_HEIGHT 1024
+
+#define BAD_IMPLEMENTATION 17
+
+struct client
+{
+   int fd;
+   bool set_up;
+   bool big_endian;
+   unsigned short sequence;
+   unsigned char *in;
+   size_t in_length, in_size;
+};
+
+/* 
+ * These requests have a reply that's only the 32 byte header, so a
+ * zeroed one is valid.  The other core requests with replies get a
+ * BadImplementation error instead.
+ */
+static const unsigned char empty_replies[] = {
+   14,                          /* GetGeometry */
+   15,                          /* QueryTree */
+   16,                          /* InternAtom */
+   17,                          /* GetAtomName */
+   20,                          /* GetProperty */
+   21,                          /* ListProperties */
+   23,                          /* GetSelectionOwner */
+   38,                          /* QueryPointer */
+   40,                          /* TranslateCoordinates */
+   43,                          /* GetInputFocus */
+   49,                          /* ListFonts */
+   52,                          /* GetFontPath */
+   83,                          /* ListInstalledColormaps */
+   97,                          /* QueryBestSize */
+   98,                          /* QueryExtension */
+   99,                          /* ListExtensions */
+   101,                         /* GetKeyboardMapping */
+   106,                         /* GetPointerControl */
+   108,                         /* GetScreenSaver */
+   110,                         /* ListHosts */
+   117,                         /* GetPointerMapping */
+   119                          /* GetModifierMapping */
+};
+
+static const unsigned char other_replies[] = {
+   3, 26, 31, 39, 44, 47, 48, 50, 73, 84, 85, 86, 87, 91, 92, 103, 116, 118
+};
+
+static bool
+has_opcode(const unsigned char *opcodes, size_t count, unsigned char opcode)
+{
+   size_t i;
+
+   for (i = 0; i < count; ++i) {
+      if (opcodes[i] == opcode)
+         return true;
+   }
+
+   return false;
+}
+
+static void
+put16(struct client *c, unsigned char *p, unsigned int v)
+{
+   if (c->big_endian) {
+      p[0] = v >> 8;
+      p[1] = v;
+   }
+   else {
+      p[0] = v;
+      p[1] = v >> 8;
+   }
+}
+
+static void
+put32(struct client *c, unsigned char *p, unsigned long v)
+{
+   if (c->big_endian) {
+      put16(c, p, v >> 16);
+      put16(c, p + 2, v);
+   }
+   else {
+      put16(c, p, v);
+      put16(c, p + 2, v >> 16);
+   }
+}
+
+static unsigned int
+get16(struct client *c, const unsigned char *p)
+{
+   return c->big_endian ? (p[0] << 8 | p[1]) : (p[1] << 8 | p[0]);
+}
+
+static size_t
+pad4(size_t length)
+{
+   return (length + 3) & ~(size_t) 3;
+}
+
+/* Return true if an error occurred. */
+static bool
+write_all(int fd, const unsigned char *data, size_t length)
+{
+   ssize_t n;
+
+   while (length > 0) {
+      n = write(fd, data, length);
+
+      if (n < 0 && EINTR == errno)
+         continue;
+
+      if (n <= 0)
+         return true;
+
+      data += n;
+      length -= n;
+   }
+
+   return false;
+}
+
+/* 
+ * The setup has one screen, with one 24 bit TrueColor visual, and no
+ * extensions.  Return true if an error occurred.
+ */
+static bool
+send_setup(struct client *c)
+{
+   unsigned char reply[256], *p;
+   size_t vendor_length = strlen(VENDOR), length;
+
+   memset(reply, 0, sizeof(reply));
+
+   /* The connection setup. */
+   p = reply + 8;
+   put32(c, p, 0);              /* release */
+   put32(c, p + 4, RESOURCE_BASE);
+   put32(c, p + 8, RESOURCE_MASK);
+   put16(c, p + 16, vendor_length);
+   put16(c, p + 18, 65535);     /* maximum request length */
+   p[20] = 1;                   /* roots */
+   p[21] = 1;                   /* pixmap formats */
+   p[22] = c->big_endian;       /* image byte order */
+   p[23] = c->big_endian;       /* bitmap bit order */
+   p[24] = 32;                  /* bitmap scanline unit */
+   p[25] = 32;                  /* bitmap scanline pad */
+   p[26] = 8;                   /* min keycode */
+   p[27] = 255;                 /* max keycode */
+   p += 32;
+
+   memcpy(p, VENDOR, vendor_length);
+   p += pad4(vendor_length);
+
+   /* The pixmap format. */
+   p[0] = 24;
+   p[1] = 32;
+   p[2] = 32;
+   p += 8;
+
+   /* The root. */
+   put32(c, p, ROOT_WINDOW);
+   put32(c, p + 4, ROOT_COLORMAP);
+   put32(c, p + 8, 0xffffff);   /* white pixel */
+   put32(c, p + 12, 0);         /* black pixel */
+   put16(c, p + 20, ROOT_WIDTH);
+   put16(c, p + 22, ROOT_HEIGHT);
+   put16(c, p + 24, ROOT_WIDTH / 4);
+   put16(c, p + 26, ROOT_HEIGHT / 4);
+   put16(c, p + 28, 1);         /* min installed maps */
+   put16(c, p + 30, 1);         /* max installed maps */
+   put32(c, p + 32, ROOT_VISUAL);
+   p[38] = 24;                  /* depth */
+   p[39] = 1;                   /* depths */
+   p += 40;
+
+   /* The depth. */
+   p[0] = 24;
+   put16(c, p + 2, 1);          /* visuals */
+   p += 8;
+
+   /* The visual. */
+   put32(c, p, ROOT_VISUAL);
+   p[4] = 4;                    /* TrueColor */
+   p[5] = 8;                    /* bits per RGB value */
+   put16(c, p + 6, 256);        /* colormap entries */
+   put32(c, p + 8, 0xff0000);
+   put32(c, p + 12, 0x00ff00);
+   put32(c, p + 16, 0x0000ff);
+   p += 24;
+
+   length = p - reply;
+
+   /* The prefix. */
+   reply[0] = 1;                /* success */
+   put16(c, reply + 2, 11);     /* protocol major version */
+   put16(c, reply + 4, 0);      /* protocol minor version */
+   put16(c, reply + 6, (length - 8) / 4);
+
+   return write_all(c->fd, reply, length);
+}
+
+/* Return true if an error occurred. */
+static bool
+answer(struct client *c, unsigned char opcode)
+{
+   unsigned char reply[32];
+
+   memset(reply, 0, sizeof(reply));
+
+   if (has_opcode(empty_replies, sizeof(empty_replies), opcode)) {
+      reply[0] = 1;             /* X_Reply */
+      put16(c, reply + 2, c->sequence);
+   }
+   else if (opcode >= 128
+            || has_opcode(other_replies, sizeof(other_replies), opcode)) {
+      reply[0] = 0;             /* X_Error */
+      reply[1] = BAD_IMPLEMENTATION;
+      put16(c, reply + 2, c->sequence);
+      reply[10] = opcode;
+   }
+   else {
+      return false;
+   }
+
+   return write_all(c->fd, reply, sizeof(reply));
+}
+
+/* Handle the complete requests that were read.  Return true on error. */
+static bool
+process(struct client *c)
+{
+   size_t offset = 0, length;
+
+   for (;;) {
+      if (!c->set_up) {
+         if (c->in_length - offset < 12)
+            break;
+
+         c->big_endian = ('B' == c->in[offset]);
+
+         length = 12 + pad4(get16(c, c->in + offset + 6))
+            + pad4(get16(c, c->in + offset + 8));
+
+         if (c->in_length - offset < length)
+            break;
+
+         if (send_setup(c))
+            return true;
+
+         c->set_up = true;
+      }
+      else {
+         if (c->in_length - offset < 4)
+            break;
+
+         /* The BIG-REQUESTS extension isn't there, so 0 is invalid. */
+         length = 4 * (size_t) get16(c, c->in + offset + 2);
+
+         if (0 == length)
+            return true;
+
+         if (c->in_length - offset < length)
+            break;
+
+         ++c->sequence;
+
+         if (answer(c, c->in[offset]))
+            return true;
+      }
+
+      offset += length;
+   }
+
+   memmove(c->in, c->in + offset, c->in_length - offset);
+   c->in_length -= offset;
+
+   return false;
+}
+
+/* Return true at the end of the stream, or on an error. */
+static bool
+read_client(struct client *c)
+{
+   unsigned char *in;
+   ssize_t n;
+
+   if (c->in_size - c->in_length < 4096) {
+      in = realloc(c->in, c->in_size + 65536);
+
+      if (NULL == in)
+         return true;
+
+      c->in = in;
+      c->in_size += 65536;
+   }
+
+   n = read(c->fd, c->in + c->in_length, c->in_size - c->in_length);
+
+   if (n < 0 && EINTR == errno)
+      return false;
+
+   if (n <= 0)
+      return true;
+
+   c->in_length += n;
+
+   return process(c);
+}
+
+static int
+listen_display(int display, struct sockaddr_un *addr)
+{
+   int fd;
+
+   (void) mkdir(SOCKET_DIRECTORY, 01777);
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   if (fd < 0)
+      return -1;
+
+   memset(addr, 0, sizeof(*addr));
+   addr->sun_family = AF_UNIX;
+   snprintf(addr->sun_path, sizeof(addr->sun_path), SOCKET_FORMAT, display);
+   unlink(addr->sun_path);
+
+   if (bind(fd, (struct sockaddr *) addr, sizeof(*addr))
+       || listen(fd, MAX_CLIENTS)) {
+      close(fd);
+      return -1;
+   }
+
+   return fd;
+}
+
+static void
+close_client(struct client *c)
+{
+   close(c->fd);
+   free(c->in);
+   memset(c, 0, sizeof(*c));
+   c->fd = -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+   struct client clients[MAX_CLIENTS];
+   struct pollfd fds[MAX_CLIENTS + 1];
+   struct sockaddr_un addr;
+   char display_name[32];
+   int display, listen_fd, status, i, n, fd;
+   pid_t child;
+
+   if (argc < 3) {
+      fprintf(stderr, "usage: %s display command [argument ...]\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   display = atoi(argv[1]);
+   listen_fd = listen_display(display, &addr);
+
+   if (listen_fd < 0) {
+      perror("listen");
+      return EXIT_FAILURE;
+   }
+
+   signal(SIGPIPE, SIG_IGN);
+
+   child = fork();
+
+   if (child < 0) {
+      perror("fork");
+      return EXIT_FAILURE;
+   }
+
+   if (0 == child) {
+      close(listen_fd);
+      snprintf(display_name, sizeof(display_name), ":%d", display);
+      setenv("DISPLAY", display_name, 1);
+      execvp(argv[2], argv + 2);
+      perror(argv[2]);
+      _exit(127);
+   }
+
+   for (i = 0; i < MAX_CLIENTS; ++i) {
+      memset(&clients[i], 0, sizeof(clients[i]));
+      clients[i].fd = -1;
+   }
+
+   while (waitpid(child, &status, WNOHANG) != child) {
+      fds[0].fd = listen_fd;
+      fds[0].events = POLLIN;
+
+      for (i = 0; i < MAX_CLIENTS; ++i) {
+         fds[i + 1].fd = clients[i].fd;
+         fds[i + 1].events = POLLIN;
+      }
+
+      /* The timeout notices the command's exit. */
+      n = poll(fds, MAX_CLIENTS + 1, 50);
+
+      if (n <= 0)
+         continue;
+
+      for (i = 0; i < MAX_CLIENTS; ++i) {
+         if (clients[i].fd >= 0 && fds[i + 1].revents
+             && read_client(&clients[i]))
+            close_client(&clients[i]);
+      }
+
+      if (fds[0].revents & POLLIN) {
+         fd = accept(listen_fd, NULL, NULL);
+
+         for (i = 0; fd >= 0 && i < MAX_CLIENTS; ++i) {
+            if (clients[i].fd < 0) {
+               clients[i].fd = fd;
+               break;
+            }
+         }
+
+         if (MAX_CLIENTS == i) {
+            fprintf(stderr, "mock_xserver: too many clients\n");
+            close(fd);
+         }
+      }
+   }
+
+   for (i = 0; i < MAX_CLIENTS; ++i) {
+      if (clients[i].fd >= 0)
+         close_client(&clients[i]);
+   }
+
+   close(listen_fd);
+   unlink(addr.sun_path);
+
+   if (WIFEXITED(status))
+      return WEXITSTATUS(status);
+
+   return EXIT_FAILURE;
+}
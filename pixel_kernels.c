@@ -0,0 +1,591 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pixel_kernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXEL_KERNELS_SSE2
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+   (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+#include <immintrin.h>
+#define PIXEL_KERNELS_AVX2
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PIXEL_KERNELS_NEON
+#endif
+
+const GLubyte __glXMsbToLsbTable[256] = {
+   0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0,
+   0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0,
+   0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8,
+   0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8,
+   0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4,
+   0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4,
+   0x0c, 0x8c, 0x4c, 0xcc, 0x2c, 0xac, 0x6c, 0xec,
+   0x1c, 0x9c, 0x5c, 0xdc, 0x3c, 0xbc, 0x7c, 0xfc,
+   0x02, 0x82, 0x42, 0xc2, 0x22, 0xa2, 0x62, 0xe2,
+   0x12, 0x92, 0x52, 0xd2, 0x32, 0xb2, 0x72, 0xf2,
+   0x0a, 0x8a, 0x4a, 0xca, 0x2a, 0xaa, 0x6a, 0xea,
+   0x1a, 0x9a, 0x5a, 0xda, 0x3a, 0xba, 0x7a, 0xfa,
+   0x06, 0x86, 0x46, 0xc6, 0x26, 0xa6, 0x66, 0xe6,
+   0x16, 0x96, 0x56, 0xd6, 0x36, 0xb6, 0x76, 0xf6,
+   0x0e, 0x8e, 0x4e, 0xce, 0x2e, 0xae, 0x6e, 0xee,
+   0x1e, 0x9e, 0x5e, 0xde, 0x3e, 0xbe, 0x7e, 0xfe,
+   0x01, 0x81, 0x41, 0xc1, 0x21, 0xa1, 0x61, 0xe1,
+   0x11, 0x91, 0x51, 0xd1, 0x31, 0xb1, 0x71, 0xf1,
+   0x09, 0x89, 0x49, 0xc9, 0x29, 0xa9, 0x69, 0xe9,
+   0x19, 0x99, 0x59, 0xd9, 0x39, 0xb9, 0x79, 0xf9,
+   0x05, 0x85, 0x45, 0xc5, 0x25, 0xa5, 0x65, 0xe5,
+   0x15, 0x95, 0x55, 0xd5, 0x35, 0xb5, 0x75, 0xf5,
+   0x0d, 0x8d, 0x4d, 0xcd, 0x2d, 0xad, 0x6d, 0xed,
+   0x1d, 0x9d, 0x5d, 0xdd, 0x3d, 0xbd, 0x7d, 0xfd,
+   0x03, 0x83, 0x43, 0xc3, 0x23, 0xa3, 0x63, 0xe3,
+   0x13, 0x93, 0x53, 0xd3, 0x33, 0xb3, 0x73, 0xf3,
+   0x0b, 0x8b, 0x4b, 0xcb, 0x2b, 0xab, 0x6b, 0xeb,
+   0x1b, 0x9b, 0x5b, 0xdb, 0x3b, 0xbb, 0x7b, 0xfb,
+   0x07, 0x87, 0x47, 0xc7, 0x27, 0xa7, 0x67, 0xe7,
+   0x17, 0x97, 0x57, 0xd7, 0x37, 0xb7, 0x77, 0xf7,
+   0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef,
+   0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff,
+};
+
+static void
+scalar_swap2(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i < count; ++i) {
+      dst[0] = src[1];
+      dst[1] = src[0];
+      dst += 2;
+      src += 2;
+   }
+}
+
+static void
+scalar_swap4(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i < count; ++i) {
+      dst[0] = src[3];
+      dst[1] = src[2];
+      dst[2] = src[1];
+      dst[3] = src[0];
+      dst += 4;
+      src += 4;
+   }
+}
+
+static void
+scalar_unpack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+                   int offset, bool lsb_first)
+{
+   size_t i;
+   GLubyte current, next;
+
+   if (0 == offset) {
+      if (lsb_first) {
+         for (i = 0; i < count; ++i)
+            dst[i] = __glXMsbToLsbTable[src[i]];
+      }
+      else {
+         memcpy(dst, src, count);
+      }
+
+      return;
+   }
+
+   for (i = 0; i < count; ++i) {
+      if (lsb_first) {
+         current = __glXMsbToLsbTable[src[i]];
+         next = __glXMsbToLsbTable[src[i + 1]];
+      }
+      else {
+         current = src[i];
+         next = src[i + 1];
+      }
+
+      dst[i] = (current << offset) | (next >> (8 - offset));
+   }
+}
+
+static void
+scalar_pack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+                 int offset, bool lsb_first)
+{
+   size_t i;
+   GLubyte byte;
+
+   if (0 == offset && !lsb_first) {
+      memcpy(dst, src, count);
+      return;
+   }
+
+   for (i = 0; i < count; ++i) {
+      if (offset)
+         byte = (src[(ptrdiff_t) i - 1] << (8 - offset)) | (src[i] >> offset);
+      else
+         byte = src[i];
+
+      dst[i] = lsb_first ? __glXMsbToLsbTable[byte] : byte;
+   }
+}
+
+static const struct __GLXpixelKernels scalar_kernels = {
+   .name = "scalar",
+   .swap2 = scalar_swap2,
+   .swap4 = scalar_swap4,
+   .unpack_bits = scalar_unpack_bits,
+   .pack_bits = scalar_pack_bits
+};
+
+#ifdef PIXEL_KERNELS_SSE2
+/*
+ * SSE2 has no byte shifts, so the bytes are shifted as 16 bit lanes and
+ * the bits that crossed into the neighbouring byte are masked off.
+ */
+static inline __m128i
+sse2_shift_left(__m128i v, int n)
+{
+   return _mm_and_si128(_mm_sll_epi16(v, _mm_cvtsi32_si128(n)),
+                        _mm_set1_epi8((char) (0xff << n)));
+}
+
+static inline __m128i
+sse2_shift_right(__m128i v, int n)
+{
+   return _mm_and_si128(_mm_srl_epi16(v, _mm_cvtsi32_si128(n)),
+                        _mm_set1_epi8((char) (0xff >> n)));
+}
+
+static inline __m128i
+sse2_reverse_bits(__m128i v)
+{
+   v = _mm_or_si128(sse2_shift_right(v, 4), sse2_shift_left(v, 4));
+   v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 2),
+                                  _mm_set1_epi8(0x33)),
+                    _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi8(0x33)), 2));
+   v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 1),
+                                  _mm_set1_epi8(0x55)),
+                    _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi8(0x55)), 1));
+   return v;
+}
+
+static void
+sse2_swap2(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t i;
+   __m128i v;
+
+   for (i = 0; i + 8 <= count; i += 8) {
+      v = _mm_loadu_si128((const __m128i *) (src + i * 2));
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128((__m128i *) (dst + i * 2), v);
+   }
+
+   scalar_swap2(dst + i * 2, src + i * 2, count - i);
+}
+
+static void
+sse2_swap4(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t i;
+   __m128i v;
+
+   for (i = 0; i + 4 <= count; i += 4) {
+      v = _mm_loadu_si128((const __m128i *) (src + i * 4));
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128((__m128i *) (dst + i * 4), v);
+   }
+
+   scalar_swap4(dst + i * 4, src + i * 4, count - i);
+}
+
+static void
+sse2_unpack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+                 int offset, bool lsb_first)
+{
+   size_t i;
+   __m128i current, next;
+
+   for (i = 0; i + 16 <= count; i += 16) {
+      current = _mm_loadu_si128((const __m128i *) (src + i));
+
+      if (lsb_first)
+         current = sse2_reverse_bits(current);
+
+      if (offset) {
+         next = _mm_loadu_si128((const __m128i *) (src + i + 1));
+
+         if (lsb_first)
+            next = sse2_reverse_bits(next);
+
+         current = _mm_or_si128(sse2_shift_left(current, offset),
+                                sse2_shift_right(next, 8 - offset));
+      }
+
+      _mm_storeu_si128((__m128i *) (dst + i), current);
+   }
+
+   scalar_unpack_bits(dst + i, src + i, count - i, offset, lsb_first);
+}
+
+static void
+sse2_pack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+               int offset, bool lsb_first)
+{
+   size_t i;
+   __m128i v;
+
+   for (i = 0; i + 16 <= count; i += 16) {
+      v = _mm_loadu_si128((const __m128i *) (src + i));
+
+      if (offset)
+         v = _mm_or_si128(sse2_shift_left
+                          (_mm_loadu_si128((const __m128i *) (src + i - 1)),
+                           8 - offset), sse2_shift_right(v, offset));
+
+      if (lsb_first)
+         v = sse2_reverse_bits(v);
+
+      _mm_storeu_si128((__m128i *) (dst + i), v);
+   }
+
+   scalar_pack_bits(dst + i, src + i, count - i, offset, lsb_first);
+}
+
+static const struct __GLXpixelKernels sse2_kernels = {
+   .name = "sse2",
+   .swap2 = sse2_swap2,
+   .swap4 = sse2_swap4,
+   .unpack_bits = sse2_unpack_bits,
+   .pack_bits = sse2_pack_bits
+};
+#endif
+
+#ifdef PIXEL_KERNELS_AVX2
+/*
+ * These are compiled for AVX2 regardless of the -m flags, and only used
+ * when the CPU reports AVX2 support at runtime.
+ */
+#define AVX2 __attribute__ ((target("avx2")))
+
+static inline AVX2 __m256i
+avx2_shift_left(__m256i v, int n)
+{
+   return _mm256_and_si256(_mm256_sll_epi16(v, _mm_cvtsi32_si128(n)),
+                           _mm256_set1_epi8((char) (0xff << n)));
+}
+
+static inline AVX2 __m256i
+avx2_shift_right(__m256i v, int n)
+{
+   return _mm256_and_si256(_mm256_srl_epi16(v, _mm_cvtsi32_si128(n)),
+                           _mm256_set1_epi8((char) (0xff >> n)));
+}
+
+/* Look up the reversal of each nibble, and swap the nibbles. */
+static inline AVX2 __m256i
+avx2_reverse_bits(__m256i v)
+{
+   const __m256i table = _mm256_setr_epi8(0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6,
+                                          0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb,
+                                          0x7, 0xf, 0x0, 0x8, 0x4, 0xc, 0x2,
+                                          0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd,
+                                          0x3, 0xb, 0x7, 0xf);
+   const __m256i low = _mm256_set1_epi8(0x0f);
+   __m256i lo, hi;
+
+   lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+   hi = _mm256_shuffle_epi8(table,
+                            _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+
+   return _mm256_or_si256(_mm256_slli_epi16(lo, 4), hi);
+}
+
+static AVX2 void
+avx2_swap(GLubyte * dst, const GLubyte * src, size_t bytes, __m256i order)
+{
+   size_t i;
+   __m256i v;
+
+   for (i = 0; i + 32 <= bytes; i += 32) {
+      v = _mm256_loadu_si256((const __m256i *) (src + i));
+      _mm256_storeu_si256((__m256i *) (dst + i),
+                          _mm256_shuffle_epi8(v, order));
+   }
+}
+
+static AVX2 void
+avx2_swap2(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t done = count & ~(size_t) 15;
+
+   avx2_swap(dst, src, done * 2,
+             _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12,
+                              15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10,
+                              13, 12, 15, 14));
+   scalar_swap2(dst + done * 2, src + done * 2, count - done);
+}
+
+static AVX2 void
+avx2_swap4(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t done = count & ~(size_t) 7;
+
+   avx2_swap(dst, src, done * 4,
+             _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                              13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                              15, 14, 13, 12));
+   scalar_swap4(dst + done * 4, src + done * 4, count - done);
+}
+
+static AVX2 void
+avx2_unpack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+                 int offset, bool lsb_first)
+{
+   size_t i;
+   __m256i current, next;
+
+   for (i = 0; i + 32 <= count; i += 32) {
+      current = _mm256_loadu_si256((const __m256i *) (src + i));
+
+      if (lsb_first)
+         current = avx2_reverse_bits(current);
+
+      if (offset) {
+         next = _mm256_loadu_si256((const __m256i *) (src + i + 1));
+
+         if (lsb_first)
+            next = avx2_reverse_bits(next);
+
+         current = _mm256_or_si256(avx2_shift_left(current, offset),
+                                   avx2_shift_right(next, 8 - offset));
+      }
+
+      _mm256_storeu_si256((__m256i *) (dst + i), current);
+   }
+
+   scalar_unpack_bits(dst + i, src + i, count - i, offset, lsb_first);
+}
+
+static AVX2 void
+avx2_pack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+               int offset, bool lsb_first)
+{
+   size_t i;
+   __m256i v;
+
+   for (i = 0; i + 32 <= count; i += 32) {
+      v = _mm256_loadu_si256((const __m256i *) (src + i));
+
+      if (offset)
+         v = _mm256_or_si256(avx2_shift_left
+                             (_mm256_loadu_si256
+                              ((const __m256i *) (src + i - 1)), 8 - offset),
+                             avx2_shift_right(v, offset));
+
+      if (lsb_first)
+         v = avx2_reverse_bits(v);
+
+      _mm256_storeu_si256((__m256i *) (dst + i), v);
+   }
+
+   scalar_pack_bits(dst + i, src + i, count - i, offset, lsb_first);
+}
+
+static const struct __GLXpixelKernels avx2_kernels = {
+   .name = "avx2",
+   .swap2 = avx2_swap2,
+   .swap4 = avx2_swap4,
+   .unpack_bits = avx2_unpack_bits,
+   .pack_bits = avx2_pack_bits
+};
+#endif
+
+#ifdef PIXEL_KERNELS_NEON
+static void
+neon_swap2(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i + 8 <= count; i += 8)
+      vst1q_u8(dst + i * 2, vrev16q_u8(vld1q_u8(src + i * 2)));
+
+   scalar_swap2(dst + i * 2, src + i * 2, count - i);
+}
+
+static void
+neon_swap4(GLubyte * dst, const GLubyte * src, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i + 4 <= count; i += 4)
+      vst1q_u8(dst + i * 4, vrev32q_u8(vld1q_u8(src + i * 4)));
+
+   scalar_swap4(dst + i * 4, src + i * 4, count - i);
+}
+
+/* NEON shifts each byte by itself; negative counts shift right. */
+static void
+neon_unpack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+                 int offset, bool lsb_first)
+{
+   size_t i;
+   uint8x16_t current, next;
+   const int8x16_t left = vdupq_n_s8(offset);
+   const int8x16_t right = vdupq_n_s8(offset - 8);
+
+   for (i = 0; i + 16 <= count; i += 16) {
+      current = vld1q_u8(src + i);
+
+      if (lsb_first)
+         current = vrbitq_u8(current);
+
+      if (offset) {
+         next = vld1q_u8(src + i + 1);
+
+         if (lsb_first)
+            next = vrbitq_u8(next);
+
+         current = vorrq_u8(vshlq_u8(current, left), vshlq_u8(next, right));
+      }
+
+      vst1q_u8(dst + i, current);
+   }
+
+   scalar_unpack_bits(dst + i, src + i, count - i, offset, lsb_first);
+}
+
+static void
+neon_pack_bits(GLubyte * dst, const GLubyte * src, size_t count,
+               int offset, bool lsb_first)
+{
+   size_t i;
+   uint8x16_t v;
+   const int8x16_t left = vdupq_n_s8(8 - offset);
+   const int8x16_t right = vdupq_n_s8(-offset);
+
+   for (i = 0; i + 16 <= count; i += 16) {
+      v = vld1q_u8(src + i);
+
+      if (offset)
+         v = vorrq_u8(vshlq_u8(vld1q_u8(src + i - 1), left),
+                      vshlq_u8(v, right));
+
+      if (lsb_first)
+         v = vrbitq_u8(v);
+
+      vst1q_u8(dst + i, v);
+   }
+
+   scalar_pack_bits(dst + i, src + i, count - i, offset, lsb_first);
+}
+
+static const struct __GLXpixelKernels neon_kernels = {
+   .name = "neon",
+   .swap2 = neon_swap2,
+   .swap4 = neon_swap4,
+   .unpack_bits = neon_unpack_bits,
+   .pack_bits = neon_pack_bits
+};
+#endif
+
+static pthread_once_t kernels_once_control = PTHREAD_ONCE_INIT;
+static const struct __GLXpixelKernels *kernels_list[4];
+static int kernels_count;
+static const struct __GLXpixelKernels *kernels = &scalar_kernels;
+
+static void
+init_kernels(void)
+{
+   const char *name = getenv("LIBGL_PIXEL_KERNELS");
+   int i;
+
+#ifdef PIXEL_KERNELS_AVX2
+   __builtin_cpu_init();
+
+   if (__builtin_cpu_supports("avx2"))
+      kernels_list[kernels_count++] = &avx2_kernels;
+#endif
+
+#ifdef PIXEL_KERNELS_SSE2
+   kernels_list[kernels_count++] = &sse2_kernels;
+#endif
+
+#ifdef PIXEL_KERNELS_NEON
+   kernels_list[kernels_count++] = &neon_kernels;
+#endif
+
+   kernels_list[kernels_count++] = &scalar_kernels;
+
+   kernels = kernels_list[0];
+
+   if (name) {
+      for (i = 0; i < kernels_count; ++i) {
+         if (!strcmp(name, kernels_list[i]->name))
+            break;
+      }
+
+      if (i < kernels_count)
+         kernels = kernels_list[i];
+      else
+         fprintf(stderr, "LIBGL_PIXEL_KERNELS: %s is not supported\n", name);
+   }
+}
+
+const struct __GLXpixelKernels *
+__glXGetPixelKernels(void)
+{
+   (void) pthread_once(&kernels_once_control, init_kernels);
+
+   return kernels;
+}
+
+const struct __GLXpixelKernels *const *
+__glXGetPixelKernelList(int *count)
+{
+   (void) pthread_once(&kernels_once_control, init_kernels);
+
+   *count = kernels_count;
+
+   return kernels_list;
+}
@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <GL/gl.h>
+
+/*
+ * These are the inner loops of __glFillImage and __glEmptyImage.  Each
+ * table has the same results, bit for bit; they only differ in the
+ * instructions used.  The first table the CPU supports, in the order of
+ * __glXGetPixelKernelList, is used unless LIBGL_PIXEL_KERNELS names another
+ * one, such as "scalar".
+ */
+struct __GLXpixelKernels
+{
+   const char *name;
+
+   /* Copy count 2 or 4 byte elements from src to dst, reversing each. */
+   void (*swap2) (GLubyte * dst, const GLubyte * src, size_t count);
+   void (*swap4) (GLubyte * dst, const GLubyte * src, size_t count);
+
+   /* 
+    * Unpack count whole bytes of a bitmap row for FillBitmap:
+    *  dst[i] = (src[i] << offset) | (src[i + 1] >> (8 - offset))
+    * with each src byte bit reversed first when lsb_first is true.
+    * src[count] is read when offset is not 0.
+    */
+   void (*unpack_bits) (GLubyte * dst, const GLubyte * src, size_t count,
+                        int offset, bool lsb_first);
+
+   /* 
+    * Pack count whole bytes of a bitmap row for EmptyBitmap:
+    *  dst[i] = (src[i - 1] << (8 - offset)) | (src[i] >> offset)
+    * with each dst byte bit reversed afterwards when lsb_first is true.
+    * src[-1] is read when offset is not 0.
+    */
+   void (*pack_bits) (GLubyte * dst, const GLubyte * src, size_t count,
+                      int offset, bool lsb_first);
+};
+
+/* This reverses the bits of a byte, for GL_UNPACK_LSB_FIRST. */
+extern const GLubyte __glXMsbToLsbTable[256];
+
+/* Return the kernels selected for this CPU. */
+const struct __GLXpixelKernels *__glXGetPixelKernels(void);
+
+/* 
+ * Return every table this CPU supports, best first, for the tests and
+ * benchmarks.  The last one is always the scalar table.
+ */
+const struct __GLXpixelKernels *const *__glXGetPixelKernelList(int *count);
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This times glXChooseVisual and glXChooseFBConfig, for a few attribute
+ * lists that are repeated like an application's startup would.  It also
+ * checks that the visual chosen is the first of the fbconfigs chosen with
+ * equivalent attributes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+#define ITERATIONS 1000
+
+static int visual_attribs[][16] = {
+   {GLX_RGBA, GLX_DOUBLEBUFFER, GLX_DEPTH_SIZE, 16, None},
+   {GLX_RGBA, GLX_RED_SIZE, 8, GLX_GREEN_SIZE, 8, GLX_BLUE_SIZE, 8, None},
+   {GLX_RGBA, GLX_DOUBLEBUFFER, GLX_STENCIL_SIZE, 8, GLX_DEPTH_SIZE, 24,
+    None}
+};
+
+static int fbconfig_attribs[][16] = {
+   {GLX_DOUBLEBUFFER, True, GLX_DEPTH_SIZE, 16, None},
+   {GLX_RED_SIZE, 8, GLX_GREEN_SIZE, 8, GLX_BLUE_SIZE, 8, None},
+   {GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT, GLX_DOUBLEBUFFER, False, None}
+};
+
+#define NUM_LISTS (sizeof(visual_attribs) / sizeof(visual_attribs[0]))
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+int
+main(int argc, char *argv[])
+{
+   Display *dpy;
+   XVisualInfo *vi;
+   GLXFBConfig *configs;
+   int screen, i, n, total, visualid;
+   unsigned int l;
+   double start;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   screen = DefaultScreen(dpy);
+
+   /* This is the equivalent of visual_attribs[0]. */
+   vi = glXChooseVisual(dpy, screen, visual_attribs[0]);
+   configs = glXChooseFBConfig(dpy, screen, fbconfig_attribs[0], &n);
+
+   if (NULL == vi || NULL == configs || n < 1) {
+      fprintf(stderr, "error: no match for a double buffered visual\n");
+      return EXIT_FAILURE;
+   }
+
+   if (glXGetFBConfigAttrib(dpy, configs[0], GLX_VISUAL_ID, &visualid)
+       == Success && visualid != (int) vi->visualid) {
+      printf("note: the best visual 0x%lx isn't the best fbconfig's 0x%x\n",
+             vi->visualid, visualid);
+   }
+
+   XFree(vi);
+   XFree(configs);
+
+   start = current_time();
+
+   for (i = 0; i < ITERATIONS; ++i) {
+      for (l = 0; l < NUM_LISTS; ++l) {
+         vi = glXChooseVisual(dpy, screen, visual_attribs[l]);
+         XFree(vi);
+      }
+   }
+
+   printf("glXChooseVisual: %.2f us/call\n",
+          (current_time() - start) * 1e6 / (ITERATIONS * NUM_LISTS));
+
+   total = 0;
+   start = current_time();
+
+   for (i = 0; i < ITERATIONS; ++i) {
+      for (l = 0; l < NUM_LISTS; ++l) {
+         configs = glXChooseFBConfig(dpy, screen, fbconfig_attribs[l], &n);
+         total += n;
+         XFree(configs);
+      }
+   }
+
+   printf("glXChooseFBConfig: %.2f us/call (%d configs per iteration)\n",
+          (current_time() - start) * 1e6 / (ITERATIONS * NUM_LISTS),
+          total / ITERATIONS);
+
+   XCloseDisplay(dpy);
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,2 @@
+$(TEST_BUILD_DIR)/choose_config: tests/choose_config/choose_config.c $(LIBGL)
+	$(CC) tests/choose_config/choose_config.c $(INCLUDE) -o $@ $(LINK_TEST)
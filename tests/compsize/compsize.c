@@ -0,0 +1,153 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This checks that the generated compsize tables give the same results as
+ * the original switches for every enum, and times a call of each.
+ * It doesn't need an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "glxclient.h"
+#include "compsize_reference.h"
+
+/* The last enum that is checked against every format and type below. */
+#define LAST_ENUM 0x20000
+
+#define ITERATIONS 20000000
+
+static const GLenum formats[] = {
+   GL_RGBA, GL_BGRA, GL_RGB, GL_LUMINANCE, GL_LUMINANCE_ALPHA,
+   GL_DEPTH_COMPONENT, GL_COLOR_INDEX, GL_YCBCR_422_APPLE, 0, 0xffffffff
+};
+
+static const GLenum types[] = {
+   GL_UNSIGNED_BYTE, GL_FLOAT, GL_UNSIGNED_SHORT, GL_BITMAP,
+   GL_UNSIGNED_INT_8_8_8_8_REV, GL_UNSIGNED_SHORT_5_6_5,
+   GL_UNSIGNED_SHORT_8_8_APPLE, GL_UNSIGNED_INT_24_8_MESA, 0, 0xffffffff
+};
+
+#define NUM_FORMATS (sizeof(formats) / sizeof(formats[0]))
+#define NUM_TYPES (sizeof(types) / sizeof(types[0]))
+
+static int
+check(void)
+{
+   GLenum e;
+   int i, errors = 0;
+
+   for (e = 0; e <= LAST_ENUM; ++e) {
+      if (ReferenceBytesPerElement(e) != __glBytesPerElement(e)) {
+         fprintf(stderr, "__glBytesPerElement(0x%x) mismatch\n", e);
+         ++errors;
+      }
+
+      for (i = 0; i < NUM_TYPES; ++i) {
+         if (ReferenceElementsPerGroup(e, types[i])
+             != __glElementsPerGroup(e, types[i])) {
+            fprintf(stderr, "__glElementsPerGroup(0x%x, 0x%x) mismatch\n",
+                    e, types[i]);
+            ++errors;
+         }
+      }
+
+      for (i = 0; i < NUM_FORMATS; ++i) {
+         if (ReferenceElementsPerGroup(formats[i], e)
+             != __glElementsPerGroup(formats[i], e)) {
+            fprintf(stderr, "__glElementsPerGroup(0x%x, 0x%x) mismatch\n",
+                    formats[i], e);
+            ++errors;
+         }
+      }
+   }
+
+   return errors;
+}
+
+static double
+now(void)
+{
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+
+   return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Return the nanoseconds per call of the pair, with the common enums. */
+static double
+time_calls(GLint(*elements) (GLenum, GLenum), GLint(*bytes) (GLenum))
+{
+   volatile GLint sink = 0;
+   double start;
+   int i, f = 0, t = 0;
+
+   start = now();
+
+   for (i = 0; i < ITERATIONS; ++i) {
+      sink += elements(formats[f], types[t]);
+      sink += bytes(types[t]);
+
+      /* Cycle through the valid enums. */
+      if (++f == NUM_FORMATS - 2)
+         f = 0;
+
+      if (++t == NUM_TYPES - 2)
+         t = 0;
+   }
+
+   return (now() - start) * 1000000000.0 / ITERATIONS;
+}
+
+int
+main(int argc, char *argv[])
+{
+   int errors;
+   double reference, tables;
+
+   errors = check();
+
+   if (errors) {
+      printf("%d mismatches\n", errors);
+      return EXIT_FAILURE;
+   }
+
+   printf("the tables match the switches for enums up to 0x%x\n", LAST_ENUM);
+
+   reference = time_calls(ReferenceElementsPerGroup,
+                          ReferenceBytesPerElement);
+   tables = time_calls(__glElementsPerGroup, __glBytesPerElement);
+
+   printf("switches: %.2f ns per format and type\n", reference);
+   printf("tables: %.2f ns per format and type\n", tables);
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,3 @@
+$(TEST_BUILD_DIR)/compsize: tests/compsize/compsize.c tests/compsize/compsize_reference.c tests/compsize/compsize_reference.h compsize.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/compsize/compsize.c tests/compsize/compsize_reference.c $(INCLUDE) -Itests/compsize $(GL_CFLAGS) -o $@ compsize.o
@@ -0,0 +1,200 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This tests the on-disk cache of decoded configs.  It builds the modes
+ * for a made up property list, so it doesn't need an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "glx_config_cache.h"
+
+/* Smaller tables aren't cached, since decoding them is cheaper. */
+#define COUNT 64
+#define NPROPS 40
+
+static INT32 props[COUNT * NPROPS];
+
+/* Each config has an ID and a depth size, padded with its level. */
+static void
+fill_props(void)
+{
+   int i, j;
+
+   for (i = 0; i < COUNT; ++i) {
+      props[i * NPROPS] = GLX_FBCONFIG_ID;
+      props[i * NPROPS + 1] = 0x21 + i;
+      props[i * NPROPS + 2] = GLX_DEPTH_SIZE;
+      props[i * NPROPS + 3] = (i % 3) * 8;
+
+      for (j = 4; j < NPROPS; j += 2) {
+         props[i * NPROPS + j] = GLX_LEVEL;
+         props[i * NPROPS + j + 1] = 0;
+      }
+   }
+}
+
+static void
+check(int cond, const char *what)
+{
+   if (!cond) {
+      fprintf(stderr, "FAIL: %s\n", what);
+      exit(EXIT_FAILURE);
+   }
+}
+
+static __GLcontextModes *
+decode(void)
+{
+   __GLcontextModes *modes, *m;
+   int i;
+
+   modes = _gl_context_modes_create(COUNT, sizeof(*modes));
+   check(modes != NULL, "allocating the modes");
+
+   for (m = modes, i = 0; m; m = m->next, ++i) {
+      m->fbconfigID = props[i * NPROPS + 1];
+      m->depthBits = props[i * NPROPS + 3];
+      m->haveDepthBuffer = (m->depthBits > 0);
+      m->drawableType = GLX_WINDOW_BIT;
+      m->screen = 1;
+   }
+
+   return modes;
+}
+
+static int
+same_lists(const __GLcontextModes * a, const __GLcontextModes * b)
+{
+   for (; a && b; a = a->next, b = b->next) {
+      if (!_gl_context_modes_are_same(a, b) || a->fbconfigID != b->fbconfigID
+          || a->screen != b->screen ||
+          a->haveDepthBuffer != b->haveDepthBuffer)
+         return 0;
+   }
+
+   return NULL == a && NULL == b;
+}
+
+static GLboolean
+make_key(struct __GLXconfigCacheKey *key, const char *version)
+{
+   return __glXConfigCacheKey(key, "The X.Org Foundation", 10600000,
+                              version, 1, GL_TRUE, props, COUNT, NPROPS);
+}
+
+int
+main(int argc, char *argv[])
+{
+   char dir[] = "/tmp/config_cache.XXXXXX";
+   struct __GLXconfigCacheKey key, other;
+   __GLcontextModes *decoded, *loaded;
+   FILE *fp;
+   int c;
+
+   fill_props();
+
+   unsetenv("LIBGL_CONFIG_CACHE_DIR");
+   check(!make_key(&key, "1.4"), "the cache is off by default");
+
+   check(mkdtemp(dir) != NULL, "creating the cache directory");
+   setenv("LIBGL_CONFIG_CACHE_DIR", dir, 1);
+
+   check(make_key(&key, "1.4"), "the cache is on with a directory");
+   check(!__glXConfigCacheKey(&other, "The X.Org Foundation", 10600000,
+                              "1.4", 1, GL_TRUE, props, 4, NPROPS),
+         "a small table isn't cached");
+   check(NULL == __glXConfigCacheLoad(&key), "an empty cache misses");
+
+   decoded = decode();
+   __glXConfigCacheSave(&key, decoded);
+
+   loaded = __glXConfigCacheLoad(&key);
+   check(loaded != NULL, "a saved entry hits");
+   check(same_lists(decoded, loaded), "a loaded entry matches the modes");
+   _gl_context_modes_destroy(loaded);
+
+   check(make_key(&other, "1.3"), "a key for another version");
+   check(strcmp(key.path, other.path) != 0,
+         "the GLX version selects another entry");
+
+   /* Changed properties select the same entry, but don't match it. */
+   props[3] = 32;
+   check(make_key(&other, "1.4"), "a key for changed properties");
+   check(0 == strcmp(key.path, other.path),
+         "the path ignores the properties");
+   check(NULL == __glXConfigCacheLoad(&other),
+         "changed properties miss the entry");
+   props[3] = 0;
+
+   /* A truncated entry is ignored. */
+   check(truncate(key.path, 16) == 0, "truncating the entry");
+   check(NULL == __glXConfigCacheLoad(&key), "a truncated entry misses");
+
+   /* A rewritten entry replaces the bad one. */
+   __glXConfigCacheSave(&key, decoded);
+   loaded = __glXConfigCacheLoad(&key);
+   check(loaded != NULL && same_lists(decoded, loaded),
+         "a rewritten entry hits");
+   _gl_context_modes_destroy(loaded);
+
+   /* 
+    * An entry from a build with another layout of the records is ignored,
+    * even though the records are the same size.  The layout fingerprint
+    * follows the magic, version and record size in the header.
+    */
+   fp = fopen(key.path, "r+b");
+   check(fp != NULL, "opening the entry");
+   check(0 == fseek(fp, 16, SEEK_SET), "seeking to the layout");
+   c = fgetc(fp);
+   check(0 == fseek(fp, 16, SEEK_SET), "seeking back to the layout");
+   fputc(~c & 0xff, fp);
+   fclose(fp);
+   check(NULL == __glXConfigCacheLoad(&key), "another layout misses");
+
+   __glXConfigCacheSave(&key, decoded);
+
+   /* A corrupt header is ignored. */
+   fp = fopen(key.path, "r+b");
+   check(fp != NULL, "opening the entry");
+   fputc('X', fp);
+   fclose(fp);
+   check(NULL == __glXConfigCacheLoad(&key), "a corrupt entry misses");
+
+   _gl_context_modes_destroy(decoded);
+   unlink(key.path);
+   rmdir(dir);
+
+   printf("PASS\n");
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,3 @@
+$(TEST_BUILD_DIR)/config_cache: tests/config_cache/config_cache.c glx_config_cache.o glcontextmodes.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/config_cache/config_cache.c $(INCLUDE) $(GL_CFLAGS) -o $@ glx_config_cache.o glcontextmodes.o -L$(X11_DIR)/lib -lX11
@@ -0,0 +1,260 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This checks that the table driven __glXInitializeVisualConfigFromTags
+ * decodes exactly like the original switch, on property lists in the
+ * layout that X.Org servers send, on glXChooseVisual style attribute
+ * lists, and on random lists.  It doesn't need an X server.
+ *
+ * usage: config_tags [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glxclient.h"
+#include "glcontextmodes.h"
+#include "config_reference.h"
+
+#define DEFAULT_ITERATIONS 200000
+#define MAX_WORDS 96
+
+/* This is a GetFBConfigs reply for one config, as X.Org writes it. */
+static const INT32 fbconfig_reply[] = {
+   GLX_VISUAL_ID, 0x21,
+   GLX_FBCONFIG_ID, 0x5b,
+   GLX_X_RENDERABLE, True,
+   GLX_RGBA, True,
+   GLX_RENDER_TYPE, GLX_RGBA_BIT,
+   GLX_DOUBLEBUFFER, True,
+   GLX_STEREO, False,
+   GLX_BUFFER_SIZE, 32,
+   GLX_LEVEL, 0,
+   GLX_AUX_BUFFERS, 0,
+   GLX_RED_SIZE, 8,
+   GLX_GREEN_SIZE, 8,
+   GLX_BLUE_SIZE, 8,
+   GLX_ALPHA_SIZE, 8,
+   GLX_ACCUM_RED_SIZE, 16,
+   GLX_ACCUM_GREEN_SIZE, 16,
+   GLX_ACCUM_BLUE_SIZE, 16,
+   GLX_ACCUM_ALPHA_SIZE, 16,
+   GLX_DEPTH_SIZE, 24,
+   GLX_STENCIL_SIZE, 8,
+   GLX_X_VISUAL_TYPE, GLX_TRUE_COLOR,
+   GLX_CONFIG_CAVEAT, GLX_NONE,
+   GLX_TRANSPARENT_TYPE, GLX_NONE,
+   GLX_TRANSPARENT_INDEX_VALUE, 0,
+   GLX_TRANSPARENT_RED_VALUE, 0,
+   GLX_TRANSPARENT_GREEN_VALUE, 0,
+   GLX_TRANSPARENT_BLUE_VALUE, 0,
+   GLX_TRANSPARENT_ALPHA_VALUE, 0,
+   0x8060 /* GLX_SWAP_METHOD_OML */ , 0x8063,
+   GLX_SAMPLES_SGIS, 4,
+   GLX_SAMPLE_BUFFERS_SGIS, 1,
+   0x8028 /* GLX_VISUAL_SELECT_GROUP_SGIX */ , 0,
+   GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT | GLX_PIXMAP_BIT,
+   0x20d0 /* GLX_BIND_TO_TEXTURE_RGB_EXT */ , True,
+   0x20d1 /* GLX_BIND_TO_TEXTURE_RGBA_EXT */ , True,
+   0x20d2 /* GLX_BIND_TO_MIPMAP_TEXTURE_EXT */ , False,
+   0x20d3 /* GLX_BIND_TO_TEXTURE_TARGETS_EXT */ , 7,
+   0x20d4 /* GLX_Y_INVERTED_EXT */ , GLX_DONT_CARE,
+   None, 0,
+   None, 0
+};
+
+/* This is a GetVisualConfigs reply for one visual, as X.Org writes it. */
+static const INT32 visual_reply[] = {
+   0x21, TrueColor, True,
+   8, 8, 8, 0,
+   16, 16, 16, 0,
+   True, False,
+   24, 24, 8, 0, 0,
+   GLX_VISUAL_CAVEAT_EXT, GLX_NONE,
+   GLX_TRANSPARENT_TYPE, GLX_NONE,
+   GLX_TRANSPARENT_INDEX_VALUE, 0,
+   GLX_TRANSPARENT_RED_VALUE, 0,
+   GLX_TRANSPARENT_GREEN_VALUE, 0,
+   GLX_TRANSPARENT_BLUE_VALUE, 0,
+   GLX_TRANSPARENT_ALPHA_VALUE, 0,
+   GLX_SAMPLES_SGIS, 0,
+   GLX_SAMPLE_BUFFERS_SGIS, 0,
+   0x8028 /* GLX_VISUAL_SELECT_GROUP_SGIX */ , 0,
+   None, 0
+};
+
+/* The tags, values without a tag, and unknown tags. */
+static const INT32 choose_visual_list[] = {
+   GLX_USE_GL, GLX_RGBA, GLX_DOUBLEBUFFER, GLX_STEREO,
+   GLX_RED_SIZE, 1, GLX_DEPTH_SIZE, 12, GLX_SAMPLES_SGIS, 2,
+   None
+};
+
+static const INT32 choose_fbconfig_list[] = {
+   GLX_RENDER_TYPE, GLX_RGBA_BIT, GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT,
+   GLX_DOUBLEBUFFER, GLX_DONT_CARE, GLX_RGBA, False,
+   GLX_FBCONFIG_ID, 0x5b, GLX_X_VISUAL_TYPE, GLX_DIRECT_COLOR,
+   None
+};
+
+/* Random lists draw their tags from these, to hit every case. */
+static const INT32 tags[] = {
+   None, GLX_USE_GL, GLX_BUFFER_SIZE, GLX_LEVEL, GLX_RGBA, GLX_DOUBLEBUFFER,
+   GLX_STEREO, GLX_AUX_BUFFERS, GLX_RED_SIZE, GLX_GREEN_SIZE,
+   GLX_BLUE_SIZE, GLX_ALPHA_SIZE, GLX_DEPTH_SIZE, GLX_STENCIL_SIZE,
+   GLX_ACCUM_RED_SIZE, GLX_ACCUM_GREEN_SIZE, GLX_ACCUM_BLUE_SIZE,
+   GLX_ACCUM_ALPHA_SIZE, GLX_CONFIG_CAVEAT, GLX_X_VISUAL_TYPE,
+   GLX_TRANSPARENT_TYPE, GLX_TRANSPARENT_INDEX_VALUE,
+   GLX_TRANSPARENT_RED_VALUE, GLX_TRANSPARENT_GREEN_VALUE,
+   GLX_TRANSPARENT_BLUE_VALUE, GLX_TRANSPARENT_ALPHA_VALUE,
+   GLX_VISUAL_ID, GLX_DRAWABLE_TYPE, GLX_RENDER_TYPE, GLX_X_RENDERABLE,
+   GLX_FBCONFIG_ID, GLX_MAX_PBUFFER_WIDTH, GLX_MAX_PBUFFER_HEIGHT,
+   GLX_MAX_PBUFFER_PIXELS, 0x8019, 0x801a, 0x8028, 0x8060,
+   GLX_SAMPLE_BUFFERS_SGIS, GLX_SAMPLES_SGIS,
+   0x20d0, 0x20d1, 0x20d2, 0x20d3, 0x20d4,
+   /* The edges of the ranges in the table, and beyond. */
+   0x3f, 0x40, 0x7fff, 0x807f, 0x8080, 0x20cf, 0x20df, 0x20e0,
+   GLX_SAMPLE_BUFFERS_SGIS - 1, GLX_SAMPLES_SGIS + 1, -1, 0x7fffffff
+};
+
+#define NUM_TAGS (sizeof(tags) / sizeof(tags[0]))
+
+static unsigned long failures = 0;
+
+static void
+compare(const char *what, const INT32 * list, int count, Bool tagged_only,
+        Bool fbconfig_style_tags, unsigned seed)
+{
+   __GLcontextModes expected, result;
+   unsigned char *bytes;
+   size_t i;
+
+   /* Start from the same garbage, so that every field is compared. */
+   srand(seed);
+   bytes = (unsigned char *) &expected;
+   for (i = 0; i < sizeof(expected); i++)
+      bytes[i] = rand();
+   memcpy(&result, &expected, sizeof(result));
+
+   ReferenceInitializeVisualConfigFromTags(&expected, count, list,
+                                           tagged_only, fbconfig_style_tags);
+   __glXInitializeVisualConfigFromTags(&result, count, list, tagged_only,
+                                       fbconfig_style_tags);
+
+   if (memcmp(&expected, &result, sizeof(result)) != 0) {
+      if (failures++ < 10)
+         fprintf(stderr, "FAIL: %s (count %d tagged %d fbconfig %d)\n",
+                 what, count, tagged_only, fbconfig_style_tags);
+   }
+}
+
+static void
+compare_random(unsigned long iterations)
+{
+   INT32 list[MAX_WORDS];
+   unsigned long n;
+   int i, count;
+   Bool tagged_only, fbconfig_style_tags;
+
+   srand(1);
+
+   for (n = 0; n < iterations; n++) {
+      count = 2 * (rand() % (MAX_WORDS / 2 + 1));
+      tagged_only = rand() & 1;
+      fbconfig_style_tags = rand() & 1;
+
+      /* The untagged properties come first, so they need room. */
+      if (!tagged_only && count < 18)
+         count = 18;
+
+      for (i = 0; i < MAX_WORDS; i++) {
+         switch (rand() % 4) {
+         case 0:
+            list[i] = rand() - RAND_MAX / 2;
+            break;
+         case 1:
+            list[i] = rand() % 64;
+            break;
+         default:
+            list[i] = tags[rand() % NUM_TAGS];
+            break;
+         }
+      }
+
+      compare("random list", list, count, tagged_only, fbconfig_style_tags,
+              (unsigned) n);
+   }
+}
+
+static void
+compare_all(unsigned long iterations)
+{
+   int style;
+
+   compare("fbconfig reply", fbconfig_reply,
+           sizeof(fbconfig_reply) / sizeof(INT32), GL_TRUE, GL_TRUE, 1);
+   compare("visual reply", visual_reply,
+           sizeof(visual_reply) / sizeof(INT32), GL_FALSE, GL_TRUE, 2);
+
+   for (style = 0; style < 2; style++) {
+      compare("glXChooseVisual list", choose_visual_list, 512, GL_TRUE,
+              style, 3);
+      compare("glXChooseFBConfig list", choose_fbconfig_list, 512, GL_TRUE,
+              style, 4);
+   }
+
+   compare_random(iterations);
+}
+
+int
+main(int argc, char *argv[])
+{
+   unsigned long iterations;
+
+   iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : DEFAULT_ITERATIONS;
+
+   unsetenv("LIBGL_DIAGNOSTIC");
+   compare_all(iterations);
+
+   /* The diagnostic changes how unknown tags are skipped. */
+   setenv("LIBGL_DIAGNOSTIC", "1", 1);
+   if (freopen("/dev/null", "w", stderr) == NULL)
+      return EXIT_FAILURE;
+   compare_all(iterations / 10);
+
+   if (failures) {
+      printf("FAIL: %lu lists decoded differently\n", failures);
+      return EXIT_FAILURE;
+   }
+
+   printf("PASS\n");
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,5 @@
+CONFIG_TAGS_OBJECTS=glx_config_tags.o glcontextmodes.o
+
+$(TEST_BUILD_DIR)/config_tags: tests/config_tags/config_tags.c tests/config_tags/config_reference.c tests/config_tags/config_reference.h $(CONFIG_TAGS_OBJECTS)
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/config_tags/config_tags.c tests/config_tags/config_reference.c $(INCLUDE) -Itests/config_tags $(GL_CFLAGS) -o $@ $(CONFIG_TAGS_OBJECTS) -L$(X11_DIR)/lib -lX11
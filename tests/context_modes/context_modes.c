@@ -0,0 +1,134 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This tests the array storage and the lookup tables of the
+ * __GLcontextModes lists.  It doesn't need an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <X11/X.h>
+#include <GL/glx.h>
+#include "GL/glxint.h"
+#include "glcontextmodes.h"
+
+#define COUNT 40
+
+static void
+check(int cond, const char *what)
+{
+   if (!cond) {
+      fprintf(stderr, "FAIL: %s\n", what);
+      exit(EXIT_FAILURE);
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   __GLcontextModes *modes, *m, *other;
+   __GLcontextModes *const *fbconfigs;
+   unsigned count;
+   int i;
+
+   check(NULL == _gl_context_modes_create(0, sizeof(*modes)),
+         "an empty list is NULL");
+
+   modes = _gl_context_modes_create(COUNT, sizeof(*modes));
+   check(modes != NULL, "creating the list");
+
+   /* 
+    * Every third mode is a visual without an fbconfig, and the IDs are
+    * descending, so the tables have to be sorted.  Visual 0x100 appears
+    * twice, and the first one has to be found.
+    */
+   for (m = modes, i = 0; m; m = m->next, i++) {
+      check(m == modes + i, "the list is one array in order");
+      check(GLX_DONT_CARE == m->fbconfigID, "the modes are initialized");
+
+      m->visualID = (i < 2) ? 0x100 : 0x200 - i;
+      if (i % 3)
+         m->fbconfigID = 0x400 - i;
+   }
+   check(COUNT == i, "the list has every mode");
+
+   check(_gl_context_modes_find_visual(modes, 0x200 - 7) == modes + 7,
+         "a visual is found before the list is indexed");
+
+   check(_gl_context_modes_get_fbconfigs(modes, &count) == NULL
+         && 0 == count, "an unindexed list has no fbconfig array");
+
+   check(_gl_context_modes_index(modes), "indexing the list");
+
+   for (i = 2; i < COUNT; i++)
+      check(_gl_context_modes_find_visual(modes, 0x200 - i) == modes + i,
+            "every visual is found");
+
+   check(_gl_context_modes_find_visual(modes, 0x100) == modes,
+         "the first of two modes with a visual ID is found");
+   check(NULL == _gl_context_modes_find_visual(modes, 0x300),
+         "a missing visual isn't found");
+   check(NULL == _gl_context_modes_find_visual(modes, GLX_DONT_CARE),
+         "a mode without a visual ID isn't found");
+
+   for (i = 0; i < COUNT; i++) {
+      m = _gl_context_modes_find_fbconfig(modes, 0x400 - i);
+      check((i % 3) ? m == modes + i : NULL == m,
+            "only the modes with an fbconfig ID are found");
+   }
+
+   fbconfigs = _gl_context_modes_get_fbconfigs(modes, &count);
+   check(fbconfigs != NULL, "an indexed list has an fbconfig array");
+   check(count == COUNT - (COUNT + 2) / 3, "the array has every fbconfig");
+
+   for (i = 1; i < (int) count; i++)
+      check(fbconfigs[i - 1] < fbconfigs[i], "the array is in list order");
+
+   other = _gl_context_modes_create(2, sizeof(*other));
+   check(other != NULL, "creating another list");
+
+   check(_gl_context_modes_contains(modes, modes + COUNT - 1),
+         "the last mode is in the list");
+   check(!_gl_context_modes_contains(modes, modes + COUNT),
+         "the end of the array isn't in the list");
+   check(!_gl_context_modes_contains(modes, (char *) (modes + 1) + 4),
+         "a pointer into a mode isn't a mode");
+   check(!_gl_context_modes_contains(modes, other),
+         "a mode of another list isn't in the list");
+   check(!_gl_context_modes_contains(NULL, modes), "an empty list has none");
+
+   _gl_context_modes_destroy(other);
+   _gl_context_modes_destroy(modes);
+   _gl_context_modes_destroy(NULL);
+
+   printf("PASS\n");
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,7 @@
+$(TEST_BUILD_DIR)/context_modes: tests/context_modes/context_modes.c glcontextmodes.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/context_modes/context_modes.c $(INCLUDE) $(GL_CFLAGS) -o $@ glcontextmodes.o -L$(X11_DIR)/lib -lX11
+
+$(TEST_BUILD_DIR)/context_modes_bench: tests/context_modes/context_modes_bench.c glcontextmodes.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/context_modes/context_modes_bench.c $(INCLUDE) $(GL_CFLAGS) -o $@ glcontextmodes.o -L$(X11_DIR)/lib -lX11
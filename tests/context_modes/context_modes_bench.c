@@ -0,0 +1,226 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This times the lookups of a screen with many fbconfigs, against the
+ * list walks they replaced: the ID searches, the glXGetFBConfigs array,
+ * and the validation of a GLXFBConfig.  It doesn't need an X server.
+ *
+ * usage: context_modes_bench [configs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <X11/X.h>
+#include <GL/glx.h>
+#include "GL/glxint.h"
+#include "glcontextmodes.h"
+
+#define DEFAULT_CONFIGS 600
+#define PASSES 200
+
+static double
+now(void)
+{
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+
+   return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+static __GLcontextModes *
+walk_find_fbconfig(__GLcontextModes * modes, int fbid)
+{
+   __GLcontextModes *m;
+
+   for (m = modes; m != NULL; m = m->next)
+      if (m->fbconfigID == fbid)
+         return m;
+
+   return NULL;
+}
+
+static __GLcontextModes *
+walk_find_visual(__GLcontextModes * modes, int vid)
+{
+   __GLcontextModes *m;
+
+   for (m = modes; m != NULL; m = m->next)
+      if (m->visualID == vid)
+         return m;
+
+   return NULL;
+}
+
+static __GLcontextModes **
+walk_get_fbconfigs(__GLcontextModes * modes, unsigned *count)
+{
+   __GLcontextModes *m, **config;
+   unsigned n = 0, i = 0;
+
+   for (m = modes; m != NULL; m = m->next)
+      if (m->fbconfigID != GLX_DONT_CARE)
+         n++;
+
+   config = malloc(sizeof(*config) * n);
+
+   for (m = modes; m != NULL; m = m->next)
+      if (m->fbconfigID != GLX_DONT_CARE)
+         config[i++] = m;
+
+   *count = n;
+
+   return config;
+}
+
+static __GLcontextModes **
+array_get_fbconfigs(__GLcontextModes * modes, unsigned *count)
+{
+   __GLcontextModes *const *fbconfigs;
+   __GLcontextModes **config;
+
+   fbconfigs = _gl_context_modes_get_fbconfigs(modes, count);
+   config = malloc(sizeof(*config) * *count);
+   memcpy(config, fbconfigs, sizeof(*config) * *count);
+
+   return config;
+}
+
+static int
+walk_contains(__GLcontextModes * modes, const void *config)
+{
+   __GLcontextModes *m;
+
+   for (m = modes; m != NULL; m = m->next)
+      if (m == config)
+         return 1;
+
+   return 0;
+}
+
+static void
+report(const char *name, double walk, double table, unsigned long ops)
+{
+   printf("%-20s %12.1f %12.1f %8.1fx\n", name, walk * 1000.0 / ops,
+          table * 1000.0 / ops, walk / table);
+}
+
+int
+main(int argc, char *argv[])
+{
+   __GLcontextModes *modes, *m, **config;
+   unsigned count, nconfigs;
+   volatile unsigned long sink = 0;
+   double start, walk, table;
+   int i, pass;
+
+   nconfigs = (argc > 1) ? atoi(argv[1]) : DEFAULT_CONFIGS;
+
+   modes = _gl_context_modes_create(nconfigs, sizeof(*modes));
+   if (modes == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return EXIT_FAILURE;
+   }
+
+   for (m = modes, i = 0; m; m = m->next, i++) {
+      m->visualID = 0x21 + i;
+      m->fbconfigID = 0x21 + i;
+   }
+
+   _gl_context_modes_index(modes);
+
+   printf("%u configs\n", nconfigs);
+   printf("%-20s %12s %12s %9s\n", "case", "walk ns", "table ns", "speedup");
+
+   start = now();
+   for (pass = 0; pass < PASSES; pass++)
+      for (i = 0; i < (int) nconfigs; i++)
+         sink += (unsigned long) walk_find_fbconfig(modes, 0x21 + i);
+   walk = now() - start;
+
+   start = now();
+   for (pass = 0; pass < PASSES; pass++)
+      for (i = 0; i < (int) nconfigs; i++)
+         sink += (unsigned long) _gl_context_modes_find_fbconfig(modes,
+                                                                 0x21 + i);
+   table = now() - start;
+   report("find fbconfig", walk, table, (unsigned long) PASSES * nconfigs);
+
+   start = now();
+   for (pass = 0; pass < PASSES; pass++)
+      for (i = 0; i < (int) nconfigs; i++)
+         sink += (unsigned long) walk_find_visual(modes, 0x21 + i);
+   walk = now() - start;
+
+   start = now();
+   for (pass = 0; pass < PASSES; pass++)
+      for (i = 0; i < (int) nconfigs; i++)
+         sink += (unsigned long) _gl_context_modes_find_visual(modes,
+                                                               0x21 + i);
+   table = now() - start;
+   report("find visual", walk, table, (unsigned long) PASSES * nconfigs);
+
+   start = now();
+   for (pass = 0; pass < PASSES * 10; pass++) {
+      config = walk_get_fbconfigs(modes, &count);
+      sink += count;
+      free(config);
+   }
+   walk = now() - start;
+
+   start = now();
+   for (pass = 0; pass < PASSES * 10; pass++) {
+      config = array_get_fbconfigs(modes, &count);
+      sink += count;
+      free(config);
+   }
+   table = now() - start;
+   report("get fbconfigs", walk, table, PASSES * 10);
+
+   start = now();
+   for (pass = 0; pass < PASSES; pass++)
+      for (i = 0; i < (int) nconfigs; i++)
+         sink += walk_contains(modes, modes + i);
+   walk = now() - start;
+
+   start = now();
+   for (pass = 0; pass < PASSES; pass++)
+      for (i = 0; i < (int) nconfigs; i++)
+         sink += _gl_context_modes_contains(modes, modes + i);
+   table = now() - start;
+   report("validate fbconfig", walk, table,
+          (unsigned long) PASSES * nconfigs);
+
+   _gl_context_modes_destroy(modes);
+
+   return (sink != 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,167 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This registers drawables for real X pixmaps, frees half of the pixmaps,
+ * and then runs the incremental garbage collector until it has reclaimed
+ * them.  It reports the time of the slowest pass, and checks that every
+ * reclaimed drawable was torn down in a batch.  It links directly with
+ * the registry, but it needs an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#include "apple_glx_drawable.h"
+
+#define DRAWABLES 5000
+
+static unsigned long batched, unbatched;
+
+static void
+destroy_pixmap(Display * dpy, struct apple_glx_drawable *d,
+               struct apple_glx_drawable_batch *batch)
+{
+   /* The pixmap is already gone, so there's nothing to queue. */
+   if (batch)
+      ++batched;
+   else
+      ++unbatched;
+}
+
+static const struct apple_glx_drawable_callbacks callbacks = {
+   .type = APPLE_GLX_DRAWABLE_PIXMAP,
+   .make_current = NULL,
+   .destroy = destroy_pixmap
+};
+
+void
+apple_glx_diagnostic(const char *fmt, ...)
+{
+   (void) fmt;
+}
+
+/* There are no windows with a surface prefetch here. */
+int
+apple_glx_surface_prefetched(Display * dpy, GLXDrawable * drawables, int max)
+{
+   return 0;
+}
+
+void
+apple_glx_surface_reap_prefetch(Display * dpy, GLXDrawable drawable)
+{
+}
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+int
+main(int argc, char *argv[])
+{
+   Display *dpy;
+   Pixmap pixmaps[DRAWABLES];
+   struct apple_glx_drawable *d;
+   struct apple_glx_gc_stats stats;
+   double start, elapsed, slowest = 0.0;
+   int i, passes = 0;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   for (i = 0; i < DRAWABLES; ++i) {
+      pixmaps[i] = XCreatePixmap(dpy, DefaultRootWindow(dpy), 1, 1,
+                                 DefaultDepth(dpy, DefaultScreen(dpy)));
+
+      if (apple_glx_drawable_create(dpy, 0, pixmaps[i], &d, &callbacks)) {
+         fprintf(stderr, "error: unable to create drawable %d\n", i);
+         return EXIT_FAILURE;
+      }
+
+      /* Leave the drawable unreferenced, so that it can be collected. */
+      d->ops->release(d);
+      d->ops->unlock(d);
+   }
+
+   for (i = 0; i < DRAWABLES; i += 2)
+      XFreePixmap(dpy, pixmaps[i]);
+
+   XSync(dpy, False);
+
+   while (apple_glx_get_drawable_count() > DRAWABLES / 2) {
+      start = current_time();
+      apple_glx_garbage_collect_drawables(dpy);
+      elapsed = current_time() - start;
+
+      if (elapsed > slowest)
+         slowest = elapsed;
+
+      if (++passes > 10 * DRAWABLES) {
+         fprintf(stderr, "error: the collector isn't making progress\n");
+         return EXIT_FAILURE;
+      }
+   }
+
+   apple_glx_get_gc_stats(&stats);
+
+   printf("%d passes scanned %lu and reclaimed %lu drawables\n",
+          passes, stats.scanned, stats.reclaimed);
+   printf("slowest pass: %.3f ms\n", slowest * 1000.0);
+
+   if (unbatched || batched != stats.reclaimed) {
+      fprintf(stderr, "error: %lu of %lu drawables were destroyed outside "
+              "a batch\n", unbatched, stats.reclaimed);
+      return EXIT_FAILURE;
+   }
+
+   /* The live drawables must survive a full cycle. */
+   for (i = 0; i < 2 * DRAWABLES / 64; ++i)
+      apple_glx_garbage_collect_drawables(dpy);
+
+   if (apple_glx_get_drawable_count() != DRAWABLES / 2) {
+      fprintf(stderr, "error: a live drawable was collected\n");
+      return EXIT_FAILURE;
+   }
+
+   XCloseDisplay(dpy);
+
+   return EXIT_SUCCESS;
+}
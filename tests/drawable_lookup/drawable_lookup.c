@@ -0,0 +1,155 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This measures the lookup latency of the drawable registry in
+ * apple_glx_drawable.c with 10, 1k and 100k drawables.  It links
+ * directly with the registry, so no X server is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#include "apple_glx_drawable.h"
+
+#define LOOKUPS 1000000
+
+static const struct apple_glx_drawable_callbacks callbacks = {
+   .type = APPLE_GLX_DRAWABLE_SURFACE,
+   .make_current = NULL,
+   .destroy = NULL
+};
+
+void
+apple_glx_diagnostic(const char *fmt, ...)
+{
+   (void) fmt;
+}
+
+/* There are no windows with a surface prefetch here. */
+int
+apple_glx_surface_prefetched(Display * dpy, GLXDrawable * drawables, int max)
+{
+   return 0;
+}
+
+void
+apple_glx_surface_reap_prefetch(Display * dpy, GLXDrawable drawable)
+{
+}
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void
+run(int count)
+{
+   struct apple_glx_drawable **agds, *d;
+   GLXDrawable base = 0x200000;
+   double start, xid_ns, uid_ns;
+   int i;
+
+   agds = malloc(sizeof(*agds) * count);
+
+   if (NULL == agds) {
+      perror("malloc");
+      exit(EXIT_FAILURE);
+   }
+
+   for (i = 0; i < count; ++i) {
+      if (apple_glx_drawable_create(NULL, 0, base + i, &agds[i], &callbacks)) {
+         fprintf(stderr, "error: unable to create drawable %d\n", i);
+         exit(EXIT_FAILURE);
+      }
+
+      agds[i]->types.surface.uid = i + 1;
+      apple_glx_drawable_index_uid(agds[i]);
+      agds[i]->ops->unlock(agds[i]);
+   }
+
+   start = current_time();
+
+   for (i = 0; i < LOOKUPS; ++i) {
+      d = apple_glx_drawable_find(base + (random() % count), 0);
+
+      if (NULL == d) {
+         fprintf(stderr, "error: lookup by XID failed!\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   xid_ns = (current_time() - start) * 1e9 / LOOKUPS;
+
+   start = current_time();
+
+   for (i = 0; i < LOOKUPS; ++i) {
+      d = apple_glx_drawable_find_by_uid(1 + (random() % count), 0);
+
+      if (NULL == d) {
+         fprintf(stderr, "error: lookup by uid failed!\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   uid_ns = (current_time() - start) * 1e9 / LOOKUPS;
+
+   printf("%7d drawables: %8.1f ns/find by XID %8.1f ns/find by uid\n",
+          count, xid_ns, uid_ns);
+
+   for (i = 0; i < count; ++i) {
+      d = agds[i];
+      d->ops->destroy(d);
+   }
+
+   free(agds);
+
+   if (apple_glx_get_drawable_count()) {
+      fprintf(stderr, "error: %u drawables leaked!\n",
+              apple_glx_get_drawable_count());
+      exit(EXIT_FAILURE);
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   run(10);
+   run(1000);
+   run(100000);
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,3 @@
+$(TEST_BUILD_DIR)/drawable_lookup: tests/drawable_lookup/drawable_lookup.c apple_glx_drawable.o glxhash.o glx_async.o appledri.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/drawable_lookup/drawable_lookup.c $(INCLUDE) $(GL_CFLAGS) -o $@ apple_glx_drawable.o glxhash.o glx_async.o appledri.o -L$(X11_DIR)/lib -lX11 -lXext -lpthread
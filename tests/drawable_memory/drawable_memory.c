@@ -0,0 +1,140 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This reports the heap bytes per drawable record, for each type of
+ * drawable.  It registers drawables directly with the registry, without
+ * the type specific X requests, so it doesn't need an X server.  The
+ * shared memory name of a real GLXPixmap isn't included.
+ *
+ * usage: drawable_memory [drawables]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+#include "apple_glx_drawable.h"
+
+#define DEFAULT_DRAWABLES 100000
+
+static void
+destroy_nothing(Display * dpy, struct apple_glx_drawable *d,
+                struct apple_glx_drawable_batch *batch)
+{
+}
+
+static const struct apple_glx_drawable_callbacks callbacks[] = {
+   {.type = APPLE_GLX_DRAWABLE_SURFACE,.destroy = destroy_nothing},
+   {.type = APPLE_GLX_DRAWABLE_PBUFFER,.destroy = destroy_nothing},
+   {.type = APPLE_GLX_DRAWABLE_PIXMAP,.destroy = destroy_nothing}
+};
+
+static const char *names[] = { "surface", "pbuffer", "pixmap" };
+
+void
+apple_glx_diagnostic(const char *fmt, ...)
+{
+   (void) fmt;
+}
+
+/* There are no windows with a surface prefetch here. */
+int
+apple_glx_surface_prefetched(Display * dpy, GLXDrawable * drawables, int max)
+{
+   return 0;
+}
+
+void
+apple_glx_surface_reap_prefetch(Display * dpy, GLXDrawable drawable)
+{
+}
+
+static size_t
+heap_in_use(void)
+{
+#ifdef __APPLE__
+   malloc_statistics_t stats;
+
+   malloc_zone_statistics(NULL, &stats);
+
+   return stats.size_in_use;
+#else
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+   return mallinfo2().uordblks;
+#else
+   return mallinfo().uordblks;
+#endif
+#endif
+}
+
+int
+main(int argc, char *argv[])
+{
+   struct apple_glx_drawable *d;
+   struct apple_glx_drawable_pool_stats stats;
+   size_t before, after;
+   int i, t, count;
+
+   count = (argc > 1) ? atoi(argv[1]) : DEFAULT_DRAWABLES;
+
+   printf("%-10s %16s %12s\n", "type", "bytes/drawable", "record size");
+
+   for (t = 0; t < 3; t++) {
+      before = heap_in_use();
+
+      for (i = 0; i < count; i++) {
+         if (apple_glx_drawable_create(NULL, 0, 0x100000 + i, &d,
+                                       &callbacks[t])) {
+            fprintf(stderr, "error: unable to create drawable %d\n", i);
+            return EXIT_FAILURE;
+         }
+
+         d->ops->unlock(d);
+      }
+
+      after = heap_in_use();
+
+      apple_glx_get_drawable_pool_stats(callbacks[t].type, &stats);
+
+      printf("%-10s %16.1f %12zu\n", names[t],
+             (double) (after - before) / count, stats.record_size);
+
+      /* The creation reference is the last one, so this destroys it. */
+      for (i = 0; i < count; i++)
+         apple_glx_drawable_destroy_by_type(NULL, 0x100000 + i,
+                                            callbacks[t].type);
+   }
+
+   return (apple_glx_get_drawable_count() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,604 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * Throughput benchmarks for the GLX layer, built against the mock CGL and
+ * Xplugin backend in mock/.  Run them with make mock-bench, which starts
+ * Xvfb.  Each benchmark prints its rate and the mock CGL calls per
+ * operation.
+ *
+ * usage: mock_bench [iterations] [benchmark ...]
+ *
+ * MOCK_CGL_LATENCY_US, MOCK_XP_LATENCY_US and MOCK_DRI_LATENCY_US add a
+ * fixed cost to each call into the backend.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glx.h>
+#include "appledri.h"
+#include "mock_appledri.h"
+#include "mock_cgl.h"
+
+#define NUM_PBUFFERS 512
+#define NOTIFY_BURST 16
+
+struct benchmark
+{
+   const char *name;
+   /* Return the number of operations, or -1 if there was an error. */
+   long (*run) (Display * dpy, long iterations);
+};
+
+static int fbconfig_attribs[] = {
+   GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT | GLX_PBUFFER_BIT | GLX_PIXMAP_BIT,
+   GLX_RENDER_TYPE, GLX_RGBA_BIT,
+   GLX_RED_SIZE, 8,
+   GLX_GREEN_SIZE, 8,
+   GLX_BLUE_SIZE, 8,
+   None
+};
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static GLXFBConfig
+choose_fbconfig(Display * dpy)
+{
+   GLXFBConfig *configs, result;
+   int n;
+
+   configs = glXChooseFBConfig(dpy, DefaultScreen(dpy), fbconfig_attribs,
+                               &n);
+
+   if (NULL == configs || n < 1) {
+      fprintf(stderr, "error: no usable GLXFBConfig\n");
+      return NULL;
+   }
+
+   result = configs[0];
+   XFree(configs);
+
+   return result;
+}
+
+static Window
+create_window(Display * dpy, GLXFBConfig config)
+{
+   XSetWindowAttributes attr;
+   XVisualInfo *visinfo;
+   Window root, win;
+
+   visinfo = glXGetVisualFromFBConfig(dpy, config);
+
+   if (NULL == visinfo)
+      return None;
+
+   root = RootWindow(dpy, DefaultScreen(dpy));
+
+   attr.background_pixel = 0;
+   attr.border_pixel = 0;
+   attr.colormap = XCreateColormap(dpy, root, visinfo->visual, AllocNone);
+
+   win = XCreateWindow(dpy, root, 0, 0, 64, 64, 0, visinfo->depth,
+                       InputOutput, visinfo->visual,
+                       CWBackPixel | CWBorderPixel | CWColormap, &attr);
+
+   XFree(visinfo);
+
+   return win;
+}
+
+/* Alternate one context between two windows. */
+static long
+make_current_switch(Display * dpy, long iterations)
+{
+   GLXFBConfig config;
+   GLXContext ctx;
+   Window win[2];
+   long i;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   win[0] = create_window(dpy, config);
+   win[1] = create_window(dpy, config);
+   ctx = glXCreateNewContext(dpy, config, GLX_RGBA_TYPE, NULL, True);
+
+   if (None == win[0] || None == win[1] || NULL == ctx)
+      return -1;
+
+   for (i = 0; i < iterations; ++i) {
+      if (!glXMakeCurrent(dpy, win[i & 1], ctx))
+         return -1;
+   }
+
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyContext(dpy, ctx);
+   XDestroyWindow(dpy, win[0]);
+   XDestroyWindow(dpy, win[1]);
+
+   return iterations;
+}
+
+/* Rotate three contexts, each with its own window, as middleware does. */
+static long
+make_current_rotate(Display * dpy, long iterations)
+{
+   GLXFBConfig config;
+   GLXContext ctx[3];
+   Window win[3];
+   long i;
+   int n;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   for (n = 0; n < 3; ++n) {
+      win[n] = create_window(dpy, config);
+      ctx[n] = glXCreateNewContext(dpy, config, GLX_RGBA_TYPE, NULL, True);
+
+      if (None == win[n] || NULL == ctx[n])
+         return -1;
+   }
+
+   for (i = 0; i < iterations; ++i) {
+      if (!glXMakeCurrent(dpy, win[i % 3], ctx[i % 3]))
+         return -1;
+   }
+
+   glXMakeCurrent(dpy, None, NULL);
+
+   for (n = 0; n < 3; ++n) {
+      glXDestroyContext(dpy, ctx[n]);
+      XDestroyWindow(dpy, win[n]);
+   }
+
+   return iterations;
+}
+
+/* Make the same context and window current again and again. */
+static long
+make_current_same(Display * dpy, long iterations)
+{
+   GLXFBConfig config;
+   GLXContext ctx;
+   Window win;
+   long i;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   win = create_window(dpy, config);
+   ctx = glXCreateNewContext(dpy, config, GLX_RGBA_TYPE, NULL, True);
+
+   if (None == win || NULL == ctx)
+      return -1;
+
+   for (i = 0; i < iterations; ++i) {
+      if (!glXMakeCurrent(dpy, win, ctx))
+         return -1;
+   }
+
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyContext(dpy, ctx);
+   XDestroyWindow(dpy, win);
+
+   return iterations;
+}
+
+/* 
+ * The per-call overhead of the entry points that libGL wraps, which all
+ * look up the current context.  Each iteration is four calls.
+ */
+static long
+wrapped_calls(Display * dpy, long iterations)
+{
+   GLXFBConfig config;
+   GLXContext ctx;
+   GLenum buffers[1] = { GL_BACK };
+   GLuint pixel;
+   Window win;
+   long i;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   win = create_window(dpy, config);
+   ctx = glXCreateNewContext(dpy, config, GLX_RGBA_TYPE, NULL, True);
+
+   if (None == win || NULL == ctx || !glXMakeCurrent(dpy, win, ctx))
+      return -1;
+
+   for (i = 0; i < iterations; ++i) {
+      glViewport(0, 0, 64, 64);
+      glDrawBuffer(GL_BACK);
+      glDrawBuffers(1, buffers);
+      glReadPixels(0, 0, 1, 1, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, &pixel);
+   }
+
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyContext(dpy, ctx);
+   XDestroyWindow(dpy, win);
+
+   return iterations * 4;
+}
+
+struct notifier
+{
+   Display *dpy;
+   unsigned int uid;
+   long bursts;
+   pthread_barrier_t barrier;
+};
+
+/* This delivers the notifications from another thread, as an event loop. */
+static void *
+notify_bursts(void *arg)
+{
+   struct notifier *n = arg;
+   long i;
+   int k;
+
+   for (i = 0; i < n->bursts; ++i) {
+      pthread_barrier_wait(&n->barrier);
+
+      for (k = 0; k < NOTIFY_BURST; ++k)
+         mock_appledri_notify(n->dpy, n->uid, AppleDRISurfaceNotifyChanged);
+
+      pthread_barrier_wait(&n->barrier);
+   }
+
+   return NULL;
+}
+
+/* 
+ * Bursts of surface changes, as from an interactive resize, each followed
+ * by a glViewport in the rendering thread.  Each operation is one
+ * notification.
+ */
+static long
+surface_notify(Display * dpy, long iterations)
+{
+   struct notifier n;
+   GLXFBConfig config;
+   GLXContext ctx;
+   pthread_t thread;
+   Window win;
+   long i;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   win = create_window(dpy, config);
+   ctx = glXCreateNewContext(dpy, config, GLX_RGBA_TYPE, NULL, True);
+
+   if (None == win || NULL == ctx || !glXMakeCurrent(dpy, win, ctx))
+      return -1;
+
+   n.dpy = dpy;
+   n.uid = mock_appledri_surface_uid(win);
+   n.bursts = (iterations + NOTIFY_BURST - 1) / NOTIFY_BURST;
+
+   if (0 == n.uid)
+      return -1;
+
+   pthread_barrier_init(&n.barrier, NULL, 2);
+
+   if (pthread_create(&thread, NULL, notify_bursts, &n))
+      return -1;
+
+   for (i = 0; i < n.bursts; ++i) {
+      pthread_barrier_wait(&n.barrier);
+      pthread_barrier_wait(&n.barrier);
+      glViewport(0, 0, 64, 64);
+   }
+
+   pthread_join(thread, NULL);
+   pthread_barrier_destroy(&n.barrier);
+
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyContext(dpy, ctx);
+   XDestroyWindow(dpy, win);
+
+   return n.bursts * NOTIFY_BURST;
+}
+
+/* Query drawables out of a large set of live pbuffers. */
+static long
+drawable_lookup(Display * dpy, long iterations)
+{
+   int attribs[] = { GLX_PBUFFER_WIDTH, 16, GLX_PBUFFER_HEIGHT, 16, None };
+   GLXPbuffer pbufs[NUM_PBUFFERS];
+   GLXFBConfig config;
+   unsigned int width;
+   long i;
+   int n;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   for (n = 0; n < NUM_PBUFFERS; ++n) {
+      pbufs[n] = glXCreatePbuffer(dpy, config, attribs);
+
+      if (None == pbufs[n])
+         return -1;
+   }
+
+   for (i = 0; i < iterations; ++i) {
+      width = 0;
+      glXQueryDrawable(dpy, pbufs[(i * 7) % NUM_PBUFFERS], GLX_WIDTH,
+                       &width);
+
+      if (16 != width)
+         return -1;
+   }
+
+   for (n = 0; n < NUM_PBUFFERS; ++n)
+      glXDestroyPbuffer(dpy, pbufs[n]);
+
+   return iterations;
+}
+
+/* Create, render to, and destroy a pbuffer. */
+static long
+pbuffer_churn(Display * dpy, long iterations)
+{
+   int attribs[] = { GLX_PBUFFER_WIDTH, 64, GLX_PBUFFER_HEIGHT, 64, None };
+   GLXFBConfig config;
+   GLXContext ctx;
+   GLXPbuffer pbuf;
+   long i;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   ctx = glXCreateNewContext(dpy, config, GLX_RGBA_TYPE, NULL, True);
+
+   if (NULL == ctx)
+      return -1;
+
+   for (i = 0; i < iterations; ++i) {
+      pbuf = glXCreatePbuffer(dpy, config, attribs);
+
+      if (None == pbuf || !glXMakeContextCurrent(dpy, pbuf, pbuf, ctx))
+         return -1;
+
+      glClear(GL_COLOR_BUFFER_BIT);
+
+      glXMakeContextCurrent(dpy, None, None, NULL);
+      glXDestroyPbuffer(dpy, pbuf);
+   }
+
+   glXDestroyContext(dpy, ctx);
+
+   return iterations;
+}
+
+/* Create, render to, and destroy an X pixmap and its GLXPixmap. */
+static long
+pixmap_churn(Display * dpy, long iterations)
+{
+   GLXFBConfig config;
+   XVisualInfo *visinfo;
+   GLXContext ctx;
+   GLXPixmap glxpixmap;
+   Pixmap pixmap;
+   long i;
+
+   config = choose_fbconfig(dpy);
+
+   if (NULL == config)
+      return -1;
+
+   visinfo = glXGetVisualFromFBConfig(dpy, config);
+
+   if (NULL == visinfo)
+      return -1;
+
+   ctx = glXCreateContext(dpy, visinfo, NULL, False);
+
+   if (NULL == ctx)
+      return -1;
+
+   for (i = 0; i < iterations; ++i) {
+      pixmap = XCreatePixmap(dpy, RootWindow(dpy, DefaultScreen(dpy)),
+                             64, 64, visinfo->depth);
+      glxpixmap = glXCreateGLXPixmap(dpy, visinfo, pixmap);
+
+      if (None == glxpixmap || !glXMakeCurrent(dpy, glxpixmap, ctx))
+         return -1;
+
+      glClear(GL_COLOR_BUFFER_BIT);
+
+      glXMakeCurrent(dpy, None, NULL);
+      glXDestroyGLXPixmap(dpy, glxpixmap);
+      XFreePixmap(dpy, pixmap);
+   }
+
+   glXDestroyContext(dpy, ctx);
+   XFree(visinfo);
+
+   return iterations;
+}
+
+/* Choose an fbconfig and a visual with varied attributes. */
+static long
+choose_config(Display * dpy, long iterations)
+{
+   int visual_attribs[] = { GLX_RGBA, GLX_DOUBLEBUFFER, GLX_DEPTH_SIZE, 0,
+      None
+   };
+   int config_attribs[] = { GLX_RENDER_TYPE, GLX_RGBA_BIT,
+      GLX_DEPTH_SIZE, 0,
+      GLX_DOUBLEBUFFER, True,
+      None
+   };
+   GLXFBConfig *configs;
+   XVisualInfo *visinfo;
+   long i;
+   int n;
+
+   for (i = 0; i < iterations; ++i) {
+      visual_attribs[3] = config_attribs[3] = (i & 3) * 8;
+
+      configs = glXChooseFBConfig(dpy, DefaultScreen(dpy), config_attribs,
+                                  &n);
+
+      if (configs)
+         XFree(configs);
+
+      visinfo = glXChooseVisual(dpy, DefaultScreen(dpy), visual_attribs);
+
+      if (visinfo)
+         XFree(visinfo);
+   }
+
+   return iterations * 2;
+}
+
+static struct benchmark benchmarks[] = {
+   {"make_current_switch", make_current_switch},
+   {"make_current_rotate", make_current_rotate},
+   {"make_current_same", make_current_same},
+   {"wrapped_calls", wrapped_calls},
+   {"surface_notify", surface_notify},
+   {"drawable_lookup", drawable_lookup},
+   {"pbuffer_churn", pbuffer_churn},
+   {"pixmap_churn", pixmap_churn},
+   {"choose_config", choose_config}
+};
+
+#define NUM_BENCHMARKS (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static bool
+selected(const char *name, int argc, char *argv[])
+{
+   int i;
+
+   if (argc < 3)
+      return true;
+
+   for (i = 2; i < argc; ++i)
+      if (!strcmp(name, argv[i]))
+         return true;
+
+   return false;
+}
+
+int
+main(int argc, char *argv[])
+{
+   struct mock_cgl_stats stats;
+   unsigned long attaches;
+   Display *dpy;
+   long iterations = 10000, ops;
+   double start, elapsed;
+   unsigned int i;
+   int failures = 0;
+
+   if (argc > 1)
+      iterations = strtol(argv[1], NULL, 10);
+
+   if (iterations < 1) {
+      fprintf(stderr, "usage: %s [iterations] [benchmark ...]\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   for (i = 0; i < NUM_BENCHMARKS; ++i) {
+      if (!selected(benchmarks[i].name, argc, argv))
+         continue;
+
+      /* The first run pays for the GLX and backend initialization. */
+      if (benchmarks[i].run(dpy, 1) < 0) {
+         printf("%-20s FAILED\n", benchmarks[i].name);
+         ++failures;
+         continue;
+      }
+
+      MockCGLResetStats();
+
+      start = current_time();
+      ops = benchmarks[i].run(dpy, iterations);
+      elapsed = current_time() - start;
+
+      if (ops <= 0) {
+         printf("%-20s FAILED\n", benchmarks[i].name);
+         ++failures;
+         continue;
+      }
+
+      MockCGLGetStats(&stats);
+
+      attaches = stats.set_surface + stats.set_pbuffer + stats.set_off_screen;
+
+      printf("%-20s %10.0f ops/s %8.3f set_current/op %8.3f attach/op "
+             "%8.3f contexts/op\n", benchmarks[i].name, ops / elapsed,
+             (double) stats.set_current_context / ops,
+             (double) attaches / ops, (double) stats.create_context / ops);
+   }
+
+   XCloseDisplay(dpy);
+
+   return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,2 @@
+$(MOCK_BUILD_DIR)/mock_bench: tests/mock_bench/mock_bench.c $(MOCK_LIBGL) $(MOCK_CGL)
+	$(CC) tests/mock_bench/mock_bench.c $(MOCK_INCLUDE) $(MOCK_CFLAGS) -o $@ $(MOCK_LIBGL) $(MOCK_CGL) -Wl,-rpath,$(CURDIR)/$(MOCK_BUILD_DIR) -lX11 -lpthread
@@ -0,0 +1,148 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This tests the pixel format cache in apple_visual.c.  It replaces the
+ * apple_cgl table with stubs that count calls, so it doesn't need CGL
+ * or an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "apple_cgl.h"
+#include <GL/glxint.h>
+#include "apple_visual.h"
+#include "glcontextmodes.h"
+
+struct apple_cgl_api apple_cgl;
+
+static int choose_calls = 0;
+static int destroy_calls = 0;
+static int live_pfobjs = 0;
+
+void
+apple_glx_diagnostic(const char *fmt, ...)
+{
+   (void) fmt;
+}
+
+static CGLError
+stub_choose_pixel_format(const CGLPixelFormatAttribute * attribs,
+                         CGLPixelFormatObj * pix, GLint * npix)
+{
+   ++choose_calls;
+   ++live_pfobjs;
+   *pix = malloc(1);
+   *npix = 1;
+   return kCGLNoError;
+}
+
+static CGLError
+stub_destroy_pixel_format(CGLPixelFormatObj pix)
+{
+   ++destroy_calls;
+   --live_pfobjs;
+   free(pix);
+   return kCGLNoError;
+}
+
+static const char *
+stub_error_string(CGLError error)
+{
+   return "stub error";
+}
+
+static void
+check(int cond, const char *what)
+{
+   if (!cond) {
+      fprintf(stderr, "FAIL: %s (choose %d destroy %d live %d)\n", what,
+              choose_calls, destroy_calls, live_pfobjs);
+      exit(EXIT_FAILURE);
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   __GLcontextModes a, b;
+   CGLPixelFormatObj pa1, pa2, pb, poff;
+   bool double_buffered, uses_stereo;
+   unsigned long hits, misses;
+
+   apple_cgl.choose_pixel_format = stub_choose_pixel_format;
+   apple_cgl.destroy_pixel_format = stub_destroy_pixel_format;
+   apple_cgl.error_string = stub_error_string;
+
+   memset(&a, 0, sizeof(a));
+   a.redBits = a.greenBits = a.blueBits = 8;
+   a.depthBits = 24;
+   a.doubleBufferMode = GL_TRUE;
+
+   b = a;
+   b.stencilBits = 8;
+
+   apple_visual_create_pfobj(&pa1, &a, &double_buffered, &uses_stereo,
+                             false);
+   apple_visual_create_pfobj(&pa2, &a, &double_buffered, &uses_stereo,
+                             false);
+   check(pa1 == pa2 && 1 == choose_calls, "identical modes share a pfobj");
+   check(double_buffered && !uses_stereo, "the mode flags are returned");
+
+   apple_visual_create_pfobj(&pb, &b, &double_buffered, &uses_stereo,
+                             false);
+   check(pb != pa1 && 2 == choose_calls, "different modes don't share");
+
+   apple_visual_create_pfobj(&poff, &a, &double_buffered, &uses_stereo,
+                             true);
+   check(poff != pa1 && 3 == choose_calls, "offscreen is part of the key");
+
+   apple_visual_get_pfobj_stats(&hits, &misses);
+   check(1 == hits && 3 == misses, "hit and miss counters");
+
+   apple_visual_destroy_pfobj(pa1);
+   check(0 == destroy_calls, "a shared pfobj outlives its first user");
+
+   apple_visual_destroy_pfobj(pa2);
+   apple_visual_destroy_pfobj(pb);
+   apple_visual_destroy_pfobj(poff);
+   check(3 == destroy_calls && 0 == live_pfobjs, "the last user releases");
+
+   apple_visual_create_pfobj(&pa1, &a, &double_buffered, &uses_stereo,
+                             false);
+   check(4 == choose_calls, "a released entry is chosen again");
+   apple_visual_destroy_pfobj(pa1);
+   check(0 == live_pfobjs, "no pixel formats leaked");
+
+   printf("PASS\n");
+
+   return EXIT_SUCCESS;
+}
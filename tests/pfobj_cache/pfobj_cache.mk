@@ -0,0 +1,3 @@
+$(TEST_BUILD_DIR)/pfobj_cache: tests/pfobj_cache/pfobj_cache.c apple_visual.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/pfobj_cache/pfobj_cache.c $(INCLUDE) $(GL_CFLAGS) -o $@ apple_visual.o -lpthread
@@ -0,0 +1,247 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This checks that __glFillImage and __glEmptyImage produce the same bytes
+ * as the original scalar loops, for random pixel store modes, and that
+ * every kernel table the CPU supports matches the scalar table.
+ * It doesn't need an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glxclient.h"
+#include "pixel_kernels.h"
+#include "pixel_reference.h"
+
+#define ITERATIONS 2000
+#define BUFFER_SIZE (1 << 18)
+#define MAX_REPORTS 10
+
+/* This is normally defined in apple_glx.c. */
+const GLuint __glXDefaultPixelStore[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+static const struct
+{
+   GLenum format, type;
+} formats[] = {
+   {GL_COLOR_INDEX, GL_BITMAP},
+   {GL_LUMINANCE_ALPHA, GL_BITMAP},
+   {GL_RGBA, GL_UNSIGNED_BYTE},
+   {GL_RGB, GL_UNSIGNED_SHORT},
+   {GL_LUMINANCE, GL_SHORT},
+   {GL_RGB, GL_UNSIGNED_SHORT_5_6_5},
+   {GL_RGBA, GL_FLOAT},
+   {GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV},
+   {GL_DEPTH_COMPONENT, GL_UNSIGNED_INT}
+};
+
+#define NUM_FORMATS (sizeof(formats) / sizeof(formats[0]))
+
+static GLubyte *user[2], *image[2], *source;
+
+static int
+random_range(int n)
+{
+   return random() % n;
+}
+
+static void
+fill_random(GLubyte * p, size_t size)
+{
+   size_t i;
+
+   for (i = 0; i < size; ++i)
+      p[i] = random();
+}
+
+static void
+random_modes(__GLXpixelStoreMode * mode, int width, int height)
+{
+   static const GLuint alignments[] = { 1, 2, 4, 8 };
+
+   mode->swapEndian = random_range(2);
+   mode->lsbFirst = random_range(2);
+   mode->rowLength = random_range(2) ? width + random_range(40) : 0;
+   mode->imageHeight = random_range(2) ? height + random_range(3) : 0;
+   mode->skipRows = random_range(3);
+   mode->skipPixels = random_range(18);
+   mode->skipImages = random_range(2);
+   mode->alignment = alignments[random_range(4)];
+}
+
+static int
+check_images(__GLXcontext * gc, __GLXattribute * state)
+{
+   int i, f, width, height, depth, dim;
+   int errors = 0;
+   GLubyte modes[2][36];
+
+   for (i = 0; i < ITERATIONS; ++i) {
+      f = random_range(NUM_FORMATS);
+      width = 1 + random_range((i & 1) ? 300 : 40);
+      height = 1 + random_range(5);
+      depth = 1 + random_range(2);
+      dim = (depth > 1) ? 3 : 2;
+
+      random_modes(&state->storeUnpack, width, height);
+      random_modes(&state->storePack, width, height);
+
+      fill_random(user[0], BUFFER_SIZE);
+      memcpy(user[1], user[0], BUFFER_SIZE);
+      memset(image[0], 0xa5, BUFFER_SIZE);
+      memset(image[1], 0xa5, BUFFER_SIZE);
+
+      ReferenceFillImage(gc, dim, width, height, depth, formats[f].format,
+                         formats[f].type, user[0], image[0], modes[0]);
+      __glFillImage(gc, dim, width, height, depth, formats[f].format,
+                    formats[f].type, user[0], image[1], modes[1]);
+
+      if (memcmp(image[0], image[1], BUFFER_SIZE)
+          || memcmp(modes[0], modes[1], (dim < 3) ? 20 : 36)) {
+         if (errors < MAX_REPORTS)
+            fprintf(stderr, "__glFillImage mismatch: iteration %d "
+                    "format %d %dx%dx%d\n", i, f, width, height, depth);
+         ++errors;
+      }
+
+      ReferenceEmptyImage(gc, dim, width, height, depth, formats[f].format,
+                          formats[f].type, source, user[0]);
+      __glEmptyImage(gc, dim, width, height, depth, formats[f].format,
+                     formats[f].type, source, user[1]);
+
+      if (memcmp(user[0], user[1], BUFFER_SIZE)) {
+         if (errors < MAX_REPORTS)
+            fprintf(stderr, "__glEmptyImage mismatch: iteration %d "
+                    "format %d %dx%dx%d\n", i, f, width, height, depth);
+         ++errors;
+      }
+   }
+
+   return errors;
+}
+
+static int
+check_kernels(const struct __GLXpixelKernels *k,
+              const struct __GLXpixelKernels *scalar)
+{
+   GLubyte *src = source + 1;
+   size_t count;
+   int offset, lsb, errors = 0;
+
+   for (count = 0; count < 300; ++count) {
+      memset(image[0], 0x5a, count * 4 + 64);
+      memset(image[1], 0x5a, count * 4 + 64);
+      scalar->swap2(image[0], src, count);
+      k->swap2(image[1], src, count);
+
+      if (memcmp(image[0], image[1], count * 4 + 64)) {
+         fprintf(stderr, "%s swap2 mismatch: %zu\n", k->name, count);
+         ++errors;
+      }
+
+      scalar->swap4(image[0], src, count);
+      k->swap4(image[1], src, count);
+
+      if (memcmp(image[0], image[1], count * 4 + 64)) {
+         fprintf(stderr, "%s swap4 mismatch: %zu\n", k->name, count);
+         ++errors;
+      }
+
+      for (offset = 0; offset < 8; ++offset) {
+         for (lsb = 0; lsb < 2; ++lsb) {
+            scalar->unpack_bits(image[0], src, count, offset, lsb);
+            k->unpack_bits(image[1], src, count, offset, lsb);
+
+            if (memcmp(image[0], image[1], count + 64)) {
+               fprintf(stderr, "%s unpack_bits mismatch: %zu %d %d\n",
+                       k->name, count, offset, lsb);
+               ++errors;
+            }
+
+            scalar->pack_bits(image[0], src, count, offset, lsb);
+            k->pack_bits(image[1], src, count, offset, lsb);
+
+            if (memcmp(image[0], image[1], count + 64)) {
+               fprintf(stderr, "%s pack_bits mismatch: %zu %d %d\n",
+                       k->name, count, offset, lsb);
+               ++errors;
+            }
+         }
+      }
+   }
+
+   return errors;
+}
+
+int
+main(int argc, char *argv[])
+{
+   __GLXcontext gc;
+   __GLXattribute state;
+   const struct __GLXpixelKernels *const *list;
+   int i, count, errors;
+
+   memset(&gc, 0, sizeof(gc));
+   memset(&state, 0, sizeof(state));
+   gc.client_state_private = &state;
+
+   for (i = 0; i < 2; ++i) {
+      user[i] = malloc(BUFFER_SIZE);
+      image[i] = malloc(BUFFER_SIZE);
+   }
+
+   source = malloc(BUFFER_SIZE);
+
+   if (!user[0] || !user[1] || !image[0] || !image[1] || !source) {
+      fprintf(stderr, "out of memory\n");
+      return EXIT_FAILURE;
+   }
+
+   srandom(1);
+   fill_random(source, BUFFER_SIZE);
+
+   list = __glXGetPixelKernelList(&count);
+   printf("using the %s kernels\n", __glXGetPixelKernels()->name);
+
+   errors = check_images(&gc, &state);
+
+   for (i = 0; i < count; ++i)
+      errors += check_kernels(list[i], list[count - 1]);
+
+   if (errors) {
+      printf("%d mismatches\n", errors);
+      return EXIT_FAILURE;
+   }
+
+   printf("all kernels match the scalar loops\n");
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,9 @@
+PIXEL_KERNELS_OBJECTS=pixel.o pixel_kernels.o compsize.o
+
+$(TEST_BUILD_DIR)/pixel_kernels: tests/pixel_kernels/pixel_kernels.c tests/pixel_kernels/pixel_reference.c tests/pixel_kernels/pixel_reference.h $(PIXEL_KERNELS_OBJECTS)
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/pixel_kernels/pixel_kernels.c tests/pixel_kernels/pixel_reference.c $(INCLUDE) -Itests/pixel_kernels $(GL_CFLAGS) -o $@ $(PIXEL_KERNELS_OBJECTS) -lpthread
+
+$(TEST_BUILD_DIR)/pixel_kernels_bench: tests/pixel_kernels/pixel_kernels_bench.c tests/pixel_kernels/pixel_reference.c tests/pixel_kernels/pixel_reference.h $(PIXEL_KERNELS_OBJECTS)
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/pixel_kernels/pixel_kernels_bench.c tests/pixel_kernels/pixel_reference.c $(INCLUDE) -Itests/pixel_kernels $(GL_CFLAGS) -o $@ $(PIXEL_KERNELS_OBJECTS) -lpthread
@@ -0,0 +1,165 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This times __glFillImage and __glEmptyImage for a few image sizes and
+ * pixel store modes, against the original scalar loops.  Set
+ * LIBGL_PIXEL_KERNELS to time a kernel table other than the default.
+ * It doesn't need an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "glxclient.h"
+#include "pixel_kernels.h"
+#include "pixel_reference.h"
+
+/* This is normally defined in apple_glx.c. */
+const GLuint __glXDefaultPixelStore[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+/* The number of bytes to process in each test. */
+#define TOTAL_BYTES (256 << 20)
+
+static const int sizes[] = { 64, 256, 1024 };
+
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static const struct
+{
+   const char *name;
+   GLenum format, type;
+   GLboolean swap, lsb_first;
+   GLuint skip_pixels;
+   bool empty;
+} cases[] = {
+   {"fill ushort swap", GL_RGBA, GL_UNSIGNED_SHORT, GL_TRUE, GL_FALSE, 0,
+    false},
+   {"fill uint swap", GL_RGBA, GL_UNSIGNED_INT, GL_TRUE, GL_FALSE, 0, false},
+   {"fill bitmap lsb", GL_COLOR_INDEX, GL_BITMAP, GL_FALSE, GL_TRUE, 0,
+    false},
+   {"fill bitmap skip 3", GL_COLOR_INDEX, GL_BITMAP, GL_FALSE, GL_FALSE, 3,
+    false},
+   {"empty bitmap lsb", GL_COLOR_INDEX, GL_BITMAP, GL_FALSE, GL_TRUE, 0,
+    true},
+   {"empty bitmap skip 3", GL_COLOR_INDEX, GL_BITMAP, GL_FALSE, GL_FALSE, 3,
+    true}
+};
+
+#define NUM_CASES (sizeof(cases) / sizeof(cases[0]))
+
+static double
+now(void)
+{
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+
+   return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static double
+run(__GLXcontext * gc, int c, int size, bool reference, GLubyte * user,
+    GLubyte * image)
+{
+   GLint bytes = __glImageSize(size, size, 1, cases[c].format,
+                               cases[c].type, 0);
+   int i, iterations = TOTAL_BYTES / bytes;
+   double start = now();
+
+   for (i = 0; i < iterations; ++i) {
+      if (cases[c].empty) {
+         if (reference)
+            ReferenceEmptyImage(gc, 2, size, size, 1, cases[c].format,
+                                cases[c].type, image, user);
+         else
+            __glEmptyImage(gc, 2, size, size, 1, cases[c].format,
+                           cases[c].type, image, user);
+      }
+      else {
+         if (reference)
+            ReferenceFillImage(gc, 2, size, size, 1, cases[c].format,
+                               cases[c].type, user, image, NULL);
+         else
+            __glFillImage(gc, 2, size, size, 1, cases[c].format,
+                          cases[c].type, user, image, NULL);
+      }
+   }
+
+   return (now() - start) * 1000000.0 / iterations;
+}
+
+int
+main(int argc, char *argv[])
+{
+   __GLXcontext gc;
+   __GLXattribute state;
+   __GLXpixelStoreMode *mode;
+   GLubyte *user, *image;
+   size_t max = 1024 * 1024 * 16 + 4096;
+   int c, s;
+   double reference, kernels;
+
+   memset(&gc, 0, sizeof(gc));
+   memset(&state, 0, sizeof(state));
+   gc.client_state_private = &state;
+
+   user = calloc(1, max);
+   image = calloc(1, max);
+
+   if (!user || !image) {
+      fprintf(stderr, "out of memory\n");
+      return EXIT_FAILURE;
+   }
+
+   printf("%-20s %6s %12s %12s %8s\n", "case", "size", "original us",
+          __glXGetPixelKernels()->name, "speedup");
+
+   for (c = 0; c < NUM_CASES; ++c) {
+      mode = cases[c].empty ? &state.storePack : &state.storeUnpack;
+      memset(&state.storePack, 0, sizeof(state.storePack));
+      memset(&state.storeUnpack, 0, sizeof(state.storeUnpack));
+      state.storePack.alignment = 4;
+      state.storeUnpack.alignment = 4;
+      mode->swapEndian = cases[c].swap;
+      mode->lsbFirst = cases[c].lsb_first;
+      mode->skipPixels = cases[c].skip_pixels;
+
+      for (s = 0; s < NUM_SIZES; ++s) {
+         reference = run(&gc, c, sizes[s], true, user, image);
+         kernels = run(&gc, c, sizes[s], false, user, image);
+
+         printf("%-20s %6d %12.2f %12.2f %7.2fx\n", cases[c].name, sizes[s],
+                reference, kernels, reference / kernels);
+      }
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+#ifndef PIXEL_REFERENCE_H
+#define PIXEL_REFERENCE_H
+
+#include "glxclient.h"
+
+/* The original __glFillImage and __glEmptyImage. */
+void ReferenceFillImage(__GLXcontext * gc, GLint dim, GLint width,
+                        GLint height, GLint depth, GLenum format, GLenum type,
+                        const GLvoid * userdata, GLubyte * newimage,
+                        GLubyte * modes);
+
+void ReferenceEmptyImage(__GLXcontext * gc, GLint dim, GLint width,
+                         GLint height, GLint depth, GLenum format,
+                         GLenum type, const GLubyte * sourceImage,
+                         GLvoid * userdata);
+
+#endif
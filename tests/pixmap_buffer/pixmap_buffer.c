@@ -0,0 +1,199 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This renders to a GLXPixmap, and checks that the view from
+ * glXQueryPixmapBufferAPPLE has the same pixels as glReadPixels.  It also
+ * times both ways of getting the pixels.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+#include <GL/glxext.h>
+
+#define READS 1000
+#define WIDTH 300
+#define HEIGHT 200
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Clear quarters of the pixmap to different colors. */
+static void
+render(void)
+{
+   glViewport(0, 0, WIDTH, HEIGHT);
+   glClearColor(0.0, 0.0, 1.0, 1.0);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glEnable(GL_SCISSOR_TEST);
+   glScissor(0, 0, WIDTH / 2, HEIGHT / 2);
+   glClearColor(1.0, 0.0, 0.0, 1.0);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glScissor(WIDTH / 2, HEIGHT / 2, WIDTH / 2, HEIGHT / 2);
+   glClearColor(0.0, 1.0, 0.0, 1.0);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glDisable(GL_SCISSOR_TEST);
+}
+
+int
+main(int argc, char *argv[])
+{
+   int attrib[] = { GLX_RGBA, GLX_RED_SIZE, 8, GLX_GREEN_SIZE, 8,
+      GLX_BLUE_SIZE, 8, None
+   };
+   Display *dpy;
+   XVisualInfo *visinfo;
+   GLXContext ctx;
+   Pixmap pixmap;
+   GLXPixmap glxpixmap;
+   PFNGLXQUERYPIXMAPBUFFERAPPLEPROC query;
+   const void *data;
+   const GLubyte *row;
+   GLubyte *pixels;
+   int width, height, pitch, y, i;
+   GLenum format, type;
+   double start, read_time, view_time;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   query = (PFNGLXQUERYPIXMAPBUFFERAPPLEPROC)
+      glXGetProcAddress((const GLubyte *) "glXQueryPixmapBufferAPPLE");
+
+   if (NULL == query) {
+      fprintf(stderr, "error: glXQueryPixmapBufferAPPLE is missing\n");
+      return EXIT_FAILURE;
+   }
+
+   visinfo = glXChooseVisual(dpy, DefaultScreen(dpy), attrib);
+
+   if (NULL == visinfo) {
+      fprintf(stderr, "error: choosing a visual\n");
+      return EXIT_FAILURE;
+   }
+
+   ctx = glXCreateContext(dpy, visinfo, NULL, True);
+   pixmap = XCreatePixmap(dpy, DefaultRootWindow(dpy), WIDTH, HEIGHT,
+                          visinfo->depth);
+   glxpixmap = glXCreateGLXPixmap(dpy, visinfo, pixmap);
+
+   if (NULL == ctx || None == glxpixmap
+       || !glXMakeCurrent(dpy, glxpixmap, ctx)) {
+      fprintf(stderr, "error: making the pixmap current\n");
+      return EXIT_FAILURE;
+   }
+
+   if (query(dpy, None, &data, &width, &height, &pitch, &format, &type)) {
+      fprintf(stderr, "error: None isn't a GLXPixmap\n");
+      return EXIT_FAILURE;
+   }
+
+   render();
+
+   /* The query must finish the rendering, so there's no glFinish here. */
+   if (!query(dpy, glxpixmap, &data, &width, &height, &pitch, &format,
+              &type)) {
+      fprintf(stderr, "error: querying the pixmap buffer\n");
+      return EXIT_FAILURE;
+   }
+
+   printf("%dx%d pitch %d format 0x%x type 0x%x\n", width, height, pitch,
+          format, type);
+
+   if (WIDTH != width || HEIGHT != height || GL_BGRA != format
+       || GL_UNSIGNED_INT_8_8_8_8_REV != type) {
+      fprintf(stderr, "error: unexpected pixmap buffer layout\n");
+      return EXIT_FAILURE;
+   }
+
+   pixels = malloc(WIDTH * HEIGHT * 4);
+
+   if (NULL == pixels) {
+      fprintf(stderr, "error: out of memory\n");
+      return EXIT_FAILURE;
+   }
+
+   glPixelStorei(GL_PACK_ALIGNMENT, 4);
+   glReadPixels(0, 0, WIDTH, HEIGHT, format, type, pixels);
+
+   /* The buffer's rows are top-down, and glReadPixels rows are bottom-up. */
+   for (y = 0; y < HEIGHT; ++y) {
+      row = (const GLubyte *) data + (size_t) (HEIGHT - 1 - y) * pitch;
+
+      if (memcmp(row, pixels + y * WIDTH * 4, WIDTH * 4)) {
+         fprintf(stderr, "error: row %d differs from glReadPixels\n", y);
+         return EXIT_FAILURE;
+      }
+   }
+
+   start = current_time();
+
+   for (i = 0; i < READS; ++i)
+      glReadPixels(0, 0, WIDTH, HEIGHT, format, type, pixels);
+
+   read_time = current_time() - start;
+
+   start = current_time();
+
+   for (i = 0; i < READS; ++i)
+      (void) query(dpy, glxpixmap, &data, &width, &height, &pitch, &format,
+                   &type);
+
+   view_time = current_time() - start;
+
+   printf("glReadPixels: %.2f us per read\n", read_time * 1000000.0 / READS);
+   printf("glXQueryPixmapBufferAPPLE: %.2f us per query\n",
+          view_time * 1000000.0 / READS);
+
+   free(pixels);
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyGLXPixmap(dpy, glxpixmap);
+   XFreePixmap(dpy, pixmap);
+   glXDestroyContext(dpy, ctx);
+   XCloseDisplay(dpy);
+
+   printf("the pixmap buffer matches glReadPixels\n");
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,2 @@
+$(TEST_BUILD_DIR)/pixmap_buffer: tests/pixmap_buffer/pixmap_buffer.c $(LIBGL)
+	$(CC) tests/pixmap_buffer/pixmap_buffer.c $(INCLUDE) -o $@ $(LINK_TEST)
@@ -0,0 +1,250 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This tests the GLXPixmap context pool.  It replaces the apple_cgl table
+ * and the pixel format release with stubs that count calls, so it doesn't
+ * need CGL or an X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "apple_cgl.h"
+#include "apple_glx_pixmap_pool.h"
+
+struct apple_cgl_api apple_cgl;
+
+/* The stub contexts have an enable and a viewport. */
+struct stub_context
+{
+   int enabled;
+   int viewport[4];
+};
+
+static int live_contexts = 0;
+static int destroyed_contexts = 0;
+static int released_pfobjs = 0;
+static int referenced_pfobjs = 0;
+static int copied_contexts = 0;
+static struct stub_context *current = NULL;
+
+void
+apple_glx_diagnostic(const char *fmt, ...)
+{
+   (void) fmt;
+}
+
+void
+apple_visual_destroy_pfobj(CGLPixelFormatObj pfobj)
+{
+   ++released_pfobjs;
+}
+
+bool
+apple_visual_reference_pfobj(CGLPixelFormatObj pfobj)
+{
+   ++referenced_pfobjs;
+   return true;
+}
+
+void
+glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+   current->viewport[0] = x;
+   current->viewport[1] = y;
+   current->viewport[2] = width;
+   current->viewport[3] = height;
+}
+
+void
+glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+}
+
+static CGLError
+stub_clear_drawable(CGLContextObj ctx)
+{
+   return kCGLNoError;
+}
+
+static CGLError
+stub_destroy_context(CGLContextObj ctx)
+{
+   ++destroyed_contexts;
+   --live_contexts;
+   free(ctx);
+   return kCGLNoError;
+}
+
+static CGLContextObj
+new_context(void)
+{
+   ++live_contexts;
+   return calloc(1, sizeof(struct stub_context));
+}
+
+static CGLError
+stub_create_context(CGLPixelFormatObj pix, CGLContextObj share,
+                    CGLContextObj * ctx)
+{
+   *ctx = new_context();
+   return kCGLNoError;
+}
+
+static CGLError
+stub_copy_context(CGLContextObj src, CGLContextObj dst, GLbitfield mask)
+{
+   struct stub_context *from = (struct stub_context *) src;
+   struct stub_context *to = (struct stub_context *) dst;
+
+   ++copied_contexts;
+
+   if (mask & GL_ENABLE_BIT)
+      to->enabled = from->enabled;
+
+   if (mask & GL_VIEWPORT_BIT)
+      memcpy(to->viewport, from->viewport, sizeof(to->viewport));
+
+   return kCGLNoError;
+}
+
+static CGLError
+stub_set_current_context(CGLContextObj ctx)
+{
+   current = (struct stub_context *) ctx;
+   return kCGLNoError;
+}
+
+static CGLContextObj
+stub_get_current_context(void)
+{
+   return (CGLContextObj) current;
+}
+
+static void
+check(int cond, const char *what)
+{
+   if (!cond) {
+      fprintf(stderr, "FAIL: %s (live %d destroyed %d released %d)\n",
+              what, live_contexts, destroyed_contexts, released_pfobjs);
+      exit(EXIT_FAILURE);
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   CGLPixelFormatObj pfa = (CGLPixelFormatObj) 0x10;
+   CGLPixelFormatObj pfb = (CGLPixelFormatObj) 0x20;
+   CGLContextObj c1, c2, c3, found;
+   struct stub_context *state, other;
+   struct apple_glx_pixmap_pool_stats stats;
+   const size_t size = 64 * 64 * 4;
+
+   apple_cgl.clear_drawable = stub_clear_drawable;
+   apple_cgl.destroy_context = stub_destroy_context;
+   apple_cgl.create_context = stub_create_context;
+   apple_cgl.copy_context = stub_copy_context;
+   apple_cgl.set_current_context = stub_set_current_context;
+   apple_cgl.get_current_context = stub_get_current_context;
+
+   /* Room for two 64x64 pixmaps. */
+   setenv("LIBGL_PIXMAP_POOL_BYTES", "40000", 1);
+
+   check(!apple_glx_pixmap_pool_get(pfa, 64, 64, 256, size, &found),
+         "an empty pool misses");
+
+   /* The released context has the state of its previous pixmap. */
+   c1 = new_context();
+   state = (struct stub_context *) c1;
+   state->enabled = 1;
+   state->viewport[2] = 16;
+   current = &other;
+
+   apple_glx_pixmap_pool_put(pfa, 64, 64, 256, size, c1);
+   check(0 == destroyed_contexts, "a released context is retained");
+   check(1 == referenced_pfobjs && 2 == live_contexts,
+         "a pristine context is made for the pixel format");
+   check(1 == copied_contexts && 0 == state->enabled,
+         "a released context is reset");
+   check(0 == state->viewport[0] && 64 == state->viewport[2]
+         && 64 == state->viewport[3],
+         "the viewport of a reset context covers the pixmap");
+   check(&other == current, "the current context is restored");
+
+   check(!apple_glx_pixmap_pool_get(pfb, 64, 64, 256, size, &found),
+         "the pixel format is part of the key");
+   check(!apple_glx_pixmap_pool_get(pfa, 32, 128, 128, size, &found),
+         "the dimensions are part of the key");
+
+   check(apple_glx_pixmap_pool_get(pfa, 64, 64, 256, size, &found)
+         && found == c1, "a matching pixmap reuses the context");
+   check(1 == released_pfobjs, "a hit releases the pool's pfobj");
+
+   apple_glx_pixmap_pool_get_stats(&stats);
+   check(1 == stats.hits && 3 == stats.misses, "hit and miss counters");
+   check(0 == stats.bytes_retained && 0 == stats.entries,
+         "a hit removes the entry");
+
+   c2 = new_context();
+   c3 = new_context();
+   apple_glx_pixmap_pool_put(pfa, 64, 64, 256, size, c1);
+   apple_glx_pixmap_pool_put(pfa, 64, 64, 256, size, c2);
+   apple_glx_pixmap_pool_get_stats(&stats);
+   check(2 * size == stats.bytes_retained && 2 == stats.entries,
+         "bytes retained");
+   check(1 == stats.formats && 1 == referenced_pfobjs,
+         "the pristine context is shared by its pixel format");
+
+   apple_glx_pixmap_pool_put(pfb, 64, 64, 256, size, c3);
+   apple_glx_pixmap_pool_get_stats(&stats);
+   check(1 == destroyed_contexts && 1 == stats.evictions,
+         "the byte limit evicts");
+   check(apple_glx_pixmap_pool_get(pfa, 64, 64, 256, size, &found)
+         && found == c2, "the least recently released was evicted");
+   stub_destroy_context(found);
+
+   apple_glx_pixmap_pool_put(pfa, 1024, 1024, 4096, 1024 * 4096,
+                             new_context());
+   apple_glx_pixmap_pool_get_stats(&stats);
+   check(3 == destroyed_contexts && 1 == stats.entries,
+         "a pixmap larger than the limit isn't retained");
+   check(2 == stats.formats, "a pristine context for each pixel format");
+
+   apple_glx_pixmap_pool_flush();
+   check(0 == live_contexts, "the flush destroys every context");
+   check(5 + referenced_pfobjs == released_pfobjs,
+         "every pfobj reference was released");
+
+   printf("PASS\n");
+
+   return EXIT_SUCCESS;
+}
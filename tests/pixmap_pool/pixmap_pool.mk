@@ -0,0 +1,3 @@
+$(TEST_BUILD_DIR)/pixmap_pool: tests/pixmap_pool/pixmap_pool.c apple_glx_pixmap_pool.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/pixmap_pool/pixmap_pool.c $(INCLUDE) $(GL_CFLAGS) -o $@ apple_glx_pixmap_pool.o -lpthread
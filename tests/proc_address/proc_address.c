@@ -0,0 +1,122 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This compares the cold (first) and warm (cached) throughput of
+ * glXGetProcAddress.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+#define WARM_PASSES 1000
+
+static const char *names[] = {
+   "glActiveTexture", "glAttachShader", "glBindBuffer", "glBindTexture",
+   "glBlendEquation", "glBlendFuncSeparate", "glBufferData",
+   "glBufferSubData", "glClientActiveTexture", "glCompileShader",
+   "glCompressedTexImage2D", "glCreateProgram", "glCreateShader",
+   "glDeleteBuffers", "glDeleteProgram", "glDeleteShader",
+   "glDisableVertexAttribArray", "glDrawBuffers", "glDrawRangeElements",
+   "glEnableVertexAttribArray", "glGenBuffers", "glGenerateMipmapEXT",
+   "glGetAttribLocation", "glGetProgramiv", "glGetShaderInfoLog",
+   "glGetShaderiv", "glGetUniformLocation", "glLinkProgram",
+   "glMapBuffer", "glMultiTexCoord2f", "glPointParameterf",
+   "glSecondaryColor3f", "glShaderSource", "glTexImage3D",
+   "glUniform1f", "glUniform1i", "glUniform4fv", "glUniformMatrix4fv",
+   "glUnmapBuffer", "glUseProgram", "glVertexAttribPointer",
+   "glWindowPos2i", "glXCreatePbuffer", "glXGetFBConfigs",
+   "glXMakeContextCurrent", "glXQueryDrawable"
+};
+
+#define NUM_NAMES (sizeof(names) / sizeof(names[0]))
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static double
+resolve_all(int passes)
+{
+   double start;
+   int p;
+   unsigned int i;
+
+   start = current_time();
+
+   for (p = 0; p < passes; ++p) {
+      for (i = 0; i < NUM_NAMES; ++i) {
+         if (NULL == glXGetProcAddress((const GLubyte *) names[i])) {
+            fprintf(stderr, "error: unable to resolve %s\n", names[i]);
+            exit(EXIT_FAILURE);
+         }
+      }
+   }
+
+   return current_time() - start;
+}
+
+int
+main(int argc, char *argv[])
+{
+   Display *dpy;
+   int eventbase, errorbase;
+   double cold, warm;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   if (!glXQueryExtension(dpy, &eventbase, &errorbase)) {
+      fprintf(stderr, "GLX is not available!\n");
+      return EXIT_FAILURE;
+   }
+
+   cold = resolve_all(1);
+   warm = resolve_all(WARM_PASSES);
+
+   printf("cold: %10.0f lookups/sec\n", NUM_NAMES / cold);
+   printf("warm: %10.0f lookups/sec\n", NUM_NAMES * WARM_PASSES / warm);
+
+   XCloseDisplay(dpy);
+
+   return EXIT_SUCCESS;
+}
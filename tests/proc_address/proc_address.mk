@@ -0,0 +1,2 @@
+$(TEST_BUILD_DIR)/proc_address: tests/proc_address/proc_address.c $(LIBGL)
+	$(CC) tests/proc_address/proc_address.c $(INCLUDE) -o $@ $(LINK_TEST)
@@ -0,0 +1,168 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This compares two ways of reading a pbuffer while drawing to a window:
+ * switching the current drawables around every glReadPixels, and binding
+ * the pbuffer once as the read drawable with glXMakeContextCurrent.  It
+ * also checks that both return the color the pbuffer was cleared to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+#define READS 10000
+#define SIZE 64
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void
+check_pixels(const GLubyte * pixels, const char *what)
+{
+   if (pixels[0] != 255 || pixels[1] != 0 || pixels[2] != 0) {
+      fprintf(stderr, "error: %s read %u %u %u instead of red\n", what,
+              pixels[0], pixels[1], pixels[2]);
+      exit(EXIT_FAILURE);
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   int attrib[] = {
+      GLX_RED_SIZE, 8,
+      GLX_GREEN_SIZE, 8,
+      GLX_BLUE_SIZE, 8,
+      GLX_RENDER_TYPE, GLX_RGBA_BIT,
+      GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT | GLX_WINDOW_BIT,
+      None
+   };
+   int pbattrib[] = {
+      GLX_PBUFFER_WIDTH, SIZE,
+      GLX_PBUFFER_HEIGHT, SIZE,
+      None
+   };
+   static GLubyte pixels[SIZE * SIZE * 4];
+   Display *dpy;
+   Window root, win;
+   XVisualInfo *visinfo;
+   XSetWindowAttributes attr;
+   GLXFBConfig *fbconfig;
+   GLXPbuffer pbuf;
+   GLXContext ctx;
+   double start, swapped, bound;
+   int n, i;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   root = DefaultRootWindow(dpy);
+   fbconfig = glXChooseFBConfig(dpy, DefaultScreen(dpy), attrib, &n);
+
+   if (NULL == fbconfig || n < 1) {
+      fprintf(stderr, "error: no fbconfig for a window and a pbuffer\n");
+      return EXIT_FAILURE;
+   }
+
+   visinfo = glXGetVisualFromFBConfig(dpy, fbconfig[0]);
+
+   attr.background_pixel = 0;
+   attr.border_pixel = 0;
+   attr.colormap = XCreateColormap(dpy, root, visinfo->visual, AllocNone);
+
+   win = XCreateWindow(dpy, root, 0, 0, SIZE, SIZE, 0, visinfo->depth,
+                       InputOutput, visinfo->visual,
+                       CWBackPixel | CWBorderPixel | CWColormap, &attr);
+   XMapWindow(dpy, win);
+
+   pbuf = glXCreatePbuffer(dpy, fbconfig[0], pbattrib);
+   ctx = glXCreateNewContext(dpy, fbconfig[0], GLX_RGBA_TYPE, NULL, True);
+
+   if (None == pbuf || NULL == ctx) {
+      fprintf(stderr, "error: creating the pbuffer or the context\n");
+      return EXIT_FAILURE;
+   }
+
+   glXMakeContextCurrent(dpy, pbuf, pbuf, ctx);
+   glClearColor(1.0, 0.0, 0.0, 1.0);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glFinish();
+
+   glXMakeContextCurrent(dpy, win, win, ctx);
+   glClearColor(0.0, 0.0, 1.0, 1.0);
+   glClear(GL_COLOR_BUFFER_BIT);
+
+   /* The application switches drawables around each read. */
+   start = current_time();
+
+   for (i = 0; i < READS; ++i) {
+      glXMakeContextCurrent(dpy, pbuf, pbuf, ctx);
+      glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+      glXMakeContextCurrent(dpy, win, win, ctx);
+   }
+
+   swapped = (current_time() - start) * 1e6 / READS;
+   check_pixels(pixels, "the swapped path");
+
+   /* The pbuffer stays bound as the read drawable. */
+   glXMakeContextCurrent(dpy, win, pbuf, ctx);
+
+   start = current_time();
+
+   for (i = 0; i < READS; ++i)
+      glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+   bound = (current_time() - start) * 1e6 / READS;
+   check_pixels(pixels, "the bound path");
+
+   printf("make current per read: %.2f us/read\n", swapped);
+   printf("bound read drawable: %.2f us/read\n", bound);
+
+   glXMakeContextCurrent(dpy, None, None, NULL);
+   glXDestroyContext(dpy, ctx);
+   glXDestroyPbuffer(dpy, pbuf);
+   XCloseDisplay(dpy);
+
+   return EXIT_SUCCESS;
+}
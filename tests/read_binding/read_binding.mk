@@ -0,0 +1,2 @@
+$(TEST_BUILD_DIR)/read_binding: tests/read_binding/read_binding.c $(LIBGL)
+	$(CC) tests/read_binding/read_binding.c $(INCLUDE) -o $@ $(LINK_TEST)
@@ -0,0 +1,249 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This checks that glReadPixels reads the pbuffer bound only for reading
+ * with apple_glx_context_bind_read, and not the draw pbuffer.  A read only
+ * copies state that changed, reports its errors to glGetError, and the
+ * binding goes away with the release of the context.  It's built against
+ * the mock CGL, and run by make mock-test, which only needs the XIDs and
+ * round trips of mock_xserver.
+ */
+
+#define GL_GLEXT_PROTOTYPES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+#include "GL/glxint.h"
+#include "glcontextmodes.h"
+#include "apple_glx.h"
+#include "apple_glx_context.h"
+#include "apple_glx_drawable.h"
+#include "mock_cgl.h"
+
+#define SIZE 16
+
+static void
+fail(const char *fmt, ...)
+{
+   va_list args;
+
+   va_start(args, fmt);
+   fprintf(stderr, "error: ");
+   vfprintf(stderr, fmt, args);
+   fprintf(stderr, "\n");
+   va_end(args);
+
+   exit(EXIT_FAILURE);
+}
+
+static void
+clear(Display * dpy, void *ac, GLXPbuffer pbuf, GLfloat r, GLfloat g,
+      GLfloat b)
+{
+   if (apple_glx_make_current_context(dpy, NULL, ac, pbuf))
+      fail("unable to make pbuffer 0x%lx current", pbuf);
+
+   glClearColor(r, g, b, 1.0f);
+   glClear(GL_COLOR_BUFFER_BIT);
+}
+
+static void
+check_pixel(const char *what, GLubyte r, GLubyte g, GLubyte b)
+{
+   GLubyte pixel[4] = { 0 };
+
+   glReadPixels(SIZE / 2, SIZE / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+
+   if (pixel[0] != r || pixel[1] != g || pixel[2] != b)
+      fail("%s read %u %u %u instead of %u %u %u", what, pixel[0], pixel[1],
+           pixel[2], r, g, b);
+}
+
+static unsigned long
+copies(void)
+{
+   struct mock_cgl_stats stats;
+
+   MockCGLGetStats(&stats);
+
+   return stats.copy_context;
+}
+
+int
+main(int argc, char *argv[])
+{
+   Display *dpy;
+   __GLcontextModes *mode;
+   GLXPbuffer draw, read;
+   void *ac = NULL;
+   int error, i;
+   bool x11error;
+   GLubyte row[8];
+   unsigned long before;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy)
+      fail("opening display");
+
+   if (apple_init_glx(dpy))
+      fail("initializing GLX");
+
+   mode = _gl_context_modes_create(1, sizeof(*mode));
+
+   if (NULL == mode)
+      fail("allocating the mode");
+
+   mode->rgbMode = GL_TRUE;
+   mode->redBits = mode->greenBits = mode->blueBits = mode->alphaBits = 8;
+   mode->drawableType = GLX_PBUFFER_BIT;
+   mode->fbconfigID = 1;
+
+   if (apple_glx_pbuffer_create(dpy, (GLXFBConfig) mode, SIZE, SIZE, &error,
+                                &draw)
+       || apple_glx_pbuffer_create(dpy, (GLXFBConfig) mode, SIZE, SIZE,
+                                   &error, &read))
+      fail("creating the pbuffers: %d", error);
+
+   if (apple_glx_create_context(&ac, dpy, DefaultScreen(dpy), mode, NULL,
+                                &error, &x11error))
+      fail("creating the context: %d", error);
+
+   clear(dpy, ac, read, 1.0f, 0.0f, 0.0f);
+   clear(dpy, ac, draw, 0.0f, 1.0f, 0.0f);
+
+   apple_glx_context_bind_read(dpy, ac, draw, read);
+
+   /* The binding is reused by every read. */
+   for (i = 0; i < 2; ++i) {
+      before = copies();
+
+      if (!apple_glx_context_begin_read(ac))
+         fail("the read pbuffer isn't bound");
+
+      check_pixel("the read pbuffer", 255, 0, 0);
+
+      apple_glx_context_end_read(ac);
+
+      check_pixel("the draw pbuffer", 0, 255, 0);
+
+      /* Only the first read copies the state. */
+      if (copies() - before != (0 == i))
+         fail("read %d copied the state %lu times", i, copies() - before);
+   }
+
+   /* 
+    * A change of the state is copied by the next read.  There's no
+    * GLXContext for the wrappers in apple_xgl_api_read.c to find, so the
+    * changes are flagged as they would flag them.
+    */
+   glReadBuffer(GL_FRONT);
+   apple_glx_context_read_state_changed(ac, APPLE_GLX_READ_MODE_DIRTY);
+   before = copies();
+
+   if (!apple_glx_context_begin_read(ac))
+      fail("the read pbuffer isn't bound");
+
+   apple_glx_context_end_read(ac);
+
+   if (copies() - before != 1)
+      fail("the read buffer change wasn't copied");
+
+   glPixelStorei(GL_PACK_SKIP_PIXELS, 1);
+   apple_glx_context_read_state_changed(ac, APPLE_GLX_READ_PACK_DIRTY);
+   memset(row, 0, sizeof(row));
+
+   if (!apple_glx_context_begin_read(ac))
+      fail("the read pbuffer isn't bound");
+
+   glReadPixels(SIZE / 2, SIZE / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, row);
+   apple_glx_context_end_read(ac);
+
+   if (row[0] || row[4] != 255 || row[5] || row[6])
+      fail("the pack state wasn't copied");
+
+   glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+
+   /* The mock fails reads into a pixel pack buffer. */
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 1);
+   apple_glx_context_read_state_changed(ac, APPLE_GLX_READ_PACK_DIRTY);
+
+   if (!apple_glx_context_begin_read(ac))
+      fail("the read pbuffer isn't bound");
+
+   glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, row);
+   apple_glx_context_end_read(ac);
+
+   if (apple_glx_context_read_error(ac) != GL_INVALID_OPERATION)
+      fail("the error of the read wasn't kept");
+
+   if (apple_glx_context_read_error(ac) != GL_NO_ERROR
+       || glGetError() != GL_NO_ERROR)
+      fail("the error of the read was kept twice");
+
+   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+   apple_glx_context_bind_read(dpy, ac, draw, None);
+
+   if (apple_glx_context_begin_read(ac))
+      fail("the read pbuffer is still bound");
+
+   /* Releasing the context drops the binding, and the read pbuffer. */
+   apple_glx_context_bind_read(dpy, ac, draw, read);
+
+   if (apple_glx_make_current_context(dpy, ac, NULL, None))
+      fail("releasing the context");
+
+   if (apple_glx_context_begin_read(ac))
+      fail("the read pbuffer is bound after the release");
+
+   if (apple_glx_pbuffer_destroy(dpy, read))
+      fail("destroying the read pbuffer");
+
+   if (apple_glx_drawable_find(read, 0))
+      fail("the released context kept the read pbuffer");
+
+   apple_glx_destroy_context(&ac, dpy);
+
+   if (apple_glx_pbuffer_destroy(dpy, draw))
+      fail("destroying the draw pbuffer");
+
+   _gl_context_modes_destroy(mode);
+   XCloseDisplay(dpy);
+
+   printf("read_pbuffer: passed\n");
+
+   return EXIT_SUCCESS;
+}
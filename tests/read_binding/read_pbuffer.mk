@@ -0,0 +1,2 @@
+$(MOCK_BUILD_DIR)/read_pbuffer: tests/read_binding/read_pbuffer.c $(MOCK_LIBGL) $(MOCK_CGL)
+	$(CC) tests/read_binding/read_pbuffer.c $(MOCK_INCLUDE) $(MOCK_CFLAGS) -o $@ $(MOCK_LIBGL) $(MOCK_CGL) -Wl,-rpath,$(CURDIR)/$(MOCK_BUILD_DIR) -lX11 -lpthread
@@ -0,0 +1,232 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This tests the renderer capability cache in apple_glx_caps.c.  The
+ * apple_cgl table, glGetIntegerv and the display reconfiguration callback
+ * are replaced with stubs that count calls, so it doesn't need CGL or an
+ * X server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ApplicationServices/ApplicationServices.h>
+#include "apple_cgl.h"
+#include "apple_glx_caps.h"
+
+struct apple_cgl_api apple_cgl;
+
+static int create_calls = 0;
+static int choose_calls = 0;
+static int live_objects = 0;
+static CGDisplayReconfigurationCallBack reconfigured = NULL;
+static CGLContextObj current = NULL;
+static GLint max_dims = 4096;
+static GLint renderer_id = 0x1000;
+static CGLError describe_error = kCGLNoError;
+
+void
+apple_glx_diagnostic(const char *fmt, ...)
+{
+   (void) fmt;
+}
+
+CGError
+CGDisplayRegisterReconfigurationCallback(CGDisplayReconfigurationCallBack
+                                         proc, void *userInfo)
+{
+   reconfigured = proc;
+   return kCGErrorSuccess;
+}
+
+/* A reconfiguration has a notification before it and one after it. */
+static void
+reconfigure(void)
+{
+   reconfigured(1, kCGDisplayBeginConfigurationFlag, NULL);
+   reconfigured(1, 0, NULL);
+}
+
+void
+glGetIntegerv(GLenum pname, GLint * params)
+{
+   if (GL_MAX_VIEWPORT_DIMS == pname) {
+      params[0] = max_dims;
+      params[1] = max_dims;
+   }
+   else {
+      params[0] = max_dims / 2;
+   }
+}
+
+static CGLError
+stub_choose_pixel_format(const CGLPixelFormatAttribute * attribs,
+                         CGLPixelFormatObj * pix, GLint * npix)
+{
+   ++choose_calls;
+   ++live_objects;
+   *pix = malloc(1);
+   *npix = 1;
+   return kCGLNoError;
+}
+
+static CGLError
+stub_destroy_pixel_format(CGLPixelFormatObj pix)
+{
+   --live_objects;
+   free(pix);
+   return kCGLNoError;
+}
+
+static CGLError
+stub_describe_pixel_format(CGLPixelFormatObj pix, GLint pix_num,
+                           CGLPixelFormatAttribute attrib, GLint * value)
+{
+   if (kCGLPFARendererID != attrib)
+      return kCGLBadAttribute;
+
+   *value = renderer_id;
+   return describe_error;
+}
+
+static CGLError
+stub_create_context(CGLPixelFormatObj pix, CGLContextObj share,
+                    CGLContextObj * ctx)
+{
+   ++create_calls;
+   ++live_objects;
+   *ctx = malloc(1);
+   return kCGLNoError;
+}
+
+static CGLError
+stub_destroy_context(CGLContextObj ctx)
+{
+   --live_objects;
+   free(ctx);
+   return kCGLNoError;
+}
+
+static CGLError
+stub_set_current_context(CGLContextObj ctx)
+{
+   current = ctx;
+   return kCGLNoError;
+}
+
+static CGLContextObj
+stub_get_current_context(void)
+{
+   return current;
+}
+
+static const char *
+stub_error_string(CGLError error)
+{
+   return "stub error";
+}
+
+static void
+check(int cond, const char *what)
+{
+   if (!cond) {
+      fprintf(stderr, "FAIL: %s (creates %d live %d)\n", what,
+              create_calls, live_objects);
+      exit(EXIT_FAILURE);
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   struct apple_glx_screen_caps screen0 = { 0 }, screen1 = { 0 };
+   struct apple_glx_renderer_caps caps;
+   CGLContextObj app_context = (CGLContextObj) 0x1234;
+
+   apple_cgl.choose_pixel_format = stub_choose_pixel_format;
+   apple_cgl.destroy_pixel_format = stub_destroy_pixel_format;
+   apple_cgl.describe_pixel_format = stub_describe_pixel_format;
+   apple_cgl.create_context = stub_create_context;
+   apple_cgl.destroy_context = stub_destroy_context;
+   apple_cgl.set_current_context = stub_set_current_context;
+   apple_cgl.get_current_context = stub_get_current_context;
+   apple_cgl.error_string = stub_error_string;
+
+   check(!apple_glx_get_renderer_caps(&screen0, &caps), "the first query");
+   check(4096 == caps.max_viewport_dims[0] && 2048 == caps.max_texture_size,
+         "the probed limits");
+   check(1 == create_calls && 0 == live_objects,
+         "the probe releases its context");
+   check(NULL != reconfigured, "display changes are watched");
+
+   current = app_context;
+   check(!apple_glx_get_renderer_caps(&screen0, &caps)
+         && 1 == choose_calls && 1 == create_calls,
+         "a second query doesn't call CGL");
+   check(current == app_context, "the current context is restored");
+
+   check(!apple_glx_get_renderer_caps(&screen1, &caps) && 2 == create_calls,
+         "each screen has its own cache");
+
+   /* The renderer changes, but only a notification makes that visible. */
+   max_dims = 8192;
+   renderer_id = 0x2000;
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 2 == create_calls
+         && 4096 == caps.max_viewport_dims[0],
+         "the renderer isn't checked without a notification");
+
+   reconfigure();
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 3 == create_calls,
+         "another renderer is probed after a notification");
+   check(8192 == caps.max_viewport_dims[1], "the new limits are returned");
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 3 == create_calls
+         && 3 == choose_calls, "the new renderer is cached");
+
+   reconfigure();
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 3 == create_calls
+         && 4 == choose_calls,
+         "the same renderer after a notification isn't probed");
+
+   reconfigure();
+   describe_error = kCGLBadPixelFormat;
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 4 == create_calls,
+         "an unknown renderer is probed");
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 5 == create_calls,
+         "an unknown renderer isn't cached");
+
+   describe_error = kCGLNoError;
+   check(!apple_glx_get_renderer_caps(&screen0, &caps) && 5 == create_calls,
+         "the cache survives an unknown renderer");
+   check(0 == live_objects, "nothing leaked");
+
+   printf("PASS\n");
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,3 @@
+$(TEST_BUILD_DIR)/renderer_caps: tests/renderer_caps/renderer_caps.c apple_glx_caps.o
+	-if ! test -d $(TEST_BUILD_DIR); then $(MKDIR) $(TEST_BUILD_DIR); fi
+	$(CC) tests/renderer_caps/renderer_caps.c $(INCLUDE) $(GL_CFLAGS) -o $@ apple_glx_caps.o -lpthread
@@ -0,0 +1,38 @@
+#!/bin/sh
+#This runs startup_time against Xvfb directly, and then through xdelay,
+#which adds delay_ms to each direction of the connection.
+#
+#usage: launch_bench.sh startup_time xdelay delay_ms xvfb_display delayed_display
+
+if test $# -ne 5; then
+    echo "usage: $0 startup_time xdelay delay_ms xvfb_display delayed_display" >&2
+    exit 1
+fi
+
+STARTUP_TIME=$1
+XDELAY=$2
+DELAY_MS=$3
+XVFB_DISPLAY=$4
+DELAYED_DISPLAY=$5
+
+Xvfb :$XVFB_DISPLAY -screen 0 1280x1024x24 +extension GLX -nolisten tcp &
+XVFB_PID=$!
+
+$XDELAY $DELAY_MS $XVFB_DISPLAY $DELAYED_DISPLAY &
+XDELAY_PID=$!
+
+trap 'kill $XDELAY_PID $XVFB_PID 2>/dev/null' EXIT
+
+#Wait for both sockets.
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    if test -S /tmp/.X11-unix/X$XVFB_DISPLAY -a -S /tmp/.X11-unix/X$DELAYED_DISPLAY; then
+        break
+    fi
+    sleep 1
+done
+
+echo "direct:"
+DISPLAY=:$XVFB_DISPLAY $STARTUP_TIME || exit 1
+
+echo "with $DELAY_MS ms of delay each way:"
+DISPLAY=:$DELAYED_DISPLAY $STARTUP_TIME || exit 1
@@ -0,0 +1,103 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This measures the time to the first glXCreateContext, which includes
+ * the binding of the __gl_api dispatch table in apple_init_glx.
+ *
+ * Build libGL with make API_BINDING=eager or make API_BINDING=lazy
+ * (after a make clean), and compare the results.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+int
+main(int argc, char *argv[])
+{
+   int attrib[] = { GLX_RGBA,
+      GLX_RED_SIZE, 1,
+      GLX_GREEN_SIZE, 1,
+      GLX_BLUE_SIZE, 1,
+      None
+   };
+   Display *dpy;
+   XVisualInfo *visinfo;
+   GLXContext ctx;
+   double start, opened, created;
+
+   start = current_time();
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   opened = current_time();
+
+   visinfo = glXChooseVisual(dpy, DefaultScreen(dpy), attrib);
+
+   if (NULL == visinfo) {
+      fprintf(stderr, "error: couldn't get an RGB visual\n");
+      return EXIT_FAILURE;
+   }
+
+   ctx = glXCreateContext(dpy, visinfo, NULL, True);
+
+   if (NULL == ctx) {
+      fprintf(stderr, "error: glXCreateContext failed\n");
+      return EXIT_FAILURE;
+   }
+
+   created = current_time();
+
+   printf("XOpenDisplay: %.3f ms\n", (opened - start) * 1000.0);
+   printf("first glXCreateContext: %.3f ms\n", (created - start) * 1000.0);
+
+   glXDestroyContext(dpy, ctx);
+   XFree(visinfo);
+   XCloseDisplay(dpy);
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,5 @@
+$(TEST_BUILD_DIR)/startup_time: tests/startup_time/startup_time.c $(LIBGL)
+	$(CC) tests/startup_time/startup_time.c $(INCLUDE) -o $@ $(LINK_TEST)
+
+$(TEST_BUILD_DIR)/window_startup: tests/startup_time/window_startup.c $(LIBGL)
+	$(CC) tests/startup_time/window_startup.c $(INCLUDE) -o $@ $(LINK_TEST)
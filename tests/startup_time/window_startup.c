@@ -0,0 +1,206 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This measures the startup of an application with many windows: the
+ * time to create N windows and make each current once.  The plain X
+ * windows request their surfaces at the first make current, one round
+ * trip each.  The GLX windows prefetch them at glXCreateWindow.
+ *
+ * usage: window_startup [N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+#define DEFAULT_WINDOWS 32
+
+static int fbconfig_attribs[] = {
+   GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT,
+   GLX_RENDER_TYPE, GLX_RGBA_BIT,
+   GLX_RED_SIZE, 8,
+   GLX_GREEN_SIZE, 8,
+   GLX_BLUE_SIZE, 8,
+   None
+};
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static Window
+create_window(Display * dpy, XVisualInfo * visinfo, int n)
+{
+   XSetWindowAttributes attr;
+   Window root;
+
+   root = RootWindow(dpy, DefaultScreen(dpy));
+
+   attr.background_pixel = 0;
+   attr.border_pixel = 0;
+   attr.colormap = XCreateColormap(dpy, root, visinfo->visual, AllocNone);
+
+   return XCreateWindow(dpy, root, (n % 8) * 70, (n / 8) * 70, 64, 64, 0,
+                        visinfo->depth, InputOutput, visinfo->visual,
+                        CWBackPixel | CWBorderPixel | CWColormap, &attr);
+}
+
+/* Return the time in seconds, or a negative value if there was an error. */
+static double
+start_windows(Display * dpy, GLXFBConfig config, XVisualInfo * visinfo,
+              GLXContext ctx, int count, Bool use_glx_windows)
+{
+   Window *windows;
+   GLXWindow *drawables;
+   double start, elapsed;
+   int n;
+
+   windows = calloc(count, sizeof(*windows));
+   drawables = calloc(count, sizeof(*drawables));
+
+   if (NULL == windows || NULL == drawables)
+      return -1.0;
+
+   start = current_time();
+
+   for (n = 0; n < count; ++n) {
+      windows[n] = create_window(dpy, visinfo, n);
+      XMapWindow(dpy, windows[n]);
+
+      if (use_glx_windows)
+         drawables[n] = glXCreateWindow(dpy, config, windows[n], NULL);
+      else
+         drawables[n] = windows[n];
+
+      if (None == drawables[n])
+         return -1.0;
+   }
+
+   for (n = 0; n < count; ++n) {
+      if (!glXMakeCurrent(dpy, drawables[n], ctx))
+         return -1.0;
+
+      glClear(GL_COLOR_BUFFER_BIT);
+   }
+
+   glFinish();
+
+   elapsed = current_time() - start;
+
+   glXMakeCurrent(dpy, None, NULL);
+
+   for (n = 0; n < count; ++n) {
+      if (use_glx_windows)
+         glXDestroyWindow(dpy, drawables[n]);
+
+      XDestroyWindow(dpy, windows[n]);
+   }
+
+   XSync(dpy, False);
+
+   free(windows);
+   free(drawables);
+
+   return elapsed;
+}
+
+int
+main(int argc, char *argv[])
+{
+   Display *dpy;
+   GLXFBConfig *configs;
+   XVisualInfo *visinfo;
+   GLXContext ctx;
+   double plain, glx;
+   int count = DEFAULT_WINDOWS, n;
+
+   if (argc > 1)
+      count = atoi(argv[1]);
+
+   if (count < 1) {
+      fprintf(stderr, "usage: %s [N]\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   configs = glXChooseFBConfig(dpy, DefaultScreen(dpy), fbconfig_attribs,
+                               &n);
+
+   if (NULL == configs || n < 1) {
+      fprintf(stderr, "error: no usable GLXFBConfig\n");
+      return EXIT_FAILURE;
+   }
+
+   visinfo = glXGetVisualFromFBConfig(dpy, configs[0]);
+   ctx = glXCreateNewContext(dpy, configs[0], GLX_RGBA_TYPE, NULL, True);
+
+   if (NULL == visinfo || NULL == ctx) {
+      fprintf(stderr, "error: creating the context\n");
+      return EXIT_FAILURE;
+   }
+
+   /* The first pass pays for the GLX initialization. */
+   if (start_windows(dpy, configs[0], visinfo, ctx, 1, False) < 0.0) {
+      fprintf(stderr, "error: starting a window\n");
+      return EXIT_FAILURE;
+   }
+
+   plain = start_windows(dpy, configs[0], visinfo, ctx, count, False);
+   glx = start_windows(dpy, configs[0], visinfo, ctx, count, True);
+
+   if (plain < 0.0 || glx < 0.0) {
+      fprintf(stderr, "error: starting the windows\n");
+      return EXIT_FAILURE;
+   }
+
+   printf("%d X windows: %.3f ms\n", count, plain * 1000.0);
+   printf("%d GLX windows: %.3f ms\n", count, glx * 1000.0);
+
+   glXDestroyContext(dpy, ctx);
+   XFree(visinfo);
+   XFree(configs);
+   XCloseDisplay(dpy);
+
+   return EXIT_SUCCESS;
+}
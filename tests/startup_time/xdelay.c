@@ -0,0 +1,295 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This forwards an X display with a delay in each direction, so that a
+ * local Xvfb behaves like a remote display.  A round trip costs twice the
+ * delay.  It serves one client connection at a time.
+ *
+ * usage: xdelay delay_ms upstream_display listen_display
+ *
+ * The displays are numbers, and both use the local socket directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SOCKET_FORMAT "/tmp/.X11-unix/X%d"
+#define CHUNK_SIZE 65536
+
+struct chunk
+{
+   double due;
+   size_t length;
+   struct chunk *next;
+   char data[];
+};
+
+/* The data read from one side, waiting to be written to the other. */
+struct queue
+{
+   struct chunk *head, *tail;
+};
+
+static double
+current_ms(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void
+socket_path(struct sockaddr_un *addr, int display)
+{
+   memset(addr, 0, sizeof(*addr));
+   addr->sun_family = AF_UNIX;
+   snprintf(addr->sun_path, sizeof(addr->sun_path), SOCKET_FORMAT, display);
+}
+
+static int
+connect_display(int display)
+{
+   struct sockaddr_un addr;
+   int fd;
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   if (fd < 0)
+      return -1;
+
+   socket_path(&addr, display);
+
+   if (connect(fd, (struct sockaddr *) &addr, sizeof(addr))) {
+      close(fd);
+      return -1;
+   }
+
+   return fd;
+}
+
+static int
+listen_display(int display)
+{
+   struct sockaddr_un addr;
+   int fd;
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   if (fd < 0)
+      return -1;
+
+   socket_path(&addr, display);
+   unlink(addr.sun_path);
+
+   if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) || listen(fd, 4)) {
+      close(fd);
+      return -1;
+   }
+
+   return fd;
+}
+
+/* Return false at the end of the stream or on an error. */
+static int
+read_chunk(int fd, struct queue *q, double delay)
+{
+   struct chunk *c;
+   ssize_t n;
+
+   c = malloc(sizeof(*c) + CHUNK_SIZE);
+
+   if (NULL == c)
+      return 0;
+
+   n = read(fd, c->data, CHUNK_SIZE);
+
+   if (n <= 0) {
+      free(c);
+      return 0;
+   }
+
+   c->due = current_ms() + delay;
+   c->length = n;
+   c->next = NULL;
+
+   if (q->tail)
+      q->tail->next = c;
+   else
+      q->head = c;
+
+   q->tail = c;
+
+   return 1;
+}
+
+/* Return false on an error. */
+static int
+write_due(int fd, struct queue *q, double now)
+{
+   struct chunk *c;
+   size_t done;
+   ssize_t n;
+
+   while ((c = q->head) && c->due <= now) {
+      for (done = 0; done < c->length; done += n) {
+         n = write(fd, c->data + done, c->length - done);
+
+         if (n < 0 && EINTR == errno)
+            n = 0;
+         else if (n < 0)
+            return 0;
+      }
+
+      q->head = c->next;
+
+      if (NULL == q->head)
+         q->tail = NULL;
+
+      free(c);
+   }
+
+   return 1;
+}
+
+static void
+free_queue(struct queue *q)
+{
+   struct chunk *c, *next;
+
+   for (c = q->head; c; c = next) {
+      next = c->next;
+      free(c);
+   }
+
+   q->head = q->tail = NULL;
+}
+
+static void
+forward(int client, int upstream, double delay)
+{
+   struct queue to_upstream = { NULL, NULL }, to_client = { NULL, NULL };
+   struct pollfd fds[2];
+   double now, due;
+   int timeout;
+
+   for (;;) {
+      now = current_ms();
+
+      if (!write_due(upstream, &to_upstream, now)
+          || !write_due(client, &to_client, now))
+         break;
+
+      due = -1.0;
+
+      if (to_upstream.head)
+         due = to_upstream.head->due;
+
+      if (to_client.head && (due < 0.0 || to_client.head->due < due))
+         due = to_client.head->due;
+
+      timeout = (due < 0.0) ? -1 : (int) (due - now) + 1;
+
+      fds[0].fd = client;
+      fds[0].events = POLLIN;
+      fds[1].fd = upstream;
+      fds[1].events = POLLIN;
+
+      if (poll(fds, 2, timeout) < 0 && EINTR != errno)
+         break;
+
+      if ((fds[0].revents & (POLLIN | POLLHUP))
+          && !read_chunk(client, &to_upstream, delay))
+         break;
+
+      if ((fds[1].revents & (POLLIN | POLLHUP))
+          && !read_chunk(upstream, &to_client, delay))
+         break;
+   }
+
+   free_queue(&to_upstream);
+   free_queue(&to_client);
+}
+
+int
+main(int argc, char *argv[])
+{
+   int listener, client, upstream;
+   double delay;
+
+   if (argc != 4) {
+      fprintf(stderr, "usage: %s delay_ms upstream_display listen_display\n",
+              argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   delay = atof(argv[1]);
+   listener = listen_display(atoi(argv[3]));
+
+   if (listener < 0) {
+      perror("listen");
+      return EXIT_FAILURE;
+   }
+
+   for (;;) {
+      client = accept(listener, NULL, NULL);
+
+      if (client < 0) {
+         if (EINTR == errno)
+            continue;
+
+         perror("accept");
+         return EXIT_FAILURE;
+      }
+
+      upstream = connect_display(atoi(argv[2]));
+
+      if (upstream < 0) {
+         perror("connect");
+         close(client);
+         continue;
+      }
+
+      forward(client, upstream, delay);
+
+      close(client);
+      close(upstream);
+   }
+
+   return EXIT_SUCCESS;
+}
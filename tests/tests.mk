@@ -16,6 +16,23 @@ include tests/engine/engine.mk
 include tests/glxpixmap/glxpixmap.mk
 include tests/triangle_glx_single/triangle_glx.mk
 include tests/shared/shared.mk
+include tests/drawable_lookup/drawable_lookup.mk
+include tests/proc_address/proc_address.mk
+include tests/startup_time/startup_time.mk
+include tests/pfobj_cache/pfobj_cache.mk
+include tests/xfont/xfont.mk
+include tests/pixmap_pool/pixmap_pool.mk
+include tests/renderer_caps/renderer_caps.mk
+include tests/drawable_gc/drawable_gc.mk
+include tests/choose_config/choose_config.mk
+include tests/read_binding/read_binding.mk
+include tests/pixel_kernels/pixel_kernels.mk
+include tests/compsize/compsize.mk
+include tests/pixmap_buffer/pixmap_buffer.mk
+include tests/config_cache/config_cache.mk
+include tests/context_modes/context_modes.mk
+include tests/config_tags/config_tags.mk
+include tests/drawable_memory/drawable_memory.mk
 
 tests: $(TEST_BUILD_DIR)/simple $(TEST_BUILD_DIR)/fbconfigs $(TEST_BUILD_DIR)/triangle_glx \
   $(TEST_BUILD_DIR)/create_destroy_context $(TEST_BUILD_DIR)/glxgears $(TEST_BUILD_DIR)/glxinfo \
@@ -36,5 +53,25 @@ tests: $(TEST_BUILD_DIR)/simple $(TEST_BUILD_DIR)/fbconfigs $(TEST_BUILD_DIR)/tr
   $(TEST_BUILD_DIR)/triangle_glx_surface-2 \
   $(TEST_BUILD_DIR)/triangle_glx_withdraw_remap \
   $(TEST_BUILD_DIR)/triangle_glx_destroy_relation \
-  $(TEST_BUILD_DIR)/query_drawable
+  $(TEST_BUILD_DIR)/query_drawable \
+  $(TEST_BUILD_DIR)/drawable_lookup \
+  $(TEST_BUILD_DIR)/proc_address \
+  $(TEST_BUILD_DIR)/startup_time \
+  $(TEST_BUILD_DIR)/window_startup \
+  $(TEST_BUILD_DIR)/pfobj_cache \
+  $(TEST_BUILD_DIR)/usexfont \
+  $(TEST_BUILD_DIR)/pixmap_pool \
+  $(TEST_BUILD_DIR)/renderer_caps \
+  $(TEST_BUILD_DIR)/drawable_gc \
+  $(TEST_BUILD_DIR)/choose_config \
+  $(TEST_BUILD_DIR)/read_binding \
+  $(TEST_BUILD_DIR)/pixel_kernels \
+  $(TEST_BUILD_DIR)/pixel_kernels_bench \
+  $(TEST_BUILD_DIR)/compsize \
+  $(TEST_BUILD_DIR)/pixmap_buffer \
+  $(TEST_BUILD_DIR)/config_cache \
+  $(TEST_BUILD_DIR)/context_modes \
+  $(TEST_BUILD_DIR)/context_modes_bench \
+  $(TEST_BUILD_DIR)/config_tags \
+  $(TEST_BUILD_DIR)/drawable_memory
 
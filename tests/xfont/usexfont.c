@@ -0,0 +1,171 @@
+/*
+ Copyright (c) 2009 Apple Inc.
+ 
+ Permission is hereby granted, free of charge, to any person
+ obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software,
+ and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT.  IN NO EVENT SHALL THE ABOVE LISTED COPYRIGHT
+ HOLDER(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ 
+ Except as contained in this notice, the name(s) of the above
+ copyright holders shall not be used in advertising or otherwise to
+ promote the sale, use or other dealings in this Software without
+ prior written authorization.
+*/
+
+/*
+ * This times glXUseXFont for a 256 glyph range, first when the glyphs
+ * are rendered, and then when the cached bitmaps are reused by another
+ * context.  It also draws a string with the lists, and checks that some
+ * pixels were set.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+#define WIDTH 300
+#define HEIGHT 100
+
+static double
+current_time(void)
+{
+   struct timeval tv;
+
+   (void) gettimeofday(&tv, NULL);
+
+   return (double) tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static double
+use_font(Display * dpy, Font font, GLuint base)
+{
+   double start = current_time();
+
+   glXUseXFont(font, 0, 256, base);
+   glFinish();
+
+   return current_time() - start;
+}
+
+int
+main(int argc, char *argv[])
+{
+   int attrib[] = { GLX_RGBA,
+      GLX_RED_SIZE, 1,
+      GLX_GREEN_SIZE, 1,
+      GLX_BLUE_SIZE, 1,
+      None
+   };
+   const char *message = "glXUseXFont";
+   Display *dpy;
+   XVisualInfo *visinfo;
+   XSetWindowAttributes attr;
+   Window root, win;
+   GLXContext ctx, ctx2;
+   XFontStruct *fs;
+   GLuint base, base2;
+   GLubyte *pixels;
+   double cold, warm;
+   int i, lit = 0;
+
+   dpy = XOpenDisplay(NULL);
+
+   if (NULL == dpy) {
+      fprintf(stderr, "error: opening display\n");
+      return EXIT_FAILURE;
+   }
+
+   root = DefaultRootWindow(dpy);
+   visinfo = glXChooseVisual(dpy, DefaultScreen(dpy), attrib);
+
+   if (NULL == visinfo) {
+      fprintf(stderr, "error: couldn't get an RGB visual\n");
+      return EXIT_FAILURE;
+   }
+
+   attr.background_pixel = 0;
+   attr.border_pixel = 0;
+   attr.colormap = XCreateColormap(dpy, root, visinfo->visual, AllocNone);
+
+   win = XCreateWindow(dpy, root, 0, 0, WIDTH, HEIGHT, 0, visinfo->depth,
+                       InputOutput, visinfo->visual,
+                       CWBackPixel | CWBorderPixel | CWColormap, &attr);
+   XMapWindow(dpy, win);
+
+   fs = XLoadQueryFont(dpy, "fixed");
+
+   if (NULL == fs) {
+      fprintf(stderr, "error: unable to load the fixed font\n");
+      return EXIT_FAILURE;
+   }
+
+   ctx = glXCreateContext(dpy, visinfo, NULL, True);
+   ctx2 = glXCreateContext(dpy, visinfo, NULL, True);
+
+   if (NULL == ctx || NULL == ctx2) {
+      fprintf(stderr, "error: glXCreateContext failed\n");
+      return EXIT_FAILURE;
+   }
+
+   glXMakeCurrent(dpy, win, ctx2);
+   base2 = glGenLists(256);
+   cold = use_font(dpy, fs->fid, base2);
+
+   glXMakeCurrent(dpy, win, ctx);
+   base = glGenLists(256);
+   warm = use_font(dpy, fs->fid, base);
+
+   printf("first glXUseXFont: %.3f ms\n", cold * 1000.0);
+   printf("cached glXUseXFont: %.3f ms\n", warm * 1000.0);
+
+   glViewport(0, 0, WIDTH, HEIGHT);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   glOrtho(0.0, WIDTH, 0.0, HEIGHT, -1.0, 1.0);
+   glMatrixMode(GL_MODELVIEW);
+   glLoadIdentity();
+
+   glClearColor(0.0, 0.0, 0.0, 1.0);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glColor3f(1.0, 1.0, 1.0);
+   glRasterPos2i(10, HEIGHT / 2);
+   glListBase(base);
+   glCallLists(strlen(message), GL_UNSIGNED_BYTE, (const GLubyte *) message);
+   glFinish();
+
+   pixels = malloc(WIDTH * HEIGHT);
+   glReadPixels(0, 0, WIDTH, HEIGHT, GL_RED, GL_UNSIGNED_BYTE, pixels);
+
+   for (i = 0; i < WIDTH * HEIGHT; ++i) {
+      if (pixels[i])
+         ++lit;
+   }
+
+   printf("%d pixels were drawn\n", lit);
+
+   free(pixels);
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyContext(dpy, ctx);
+   glXDestroyContext(dpy, ctx2);
+   XCloseDisplay(dpy);
+
+   return lit ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,2 @@
+$(TEST_BUILD_DIR)/usexfont: tests/xfont/usexfont.c $(LIBGL)
+	$(CC) tests/xfont/usexfont.c $(INCLUDE) -o $@ $(LINK_TEST)
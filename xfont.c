@@ -104,9 +104,9 @@ dump_bitmap(unsigned int width, unsigned int height, GLubyte * bitmap)
 
 /* Implementation.  */
 
-/* Fill a BITMAP with a character C from thew current font
-   in the graphics context GC.  WIDTH is the width in bytes
-   and HEIGHT is the height in bits.
+/* The glyphs are rendered into bitmaps with a character C from the
+   current font, where WIDTH is the width in bytes and HEIGHT is the
+   height in bits.
 
    Note that the generated bitmaps must be used with
 
@@ -117,49 +117,182 @@ dump_bitmap(unsigned int width, unsigned int height, GLubyte * bitmap)
         glPixelStorei (GL_UNPACK_SKIP_PIXELS, 0);
         glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
 
-   Possible optimizations:
-
-     * use only one reusable pixmap with the maximum dimensions.
-     * draw the entire font into a single pixmap (careful with
-       proportional fonts!).
+   All of the requested glyphs are drawn into one atlas pixmap, in
+   cells that start on a byte boundary, and the atlas is read back with
+   a single XGetImage.  Each bitmap is then a plain copy of bytes from
+   the atlas.
 */
 
+/* The largest atlas pixmap.  Larger ranges use several atlases. */
+#define ATLAS_MAX_WIDTH 2048
+#define ATLAS_MAX_HEIGHT 2048
+
+/* The number of glyph ranges kept by the cache. */
+#define GLYPH_CACHE_SIZE 8
+
+struct glyph
+{
+   XCharStruct metrics;
+   int valid;
+   unsigned int bm_width, bm_height;
+   size_t offset;               /* Into the bitmaps of the glyph_set. */
+};
+
+/* This is a cached set of bitmaps for a (font, range). */
+struct glyph_set
+{
+   Display *dpy;
+   Font font;
+   int first, count;
+   struct glyph *glyphs;
+   GLubyte *bitmaps;
+   int users;                   /* The threads using the set. */
+   int evicted;                 /* The last user frees an evicted set. */
+   struct glyph_set *next;
+};
+
+static struct glyph_set *glyph_cache = NULL;
+
+static const GLubyte reverse_bits[256] = {
+#define R2(n) n, n + 2*64, n + 1*64, n + 3*64
+#define R4(n) R2(n), R2(n + 2*16), R2(n + 1*16), R2(n + 3*16)
+#define R6(n) R4(n), R4(n + 2*4 ), R4(n + 1*4 ), R4(n + 3*4 )
+   R6(0), R6(2), R6(1), R6(3)
+#undef R6
+#undef R4
+#undef R2
+};
 
 /*
- * Generate OpenGL-compatible bitmap.
+ * Convert the scanlines of a 1 bit XYPixmap image to MSB first bytes,
+ * so that pixel x is bit (7 - x % 8) of byte x / 8.
  */
 static void
-fill_bitmap(Display * dpy, Window win, GC gc,
-            unsigned int width, unsigned int height,
-            int x0, int y0, unsigned int c, GLubyte * bitmap)
+normalize_image(XImage * image)
+{
+   unsigned int unit = image->bitmap_unit / 8;
+   size_t i, j, size;
+   unsigned char *data = (unsigned char *) image->data;
+   unsigned char t;
+
+   size = (size_t) image->bytes_per_line * image->height;
+
+   /* The first pixel of each unit must be in its first byte. */
+   if (unit > 1 && image->byte_order != image->bitmap_bit_order) {
+      for (i = 0; i + unit <= size; i += unit) {
+         for (j = 0; j < unit / 2; ++j) {
+            t = data[i + j];
+            data[i + j] = data[i + unit - 1 - j];
+            data[i + unit - 1 - j] = t;
+         }
+      }
+   }
+
+   if (LSBFirst == image->bitmap_bit_order) {
+      for (i = 0; i < size; ++i)
+         data[i] = reverse_bits[data[i]];
+   }
+}
+
+/*
+ * Render the glyphs[start .. start + n) into an atlas, and copy each one
+ * into its bitmap.  Every cell is cell_width bytes by cell_height rows.
+ */
+static void
+fill_atlas(Display * dpy, Window win, GC gc, XFontStruct * fs,
+           struct glyph *glyphs, int first, int start, int n,
+           unsigned int cell_width, unsigned int cell_height,
+           unsigned int columns, GLubyte * bitmaps)
 {
    XImage *image;
-   unsigned int x, y;
    Pixmap pixmap;
-   XChar2b char2b;
+   XChar2b *chars;
+   XTextItem16 *items;
+   unsigned int atlas_width, atlas_height, rows;
+   int i, row, nitems, pen, origin;
+
+   rows = (n + columns - 1) / columns;
+   atlas_width = 8 * cell_width * (n < (int) columns ? n : columns);
+   atlas_height = cell_height * rows;
 
-   pixmap = XCreatePixmap(dpy, win, 8 * width, height, 1);
+   chars = Xmalloc(sizeof(*chars) * columns);
+   items = Xmalloc(sizeof(*items) * columns);
+
+   if (!chars || !items) {
+      Xfree(chars);
+      Xfree(items);
+      return;
+   }
+
+   pixmap = XCreatePixmap(dpy, win, atlas_width, atlas_height, 1);
    XSetForeground(dpy, gc, 0);
-   XFillRectangle(dpy, pixmap, gc, 0, 0, 8 * width, height);
+   XFillRectangle(dpy, pixmap, gc, 0, 0, atlas_width, atlas_height);
    XSetForeground(dpy, gc, 1);
 
-   char2b.byte1 = (c >> 8) & 0xff;
-   char2b.byte2 = (c & 0xff);
+   /* Each row of cells shares a baseline, so it's drawn as one string. */
+   for (row = 0; row < (int) rows; ++row) {
+      nitems = 0;
+      pen = 0;
+
+      for (i = row * columns; i < n && i < (row + 1) * (int) columns; ++i) {
+         struct glyph *g = &glyphs[start + i];
+         unsigned int c = first + start + i;
 
-   XDrawString16(dpy, pixmap, gc, x0, y0, &char2b, 1);
+         if (!g->valid || !g->bm_width || !g->bm_height)
+            continue;
+
+         /* The ink starts at the left edge of the cell. */
+         origin = 8 * cell_width * (i % columns) - g->metrics.lbearing;
+
+         chars[nitems].byte1 = (c >> 8) & 0xff;
+         chars[nitems].byte2 = (c & 0xff);
+         items[nitems].chars = &chars[nitems];
+         items[nitems].nchars = 1;
+         items[nitems].delta = origin - pen;
+         items[nitems].font = None;
+         ++nitems;
+
+         pen = origin + g->metrics.width;
+      }
+
+      if (nitems)
+         XDrawText16(dpy, pixmap, gc, 0, row * cell_height + fs->max_bounds.ascent,
+                     items, nitems);
+   }
+
+   image = XGetImage(dpy, pixmap, 0, 0, atlas_width, atlas_height, 1,
+                     XYPixmap);
 
-   image = XGetImage(dpy, pixmap, 0, 0, 8 * width, height, 1, XYPixmap);
    if (image) {
-      /* Fill the bitmap (X11 and OpenGL are upside down wrt each other).  */
-      for (y = 0; y < height; y++)
-         for (x = 0; x < 8 * width; x++)
-            if (XGetPixel(image, x, y))
-               bitmap[width * (height - y - 1) + x / 8] |=
-                  (1 << (7 - (x % 8)));
+      normalize_image(image);
+
+      for (i = 0; i < n; ++i) {
+         struct glyph *g = &glyphs[start + i];
+         const char *src;
+         unsigned int y, top;
+
+         if (!g->valid || !g->bm_width || !g->bm_height)
+            continue;
+
+         top = (i / columns) * cell_height
+            + fs->max_bounds.ascent - g->metrics.ascent;
+         src = image->data + (size_t) top * image->bytes_per_line
+            + cell_width * (i % columns);
+
+         /* Fill the bitmap (X11 and OpenGL are upside down wrt each other).  */
+         for (y = 0; y < g->bm_height; ++y) {
+            memcpy(bitmaps + g->offset
+                   + (size_t) g->bm_width * (g->bm_height - y - 1),
+                   src + (size_t) y * image->bytes_per_line, g->bm_width);
+         }
+      }
+
       XDestroyImage(image);
    }
 
    XFreePixmap(dpy, pixmap);
+   Xfree(chars);
+   Xfree(items);
 }
 
 /*
@@ -211,6 +344,199 @@ isvalid(XFontStruct * fs, int which)
    return (NULL);
 }
 
+/*
+ * Return true if the set was built from the same glyph metrics as fs,
+ * which guards against a Font XID that was reused for another font.
+ */
+static int
+glyph_set_matches(struct glyph_set *set, Display * dpy, XFontStruct * fs,
+                  int first, int count)
+{
+   XCharStruct *ch;
+   int i;
+
+   if (set->dpy != dpy || set->font != fs->fid
+       || set->first != first || set->count != count)
+      return 0;
+
+   for (i = 0; i < count; i++) {
+      ch = isvalid(fs, first + i);
+
+      if (!ch) {
+         if (set->glyphs[i].valid)
+            return 0;
+      }
+      else if (!set->glyphs[i].valid
+               || memcmp(ch, &set->glyphs[i].metrics, sizeof(*ch))) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+/* Find a cached glyph set, and move it to the front of the cache. */
+static struct glyph_set *
+find_glyph_set(Display * dpy, XFontStruct * fs, int first, int count)
+{
+   struct glyph_set *set, **prev;
+
+   __glXLock();
+
+   for (prev = &glyph_cache; (set = *prev); prev = &set->next) {
+      if (glyph_set_matches(set, dpy, fs, first, count)) {
+         *prev = set->next;
+         set->next = glyph_cache;
+         glyph_cache = set;
+         ++set->users;
+         break;
+      }
+   }
+
+   __glXUnlock();
+
+   return set;
+}
+
+static void
+free_glyph_set(struct glyph_set *set)
+{
+   Xfree(set->glyphs);
+   Xfree(set->bitmaps);
+   Xfree(set);
+}
+
+static void
+cache_glyph_set(struct glyph_set *set)
+{
+   struct glyph_set *i, **prev;
+   int n = 0;
+
+   __glXLock();
+
+   set->users = 1;
+   set->next = glyph_cache;
+   glyph_cache = set;
+
+   /* Evict the least recently used sets. */
+   for (prev = &glyph_cache; (i = *prev); ++n) {
+      if (n >= GLYPH_CACHE_SIZE) {
+         *prev = i->next;
+
+         if (i->users)
+            i->evicted = 1;
+         else
+            free_glyph_set(i);
+      }
+      else {
+         prev = &i->next;
+      }
+   }
+
+   __glXUnlock();
+}
+
+static void
+release_glyph_set(struct glyph_set *set)
+{
+   __glXLock();
+
+   if (0 == --set->users && set->evicted)
+      free_glyph_set(set);
+
+   __glXUnlock();
+}
+
+static struct glyph_set *
+create_glyph_set(Display * dpy, Window win, GC gc, XFontStruct * fs,
+                 int first, int count)
+{
+   struct glyph_set *set;
+   unsigned int max_width, max_height, cell_width, columns, rows_per_atlas;
+   size_t size = 0;
+   XCharStruct *ch;
+   int i, n;
+
+   set = Xmalloc(sizeof(*set));
+   if (!set)
+      return NULL;
+
+   set->dpy = dpy;
+   set->font = fs->fid;
+   set->first = first;
+   set->count = count;
+   set->users = 0;
+   set->evicted = 0;
+   set->next = NULL;
+   set->bitmaps = NULL;
+   set->glyphs = Xmalloc(sizeof(*set->glyphs) * count);
+
+   if (!set->glyphs) {
+      Xfree(set);
+      return NULL;
+   }
+
+   for (i = 0; i < count; i++) {
+      struct glyph *g = &set->glyphs[i];
+
+      /* check on index validity and get the bounds */
+      ch = isvalid(fs, first + i);
+      if (!ch) {
+         g->metrics = fs->max_bounds;
+         g->valid = 0;
+      }
+      else {
+         g->metrics = *ch;
+         g->valid = 1;
+      }
+
+      /* Round the width to a multiple of eight.  This is slightly
+         inefficient, but it makes the OpenGL part real easy.  */
+      g->bm_width = (g->metrics.rbearing - g->metrics.lbearing + 7) / 8;
+      g->bm_height = g->metrics.ascent + g->metrics.descent;
+      g->offset = size;
+
+      if (g->valid)
+         size += (size_t) g->bm_width * g->bm_height;
+   }
+
+   set->bitmaps = Xmalloc(size ? size : 1);
+   if (!set->bitmaps) {
+      free_glyph_set(set);
+      return NULL;
+   }
+
+   memset(set->bitmaps, '\0', size);
+
+   /* Every cell can fit any character.  */
+   max_width = fs->max_bounds.rbearing - fs->min_bounds.lbearing;
+   max_height = fs->max_bounds.ascent + fs->max_bounds.descent;
+   cell_width = (max_width + 7) / 8;
+
+   if (!cell_width || !max_height)
+      return set;
+
+   columns = ATLAS_MAX_WIDTH / (8 * cell_width);
+   if (!columns)
+      columns = 1;
+
+   rows_per_atlas = ATLAS_MAX_HEIGHT / max_height;
+   if (!rows_per_atlas)
+      rows_per_atlas = 1;
+
+   for (i = 0; i < count; i += n) {
+      n = count - i;
+
+      if (n > (int) (columns * rows_per_atlas))
+         n = columns * rows_per_atlas;
+
+      fill_atlas(dpy, win, gc, fs, set->glyphs, first, i, n,
+                 cell_width, max_height, columns, set->bitmaps);
+   }
+
+   return set;
+}
+
 _X_HIDDEN void
 DRI_glXUseXFont(Font font, int first, int count, int listbase)
 {
@@ -222,13 +548,11 @@ DRI_glXUseXFont(Font font, int first, int count, int listbase)
    XGCValues values;
    unsigned long valuemask;
    XFontStruct *fs;
+   struct glyph_set *set;
 
    GLint swapbytes, lsbfirst, rowlength;
    GLint skiprows, skippixels, alignment;
 
-   unsigned int max_width, max_height, max_bm_width, max_bm_height;
-   GLubyte *bm;
-
    int i;
 
    CC = __glXGetCurrentContext();
@@ -241,27 +565,34 @@ DRI_glXUseXFont(Font font, int first, int count, int listbase)
       return;
    }
 
-   /* Allocate a bitmap that can fit all characters.  */
-   max_width = fs->max_bounds.rbearing - fs->min_bounds.lbearing;
-   max_height = fs->max_bounds.ascent + fs->max_bounds.descent;
-   max_bm_width = (max_width + 7) / 8;
-   max_bm_height = max_height;
+#ifdef DEBUG
+   if (debug_xfonts)
+      dump_font_struct(fs);
+#endif
 
-   bm = (GLubyte *) Xmalloc((max_bm_width * max_bm_height) * sizeof(GLubyte));
-   if (!bm) {
-      XFreeFontInfo(NULL, fs, 1);
-      __glXSetError(CC, GL_OUT_OF_MEMORY);
-      return;
-   }
+   set = find_glyph_set(dpy, fs, first, count);
 
-#if 0
-   /* get the page info */
-   pages = fs->max_char_or_byte2 - fs->min_char_or_byte2 + 1;
-   firstchar = (fs->min_byte1 << 8) + fs->min_char_or_byte2;
-   lastchar = (fs->max_byte1 << 8) + fs->max_char_or_byte2;
-   rows = fs->max_byte1 - fs->min_byte1 + 1;
-   unsigned int first_char, last_char, pages, rows;
-#endif
+   if (!set) {
+      pixmap = XCreatePixmap(dpy, win, 10, 10, 1);
+      values.foreground = BlackPixel(dpy, DefaultScreen(dpy));
+      values.background = WhitePixel(dpy, DefaultScreen(dpy));
+      values.font = fs->fid;
+      valuemask = GCForeground | GCBackground | GCFont;
+      gc = XCreateGC(dpy, pixmap, valuemask, &values);
+      XFreePixmap(dpy, pixmap);
+
+      set = create_glyph_set(dpy, win, gc, fs, first, count);
+
+      XFreeGC(dpy, gc);
+
+      if (!set) {
+         XFreeFontInfo(NULL, fs, 1);
+         __glXSetError(CC, GL_OUT_OF_MEMORY);
+         return;
+      }
+
+      cache_glyph_set(set);
+   }
 
    /* Save the current packing mode for bitmaps.  */
    glGetIntegerv(GL_UNPACK_SWAP_BYTES, &swapbytes);
@@ -272,7 +603,7 @@ DRI_glXUseXFont(Font font, int first, int count, int listbase)
    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
 
    /* Enforce a standard packing mode which is compatible with
-      fill_bitmap() from above.  This is actually the default mode,
+      fill_atlas() from above.  This is actually the default mode,
       except for the (non)alignment.  */
    glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_FALSE);
    glPixelStorei(GL_UNPACK_LSB_FIRST, GL_FALSE);
@@ -281,77 +612,39 @@ DRI_glXUseXFont(Font font, int first, int count, int listbase)
    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-   pixmap = XCreatePixmap(dpy, win, 10, 10, 1);
-   values.foreground = BlackPixel(dpy, DefaultScreen(dpy));
-   values.background = WhitePixel(dpy, DefaultScreen(dpy));
-   values.font = fs->fid;
-   valuemask = GCForeground | GCBackground | GCFont;
-   gc = XCreateGC(dpy, pixmap, valuemask, &values);
-   XFreePixmap(dpy, pixmap);
-
-#ifdef DEBUG
-   if (debug_xfonts)
-      dump_font_struct(fs);
-#endif
-
    for (i = 0; i < count; i++) {
-      unsigned int width, height, bm_width, bm_height;
+      struct glyph *g = &set->glyphs[i];
+      unsigned int width, height;
       GLfloat x0, y0, dx, dy;
-      XCharStruct *ch;
-      int x, y;
-      unsigned int c = first + i;
       int list = listbase + i;
-      int valid;
-
-      /* check on index validity and get the bounds */
-      ch = isvalid(fs, c);
-      if (!ch) {
-         ch = &fs->max_bounds;
-         valid = 0;
-      }
-      else {
-         valid = 1;
-      }
 
 #ifdef DEBUG
       if (debug_xfonts) {
          char s[7];
+         unsigned int c = first + i;
          sprintf(s, isprint(c) ? "%c> " : "\\%03o> ", c);
-         dump_char_struct(ch, s);
+         dump_char_struct(&g->metrics, s);
       }
 #endif
 
       /* glBitmap()' parameters:
          straight from the glXUseXFont(3) manpage.  */
-      width = ch->rbearing - ch->lbearing;
-      height = ch->ascent + ch->descent;
-      x0 = -ch->lbearing;
-      y0 = ch->descent - 1;
-      dx = ch->width;
+      width = g->metrics.rbearing - g->metrics.lbearing;
+      height = g->metrics.ascent + g->metrics.descent;
+      x0 = -g->metrics.lbearing;
+      y0 = g->metrics.descent - 1;
+      dx = g->metrics.width;
       dy = 0;
 
-      /* X11's starting point.  */
-      x = -ch->lbearing;
-      y = ch->ascent;
-
-      /* Round the width to a multiple of eight.  We will use this also
-         for the pixmap for capturing the X11 font.  This is slightly
-         inefficient, but it makes the OpenGL part real easy.  */
-      bm_width = (width + 7) / 8;
-      bm_height = height;
-
       glNewList(list, GL_COMPILE);
-      if (valid && (bm_width > 0) && (bm_height > 0)) {
-
-         memset(bm, '\0', bm_width * bm_height);
-         fill_bitmap(dpy, win, gc, bm_width, bm_height, x, y, c, bm);
-
-         glBitmap(width, height, x0, y0, dx, dy, bm);
+      if (g->valid && (g->bm_width > 0) && (g->bm_height > 0)) {
+         glBitmap(width, height, x0, y0, dx, dy, set->bitmaps + g->offset);
 #ifdef DEBUG
          if (debug_xfonts) {
             printf("width/height = %u/%u\n", width, height);
-            printf("bm_width/bm_height = %u/%u\n", bm_width, bm_height);
-            dump_bitmap(bm_width, bm_height, bm);
+            printf("bm_width/bm_height = %u/%u\n", g->bm_width,
+                   g->bm_height);
+            dump_bitmap(g->bm_width, g->bm_height, set->bitmaps + g->offset);
          }
 #endif
       }
@@ -361,9 +654,8 @@ DRI_glXUseXFont(Font font, int first, int count, int listbase)
       glEndList();
    }
 
-   Xfree(bm);
+   release_glyph_set(set);
    XFreeFontInfo(NULL, fs, 1);
-   XFreeGC(dpy, gc);
 
    /* Restore saved packing modes.  */
    glPixelStorei(GL_UNPACK_SWAP_BYTES, swapbytes);